@@ -29,6 +29,8 @@
 #include "RtAccelerationStructure.h"
 #include "Device.h"
 #include "CopyContext.h"
+#include "GpuFence.h"
+#include "LowLevelContextData.h"
 #include "GFXAPI.h"
 
 namespace Falcor
@@ -55,6 +57,10 @@ uint64_t RtAccelerationStructurePostBuildInfoPool::getElement(CopyContext* pCont
         pContext->flush(true);
         mNeedFlush = false;
     }
+    else
+    {
+        pContext->getLowLevelData()->getFence()->syncCpu(mFenceValue);
+    }
     uint64_t result = 0;
     FALCOR_GFX_CALL(mpGFXQueryPool->getResult(index, 1, &result));
     return result;
@@ -65,4 +71,11 @@ void RtAccelerationStructurePostBuildInfoPool::reset(CopyContext* pContext)
     FALCOR_GFX_CALL(mpGFXQueryPool->reset());
     mNeedFlush = true;
 }
+
+void RtAccelerationStructurePostBuildInfoPool::submit(CopyContext* pContext)
+{
+    pContext->flush(false);
+    mFenceValue = pContext->getLowLevelData()->getFence()->getCpuValue() - 1;
+    mNeedFlush = false;
+}
 } // namespace Falcor
@@ -53,6 +53,13 @@ public:
     ~RtAccelerationStructurePostBuildInfoPool();
     uint64_t getElement(CopyContext* pContext, uint32_t index);
     void reset(CopyContext* pContext);
+
+    /**
+     * Submit the commands writing the post-build info without waiting for the GPU.
+     * A subsequent getElement() then only waits for these commands, not for the work submitted after them.
+     */
+    void submit(CopyContext* pContext);
+
     gfx::IQueryPool* getGFXQueryPool() const { return mpGFXQueryPool.get(); }
 
 protected:
@@ -62,6 +69,7 @@ private:
     Desc mDesc;
     Slang::ComPtr<gfx::IQueryPool> mpGFXQueryPool;
     bool mNeedFlush = true;
+    uint64_t mFenceValue = 0;
 };
 
 struct RtAccelerationStructurePostBuildInfoDesc
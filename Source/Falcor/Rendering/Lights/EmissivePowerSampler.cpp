@@ -26,11 +26,23 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "EmissivePowerSampler.h"
+#include "Utils/Sampling/AliasTableBuilder.h"
+#include "Utils/Threading.h"
 #include "Utils/Timing/Profiler.h"
-#include <algorithm>
 
 namespace Falcor
 {
+    namespace
+    {
+        // Pack 16-bit threshold (i.e., a half float) plus 2x 24-bit table entries.
+        uint2 packEntry(const AliasTableBuilder::Entry& entry, uint32_t alias, uint32_t index)
+        {
+            uint32_t prob = (uint32_t(f32tof16(entry.threshold)) << 16u);
+            uint2 lowPrec = uint2(alias & 0xFFFFFFu, index & 0xFFFFFFu);
+            return uint2(prob | ((lowPrec.x >> 8u) & 0xFFFFu), ((lowPrec.x & 0xFFu) << 24u) | lowPrec.y);
+        }
+    }
+
     bool EmissivePowerSampler::update(RenderContext* pRenderContext)
     {
         FALCOR_PROFILE(pRenderContext, "EmissivePowerSampler::update");
@@ -54,10 +66,20 @@ namespace Falcor
             std::vector<float> weights(numTris);
             for (size_t i = 0; i < numTris; i++) weights[i] = triangles[i].flux;
 
-            mTriangleTable = generateAliasTable(std::move(weights));
+            if (!mpTriangleAliasTable || weights.size() != mTriangleTable.getCount())
+            {
+                buildAliasTable(weights);
+                samplerChanged = true;
+            }
+            else if (mTriangleTable.update(weights) > 0)
+            {
+                // Moving emissive geometry marks the light collection as changed, but the flux is often unchanged.
+                // Only the blocks with changed flux are rebuilt and uploaded.
+                uploadAliasTable();
+                samplerChanged = true;
+            }
 
             mNeedsRebuild = false;
-            samplerChanged = true;
         }
 
         return samplerChanged;
@@ -67,8 +89,12 @@ namespace Falcor
     {
         FALCOR_ASSERT(var.isValid());
 
-        var["_emissivePower"]["invWeightsSum"] = 1.0f / mTriangleTable.weightSum;
-        var["_emissivePower"]["triangleAliasTable"] = mTriangleTable.fullTable;
+        auto emissivePower = var["_emissivePower"];
+        emissivePower["invWeightsSum"] = 1.0f / float(mTriangleTable.getWeightSum());
+        emissivePower["blockSize"] = mTriangleTable.getBlockSize();
+        emissivePower["blockCount"] = mTriangleTable.getBlockCount();
+        emissivePower["blockAliasTable"] = mpBlockAliasTable;
+        emissivePower["triangleAliasTable"] = mpTriangleAliasTable;
     }
 
     EmissivePowerSampler::EmissivePowerSampler(RenderContext* pRenderContext, ref<Scene> pScene)
@@ -78,95 +104,38 @@ namespace Falcor
         mpLightCollection = pScene->getLightCollection(pRenderContext);
     }
 
-    EmissivePowerSampler::AliasTable EmissivePowerSampler::generateAliasTable(std::vector<float> weights)
+    void EmissivePowerSampler::buildAliasTable(const std::vector<float>& weights)
     {
-        uint32_t N = uint32_t(weights.size());
-        std::uniform_int_distribution<uint32_t> rngDist;
-
-        double sum = 0.0f;
-        for (float f : weights)
-        {
-            sum += f;
-        }
-        for (float& f : weights)
-        {
-            f *= N / float(sum);
-        }
-
-        std::vector<uint32_t> permutation(N);
-        for (uint32_t i = 0; i < N; ++i)
-        {
-            permutation[i] = i;
-        }
-        std::sort(permutation.begin(), permutation.end(), [&](uint32_t a, uint32_t b) { return weights[a] < weights[b]; });
-
-        std::vector<float> thresholds(N);
-        std::vector<uint32_t> redirect(N);
-        std::vector<uint2> merged(N);
-        std::vector<uint2> fullTable(N);
+        const uint32_t N = uint32_t(weights.size());
+        if (N > (1u << 24)) throw RuntimeError("Too many emissive triangles for the alias table ({}). The maximum is 2^24.", N);
 
-        uint32_t head = 0;
-        uint32_t tail = N - 1;
+        mTriangleTable.build(weights);
+        mpTriangleAliasTable = Buffer::createTyped<uint2>(mpScene->getDevice(), N);
+        mpBlockAliasTable = Buffer::createTyped<uint2>(mpScene->getDevice(), mTriangleTable.getBlockCount());
+        uploadAliasTable();
+    }
 
-        while (head != tail)
+    void EmissivePowerSampler::uploadAliasTable()
+    {
+        // The block tables store aliases relative to the start of the block, the GPU table uses triangle indices.
+        const auto& entries = mTriangleTable.getEntries();
+        const uint32_t blockSize = mTriangleTable.getBlockSize();
+        std::vector<uint2> packedEntries;
+        for (const auto& range : mTriangleTable.collectDirtyRanges())
         {
-            int i = permutation[head];
-            int j = permutation[tail];
-
-            thresholds[i] = weights[i];
-            redirect[i] = j;
-            weights[j] -= 1.0f - weights[i];
-
-            if (head == tail - 1)
-            {
-                thresholds[j] = 1.0f;
-                redirect[j] = j;
-                break;
-            }
-            else if (weights[j] < 1.0f)
-            {
-                std::swap(permutation[head], permutation[tail]);
-                tail--;
-            }
-            else
+            packedEntries.resize(range.end - range.begin);
+            Threading::parallel_for(range.begin, range.end, [&](uint32_t i)
             {
-                head++;
-            }
-        }
-
-        for (uint32_t i = 0; i < N; ++i)
-        {
-            permutation[i] = i;
+                const uint32_t blockBegin = i - i % blockSize;
+                packedEntries[i - range.begin] = packEntry(entries[i], blockBegin + entries[i].alias, i);
+            });
+            mpTriangleAliasTable->setBlob(packedEntries.data(), range.begin * sizeof(uint2), packedEntries.size() * sizeof(uint2));
         }
 
-        for (uint32_t i = 0; i < N; ++i)
-        {
-            uint32_t dst = i + (rngDist(mAliasTableRng) % (N - i));
-            std::swap(thresholds[i], thresholds[dst]);
-            std::swap(redirect[i], redirect[dst]);
-            std::swap(permutation[i], permutation[dst]);
-        }
-
-        for (uint32_t i = 0; i < N; ++i)
-        {
-            merged[i] = uint2(redirect[i], permutation[i]);
-
-            // Pack 16-bit threshold (i.e., a half float) plus 2x 24-bit table entries
-            uint32_t prob = (uint32_t(f32tof16(thresholds[i])) << 16u);
-            uint2 lowPrec = uint2(redirect[i] & 0xFFFFFFu, permutation[i] & 0xFFFFFFu);
-            uint2 mergedEntry = uint2(prob | ((lowPrec.x >> 8u) & 0xFFFFu), ((lowPrec.x & 0xFFu) << 24u) | lowPrec.y);
-            fullTable[i] = mergedEntry;
-        }
-
-        AliasTable result
-        {
-            float(sum),
-            N,
-            Buffer::createTyped<uint2>(mpScene->getDevice(), N),
-        };
-
-        result.fullTable->setBlob(&fullTable[0], 0, N * sizeof(uint2));
-
-        return result;
+        // The table over the blocks is rebuilt on every change.
+        const auto& blockEntries = mTriangleTable.getBlockEntries();
+        packedEntries.resize(blockEntries.size());
+        for (uint32_t i = 0; i < blockEntries.size(); i++) packedEntries[i] = packEntry(blockEntries[i], blockEntries[i].alias, i);
+        mpBlockAliasTable->setBlob(packedEntries.data(), 0, packedEntries.size() * sizeof(uint2));
     }
 }
@@ -29,7 +29,7 @@
 #include "EmissiveLightSampler.h"
 #include "Core/Macros.h"
 #include "Scene/Lights/LightCollection.h"
-#include <random>
+#include "Utils/Sampling/HierarchicalAliasTable.h"
 #include <vector>
 
 namespace Falcor
@@ -38,17 +38,13 @@ namespace Falcor
     struct ShaderVar;
 
     /** Sample geometry proportionally to its emissive power.
+
+        The triangles are sampled with a two-level alias table (see HierarchicalAliasTable), so that
+        a change in the flux of a few triangles only rebuilds and uploads the tables of their blocks.
     */
     class FALCOR_API EmissivePowerSampler : public EmissiveLightSampler
     {
     public:
-        struct AliasTable
-        {
-            float weightSum;                ///< Total weight of all elements used to create the alias table
-            uint32_t N;                     ///< Number of entries in the alias table (and # elements in the buffers)
-            ref<Buffer> fullTable;          ///< A compressed/packed merged table.  Max 2^24 (16 million) entries per table.
-        };
-
         /** Creates a EmissivePowerSampler for a given scene.
             \param[in] pRenderContext The render context.
             \param[in] pScene The scene.
@@ -69,18 +65,22 @@ namespace Falcor
         virtual void setShaderData(const ShaderVar& var) const override;
 
     protected:
-        /** Generate an alias table
-            \param[in] weights  The weights we'd like to sample each entry proportional to
-            \returns The alias table
+        /** Build the alias table from scratch and allocate its GPU buffers.
+            \param[in] weights The weights we'd like to sample each entry proportional to.
+        */
+        void buildAliasTable(const std::vector<float>& weights);
+
+        /** Upload the blocks of the alias table modified since the last upload, and the table over the blocks.
         */
-        AliasTable generateAliasTable(std::vector<float> weights);
+        void uploadAliasTable();
 
         // Internal state
         bool                            mNeedsRebuild = true;   ///< Trigger rebuild on the next call to update(). We should always build on the first call, so the initial value is true.
 
         ref<const LightCollection>      mpLightCollection;
 
-        std::mt19937                    mAliasTableRng;
-        AliasTable                      mTriangleTable;
+        HierarchicalAliasTable          mTriangleTable;         ///< Alias table over the emissive triangles weighted by their flux.
+        ref<Buffer>                     mpTriangleAliasTable;   ///< Packed per-block alias tables, one entry per triangle. Max 2^24 (16 million) entries.
+        ref<Buffer>                     mpBlockAliasTable;      ///< Packed alias table over the blocks.
     };
 }
@@ -33,6 +33,10 @@
 namespace
 {
     const char kShaderFile[] = "Rendering/Lights/LightBVHRefit.cs.slang";
+
+    // Maximum fraction of moved triangles for refitting the BVH on the CPU. The CPU refit waits for the moved
+    // triangles to be read back, so it only pays off if it saves refitting and uploading most of the nodes.
+    const float kMaxCPURefitTriangleFraction = 0.01f;
 }
 
 namespace Falcor
@@ -45,13 +49,17 @@ namespace Falcor
         mInternalUpdater = ComputePass::create(mpDevice, kShaderFile, "updateInternalNodes");
     }
 
-    // TODO: Only update the ones that moved.
     void LightBVH::refit(RenderContext* pRenderContext)
     {
         FALCOR_PROFILE(pRenderContext, "LightBVH::refit()");
 
         FALCOR_ASSERT(mIsValid);
 
+        // Refitting doesn't change the hierarchy, so the wide BVH stats stay valid but its node attributes need to be collapsed again.
+        mIsWideBVHValid = false;
+        mCPURefitNodeCount = 0;
+        if (refitOnCPU(pRenderContext)) return;
+
         // Update all leaf nodes.
         {
             auto var = mLeafUpdater->getRootVar()["CB"];
@@ -89,6 +97,43 @@ namespace Falcor
         mIsCpuDataValid = false;
     }
 
+    bool LightBVH::refitOnCPU(RenderContext* pRenderContext)
+    {
+        if (!mRefitter.isInitialized()) return false;
+
+        // Gather the triangles of the updated mesh lights.
+        const auto& meshLights = mpLightCollection->getMeshLights();
+        const uint32_t maxTriangleCount = (uint32_t)(kMaxCPURefitTriangleFraction * mpLightCollection->getTotalLightCount());
+        std::vector<uint32_t> updatedTriangles;
+        for (uint32_t lightIdx : mpLightCollection->getUpdatedLights())
+        {
+            const MeshLightData& meshLight = meshLights[lightIdx];
+            if (updatedTriangles.size() + meshLight.triangleCount > maxTriangleCount) return false;
+            for (uint32_t i = 0; i < meshLight.triangleCount; i++) updatedTriangles.push_back(meshLight.triangleOffset + i);
+        }
+        if (updatedTriangles.empty()) return false;
+
+        FALCOR_PROFILE(pRenderContext, "refitOnCPU");
+
+        // Refit the affected nodes. The light collection only reads back the triangles of the moved mesh lights
+        // (and of any mesh lights moved while the BVH was refit on the GPU). The CPU-side nodes are only out of
+        // date if the previous refit ran on the GPU.
+        mpLightCollection->prepareSyncCPUData(pRenderContext);
+        syncDataToCPU();
+        mRefitter.refit(mNodes, mpLightCollection->getMeshLightTriangles(pRenderContext), updatedTriangles);
+        mCPURefitNodeCount = mRefitter.getRefitNodeCount();
+
+        // Upload the modified node ranges.
+        for (const auto& range : mRefitter.collectDirtyRanges())
+        {
+            const size_t offset = range.begin * sizeof(PackedNode);
+            const size_t size = (range.end - range.begin) * sizeof(PackedNode);
+            pRenderContext->updateBuffer(mpBVHNodesBuffer.get(), mNodes.data() + range.begin, offset, size);
+        }
+
+        return true;
+    }
+
     void LightBVH::renderUI(Gui::Widgets& widget)
     {
         // Render the BVH stats.
@@ -106,6 +151,17 @@ namespace Falcor
             "  Triangle count:      " + std::to_string(stats.triangleCount) + "\n";
         widget.text(statsStr);
 
+        if (stats.wideBVHWidth != 0)
+        {
+            const std::string wideStatsStr =
+                "  Wide BVH width:      " + std::to_string(stats.wideBVHWidth) + "\n" +
+                "  Wide tree height:    " + std::to_string(stats.wideTreeHeight) + "\n" +
+                "  Wide size:           " + std::to_string(stats.wideByteSize) + " bytes\n" +
+                "  Wide node count:     " + std::to_string(stats.wideNodeCount) + "\n" +
+                "  Wide leaf count:     " + std::to_string(stats.wideLeafCount) + "\n";
+            widget.text(wideStatsStr);
+        }
+
         if (auto nodeGroup = widget.group("Node count per level"))
         {
             std::string countStr;
@@ -139,6 +195,36 @@ namespace Falcor
         mBVHStats = BVHStats();
         mIsValid = false;
         mIsCpuDataValid = false;
+        mRefitter = LightBVHRefitter();
+        mCPURefitNodeCount = 0;
+        mWideBVHWidth = 0;
+        mWideBVH4 = LightBVH4();
+        mWideBVH8 = LightBVH8();
+        mIsWideBVHValid = false;
+    }
+
+    const LightBVH4* LightBVH::getWideBVH4() const
+    {
+        if (mWideBVHWidth != 4) return nullptr;
+        updateWideBVH();
+        return &mWideBVH4;
+    }
+
+    const LightBVH8* LightBVH::getWideBVH8() const
+    {
+        if (mWideBVHWidth != 8) return nullptr;
+        updateWideBVH();
+        return &mWideBVH8;
+    }
+
+    void LightBVH::updateWideBVH() const
+    {
+        FALCOR_ASSERT(isValid());
+        if (mIsWideBVHValid) return;
+
+        if (mWideBVHWidth == 4) mWideBVH4.build(getNodes());
+        else if (mWideBVHWidth == 8) mWideBVH8.build(getNodes());
+        mIsWideBVHValid = true;
     }
 
     void LightBVH::traverseBVH(const NodeFunction& evalInternal, const NodeFunction& evalLeaf, uint32_t rootNodeIndex)
@@ -214,6 +300,22 @@ namespace Falcor
         traverseBVH(evalInternal, evalLeaf);
 
         mBVHStats.byteSize = (uint32_t)(mNodes.size() * sizeof(mNodes[0]));
+
+        // Collapse the wide BVH from the freshly built nodes.
+        mBVHStats.wideBVHWidth = mWideBVHWidth;
+        if (mWideBVHWidth != 0)
+        {
+            updateWideBVH();
+            auto setWideStats = [&](const auto& wideStats)
+            {
+                mBVHStats.wideTreeHeight = wideStats.treeHeight;
+                mBVHStats.wideByteSize = wideStats.byteSize;
+                mBVHStats.wideNodeCount = wideStats.nodeCount;
+                mBVHStats.wideLeafCount = wideStats.leafCount;
+            };
+            if (mWideBVHWidth == 4) setWideStats(mWideBVH4.getStats());
+            else setWideStats(mWideBVH8.getStats());
+        }
     }
 
     void LightBVH::updateNodeIndices()
@@ -300,6 +402,8 @@ namespace Falcor
         FALCOR_ASSERT(mpTriangleBitmasksBuffer->getSize() >= triangleBitmasks.size() * sizeof(triangleBitmasks[0]));
         mpTriangleBitmasksBuffer->setBlob(triangleBitmasks.data(), 0, triangleBitmasks.size() * sizeof(triangleBitmasks[0]));
 
+        mRefitter.init(mNodes, triangleIndices, mpLightCollection->getTotalLightCount());
+
         mIsCpuDataValid = true;
     }
 
@@ -26,7 +26,9 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #pragma once
+#include "LightBVHRefitter.h"
 #include "LightBVHTypes.slang"
+#include "WideLightBVH.h"
 #include "Core/Macros.h"
 #include "Core/API/Buffer.h"
 #include "Scene/Lights/LightCollection.h"
@@ -78,12 +80,18 @@ namespace Falcor
         */
         LightBVH(ref<Device> pDevice, const ref<const LightCollection>& pLightCollection);
 
-        /** Refit all the BVH nodes to the underlying geometry, without changing the hierarchy.
+        /** Refit the BVH nodes to the underlying geometry, without changing the hierarchy.
+            If only a small fraction of the triangles moved, only the affected nodes are refit on the CPU and uploaded.
+            Otherwise all nodes are refit on the GPU.
             The BVH needs to have been built before trying to refit it.
             \param[in] pRenderContext The render context.
         */
         void refit(RenderContext* pRenderContext);
 
+        /** Get the number of nodes refit on the CPU by the last call to refit(), or zero if the BVH was refit on the GPU.
+        */
+        uint32_t getCPURefitNodeCount() const { return mCPURefitNodeCount; }
+
         /** Perform a depth-first traversal of the BVH and run a function on each node.
             \param[in] evalInternal Function called on each internal node.
             \param[in] evalLeaf Function called on each leaf node.
@@ -102,6 +110,12 @@ namespace Falcor
             uint32_t internalNodeCount = 0;                  ///< Number of internal nodes inside the BVH.
             uint32_t leafNodeCount = 0;                      ///< Number of leaf nodes inside the BVH.
             uint32_t triangleCount = 0;                      ///< Number of triangles inside the BVH.
+
+            uint32_t wideBVHWidth = 0;                       ///< Number of children per node of the wide BVH, or 0 if no wide BVH was collapsed.
+            uint32_t wideTreeHeight = 0;                     ///< Number of edges on the longest path between the root node and a leaf of the wide BVH.
+            uint32_t wideByteSize = 0;                       ///< Number of bytes occupied by the wide BVH nodes.
+            uint32_t wideNodeCount = 0;                      ///< Number of wide BVH nodes.
+            uint32_t wideLeafCount = 0;                      ///< Number of leaves in the wide BVH.
         };
 
         /** Returns stats.
@@ -113,6 +127,19 @@ namespace Falcor
         */
         bool isValid() const { return mIsValid; }
 
+        /** Get the BVH nodes, e.g. for collapsing the BVH into a WideLightBVH.
+            The CPU-side copy is synchronized with the GPU if the BVH has been refit.
+        */
+        const std::vector<PackedNode>& getNodes() const { syncDataToCPU(); return mNodes; }
+
+        /** Get the wide BVH collapsed from this BVH.
+            The wide BVH is only available if it was enabled with LightBVHBuilder::Options::wideBVHWidth.
+            After a refit it is collapsed again from the refit nodes, which synchronizes the CPU-side nodes with the GPU.
+            \return The wide BVH, or nullptr if the BVH was not built with that width.
+        */
+        const LightBVH4* getWideBVH4() const;
+        const LightBVH8* getWideBVH8() const;
+
         /** Render the UI. This default implementation just shows the stats.
         */
         void renderUI(Gui::Widgets& widget);
@@ -130,6 +157,8 @@ namespace Falcor
 
         void uploadCPUBuffers(const std::vector<uint32_t>& triangleIndices, const std::vector<uint64_t>& triangleBitmasks);
         void syncDataToCPU() const;
+        void updateWideBVH() const;
+        bool refitOnCPU(RenderContext* pRenderContext);
 
         /** Invalidate the BVH.
         */
@@ -156,6 +185,12 @@ namespace Falcor
         BVHStats                              mBVHStats;
         bool                                  mIsValid = false;         ///< True when the BVH has been built.
         mutable bool                          mIsCpuDataValid = false;  ///< Indicates whether the CPU-side data matches the GPU buffers.
+        LightBVHRefitter                      mRefitter;                ///< Incremental CPU refit of the nodes affected by moved triangles.
+        uint32_t                              mCPURefitNodeCount = 0;   ///< Number of nodes refit on the CPU by the last refit.
+        uint32_t                              mWideBVHWidth = 0;        ///< Number of children per node of the wide BVH, or 0 if it is disabled.
+        mutable LightBVH4                     mWideBVH4;                ///< Wide BVH collapsed from the nodes if mWideBVHWidth is 4.
+        mutable LightBVH8                     mWideBVH8;                ///< Wide BVH collapsed from the nodes if mWideBVHWidth is 8.
+        mutable bool                          mIsWideBVHValid = false;  ///< Indicates whether the wide BVH matches the nodes.
 
         // GPU resources
         ref<Buffer>                           mpBVHNodesBuffer;         ///< Buffer holding all BVH nodes.
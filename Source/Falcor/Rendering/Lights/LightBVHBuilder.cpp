@@ -29,9 +29,11 @@
 #include "Core/Assert.h"
 #include "Core/Errors.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
 #include "Utils/Timing/Profiler.h"
 #include "Utils/Math/MathConstants.slangh"
 #include <algorithm>
+#include <exception>
 
 namespace
 {
@@ -45,6 +47,51 @@ namespace
     const uint32_t kMaxLeafTriangleCount = 1 << PackedNode::kTriangleCountBits;
     const uint32_t kMaxLeafTriangleOffset = 1 << PackedNode::kTriangleOffsetBits;
 
+    // Number of triangles per chunk when reducing over the triangles of a node.
+    // The chunks depend neither on the thread count nor on whether the build is parallel, so the result is deterministic.
+    const uint32_t kReductionChunkSize = 16384;
+
+    // Minimum number of triangles in a node for building its two subtrees in parallel.
+    const uint32_t kMinParallelSubtreeTriangleCount = 4096;
+
+    const Gui::DropdownList kWideBVHWidthList =
+    {
+        { 0, "Disabled" },
+        { 4, "4" },
+        { 8, "8" },
+    };
+
+    /** Reduce over the range [begin, end).
+        The range is split into chunks of kReductionChunkSize elements. Each chunk is reduced in order with chunkFunc(chunkBegin, chunkEnd, value)
+        starting from the identity value, and the chunk results are then combined in chunk order with combineFunc(result, value).
+        The summation order is the same for serial and parallel reductions, so both produce bit-identical results.
+        \param[in] parallel Reduce the chunks in parallel.
+        \return The reduced value.
+    */
+    template<typename T, typename ChunkFunc, typename CombineFunc>
+    T reduceChunks(uint32_t begin, uint32_t end, bool parallel, const T& identity, ChunkFunc&& chunkFunc, CombineFunc&& combineFunc)
+    {
+        const uint32_t chunkCount = (end - begin + kReductionChunkSize - 1) / kReductionChunkSize;
+        if (chunkCount <= 1)
+        {
+            T value = identity;
+            chunkFunc(begin, end, value);
+            return value;
+        }
+
+        std::vector<T> values(chunkCount, identity);
+        auto reduceChunk = [&](uint32_t chunk)
+        {
+            const uint32_t chunkBegin = begin + chunk * kReductionChunkSize;
+            chunkFunc(chunkBegin, std::min(chunkBegin + kReductionChunkSize, end), values[chunk]);
+        };
+        if (parallel) Threading::parallel_for(0u, chunkCount, reduceChunk, 1);
+        else for (uint32_t chunk = 0; chunk < chunkCount; ++chunk) reduceChunk(chunk);
+
+        for (uint32_t chunk = 1; chunk < chunkCount; ++chunk) combineFunc(values[0], values[chunk]);
+        return values[0];
+    }
+
     inline float safeACos(float v)
     {
         return std::acos(std::clamp(v, -1.0f, 1.0f));
@@ -230,6 +277,11 @@ namespace Falcor
     {
         FALCOR_PROFILE(pRenderContext, "LightBVHBuilder::build()");
 
+        if (mOptions.wideBVHWidth != 0 && mOptions.wideBVHWidth != 4 && mOptions.wideBVHWidth != 8)
+        {
+            throw RuntimeError("Wide light BVH width must be 0, 4 or 8 (got {})", mOptions.wideBVHWidth);
+        }
+
         bvh.clear();
         FALCOR_ASSERT(!bvh.isValid() && bvh.mNodes.empty());
 
@@ -238,10 +290,33 @@ namespace Falcor
         const auto& triangles = bvh.mpLightCollection->getMeshLightTriangles(pRenderContext);
         if (triangles.empty()) return;
 
+        std::vector<uint32_t> triangleIndices;
+        std::vector<uint64_t> triangleBitmasks;
+        buildNodes(triangles, bvh.mNodes, triangleIndices, triangleBitmasks);
+
+        // If there are no non-culled triangles, we're done.
+        if (bvh.mNodes.empty()) return;
+
+        // The BVH is ready, mark it as valid and upload the data.
+        bvh.mIsValid = true;
+        bvh.mMaxTriangleCountPerLeaf = mOptions.maxTriangleCountPerLeaf;
+        bvh.mWideBVHWidth = mOptions.wideBVHWidth;
+        bvh.uploadCPUBuffers(triangleIndices, triangleBitmasks);
+
+        // Computate metadata.
+        bvh.finalize();
+    }
+
+    void LightBVHBuilder::buildNodes(const std::vector<LightCollection::MeshLightTriangle>& triangles, std::vector<PackedNode>& nodes, std::vector<uint32_t>& triangleIndices, std::vector<uint64_t>& triangleBitmasks)
+    {
+        nodes.clear();
+        triangleIndices.clear();
+        triangleBitmasks.clear();
+
         // Create list of triangles that should be included in BVH.
         // For each triangle, precompute data we need for the build.
-        BuildingData data(bvh.mNodes);
-        data.trianglesData.reserve(triangles.size());
+        std::vector<TriangleSortData> trianglesData;
+        trianglesData.reserve(triangles.size());
 
         for (size_t i = 0; i < triangles.size(); i++)
         {
@@ -258,19 +333,19 @@ namespace Falcor
                 tri.flux = triangles[i].flux;
                 tri.triangleIndex = static_cast<uint32_t>(i);
 
-                data.trianglesData.push_back(tri);
+                trianglesData.push_back(tri);
             }
         }
 
         // If there are no non-culled triangles, we're done.
-        if (data.trianglesData.empty()) return;
+        if (trianglesData.empty()) return;
 
         // Validate options.
         if (mOptions.maxTriangleCountPerLeaf > kMaxLeafTriangleCount)
         {
             throw RuntimeError("Max triangle count per leaf exceeds the maximum supported ({})", kMaxLeafTriangleCount);
         }
-        if (data.trianglesData.size() > kMaxLeafTriangleOffset + kMaxLeafTriangleCount)
+        if (trianglesData.size() > kMaxLeafTriangleOffset + kMaxLeafTriangleCount)
         {
             throw RuntimeError("Emissive triangle count exceeds the maximum supported ({})", kMaxLeafTriangleOffset + kMaxLeafTriangleCount);
         }
@@ -279,7 +354,7 @@ namespace Falcor
         // To be grossly conservative, assume each triangle requires two nodes.
         // This is only system RAM and shouldn't be that much, so it's not worth being more careful about it.
         // TODO: Better estimate of how many nodes we will need.
-        data.nodes.clear();
+        BuildingData data(nodes, trianglesData, triangleBitmasks);
         data.nodes.reserve(2 * data.trianglesData.size());
         data.triangleIndices.reserve(data.trianglesData.size());
 
@@ -300,13 +375,7 @@ namespace Falcor
         float cosConeAngle;
         computeLightingConesInternal(0, data, cosConeAngle);
 
-        // The BVH is ready, mark it as valid and upload the data.
-        bvh.mIsValid = true;
-        bvh.mMaxTriangleCountPerLeaf = mOptions.maxTriangleCountPerLeaf;
-        bvh.uploadCPUBuffers(data.triangleIndices, data.triangleBitmasks);
-
-        // Computate metadata.
-        bvh.finalize();
+        triangleIndices = std::move(data.triangleIndices);
     }
 
     bool LightBVHBuilder::renderUI(Gui::Widgets& widget)
@@ -347,6 +416,10 @@ namespace Falcor
             }
         }
 
+        optionsChanged |= widget.checkbox("Parallel build", options.useParallelBuild);
+        optionsChanged |= widget.dropdown("Wide BVH width", kWideBVHWidthList, options.wideBVHWidth);
+        widget.tooltip("Also collapse the BVH into a wide BVH with compressed child attributes and show its stats.", true);
+
         return optionsChanged;
     }
 
@@ -355,13 +428,20 @@ namespace Falcor
         FALCOR_ASSERT(triangleRange.begin < triangleRange.end);
 
         // Compute the AABB and total flux of the node.
-        float nodeFlux = 0.f;
-        AABB nodeBounds;
-        for (uint32_t dataIndex = triangleRange.begin; dataIndex < triangleRange.end; ++dataIndex)
-        {
-            nodeBounds |= data.trianglesData[dataIndex].bounds;
-            nodeFlux += data.trianglesData[dataIndex].flux;
-        }
+        const auto [nodeBounds, nodeFlux] = reduceChunks(triangleRange.begin, triangleRange.end, options.useParallelBuild, std::make_pair(AABB(), 0.f),
+            [&data](uint32_t begin, uint32_t end, std::pair<AABB, float>& value)
+            {
+                for (uint32_t dataIndex = begin; dataIndex < end; ++dataIndex)
+                {
+                    value.first |= data.trianglesData[dataIndex].bounds;
+                    value.second += data.trianglesData[dataIndex].flux;
+                }
+            },
+            [](std::pair<AABB, float>& result, const std::pair<AABB, float>& value)
+            {
+                result.first |= value.first;
+                result.second += value.second;
+            });
         FALCOR_ASSERT(nodeBounds.valid());
 
         data.currentNodeFlux = nodeFlux;
@@ -395,11 +475,20 @@ namespace Falcor
                 throw RuntimeError("BVH depth of {} reached. Maximum of {} allowed.", depth + 1, kMaxBVHDepth);
             }
 
-            uint32_t leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, Range(triangleRange.begin, splitResult.triangleIndex), data);
-            uint32_t rightIndex = buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, Range(splitResult.triangleIndex, triangleRange.end), data);
+            const Range leftRange(triangleRange.begin, splitResult.triangleIndex);
+            const Range rightRange(splitResult.triangleIndex, triangleRange.end);
+            if (options.useParallelBuild && triangleRange.length() >= kMinParallelSubtreeTriangleCount)
+            {
+                node.rightChildIdx = buildSubtreesInParallel(options, splitHeuristic, bitmask, depth, leftRange, rightRange, data);
+            }
+            else
+            {
+                uint32_t leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, leftRange, data);
+                uint32_t rightIndex = buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, rightRange, data);
 
-            FALCOR_ASSERT(leftIndex == nodeIndex + 1); // The left node should always be placed immediately after the current node.
-            node.rightChildIdx = rightIndex;
+                FALCOR_ASSERT(leftIndex == nodeIndex + 1); // The left node should always be placed immediately after the current node.
+                node.rightChildIdx = rightIndex;
+            }
 
             data.nodes[nodeIndex].setInternalNode(node);
             return nodeIndex;
@@ -438,6 +527,60 @@ namespace Falcor
         }
     }
 
+    uint32_t LightBVHBuilder::buildSubtreesInParallel(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& leftRange, const Range& rightRange, BuildingData& data)
+    {
+        const uint32_t nodeIndex = (uint32_t)data.nodes.size() - 1;
+
+        // Build the left subtree in a separate task, directly into the output.
+        uint32_t leftIndex = 0;
+        Threading::Task leftTask = Threading::dispatchTask([&]()
+        {
+            leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, leftRange, data);
+        });
+
+        // Build the right subtree on this thread into separate storage. The triangle ranges are disjoint,
+        // so both subtrees can share the triangle data and the per-triangle bitmasks.
+        std::vector<PackedNode> rightNodes;
+        rightNodes.reserve(2 * rightRange.length());
+        BuildingData rightData(rightNodes, data.trianglesData, data.triangleBitmasks);
+        rightData.triangleIndices.reserve(rightRange.length());
+
+        std::exception_ptr pException;
+        try
+        {
+            buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, rightRange, rightData);
+        }
+        catch (...)
+        {
+            pException = std::current_exception();
+        }
+        leftTask.finish();
+        if (pException) std::rethrow_exception(pException);
+
+        FALCOR_ASSERT(leftIndex == nodeIndex + 1); // The left node should always be placed immediately after the current node.
+
+        // Append the right subtree, offsetting its child indices and triangle offsets.
+        // The indices are patched in the packed data directly as repacking the node attributes would not be lossless.
+        const uint32_t rightIndex = (uint32_t)data.nodes.size();
+        const uint32_t triangleOffset = (uint32_t)data.triangleIndices.size();
+        for (PackedNode node : rightNodes)
+        {
+            if (node.isLeaf())
+            {
+                FALCOR_ASSERT((node.data[0].x & (kMaxLeafTriangleOffset - 1)) + triangleOffset < kMaxLeafTriangleOffset);
+                node.data[0].x += triangleOffset;
+            }
+            else
+            {
+                node.data[0].x += rightIndex;
+            }
+            data.nodes.push_back(node);
+        }
+        data.triangleIndices.insert(data.triangleIndices.end(), rightData.triangleIndices.begin(), rightData.triangleIndices.end());
+
+        return rightIndex;
+    }
+
     float3 LightBVHBuilder::computeLightingConesInternal(const uint32_t nodeIndex, BuildingData& data, float& cosConeAngle)
     {
         if (!data.nodes[nodeIndex].isLeaf())
@@ -566,15 +709,20 @@ namespace Falcor
                 return std::min((uint32_t)((p - bmin) * scale), parameters.binCount - 1);
             };
 
-            // Reset the bins.
-            for (Bin& bin : bins) bin = Bin();
-
-            // Fill the bins with all triangles.
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
-            {
-                const auto& td = data.trianglesData[i];
-                bins[getBinId(td)] |= td;
-            }
+            // Fill the bins with all triangles. Large ranges are binned in chunks that are merged afterwards.
+            bins = reduceChunks(triangleRange.begin, triangleRange.end, parameters.useParallelBuild, std::vector<Bin>(parameters.binCount),
+                [&](uint32_t begin, uint32_t end, std::vector<Bin>& chunkBins)
+                {
+                    for (uint32_t i = begin; i < end; ++i)
+                    {
+                        const auto& td = data.trianglesData[i];
+                        chunkBins[getBinId(td)] |= td;
+                    }
+                },
+                [](std::vector<Bin>& result, const std::vector<Bin>& chunkBins)
+                {
+                    for (size_t i = 0; i < result.size(); ++i) result[i] |= chunkBins[i];
+                });
 
             // First, compute A_j(L) * N_j(L) by sweeping over the bins from left to right.
             // Note that the costs vector has n-1 elements when there are n bins; the i:th elements represents the split between bin i and i+1.
@@ -736,15 +884,20 @@ namespace Falcor
                 return std::min((uint32_t)((p - bmin) * scale), parameters.binCount - 1);
             };
 
-            // Reset the bins.
-            for (Bin& bin : bins) bin = Bin();
-
-            // Fill the bins with all triangles.
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
-            {
-                const auto& td = data.trianglesData[i];
-                bins[getBinId(td)] |= td;
-            }
+            // Fill the bins with all triangles. Large ranges are binned in chunks that are merged afterwards.
+            bins = reduceChunks(triangleRange.begin, triangleRange.end, parameters.useParallelBuild, std::vector<Bin>(parameters.binCount),
+                [&](uint32_t begin, uint32_t end, std::vector<Bin>& chunkBins)
+                {
+                    for (uint32_t i = begin; i < end; ++i)
+                    {
+                        const auto& td = data.trianglesData[i];
+                        chunkBins[getBinId(td)] |= td;
+                    }
+                },
+                [](std::vector<Bin>& result, const std::vector<Bin>& chunkBins)
+                {
+                    for (size_t i = 0; i < result.size(); ++i) result[i] |= chunkBins[i];
+                });
 
             // Compute the lighting cones for each bin.
             // The cone direction is the average direction over all lights in the bin and the cone angle is grown to include all.
@@ -755,12 +908,24 @@ namespace Falcor
                 bin.cosConeAngle = length(bin.coneDirection) < FLT_MIN ? kInvalidCosConeAngle : 1.0f;
                 bin.coneDirection = normalize(bin.coneDirection);
             }
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
-            {
-                const auto& td = data.trianglesData[i];
-                Bin& bin = bins[getBinId(td)];
-                bin.cosConeAngle = computeCosConeAngle(bin.coneDirection, bin.cosConeAngle, td.coneDirection, td.cosConeAngle);
-            }
+            // Growing a cone only takes the minimum of the cone angles, so the chunks can be merged with std::min.
+            std::vector<float> binCosConeAngles(bins.size());
+            for (size_t i = 0; i < bins.size(); ++i) binCosConeAngles[i] = bins[i].cosConeAngle;
+            binCosConeAngles = reduceChunks(triangleRange.begin, triangleRange.end, parameters.useParallelBuild, binCosConeAngles,
+                [&](uint32_t begin, uint32_t end, std::vector<float>& cosConeAngles)
+                {
+                    for (uint32_t i = begin; i < end; ++i)
+                    {
+                        const auto& td = data.trianglesData[i];
+                        const uint32_t binId = getBinId(td);
+                        cosConeAngles[binId] = computeCosConeAngle(bins[binId].coneDirection, cosConeAngles[binId], td.coneDirection, td.cosConeAngle);
+                    }
+                },
+                [](std::vector<float>& result, const std::vector<float>& cosConeAngles)
+                {
+                    for (size_t i = 0; i < result.size(); ++i) result[i] = std::min(result[i], cosConeAngles[i]);
+                });
+            for (size_t i = 0; i < bins.size(); ++i) bins[i].cosConeAngle = binCosConeAngles[i];
 
             // First, compute A_j(L) * N_j(L) by sweeping over the bins from left to right.
             // Note that the costs vector has n-1 elements when there are n bins; the i:th elements represents the split between bin i and i+1.
@@ -78,6 +78,8 @@ namespace Falcor
             bool           allowRefitting = true;                                ///< Rather than always rebuilding the BVH from scratch, keep the hierarchy but update the bounds and lighting cones.
             bool           usePreintegration = true;                             ///< Use pre-integration for culling out emissive triangles and use their flux when computing the splits. Only valid when using the BinnedSAOH split heuristic.
             bool           useLightingCones = true;                              ///< Use lighting cones when computing the splits. Only valid when using the BinnedSAOH split heuristic.
+            bool           useParallelBuild = true;                              ///< Build subtrees and bin large triangle ranges in parallel. The result is bit-identical to the serial build.
+            uint32_t       wideBVHWidth = 0;                                     ///< Also collapse the BVH into a WideLightBVH with this many children per node (4 or 8) and compute its stats. Set to 0 to disable.
 
             template<typename Archive>
             void serialize(Archive& ar)
@@ -93,6 +95,8 @@ namespace Falcor
                 ar("allowRefitting", allowRefitting);
                 ar("usePreintegration", usePreintegration);
                 ar("useLightingCones", useLightingCones);
+                ar("useParallelBuild", useParallelBuild);
+                ar("wideBVHWidth", wideBVHWidth);
             }
         };
 
@@ -106,6 +110,14 @@ namespace Falcor
         */
         void build(RenderContext* pRenderContext, LightBVH& bvh);
 
+        /** Build the BVH nodes on the CPU. This is the part of build() that doesn't access the GPU.
+            \param[in] triangles Emissive triangles.
+            \param[out] nodes BVH nodes. Empty if no triangle is included in the BVH.
+            \param[out] triangleIndices Triangle indices sorted by leaf node.
+            \param[out] triangleBitmasks Bit pattern retracing the tree traversal to reach each triangle, indexed by triangle index.
+        */
+        void buildNodes(const std::vector<LightCollection::MeshLightTriangle>& triangles, std::vector<PackedNode>& nodes, std::vector<uint32_t>& triangleIndices, std::vector<uint64_t>& triangleBitmasks);
+
         bool renderUI(Gui::Widgets& widget);
 
         const Options& getOptions() const { return mOptions; }
@@ -146,12 +158,13 @@ namespace Falcor
         struct BuildingData
         {
             std::vector<PackedNode>& nodes;                 ///< BVH nodes generated by the builder.
-            std::vector<TriangleSortData> trianglesData;    ///< Compact list of triangles to include in build.
+            std::vector<TriangleSortData>& trianglesData;   ///< Compact list of triangles to include in build. Shared by subtrees built in parallel, which work on disjoint ranges.
             std::vector<uint32_t> triangleIndices;          ///< Triangle indices sorted by leaf node. Each leaf node refers to a contiguous array of triangle indices.
-            std::vector<uint64_t> triangleBitmasks;         ///< Array containing the per triangle bit pattern retracing the tree traversal to reach the triangle: 0=left child, 1=right child; this array gets filled in during the build process. Indexed by global triangle index.
+            std::vector<uint64_t>& triangleBitmasks;        ///< Array containing the per triangle bit pattern retracing the tree traversal to reach the triangle: 0=left child, 1=right child; this array gets filled in during the build process. Indexed by global triangle index. Shared by subtrees built in parallel.
             float currentNodeFlux = 0.f;                    ///< Used by computeSAOHSplit() as the leaf creation cost.
 
-            BuildingData(std::vector<PackedNode>& bvhNodes) : nodes(bvhNodes) {}
+            BuildingData(std::vector<PackedNode>& bvhNodes, std::vector<TriangleSortData>& triangles, std::vector<uint64_t>& bitmasks)
+                : nodes(bvhNodes), trianglesData(triangles), triangleBitmasks(bitmasks) {}
         };
 
         /** Compute the split according to a specified heuristic.
@@ -176,6 +189,13 @@ namespace Falcor
         */
         uint32_t buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data);
 
+        /** Build the two subtrees of an internal node in parallel.
+            The left subtree is built into data, the right one into separate storage that is appended afterwards,
+            so the node order is the same as for the serial build.
+            \return Index of the right child node.
+        */
+        uint32_t buildSubtreesInParallel(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& leftRange, const Range& rightRange, BuildingData& data);
+
         /** Recursive computation of lighting cones for all internal nodes.
             \param[in] nodeIndex Index of the current node.
             \param[in,out] data Updated node data.
@@ -0,0 +1,263 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "LightBVHRefitter.h"
+#include "Core/Assert.h"
+#include "Utils/Threading.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stack>
+
+namespace
+{
+    using namespace Falcor;
+
+    const uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+    // Minimum number of nodes at a level for refitting them in parallel.
+    const uint32_t kMinParallelNodeCount = 256;
+
+    inline float sinFromCos(float cosAngle)
+    {
+        return std::sqrt(std::max(0.f, 1.f - cosAngle * cosAngle));
+    }
+
+    /** Refit a leaf node to its triangles. Matches updateLeafNodes() in LightBVHRefit.cs.slang.
+    */
+    void refitLeaf(PackedNode& packedNode, const std::vector<uint32_t>& triangleIndices, const std::vector<LightCollection::MeshLightTriangle>& triangles)
+    {
+        LeafNode node = packedNode.getLeafNode();
+
+        float3 aabbMin = float3(std::numeric_limits<float>::max());
+        float3 aabbMax = float3(-std::numeric_limits<float>::max());
+        float3 normalsSum = float3(0.f);
+        for (uint32_t i = 0; i < node.triangleCount; i++)
+        {
+            const auto& tri = triangles[triangleIndices[node.triangleOffset + i]];
+            for (uint32_t vertexIndex = 0; vertexIndex < 3; vertexIndex++)
+            {
+                aabbMin = min(aabbMin, tri.vtx[vertexIndex].pos);
+                aabbMax = max(aabbMax, tri.vtx[vertexIndex].pos);
+            }
+            normalsSum += tri.normal;
+        }
+        node.attribs.setAABB(aabbMin, aabbMax);
+
+        const float coneDirectionLength = length(normalsSum);
+        float3 coneDirection = float3(0.f);
+        float cosConeAngle = kInvalidCosConeAngle;
+        if (coneDirectionLength >= FLT_MIN)
+        {
+            coneDirection = normalsSum / coneDirectionLength;
+            cosConeAngle = 1.f;
+            for (uint32_t i = 0; i < node.triangleCount; i++)
+            {
+                const float cosDiffAngle = dot(coneDirection, triangles[triangleIndices[node.triangleOffset + i]].normal);
+                cosConeAngle = std::min(cosConeAngle, cosDiffAngle);
+            }
+            cosConeAngle = std::max(cosConeAngle, -1.f); // Guard against numerical errors
+        }
+        node.attribs.cosConeAngle = cosConeAngle;
+        node.attribs.coneDirection = coneDirection;
+
+        packedNode.setLeafNode(node);
+    }
+
+    /** Refit an internal node to its children. Matches updateInternalNodes() in LightBVHRefit.cs.slang.
+    */
+    void refitInternal(std::vector<PackedNode>& nodes, uint32_t nodeIndex)
+    {
+        InternalNode node = nodes[nodeIndex].getInternalNode();
+
+        const SharedNodeAttributes leftNode = nodes[nodeIndex + 1].getNodeAttributes();
+        const SharedNodeAttributes rightNode = nodes[node.rightChildIdx].getNodeAttributes();
+
+        node.attribs.setAABB(min(leftNode.origin - leftNode.extent, rightNode.origin - rightNode.extent), max(leftNode.origin + leftNode.extent, rightNode.origin + rightNode.extent));
+
+        const float3 coneDirectionSum = leftNode.coneDirection + rightNode.coneDirection;
+        const float coneDirectionLength = length(coneDirectionSum);
+        float3 coneDirection = float3(0.f);
+        float cosConeAngle = kInvalidCosConeAngle;
+        if (coneDirectionLength >= FLT_MIN)
+        {
+            coneDirection = coneDirectionSum / coneDirectionLength;
+            if (leftNode.cosConeAngle != kInvalidCosConeAngle && rightNode.cosConeAngle != kInvalidCosConeAngle)
+            {
+                // Rotate (cosDiffAngle, sinDiffAngle) counterclockwise by each child's cone spread angle.
+                const float cosLeftDiffAngle = dot(coneDirection, leftNode.coneDirection);
+                const float sinLeftDiffAngle = sinFromCos(cosLeftDiffAngle);
+                const float cosRightDiffAngle = dot(coneDirection, rightNode.coneDirection);
+                const float sinRightDiffAngle = sinFromCos(cosRightDiffAngle);
+
+                const float sinLeftConeAngle = sinFromCos(leftNode.cosConeAngle);
+                const float sinRightConeAngle = sinFromCos(rightNode.cosConeAngle);
+
+                const float sinLeftTotalAngle = sinLeftConeAngle * cosLeftDiffAngle + sinLeftDiffAngle * leftNode.cosConeAngle;
+                const float sinRightTotalAngle = sinRightConeAngle * cosRightDiffAngle + sinRightDiffAngle * rightNode.cosConeAngle;
+
+                // If either total angle is larger than pi, the cone would represent the whole sphere and is deactivated.
+                if (sinLeftTotalAngle > 0.f && sinRightTotalAngle > 0.f)
+                {
+                    const float cosLeftTotalAngle = leftNode.cosConeAngle * cosLeftDiffAngle - sinLeftConeAngle * sinLeftDiffAngle;
+                    const float cosRightTotalAngle = rightNode.cosConeAngle * cosRightDiffAngle - sinRightConeAngle * sinRightDiffAngle;
+                    cosConeAngle = std::max(std::min(cosLeftTotalAngle, cosRightTotalAngle), -1.f); // Guard against numerical errors
+                }
+            }
+        }
+        node.attribs.cosConeAngle = cosConeAngle;
+        node.attribs.coneDirection = coneDirection;
+
+        nodes[nodeIndex].setInternalNode(node);
+    }
+}
+
+namespace Falcor
+{
+    void LightBVHRefitter::init(const std::vector<PackedNode>& nodes, const std::vector<uint32_t>& triangleIndices, uint32_t triangleCount)
+    {
+        mParents.assign(nodes.size(), kInvalidIndex);
+        mDepths.assign(nodes.size(), 0);
+        mTriangleIndices = triangleIndices;
+        mTriangleLeaves.assign(triangleCount, kInvalidIndex);
+        mIsVisited.assign(nodes.size(), 0);
+        mIsDirty.assign(nodes.size(), 0);
+        mDirty.clear();
+        mRefitNodeCount = 0;
+        if (nodes.empty()) return;
+
+        std::stack<uint32_t> stack({ 0u });
+        while (!stack.empty())
+        {
+            const uint32_t nodeIndex = stack.top();
+            stack.pop();
+
+            if (nodes[nodeIndex].isLeaf())
+            {
+                const LeafNode leaf = nodes[nodeIndex].getLeafNode();
+                for (uint32_t i = 0; i < leaf.triangleCount; i++)
+                {
+                    FALCOR_ASSERT(mTriangleIndices[leaf.triangleOffset + i] < triangleCount);
+                    mTriangleLeaves[mTriangleIndices[leaf.triangleOffset + i]] = nodeIndex;
+                }
+            }
+            else
+            {
+                for (uint32_t childIndex : { nodeIndex + 1, nodes[nodeIndex].getInternalNode().rightChildIdx })
+                {
+                    mParents[childIndex] = nodeIndex;
+                    mDepths[childIndex] = mDepths[nodeIndex] + 1;
+                    stack.push(childIndex);
+                }
+            }
+        }
+    }
+
+    void LightBVHRefitter::refit(std::vector<PackedNode>& nodes, const std::vector<LightCollection::MeshLightTriangle>& triangles, const std::vector<uint32_t>& updatedTriangles, bool parallel)
+    {
+        FALCOR_ASSERT(nodes.size() == mParents.size());
+        FALCOR_ASSERT(triangles.size() == mTriangleLeaves.size());
+        mRefitNodeCount = 0;
+
+        // Bucket the leaves containing updated triangles by depth.
+        std::vector<std::vector<uint32_t>> levels;
+        for (uint32_t triangleIndex : updatedTriangles)
+        {
+            FALCOR_ASSERT(triangleIndex < mTriangleLeaves.size());
+            const uint32_t leafIndex = mTriangleLeaves[triangleIndex];
+            if (leafIndex == kInvalidIndex || mIsVisited[leafIndex]) continue;
+            mIsVisited[leafIndex] = 1;
+            if (levels.size() <= mDepths[leafIndex]) levels.resize(mDepths[leafIndex] + 1);
+            levels[mDepths[leafIndex]].push_back(leafIndex);
+        }
+
+        // Refit the levels from the bottom up. All children of the nodes at a level are at the next level,
+        // so they are up to date when the level is processed. Nodes whose packed data didn't change don't
+        // affect their parent, so the propagation stops early when the changes are too small to be represented.
+        std::vector<uint8_t> isChanged;
+        for (size_t depth = levels.size(); depth-- > 0;)
+        {
+            std::vector<uint32_t>& level = levels[depth];
+            isChanged.assign(level.size(), 0);
+
+            auto refitNode = [&](uint32_t i)
+            {
+                const uint32_t nodeIndex = level[i];
+                const PackedNode oldNode = nodes[nodeIndex];
+                if (nodes[nodeIndex].isLeaf()) refitLeaf(nodes[nodeIndex], mTriangleIndices, triangles);
+                else refitInternal(nodes, nodeIndex);
+                isChanged[i] = std::memcmp(&oldNode, &nodes[nodeIndex], sizeof(PackedNode)) != 0;
+            };
+            if (parallel && level.size() >= kMinParallelNodeCount)
+            {
+                Threading::parallel_for(0u, (uint32_t)level.size(), refitNode);
+            }
+            else
+            {
+                for (uint32_t i = 0; i < level.size(); i++) refitNode(i);
+            }
+
+            for (uint32_t i = 0; i < level.size(); i++)
+            {
+                const uint32_t nodeIndex = level[i];
+                mIsVisited[nodeIndex] = 0;
+                if (!isChanged[i]) continue;
+
+                if (!mIsDirty[nodeIndex])
+                {
+                    mIsDirty[nodeIndex] = 1;
+                    mDirty.push_back(nodeIndex);
+                }
+
+                const uint32_t parentIndex = mParents[nodeIndex];
+                if (parentIndex != kInvalidIndex && !mIsVisited[parentIndex])
+                {
+                    FALCOR_ASSERT(depth > 0 && mDepths[parentIndex] == depth - 1);
+                    mIsVisited[parentIndex] = 1;
+                    levels[depth - 1].push_back(parentIndex);
+                }
+            }
+            mRefitNodeCount += (uint32_t)level.size();
+        }
+    }
+
+    std::vector<LightBVHRefitter::Range> LightBVHRefitter::collectDirtyRanges(uint32_t mergeGap)
+    {
+        std::sort(mDirty.begin(), mDirty.end());
+
+        std::vector<Range> ranges;
+        for (uint32_t index : mDirty)
+        {
+            if (!ranges.empty() && index - ranges.back().end <= mergeGap) ranges.back().end = index + 1;
+            else ranges.push_back({ index, index + 1 });
+            mIsDirty[index] = 0;
+        }
+
+        mDirty.clear();
+        return ranges;
+    }
+}
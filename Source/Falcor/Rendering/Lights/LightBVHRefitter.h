@@ -0,0 +1,96 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "LightBVHTypes.slang"
+#include "Core/Macros.h"
+#include "Scene/Lights/LightCollection.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Incremental CPU refit of a light BVH.
+
+        Only the leaves containing updated triangles and their ancestors are refit. The bounds and cones are
+        computed the same way as by the refit compute passes in LightBVHRefit.cs.slang, so the result matches a full refit.
+        The affected nodes are refit level by level from the bottom up, with the nodes of a level refit in parallel.
+        Propagation stops at nodes whose packed data is unchanged. The modified nodes are tracked so that only those
+        need to be uploaded. The class has no GPU dependencies.
+    */
+    class FALCOR_API LightBVHRefitter
+    {
+    public:
+        /** Range of nodes [begin, end).
+        */
+        struct Range
+        {
+            uint32_t begin;
+            uint32_t end;
+        };
+
+        static constexpr uint32_t kDefaultMergeGap = 16; ///< Dirty ranges separated by fewer clean nodes are uploaded together.
+
+        /** Set up the refitter for a BVH. Must be called whenever the BVH is rebuilt.
+            \param[in] nodes BVH nodes.
+            \param[in] triangleIndices Triangle indices sorted by leaf node.
+            \param[in] triangleCount Total number of triangles in the light collection.
+        */
+        void init(const std::vector<PackedNode>& nodes, const std::vector<uint32_t>& triangleIndices, uint32_t triangleCount);
+
+        /** Refit the leaves containing the updated triangles and all their ancestors.
+            Updated triangles that are not in the BVH are ignored.
+            \param[in,out] nodes BVH nodes, as passed to init().
+            \param[in] triangles All triangles in the light collection, with updated positions.
+            \param[in] updatedTriangles Indices of the updated triangles.
+            \param[in] parallel Refit the nodes in parallel. This doesn't change the result.
+        */
+        void refit(std::vector<PackedNode>& nodes, const std::vector<LightCollection::MeshLightTriangle>& triangles, const std::vector<uint32_t>& updatedTriangles, bool parallel = true);
+
+        /** Get the ranges of nodes modified since the last call in ascending order and clear the dirty state.
+            \param[in] mergeGap Maximum number of clean nodes between two ranges that are merged.
+            \return Ranges to upload.
+        */
+        std::vector<Range> collectDirtyRanges(uint32_t mergeGap = kDefaultMergeGap);
+
+        bool isInitialized() const { return !mParents.empty(); }
+
+        /** Get the number of nodes refit by the last call to refit().
+        */
+        uint32_t getRefitNodeCount() const { return mRefitNodeCount; }
+
+    private:
+        std::vector<uint32_t> mParents;             ///< Parent node index per node. The root has no parent.
+        std::vector<uint32_t> mDepths;              ///< Depth per node.
+        std::vector<uint32_t> mTriangleIndices;     ///< Triangle indices sorted by leaf node.
+        std::vector<uint32_t> mTriangleLeaves;      ///< Leaf node index per triangle, indexed by global triangle index.
+        std::vector<uint8_t> mIsVisited;            ///< Flag per node, to refit each node only once per refit() call.
+        std::vector<uint8_t> mIsDirty;              ///< Flag per node, to add each node only once to mDirty.
+        std::vector<uint32_t> mDirty;               ///< Indices of the modified nodes, unsorted.
+        uint32_t mRefitNodeCount = 0;
+    };
+}
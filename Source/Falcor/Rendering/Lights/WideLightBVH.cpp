@@ -0,0 +1,338 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "WideLightBVH.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Utils/Math/MathConstants.slangh"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stack>
+
+namespace
+{
+    using namespace Falcor;
+
+    // Range of the quantization grid exponents. The lower bound keeps the grid spacing a normalized float.
+    const int kMinExponent = -126;
+    const int kMaxExponent = 127;
+
+    // Largest quantized coordinate and cone angle.
+    const uint32_t kMaxQuantizedCoordinate = 255;
+    const uint32_t kMaxQuantizedConeAngle = 254;
+
+    // Margin added to the cone angle before quantization to absorb rounding in the decoding.
+    const float kConeAngleEpsilon = 1e-4f;
+
+    /** Decode a quantized coordinate. Used by both the encoder and the decoder so that the
+        conservativeness checks during encoding see exactly the decoded values.
+    */
+    inline float decodeCoordinate(float origin, uint32_t q, int exponent)
+    {
+        return origin + float(q) * std::ldexp(1.f, exponent);
+    }
+
+    inline float decodeConeAngle(uint8_t q)
+    {
+        return float(q) * (float(M_PI) / float(kMaxQuantizedConeAngle));
+    }
+
+    /** Compute the grid exponent so that 255 grid steps from the origin cover the node bounds.
+    */
+    int computeExponent(float minPoint, float maxPoint)
+    {
+        const float extent = maxPoint - minPoint;
+        int exponent = kMinExponent;
+        if (extent > 0.f)
+        {
+            exponent = std::clamp((int)std::ceil(std::log2(extent / float(kMaxQuantizedCoordinate))), kMinExponent, kMaxExponent);
+        }
+        while (exponent < kMaxExponent && decodeCoordinate(minPoint, kMaxQuantizedCoordinate, exponent) < maxPoint) exponent++;
+        FALCOR_ASSERT(decodeCoordinate(minPoint, kMaxQuantizedCoordinate, exponent) >= maxPoint);
+        return exponent;
+    }
+
+    uint8_t quantizeMin(float origin, int exponent, float value)
+    {
+        const float scale = std::ldexp(1.f, -exponent);
+        uint32_t q = (uint32_t)std::clamp(std::floor((value - origin) * scale), 0.f, float(kMaxQuantizedCoordinate));
+        while (q > 0 && decodeCoordinate(origin, q, exponent) > value) q--;
+        FALCOR_ASSERT(decodeCoordinate(origin, q, exponent) <= value);
+        return (uint8_t)q;
+    }
+
+    uint8_t quantizeMax(float origin, int exponent, float value)
+    {
+        const float scale = std::ldexp(1.f, -exponent);
+        uint32_t q = (uint32_t)std::clamp(std::ceil((value - origin) * scale), 0.f, float(kMaxQuantizedCoordinate));
+        while (q < kMaxQuantizedCoordinate && decodeCoordinate(origin, q, exponent) < value) q++;
+        FALCOR_ASSERT(decodeCoordinate(origin, q, exponent) >= value);
+        return (uint8_t)q;
+    }
+
+    AABB getBounds(const SharedNodeAttributes& attribs)
+    {
+        return AABB(attribs.origin - attribs.extent, attribs.origin + attribs.extent);
+    }
+}
+
+namespace Falcor
+{
+    template<uint32_t kWidth>
+    typename WideLightBVH<kWidth>::ChildAttributes WideLightBVH<kWidth>::Node::getChildAttributes(uint32_t slot) const
+    {
+        FALCOR_ASSERT(slot < childCount);
+        ChildAttributes attribs;
+        float3 minPoint, maxPoint;
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            minPoint[axis] = decodeCoordinate(origin[axis], boundsMin[axis][slot], exponents[axis]);
+            maxPoint[axis] = decodeCoordinate(origin[axis], boundsMax[axis][slot], exponents[axis]);
+        }
+        attribs.bounds = AABB(minPoint, maxPoint);
+        if (coneAngles[slot] != kInvalidConeAngle)
+        {
+            attribs.coneDirection = decodeNormal2x16(coneDirections[slot]);
+            attribs.cosConeAngle = std::cos(decodeConeAngle(coneAngles[slot]));
+        }
+        attribs.flux = flux[slot];
+        return attribs;
+    }
+
+    template<uint32_t kWidth>
+    void WideLightBVH<kWidth>::build(const std::vector<PackedNode>& binaryNodes)
+    {
+        mNodes.clear();
+        mStats = Stats();
+        if (binaryNodes.empty()) return;
+
+        // Each collapsed node replaces at least one binary internal node.
+        mNodes.reserve(binaryNodes.size() / 2 + 1);
+        buildNode(binaryNodes, 0, 0);
+        computeStats();
+    }
+
+    template<uint32_t kWidth>
+    uint32_t WideLightBVH<kWidth>::buildNode(const std::vector<PackedNode>& binaryNodes, uint32_t binaryNodeIndex, uint32_t depth)
+    {
+        if (depth >= kMaxDepth)
+        {
+            throw RuntimeError("Wide light BVH depth of {} reached. Maximum of {} allowed.", depth + 1, kMaxDepth);
+        }
+
+        const uint32_t nodeIndex = (uint32_t)mNodes.size();
+        mNodes.push_back({});
+
+        // Gather the children. Start with the two children of the binary node and repeatedly replace the internal
+        // child with the largest flux by its two children. The children stay in the left to right order of the binary tree.
+        // A binary root that is a leaf becomes the single child of the root node.
+        std::vector<uint32_t> children;
+        children.reserve(kWidth);
+        if (binaryNodes[binaryNodeIndex].isLeaf())
+        {
+            children.push_back(binaryNodeIndex);
+        }
+        else
+        {
+            children.push_back(binaryNodeIndex + 1);
+            children.push_back(binaryNodes[binaryNodeIndex].getInternalNode().rightChildIdx);
+        }
+        while (children.size() < kWidth)
+        {
+            size_t bestSlot = children.size();
+            float bestFlux = -1.f;
+            for (size_t slot = 0; slot < children.size(); slot++)
+            {
+                const PackedNode& child = binaryNodes[children[slot]];
+                if (!child.isLeaf() && child.getNodeAttributes().flux > bestFlux)
+                {
+                    bestSlot = slot;
+                    bestFlux = child.getNodeAttributes().flux;
+                }
+            }
+            if (bestSlot == children.size()) break;
+
+            const uint32_t openedIndex = children[bestSlot];
+            children[bestSlot] = openedIndex + 1;
+            children.insert(children.begin() + bestSlot + 1, binaryNodes[openedIndex].getInternalNode().rightChildIdx);
+        }
+
+        // Set up the quantization grid over the union of the child bounds.
+        std::vector<SharedNodeAttributes> childAttribs(children.size());
+        AABB nodeBounds;
+        for (size_t slot = 0; slot < children.size(); slot++)
+        {
+            childAttribs[slot] = binaryNodes[children[slot]].getNodeAttributes();
+            nodeBounds |= getBounds(childAttribs[slot]);
+        }
+        FALCOR_ASSERT(nodeBounds.valid());
+
+        Node node = {};
+        node.origin = nodeBounds.minPoint;
+        node.childCount = (uint8_t)children.size();
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            node.exponents[axis] = (int8_t)computeExponent(nodeBounds.minPoint[axis], nodeBounds.maxPoint[axis]);
+        }
+
+        for (uint32_t slot = 0; slot < node.childCount; slot++)
+        {
+            const SharedNodeAttributes& attribs = childAttribs[slot];
+
+            // Quantize the bounds outwards.
+            const AABB bounds = getBounds(attribs);
+            for (uint32_t axis = 0; axis < 3; axis++)
+            {
+                node.boundsMin[axis][slot] = quantizeMin(node.origin[axis], node.exponents[axis], bounds.minPoint[axis]);
+                node.boundsMax[axis][slot] = quantizeMax(node.origin[axis], node.exponents[axis], bounds.maxPoint[axis]);
+            }
+
+            // Widen the cone by the direction quantization error and round the angle up.
+            node.coneAngles[slot] = kInvalidConeAngle;
+            node.coneDirections[slot] = 0;
+            if (attribs.cosConeAngle != kInvalidCosConeAngle && length(attribs.coneDirection) > 0.f)
+            {
+                const float3 direction = normalize(attribs.coneDirection);
+                const uint32_t packedDirection = encodeNormal2x16(direction);
+                const float directionError = std::acos(std::clamp(dot(direction, decodeNormal2x16(packedDirection)), -1.f, 1.f));
+                const float angle = std::acos(std::clamp(attribs.cosConeAngle, -1.f, 1.f)) + directionError + kConeAngleEpsilon;
+                const float q = std::ceil(angle * (float(kMaxQuantizedConeAngle) / float(M_PI)));
+                if (q <= float(kMaxQuantizedConeAngle))
+                {
+                    node.coneAngles[slot] = (uint8_t)q;
+                    node.coneDirections[slot] = packedDirection;
+                }
+            }
+
+            node.flux[slot] = attribs.flux;
+        }
+
+        // Leaves are referenced directly, internal children are collapsed recursively.
+        for (uint32_t slot = 0; slot < node.childCount; slot++)
+        {
+            const PackedNode& child = binaryNodes[children[slot]];
+            node.children[slot] = child.isLeaf() ? child.data[0].x : buildNode(binaryNodes, children[slot], depth + 1);
+        }
+
+        mNodes[nodeIndex] = node;
+        return nodeIndex;
+    }
+
+    template<uint32_t kWidth>
+    void WideLightBVH<kWidth>::traverseBVH(const NodeFunction& evalInternal, const LeafFunction& evalLeaf) const
+    {
+        if (mNodes.empty()) return;
+
+        std::stack<NodeLocation> stack({ NodeLocation{ 0, 0 } });
+        while (!stack.empty())
+        {
+            const NodeLocation location = stack.top();
+            stack.pop();
+
+            if (!evalInternal(location)) break;
+
+            const Node& node = mNodes[location.nodeIndex];
+            bool traverse = true;
+            for (uint32_t slot = 0; slot < node.childCount && traverse; slot++)
+            {
+                if (node.isLeaf(slot)) traverse = evalLeaf(LeafLocation{ location.nodeIndex, slot, location.depth + 1 });
+            }
+            if (!traverse) break;
+
+            // Push the internal children in reverse order so that they are visited left to right.
+            for (uint32_t slot = node.childCount; slot-- > 0;)
+            {
+                if (!node.isLeaf(slot)) stack.push(NodeLocation{ node.getChildIndex(slot), location.depth + 1 });
+            }
+        }
+    }
+
+    template<uint32_t kWidth>
+    std::vector<uint64_t> WideLightBVH<kWidth>::computeTriangleBitmasks(const std::vector<uint32_t>& triangleIndices, size_t triangleCount) const
+    {
+        std::vector<uint64_t> bitmasks(triangleCount, std::numeric_limits<uint64_t>::max());
+        if (mNodes.empty()) return bitmasks;
+
+        struct Entry
+        {
+            uint32_t nodeIndex;
+            uint32_t depth;
+            uint64_t bitmask;
+        };
+        std::stack<Entry> stack({ Entry{ 0, 0, 0ull } });
+        while (!stack.empty())
+        {
+            const Entry entry = stack.top();
+            stack.pop();
+
+            const Node& node = mNodes[entry.nodeIndex];
+            for (uint32_t slot = 0; slot < node.childCount; slot++)
+            {
+                const uint64_t bitmask = entry.bitmask | ((uint64_t)slot << (entry.depth * kBitsPerLevel));
+                if (node.isLeaf(slot))
+                {
+                    const uint32_t offset = node.getTriangleOffset(slot);
+                    for (uint32_t i = 0; i < node.getTriangleCount(slot); i++)
+                    {
+                        FALCOR_ASSERT(offset + i < triangleIndices.size() && triangleIndices[offset + i] < triangleCount);
+                        bitmasks[triangleIndices[offset + i]] = bitmask;
+                    }
+                }
+                else
+                {
+                    stack.push(Entry{ node.getChildIndex(slot), entry.depth + 1, bitmask });
+                }
+            }
+        }
+        return bitmasks;
+    }
+
+    template<uint32_t kWidth>
+    void WideLightBVH<kWidth>::computeStats()
+    {
+        mStats = Stats();
+        traverseBVH(
+            [&](const NodeLocation& location) { ++mStats.nodeCount; return true; },
+            [&](const LeafLocation& location)
+            {
+                ++mStats.leafCount;
+                mStats.treeHeight = std::max(mStats.treeHeight, location.depth);
+                mStats.triangleCount += mNodes[location.nodeIndex].getTriangleCount(location.slot);
+                return true;
+            }
+        );
+        FALCOR_ASSERT(mStats.nodeCount == mNodes.size());
+        mStats.byteSize = (uint32_t)(mNodes.size() * sizeof(Node));
+    }
+
+    static_assert(sizeof(LightBVH4::Node) % 16 == 0, "LightBVH4::Node size should be a multiple of 16");
+    static_assert(sizeof(LightBVH8::Node) % 16 == 0, "LightBVH8::Node size should be a multiple of 16");
+
+    template class WideLightBVH<4>;
+    template class WideLightBVH<8>;
+}
@@ -0,0 +1,162 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "LightBVHTypes.slang"
+#include "Core/Macros.h"
+#include "Utils/Math/AABB.h"
+#include "Utils/Math/Vector.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Falcor
+{
+    /** Light BVH with 4 or 8 children per node and compressed child attributes.
+
+        The wide BVH is created by collapsing a binary light BVH built by LightBVHBuilder. Each node stores the
+        attributes of all its children, so a traversal step evaluates all children with a single node fetch.
+        Leaves are stored directly in the child slots of their parent and reference the same triangle index list
+        as the binary BVH.
+
+        The child attributes are quantized conservatively with respect to the decoded binary nodes:
+        - Bounds are stored with 8 bits per coordinate on a power-of-two grid spanning the node bounds.
+        - Cone directions use the same 2x16 bit octahedral encoding as PackedNode. The cone angle is stored with
+          8 bits and widened to cover the direction quantization error.
+        - Flux is stored at full precision, as it determines the sampling probabilities.
+    */
+    template<uint32_t kWidth>
+    class FALCOR_API WideLightBVH
+    {
+    public:
+        static_assert(kWidth == 4 || kWidth == 8, "Unsupported light BVH width");
+
+        static constexpr uint32_t kBitsPerLevel = kWidth == 4 ? 2 : 3;  ///< Number of triangle bitmask bits per tree level.
+        static constexpr uint32_t kMaxDepth = 64 / kBitsPerLevel;       ///< Maximum node depth supported by the 64-bit triangle bitmasks.
+        static constexpr uint8_t kInvalidConeAngle = 255;               ///< Quantized cone angle of an invalid cone. Valid angles are quantized to [0, 254].
+
+        /** Decoded attributes of a child.
+        */
+        struct ChildAttributes
+        {
+            AABB bounds;                                ///< Conservative bounding box.
+            float3 coneDirection = float3(0.f);         ///< Normal bounding cone direction.
+            float cosConeAngle = kInvalidCosConeAngle;  ///< Conservative normal bounding cone cosine spread angle, or kInvalidCosConeAngle.
+            float flux = 0.f;                           ///< Total emitted flux.
+        };
+
+        /** Wide BVH node storing the attributes of all its children.
+        */
+        struct Node
+        {
+            float3 origin;                          ///< Origin of the quantization grid (min corner of the node bounds).
+            int8_t exponents[3];                    ///< Power-of-two grid spacing per axis.
+            uint8_t childCount;                     ///< Number of used child slots.
+            uint8_t boundsMin[3][kWidth];           ///< Quantized min corner of the child bounds per axis.
+            uint8_t boundsMax[3][kWidth];           ///< Quantized max corner of the child bounds per axis.
+            uint8_t coneAngles[kWidth];             ///< Quantized child cone spread angles in [0, pi], or kInvalidConeAngle.
+            uint32_t coneDirections[kWidth];        ///< Child cone directions (octahedral 2x16 bit encoding).
+            float flux[kWidth];                     ///< Child flux.
+            uint32_t children[kWidth];              ///< Child references. The MSB is set for leaves, which store the triangle count and offset like PackedNode. Otherwise the value is the child node index.
+            uint32_t padding[kWidth == 4 ? 1 : 2];
+
+            bool isLeaf(uint32_t slot) const { return (children[slot] >> 31) != 0; }
+            uint32_t getChildIndex(uint32_t slot) const { return children[slot]; }
+            uint32_t getTriangleCount(uint32_t slot) const { return (children[slot] >> PackedNode::kTriangleOffsetBits) & ((1u << PackedNode::kTriangleCountBits) - 1); }
+            uint32_t getTriangleOffset(uint32_t slot) const { return children[slot] & ((1u << PackedNode::kTriangleOffsetBits) - 1); }
+
+            /** Decode the attributes of a child.
+                \param[in] slot Child slot in [0, childCount).
+            */
+            ChildAttributes getChildAttributes(uint32_t slot) const;
+        };
+
+        struct NodeLocation
+        {
+            uint32_t nodeIndex;
+            uint32_t depth;
+        };
+
+        struct LeafLocation
+        {
+            uint32_t nodeIndex;     ///< Index of the parent node.
+            uint32_t slot;          ///< Child slot in the parent node.
+            uint32_t depth;         ///< Depth of the leaf, which is one more than the depth of the parent node.
+        };
+
+        /** Functions called on each node/leaf by traverseBVH().
+            \return True if the traversal should continue, false otherwise.
+        */
+        using NodeFunction = std::function<bool(const NodeLocation& location)>;
+        using LeafFunction = std::function<bool(const LeafLocation& location)>;
+
+        struct Stats
+        {
+            uint32_t treeHeight = 0;                    ///< Number of edges on the longest path between the root node and a leaf.
+            uint32_t byteSize = 0;                      ///< Number of bytes occupied by the nodes.
+            uint32_t nodeCount = 0;                     ///< Number of nodes.
+            uint32_t leafCount = 0;                     ///< Number of leaves.
+            uint32_t triangleCount = 0;                 ///< Number of triangles referenced by the leaves.
+        };
+
+        /** Collapse a binary light BVH into a wide BVH.
+            Child slots are filled by repeatedly opening the internal child with the largest flux, which keeps
+            the most important subtrees shallow. Throws if the resulting tree exceeds kMaxDepth.
+            \param[in] binaryNodes Nodes of a binary light BVH, as built by LightBVHBuilder.
+        */
+        void build(const std::vector<PackedNode>& binaryNodes);
+
+        /** Perform a depth-first traversal of the BVH and run a function on each node and leaf.
+            Leaves are visited in the order of the child slots.
+            \param[in] evalInternal Function called on each node.
+            \param[in] evalLeaf Function called on each leaf.
+        */
+        void traverseBVH(const NodeFunction& evalInternal, const LeafFunction& evalLeaf) const;
+
+        /** Compute the per-triangle bit pattern retracing the tree traversal to reach each triangle.
+            The child slot taken at depth d is stored in bits [d * kBitsPerLevel, (d + 1) * kBitsPerLevel).
+            \param[in] triangleIndices Triangle indices sorted by leaf, as used by the binary BVH.
+            \param[in] triangleCount Total number of triangles. Triangles not in the BVH get an all ones bitmask.
+            \return Bitmasks indexed by global triangle index.
+        */
+        std::vector<uint64_t> computeTriangleBitmasks(const std::vector<uint32_t>& triangleIndices, size_t triangleCount) const;
+
+        const std::vector<Node>& getNodes() const { return mNodes; }
+        const Stats& getStats() const { return mStats; }
+        bool isValid() const { return !mNodes.empty(); }
+
+    private:
+        uint32_t buildNode(const std::vector<PackedNode>& binaryNodes, uint32_t binaryNodeIndex, uint32_t depth);
+        void computeStats();
+
+        std::vector<Node> mNodes;       ///< Nodes in depth-first order. The root node is at index 0.
+        Stats mStats;
+    };
+
+    using LightBVH4 = WideLightBVH<4>;
+    using LightBVH8 = WideLightBVH<8>;
+}
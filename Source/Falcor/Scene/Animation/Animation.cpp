@@ -31,6 +31,8 @@
 #include "Utils/Math/Common.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Scene/Transform.h"
+#include "Utils/Threading.h"
+#include <algorithm>
 
 namespace Falcor
 {
@@ -38,6 +40,12 @@ namespace Falcor
     {
         const double kEpsilonTime = 1e-5f;
 
+        // Number of keyframes the cursor is advanced before falling back to binary search.
+        const size_t kMaxCursorSteps = 4;
+
+        // Number of animations evaluated per task in batched evaluation.
+        const size_t kAnimationBatchSize = 64;
+
         const Gui::DropdownList kChannelLoopModeDropdown =
         {
             { (uint32_t)Animation::Behavior::Constant, "Constant" },
@@ -115,28 +123,28 @@ namespace Falcor
     {
         // Calculate the sample time.
         double time = currentTime;
-        if (time < mKeyframes.front().time || time > mKeyframes.back().time)
+        if (time < mKeyframeTimes.front() || time > mKeyframeTimes.back())
         {
             time = calcSampleTime(currentTime);
         }
 
         // Determine if the animation behaves linearly outside of defined keyframes.
-        bool isLinearPostInfinity = time > mKeyframes.back().time && this->getPostInfinityBehavior() == Behavior::Linear;
-        bool isLinearPreInfinity = time < mKeyframes.front().time && this->getPreInfinityBehavior() == Behavior::Linear;
+        bool isLinearPostInfinity = time > mKeyframeTimes.back() && this->getPostInfinityBehavior() == Behavior::Linear;
+        bool isLinearPreInfinity = time < mKeyframeTimes.front() && this->getPreInfinityBehavior() == Behavior::Linear;
 
         Keyframe interpolated;
 
-        if (isLinearPreInfinity && mKeyframes.size() > 1)
+        if (isLinearPreInfinity && mKeyframeTimes.size() > 1)
         {
-            const auto& k0 = mKeyframes.front();
+            const auto k0 = getKeyframeAt(0);
             auto k1 = interpolate(mInterpolationMode, k0.time + kEpsilonTime);
             double segmentDuration = k1.time - k0.time;
             float t = (float)((time - k0.time) / segmentDuration);
             interpolated = interpolateLinear(k0, k1, t);
         }
-        else if (isLinearPostInfinity && mKeyframes.size() > 1)
+        else if (isLinearPostInfinity && mKeyframeTimes.size() > 1)
         {
-            const auto& k1 = mKeyframes.back();
+            const auto k1 = getKeyframeAt(mKeyframeTimes.size() - 1);
             auto k0 = interpolate(mInterpolationMode, k1.time - kEpsilonTime);
             double segmentDuration = k1.time - k0.time;
             float t = (float)((time - k0.time) / segmentDuration);
@@ -155,38 +163,63 @@ namespace Falcor
         return transform;
     }
 
-    Animation::Keyframe Animation::interpolate(InterpolationMode mode, double time) const
+    void Animation::animate(const std::vector<ref<Animation>>& animations, double currentTime, float4x4* pTransforms)
     {
-        FALCOR_ASSERT(!mKeyframes.empty());
+        FALCOR_ASSERT(pTransforms || animations.empty());
+        Threading::parallel_for(size_t(0), animations.size(), [&](size_t i) { pTransforms[i] = animations[i]->animate(currentTime); }, kAnimationBatchSize);
+    }
+
+    Animation::Keyframe Animation::getKeyframeAt(size_t index) const
+    {
+        return Keyframe{ mKeyframeTimes[index], mKeyframeTranslations[index], mKeyframeScalings[index], mKeyframeRotations[index] };
+    }
 
-        // Validate cached frame index.
-        size_t frameIndex = std::clamp(mCachedFrameIndex, (size_t)0, mKeyframes.size() - 1);
-        if (time < mKeyframes[frameIndex].time) frameIndex = 0;
+    // Returns the index of the last keyframe at or before the given time, or 0 if the time is before the first keyframe.
+    size_t Animation::findKeyframe(double time) const
+    {
+        FALCOR_ASSERT(!mKeyframeTimes.empty());
+        const size_t lastIndex = mKeyframeTimes.size() - 1;
 
-        // Find frame index.
-        while (frameIndex < mKeyframes.size() - 1)
+        // Try to advance the cursor from the last evaluation. This covers the common case of time moving forward.
+        size_t frameIndex = std::min(mCachedFrameIndex, lastIndex);
+        if (time >= mKeyframeTimes[frameIndex])
         {
-            if (mKeyframes[frameIndex + 1].time > time) break;
-            frameIndex++;
+            size_t steps = 0;
+            while (frameIndex < lastIndex && mKeyframeTimes[frameIndex + 1] <= time && steps++ < kMaxCursorSteps) frameIndex++;
+            if (frameIndex == lastIndex || mKeyframeTimes[frameIndex + 1] > time)
+            {
+                mCachedFrameIndex = frameIndex;
+                return frameIndex;
+            }
         }
 
-        // Cache frame index;
+        // Time jumped, binary search over the keyframe times.
+        auto it = std::upper_bound(mKeyframeTimes.begin(), mKeyframeTimes.end(), time);
+        frameIndex = it == mKeyframeTimes.begin() ? 0 : (size_t)(it - mKeyframeTimes.begin()) - 1;
         mCachedFrameIndex = frameIndex;
+        return frameIndex;
+    }
+
+    Animation::Keyframe Animation::interpolate(InterpolationMode mode, double time) const
+    {
+        FALCOR_ASSERT(!mKeyframeTimes.empty());
+
+        size_t frameIndex = findKeyframe(time);
 
         // Compute index of adjacent frame including optional warping.
         auto adjacentFrame = [this] (size_t frame, int32_t offset = 1)
         {
-            size_t count = mKeyframes.size();
+            size_t count = mKeyframeTimes.size();
             return mEnableWarping ? (frame + count + offset) % count : std::clamp(frame + offset, (size_t)0, count - 1);
         };
 
-        if (mode == InterpolationMode::Linear || mKeyframes.size() < 4)
+        if (mode == InterpolationMode::Linear || mKeyframeTimes.size() < 4)
         {
             size_t i0 = frameIndex;
             size_t i1 = adjacentFrame(i0);
 
-            const Keyframe& k0 = mKeyframes[i0];
-            const Keyframe& k1 = mKeyframes[i1];
+            const Keyframe k0 = getKeyframeAt(i0);
+            const Keyframe k1 = getKeyframeAt(i1);
 
             double segmentDuration = k1.time - k0.time;
             if (mEnableWarping && segmentDuration < 0.0) segmentDuration += mDuration;
@@ -201,10 +234,10 @@ namespace Falcor
             size_t i2 = adjacentFrame(i1, 1);
             size_t i3 = adjacentFrame(i1, 2);
 
-            const Keyframe& k0 = mKeyframes[i0];
-            const Keyframe& k1 = mKeyframes[i1];
-            const Keyframe& k2 = mKeyframes[i2];
-            const Keyframe& k3 = mKeyframes[i3];
+            const Keyframe k0 = getKeyframeAt(i0);
+            const Keyframe k1 = getKeyframeAt(i1);
+            const Keyframe k2 = getKeyframeAt(i2);
+            const Keyframe k3 = getKeyframeAt(i3);
 
             double segmentDuration = k2.time - k1.time;
             if (mEnableWarping && segmentDuration < 0.0) segmentDuration += mDuration;
@@ -225,8 +258,8 @@ namespace Falcor
     double Animation::calcSampleTime(double currentTime)
     {
         double modifiedTime = currentTime;
-        double firstKeyframeTime = mKeyframes.front().time;
-        double lastKeyframeTime = mKeyframes.back().time;
+        double firstKeyframeTime = mKeyframeTimes.front();
+        double lastKeyframeTime = mKeyframeTimes.back();
         double duration = lastKeyframeTime - firstKeyframeTime;
 
         FALCOR_ASSERT(currentTime < firstKeyframeTime || currentTime > lastKeyframeTime);
@@ -257,59 +290,37 @@ namespace Falcor
     {
         FALCOR_ASSERT(keyframe.time <= mDuration);
 
-        if (mKeyframes.size() == 0 || mKeyframes[0].time > keyframe.time)
-        {
-            mKeyframes.insert(mKeyframes.begin(), keyframe);
-        }
-        else if (mKeyframes.back().time < keyframe.time)
+        // Find the first keyframe at or after the new one. Keyframes are typically added in order, so check the end first.
+        auto it = mKeyframeTimes.empty() || mKeyframeTimes.back() < keyframe.time
+            ? mKeyframeTimes.end()
+            : std::lower_bound(mKeyframeTimes.begin(), mKeyframeTimes.end(), keyframe.time);
+        size_t index = (size_t)(it - mKeyframeTimes.begin());
+
+        // If we already have a key-frame at the same time, replace it
+        if (it != mKeyframeTimes.end() && *it == keyframe.time)
         {
-            mKeyframes.push_back(keyframe);
+            mKeyframeTranslations[index] = keyframe.translation;
+            mKeyframeScalings[index] = keyframe.scaling;
+            mKeyframeRotations[index] = keyframe.rotation;
+            return;
         }
-        else
-        {
-            for (size_t i = 0; i < mKeyframes.size(); i++)
-            {
-                auto& current = mKeyframes[i];
-                // If we already have a key-frame at the same time, replace it
-                if (current.time == keyframe.time)
-                {
-                    current = keyframe;
-                    return;
-                }
-
-                // If this is not the last frame, Check if we are in between frames
-                if (i < mKeyframes.size() - 1)
-                {
-                    auto& Next = mKeyframes[i + 1];
-                    if (current.time < keyframe.time && Next.time > keyframe.time)
-                    {
-                        mKeyframes.insert(mKeyframes.begin() + i + 1, keyframe);
-                        return;
-                    }
-                }
-            }
 
-            // If we got here, need to push it to the end of the list
-            mKeyframes.push_back(keyframe);
-        }
+        mKeyframeTimes.insert(it, keyframe.time);
+        mKeyframeTranslations.insert(mKeyframeTranslations.begin() + index, keyframe.translation);
+        mKeyframeScalings.insert(mKeyframeScalings.begin() + index, keyframe.scaling);
+        mKeyframeRotations.insert(mKeyframeRotations.begin() + index, keyframe.rotation);
     }
 
-    const Animation::Keyframe& Animation::getKeyframe(double time) const
+    Animation::Keyframe Animation::getKeyframe(double time) const
     {
-        for (const auto& k : mKeyframes)
-        {
-            if (k.time == time) return k;
-        }
-        throw ArgumentError("'time' ({}) does not refer to an existing keyframe", time);
+        auto it = std::lower_bound(mKeyframeTimes.begin(), mKeyframeTimes.end(), time);
+        if (it == mKeyframeTimes.end() || *it != time) throw ArgumentError("'time' ({}) does not refer to an existing keyframe", time);
+        return getKeyframeAt((size_t)(it - mKeyframeTimes.begin()));
     }
 
     bool Animation::doesKeyframeExists(double time) const
     {
-        for (const auto& k : mKeyframes)
-        {
-            if (k.time == time) return true;
-        }
-        return false;
+        return std::binary_search(mKeyframeTimes.begin(), mKeyframeTimes.end(), time);
     }
 
     void Animation::renderUI(Gui::Widgets& widget)
@@ -135,7 +135,11 @@ namespace Falcor
             \param[in] time Time of the keyframe.
             \return Returns the keyframe.
         */
-        const Keyframe& getKeyframe(double time) const;
+        Keyframe getKeyframe(double time) const;
+
+        /** Get the number of keyframes.
+        */
+        size_t getKeyframeCount() const { return mKeyframeTimes.size(); }
 
         /** Check if a keyframe exists at the specified time.
             \param[in] time Time of the keyframe.
@@ -144,16 +148,28 @@ namespace Falcor
         bool doesKeyframeExists(double time) const;
 
         /** Compute the animation.
+            The keyframe segment is tracked by a cursor, so evaluating at monotonically advancing times only touches
+            neighbouring keyframes. Jumps in time fall back to a binary search over the keyframe times.
+            Calls on different animations can run concurrently, calls on the same animation can not.
             \param time The current time in seconds. This can be larger then the animation time, in which case the animation will loop.
             \return Returns the animation's transform matrix for the specified time.
         */
         float4x4 animate(double currentTime);
 
+        /** Compute a batch of animations in parallel.
+            \param[in] animations Animations to evaluate.
+            \param[in] currentTime The current time in seconds.
+            \param[out] pTransforms Transform matrix for each animation. Must have room for animations.size() matrices.
+        */
+        static void animate(const std::vector<ref<Animation>>& animations, double currentTime, float4x4* pTransforms);
+
         /* Render the UI.
         */
         void renderUI(Gui::Widgets& widget);
 
     private:
+        Keyframe getKeyframeAt(size_t index) const;
+        size_t findKeyframe(double time) const;
         Keyframe interpolate(InterpolationMode mode, double time) const;
         double calcSampleTime(double currentTime);
 
@@ -167,8 +183,13 @@ namespace Falcor
         InterpolationMode mInterpolationMode = InterpolationMode::Linear;
         bool mEnableWarping = false;
 
-        std::vector<Keyframe> mKeyframes;
-        mutable size_t mCachedFrameIndex = 0;
+        // Keyframes are stored as separate arrays per channel, sorted by time.
+        // Locating the keyframe segment only touches the time array.
+        std::vector<double> mKeyframeTimes;
+        std::vector<float3> mKeyframeTranslations;
+        std::vector<float3> mKeyframeScalings;
+        std::vector<quatf> mKeyframeRotations;
+        mutable size_t mCachedFrameIndex = 0;   ///< Cursor to the keyframe segment of the last evaluation.
 
         friend class SceneCache;
     };
@@ -29,6 +29,7 @@
 #include "Core/API/RenderContext.h"
 #include "Utils/Timing/Profiler.h"
 #include "Scene/Scene.h"
+#include "Utils/Math/MatrixMath.h"
 #include <fstream>
 
 namespace Falcor
@@ -39,6 +40,19 @@ namespace Falcor
         const std::string kInverseTransposeWorldMatrices = "inverseTransposeWorldMatrices";
         const std::string kPrevWorldMatrices = "prevWorldMatrices";
         const std::string kPrevInverseTransposeWorldMatrices = "prevInverseTransposeWorldMatrices";
+
+        float4x4 inverseTranspose(const float4x4& m)
+        {
+            // Scene graph transforms are almost always affine, which allows for a much cheaper inverse.
+            return isAffine(m) ? inverseTransposeAffine(m) : transpose(inverse(m));
+        }
+
+        NodeHierarchy createNodeHierarchy(const std::vector<Scene::Node>& sceneGraph)
+        {
+            std::vector<NodeID> parents(sceneGraph.size());
+            for (size_t i = 0; i < sceneGraph.size(); i++) parents[i] = sceneGraph[i].parent;
+            return NodeHierarchy(parents);
+        }
     }
 
     AnimationController::AnimationController(ref<Device> pDevice, Scene* pScene, const StaticVertexVector& staticVertexData, const SkinningVertexVector& skinningVertexData, uint32_t prevVertexCount, const std::vector<ref<Animation>>& animations)
@@ -49,6 +63,7 @@ namespace Falcor
         , mGlobalMatrices(pScene->mSceneGraph.size())
         , mInvTransposeGlobalMatrices(pScene->mSceneGraph.size())
         , mMatricesChanged(pScene->mSceneGraph.size())
+        , mNodeHierarchy(createNodeHierarchy(pScene->mSceneGraph))
         , mpScene(pScene)
     {
         // Create GPU resources.
@@ -194,7 +209,7 @@ namespace Falcor
     {
         FALCOR_PROFILE(pRenderContext, "animate");
 
-        std::fill(mMatricesChanged.begin(), mMatricesChanged.end(), false);
+        std::fill(mMatricesChanged.begin(), mMatricesChanged.end(), uint8_t(0));
 
         // Check for edited scene nodes and update local matrices.
         const auto& sceneGraph = mpScene->mSceneGraph;
@@ -205,7 +220,7 @@ namespace Falcor
             {
                 mLocalMatrices[i] = sceneGraph[i].transform;
                 mNodesEdited[i] = false;
-                mMatricesChanged[i] = true;
+                mMatricesChanged[i] = 1;
                 edited = true;
             }
         }
@@ -227,6 +242,9 @@ namespace Falcor
             updateWorldMatrices(true);
             uploadWorldMatrices(true);
 
+            // All matrices were reinitialized.
+            std::fill(mMatricesChanged.begin(), mMatricesChanged.end(), uint8_t(1));
+
             if (!sceneGraph.empty())
             {
                 FALCOR_ASSERT(mpWorldMatricesBuffer && mpPrevWorldMatricesBuffer);
@@ -283,49 +301,67 @@ namespace Falcor
             mTime = time;
         }
 
+        mChangedMatrices.clear();
+        if (changed)
+        {
+            for (size_t i = 0; i < mMatricesChanged.size(); i++)
+            {
+                if (mMatricesChanged[i]) mChangedMatrices.push_back((uint32_t)i);
+            }
+        }
+
         return changed;
     }
 
     void AnimationController::updateLocalMatrices(double time)
     {
-        for (auto& pAnimation : mAnimations)
+        // Evaluate all animations in parallel, then scatter the results in order.
+        // Several animations may target the same node, in which case the last one wins.
+        mAnimationMatrices.resize(mAnimations.size());
+        Animation::animate(mAnimations, time, mAnimationMatrices.data());
+
+        for (size_t i = 0; i < mAnimations.size(); i++)
         {
-            NodeID nodeID = pAnimation->getNodeID();
+            NodeID nodeID = mAnimations[i]->getNodeID();
             FALCOR_ASSERT(nodeID.get() < mLocalMatrices.size());
-            mLocalMatrices[nodeID.get()] = pAnimation->animate(time);
-            mMatricesChanged[nodeID.get()] = true;
+            mLocalMatrices[nodeID.get()] = mAnimationMatrices[i];
+            mMatricesChanged[nodeID.get()] = 1;
         }
     }
 
     void AnimationController::updateWorldMatrices(bool updateAll)
     {
         const auto& sceneGraph = mpScene->mSceneGraph;
+        FALCOR_ASSERT(mNodeHierarchy.getNodeCount() == mGlobalMatrices.size());
 
-        for (size_t i = 0; i < mGlobalMatrices.size(); i++)
+        // Nodes are visited level by level, so the parent's matrix and change flag are final when a node is processed.
+        mNodeHierarchy.parallelForEachNode([&](uint32_t i)
         {
+            const NodeID parent = sceneGraph[i].parent;
+
             // Propagate matrix change flag to children.
-            if (sceneGraph[i].parent != NodeID::Invalid())
+            if (parent != NodeID::Invalid() && mMatricesChanged[parent.get()])
             {
-                mMatricesChanged[i] = mMatricesChanged[i] || mMatricesChanged[sceneGraph[i].parent.get()];
+                mMatricesChanged[i] = 1;
             }
 
-            if (!mMatricesChanged[i] && !updateAll) continue;
+            if (!mMatricesChanged[i] && !updateAll) return;
 
             mGlobalMatrices[i] = mLocalMatrices[i];
 
-            if (mpScene->mSceneGraph[i].parent != NodeID::Invalid())
+            if (parent != NodeID::Invalid())
             {
-                mGlobalMatrices[i] = mul(mGlobalMatrices[sceneGraph[i].parent.get()], mGlobalMatrices[i]);
+                mGlobalMatrices[i] = mul(mGlobalMatrices[parent.get()], mGlobalMatrices[i]);
             }
 
-            mInvTransposeGlobalMatrices[i] = transpose(inverse(mGlobalMatrices[i]));
+            mInvTransposeGlobalMatrices[i] = inverseTranspose(mGlobalMatrices[i]);
 
             if (mpSkinningPass)
             {
                 mSkinningMatrices[i] = mul(mGlobalMatrices[i], sceneGraph[i].localToBindSpace);
-                mInvTransposeSkinningMatrices[i] = transpose(inverse(mSkinningMatrices[i]));
+                mInvTransposeSkinningMatrices[i] = inverseTranspose(mSkinningMatrices[i]);
             }
-        }
+        });
     }
 
     void AnimationController::uploadWorldMatrices(bool uploadAll)
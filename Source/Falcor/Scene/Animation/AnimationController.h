@@ -28,6 +28,7 @@
 #pragma once
 #include "Animation.h"
 #include "AnimatedVertexCache.h"
+#include "NodeHierarchy.h"
 #include "Core/Macros.h"
 #include "Core/API/Buffer.h"
 #include "Core/Pass/ComputePass.h"
@@ -108,7 +109,11 @@ namespace Falcor
 
         /** Check if a matrix changed since last frame.
         */
-        bool isMatrixChanged(NodeID matrixID) const { return mMatricesChanged[matrixID.get()]; }
+        bool isMatrixChanged(NodeID matrixID) const { return mMatricesChanged[matrixID.get()] != 0; }
+
+        /** Get the IDs of the matrices that changed in the last call to animate(), in ascending order.
+        */
+        const std::vector<uint32_t>& getChangedMatrices() const { return mChangedMatrices; }
 
         /** Get the local matrices.
             These represent the current local transform for each scene graph node.
@@ -124,6 +129,10 @@ namespace Falcor
         */
         const std::vector<float4x4>& getInvTransposeGlobalMatrices() const { return mInvTransposeGlobalMatrices; }
 
+        /** Get the skinning (bone) matrices. Empty if there are no skinned meshes.
+        */
+        const std::vector<float4x4>& getSkinningMatrices() const { return mSkinningMatrices; }
+
         /** Render the UI.
         */
         void renderUI(Gui::Widgets& widget);
@@ -159,11 +168,14 @@ namespace Falcor
 
         // Animation
         std::vector<ref<Animation>> mAnimations;
+        std::vector<float4x4> mAnimationMatrices;   ///< Transform per animation from the last batched evaluation.
         std::vector<bool> mNodesEdited;
         std::vector<float4x4> mLocalMatrices;
         std::vector<float4x4> mGlobalMatrices;
         std::vector<float4x4> mInvTransposeGlobalMatrices;
-        std::vector<bool> mMatricesChanged;         ///< Flag per matrix, true if matrix changed since last frame.
+        std::vector<uint8_t> mMatricesChanged;      ///< Flag per matrix, non-zero if matrix changed since last frame. Bytes instead of bits so flags can be written concurrently.
+        std::vector<uint32_t> mChangedMatrices;     ///< IDs of the matrices with the changed flag set.
+        NodeHierarchy mNodeHierarchy;               ///< Level ordering of the scene graph for updating world matrices in parallel.
 
         bool mFirstUpdate = true;       ///< True if this is the first update.
         bool mEnabled = true;           ///< True if animations are enabled.
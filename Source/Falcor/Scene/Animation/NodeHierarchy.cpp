@@ -0,0 +1,78 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "NodeHierarchy.h"
+#include "Core/Errors.h"
+#include <algorithm>
+#include <limits>
+
+namespace Falcor
+{
+    NodeHierarchy::NodeHierarchy(const std::vector<NodeID>& parents)
+    {
+        const uint32_t nodeCount = (uint32_t)parents.size();
+        const uint32_t kUnknown = std::numeric_limits<uint32_t>::max();
+
+        // Compute the depth of each node. Nodes may be stored in any order, so walk up to the
+        // first node with known depth and assign depths on the way back down.
+        std::vector<uint32_t> depths(nodeCount, kUnknown);
+        std::vector<uint32_t> path;
+        uint32_t maxDepth = 0;
+        for (uint32_t i = 0; i < nodeCount; i++)
+        {
+            uint32_t node = i;
+            while (depths[node] == kUnknown)
+            {
+                path.push_back(node);
+                if (path.size() > nodeCount) throw RuntimeError("Node hierarchy contains a cycle at node {}.", i);
+                NodeID parent = parents[node];
+                if (parent == NodeID::Invalid()) break;
+                checkArgument(parent.get() < nodeCount, "Parent ID {} of node {} is out of range.", parent, node);
+                node = parent.get();
+            }
+
+            // The walk either ended at a root (the last node on the path) or at a node with known depth.
+            uint32_t depth = depths[node] == kUnknown ? 0 : depths[node] + 1;
+            while (!path.empty())
+            {
+                depths[path.back()] = depth++;
+                path.pop_back();
+            }
+            maxDepth = std::max(maxDepth, depths[i]);
+        }
+
+        // Counting sort by depth. This keeps nodes on the same level in index order.
+        const uint32_t levelCount = nodeCount > 0 ? maxDepth + 1 : 0;
+        mLevelOffsets.assign(levelCount + 1, 0);
+        for (uint32_t i = 0; i < nodeCount; i++) mLevelOffsets[depths[i] + 1]++;
+        for (uint32_t level = 0; level < levelCount; level++) mLevelOffsets[level + 1] += mLevelOffsets[level];
+
+        mNodes.resize(nodeCount);
+        std::vector<uint32_t> next(mLevelOffsets.begin(), mLevelOffsets.end() - 1);
+        for (uint32_t i = 0; i < nodeCount; i++) mNodes[next[depths[i]]++] = i;
+    }
+}
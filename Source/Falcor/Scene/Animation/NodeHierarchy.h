@@ -0,0 +1,85 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Scene/SceneIDs.h"
+#include "Core/Macros.h"
+#include "Utils/Threading.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Level ordering of a node hierarchy such as the scene graph.
+        Nodes are grouped by their depth in the hierarchy. Nodes on the same level don't depend on each other,
+        so work that requires the parent to be processed first (e.g. computing world matrices) can run in
+        parallel within each level.
+    */
+    class FALCOR_API NodeHierarchy
+    {
+    public:
+        NodeHierarchy() = default;
+
+        /** Create the level ordering. Throws an exception if a parent ID is out of range or the hierarchy contains cycles.
+            \param[in] parents Parent node ID for each node, or NodeID::Invalid() for root nodes.
+        */
+        explicit NodeHierarchy(const std::vector<NodeID>& parents);
+
+        /** Get the number of nodes.
+        */
+        size_t getNodeCount() const { return mNodes.size(); }
+
+        /** Get the number of levels, i.e. the depth of the deepest node plus one.
+        */
+        uint32_t getLevelCount() const { return mLevelOffsets.empty() ? 0 : (uint32_t)mLevelOffsets.size() - 1; }
+
+        /** Get the node indices ordered by level. Within a level, nodes are sorted by index.
+        */
+        const std::vector<uint32_t>& getOrderedNodes() const { return mNodes; }
+
+        /** Call a function for every node, with parents processed before their children.
+            Nodes on the same level are processed in parallel. Small levels run on the calling thread.
+            \param[in] func Function called as func(nodeIndex). It is called concurrently for nodes on the same level.
+        */
+        template<typename Func>
+        void parallelForEachNode(Func&& func) const
+        {
+            for (uint32_t level = 0; level < getLevelCount(); level++)
+            {
+                const uint32_t* pNodes = mNodes.data() + mLevelOffsets[level];
+                const size_t count = mLevelOffsets[level + 1] - mLevelOffsets[level];
+                Threading::parallel_for(size_t(0), count, [&](size_t i) { func(pNodes[i]); }, kGrainSize);
+            }
+        }
+
+    private:
+        static constexpr size_t kGrainSize = 256;
+
+        std::vector<uint32_t> mNodes;           ///< Node indices ordered by level.
+        std::vector<uint32_t> mLevelOffsets;    ///< Offset of the first node of each level in mNodes, followed by the node count.
+    };
+}
@@ -0,0 +1,79 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "SkinnedMeshBounds.h"
+#include "Core/Errors.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace Falcor
+{
+    uint32_t SkinnedMeshBounds::addMesh(const SkinningVertexData* pSkinningData, uint32_t vertexCount, const std::vector<PackedStaticVertexData>& staticData)
+    {
+        FALCOR_CHECK_ARG(vertexCount == 0 || pSkinningData != nullptr);
+
+        std::unordered_map<uint32_t, AABB> boneBounds;
+        for (uint32_t i = 0; i < vertexCount; i++)
+        {
+            const SkinningVertexData& s = pSkinningData[i];
+            FALCOR_ASSERT(s.staticIndex < staticData.size());
+            const float3 position = staticData[s.staticIndex].position;
+            for (uint32_t j = 0; j < 4; j++)
+            {
+                if (s.boneWeight[j] > 0.f) boneBounds[s.boneID[j]].include(position);
+            }
+        }
+
+        Mesh mesh;
+        mesh.boneBegin = (uint32_t)mBones.size();
+        for (const auto& [boneID, bounds] : boneBounds) mBones.push_back({ boneID, bounds });
+        mesh.boneEnd = (uint32_t)mBones.size();
+        mesh.bindMatrixID = vertexCount > 0 ? pSkinningData[0].bindMatrixID : 0;
+        mesh.skeletonMatrixID = vertexCount > 0 ? pSkinningData[0].skeletonMatrixID : 0;
+
+        // Sort by bone ID, so the bone matrices are accessed in order.
+        std::sort(mBones.begin() + mesh.boneBegin, mBones.end(), [](const BoneBounds& a, const BoneBounds& b) { return a.boneID < b.boneID; });
+
+        mMeshes.push_back(mesh);
+        return (uint32_t)mMeshes.size() - 1;
+    }
+
+    AABB SkinnedMeshBounds::getBounds(uint32_t meshIndex, const float4x4& transform, const std::vector<float4x4>& boneMatrices, const float4x4& bindMatrix) const
+    {
+        FALCOR_ASSERT(meshIndex < mMeshes.size());
+        const Mesh& mesh = mMeshes[meshIndex];
+
+        AABB bounds;
+        for (uint32_t i = mesh.boneBegin; i < mesh.boneEnd; i++)
+        {
+            const BoneBounds& bone = mBones[i];
+            FALCOR_ASSERT(bone.boneID < boneMatrices.size());
+            bounds.include(bone.bounds.transform(mul(transform, mul(boneMatrices[bone.boneID], bindMatrix))));
+        }
+        return bounds;
+    }
+}
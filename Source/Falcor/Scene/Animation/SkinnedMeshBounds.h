@@ -0,0 +1,99 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Scene/SceneTypes.slang"
+#include "Core/Macros.h"
+#include "Utils/Math/AABB.h"
+#include "Utils/Math/Matrix.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Conservative bounds of skinned meshes without skinning the vertices.
+        A skinned vertex is a weighted average of the vertex transformed by each of its bones. With normalized weights,
+        it therefore lies in the bounding box of the per-bone results. For each bone, the bind pose bounds of the
+        vertices it influences are stored. The skinned mesh is then bounded by the union of these boxes, each
+        transformed by its bone matrix.
+    */
+    class FALCOR_API SkinnedMeshBounds
+    {
+    public:
+        /** Add a skinned mesh and compute the bind pose bounds of the vertices influenced by each bone.
+            \param[in] pSkinningData Skinning data of the mesh vertices.
+            \param[in] vertexCount Number of vertices.
+            \param[in] staticData Static vertex data, indexed by SkinningVertexData::staticIndex.
+            \return Index of the mesh.
+        */
+        uint32_t addMesh(const SkinningVertexData* pSkinningData, uint32_t vertexCount, const std::vector<PackedStaticVertexData>& staticData);
+
+        /** Get the number of meshes.
+        */
+        uint32_t getMeshCount() const { return (uint32_t)mMeshes.size(); }
+
+        /** Get the number of bones influencing a mesh.
+        */
+        uint32_t getBoneCount(uint32_t meshIndex) const { return mMeshes[meshIndex].boneEnd - mMeshes[meshIndex].boneBegin; }
+
+        /** Get the bind matrix ID of a mesh. This is the same for all vertices of a mesh.
+        */
+        uint32_t getBindMatrixID(uint32_t meshIndex) const { return mMeshes[meshIndex].bindMatrixID; }
+
+        /** Get the skeleton matrix ID of a mesh. This is the same for all vertices of a mesh.
+        */
+        uint32_t getSkeletonMatrixID(uint32_t meshIndex) const { return mMeshes[meshIndex].skeletonMatrixID; }
+
+        /** Compute the bounds of a skinned mesh.
+            Each bone box is transformed by mul(transform, mul(boneMatrices[boneID], bindMatrix)).
+            \param[in] meshIndex Mesh index.
+            \param[in] transform Transform applied after skinning.
+            \param[in] boneMatrices Bone matrices indexed by bone ID.
+            \param[in] bindMatrix Transform applied before skinning.
+            \return Bounding box of the skinned mesh.
+        */
+        AABB getBounds(uint32_t meshIndex, const float4x4& transform, const std::vector<float4x4>& boneMatrices, const float4x4& bindMatrix) const;
+
+    private:
+        struct BoneBounds
+        {
+            uint32_t boneID;
+            AABB bounds;                ///< Bind pose bounds of the vertices influenced by the bone.
+        };
+
+        struct Mesh
+        {
+            uint32_t boneBegin;         ///< First bone in mBones.
+            uint32_t boneEnd;           ///< One past the last bone in mBones.
+            uint32_t bindMatrixID;
+            uint32_t skeletonMatrixID;
+        };
+
+        std::vector<Mesh> mMeshes;
+        std::vector<BoneBounds> mBones;
+    };
+}
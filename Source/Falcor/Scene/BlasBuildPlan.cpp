@@ -0,0 +1,104 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "BlasBuildPlan.h"
+#include <algorithm>
+#include <numeric>
+
+namespace Falcor
+{
+    BlasBuildPlan planBlasBuild(const std::vector<BlasBuildSize>& sizes, uint64_t memoryBudget)
+    {
+        // Both result buffers are budgeted, so a BLAS takes up its result size twice.
+        auto getSize = [&](uint32_t blasIndex) { return 2 * sizes[blasIndex].resultByteSize + sizes[blasIndex].scratchByteSize; };
+
+        // Visit the BLASes from largest to smallest. Ties are broken by index, so the plan is deterministic.
+        std::vector<uint32_t> order(sizes.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+        {
+            const uint64_t sizeA = getSize(a);
+            const uint64_t sizeB = getSize(b);
+            return sizeA != sizeB ? sizeA > sizeB : a < b;
+        });
+
+        // Place each BLAS in the first group with enough room left. The buffers are shared by all groups, so a group only
+        // has room if the buffers stay within the budget. The result buffers are budgeted for the largest group each, as
+        // the groups are not yet assigned to a result buffer. Once a BLAS exceeding the budget has grown the buffers,
+        // the other groups may use that memory as well.
+        std::vector<BlasBuildPlan::Group> groups;
+        uint64_t resultBufferByteSize = 0;
+        uint64_t scratchBufferByteSize = 0;
+        for (uint32_t blasIndex : order)
+        {
+            const BlasBuildSize& size = sizes[blasIndex];
+            const uint64_t limit = std::max(memoryBudget, 2 * resultBufferByteSize + scratchBufferByteSize);
+            auto it = std::find_if(groups.begin(), groups.end(), [&](const BlasBuildPlan::Group& group)
+            {
+                const uint64_t resultByteSize = std::max(resultBufferByteSize, group.resultByteSize + size.resultByteSize);
+                const uint64_t scratchByteSize = std::max(scratchBufferByteSize, group.scratchByteSize + size.scratchByteSize);
+                return 2 * resultByteSize + scratchByteSize <= limit;
+            });
+            if (it == groups.end()) it = groups.insert(groups.end(), BlasBuildPlan::Group{});
+
+            it->blasIndices.push_back(blasIndex);
+            it->resultByteSize += size.resultByteSize;
+            it->scratchByteSize += size.scratchByteSize;
+            resultBufferByteSize = std::max(resultBufferByteSize, it->resultByteSize);
+            scratchBufferByteSize = std::max(scratchBufferByteSize, it->scratchByteSize);
+        }
+
+        BlasBuildPlan plan;
+        plan.groups = std::move(groups);
+
+        // Compute the offsets within the groups and the buffer sizes.
+        plan.placements.resize(sizes.size());
+        for (uint32_t groupIndex = 0; groupIndex < (uint32_t)plan.groups.size(); groupIndex++)
+        {
+            auto& group = plan.groups[groupIndex];
+            std::sort(group.blasIndices.begin(), group.blasIndices.end());
+
+            uint64_t resultByteOffset = 0;
+            uint64_t scratchByteOffset = 0;
+            for (uint32_t blasIndex : group.blasIndices)
+            {
+                auto& placement = plan.placements[blasIndex];
+                placement.groupIndex = groupIndex;
+                placement.resultByteOffset = resultByteOffset;
+                placement.scratchByteOffset = scratchByteOffset;
+                resultByteOffset += sizes[blasIndex].resultByteSize;
+                scratchByteOffset += sizes[blasIndex].scratchByteSize;
+            }
+
+            uint64_t& bufferByteSize = plan.resultBufferByteSize[BlasBuildPlan::getResultBufferIndex(groupIndex)];
+            bufferByteSize = std::max(bufferByteSize, group.resultByteSize);
+            plan.scratchBufferByteSize = std::max(plan.scratchBufferByteSize, group.scratchByteSize);
+        }
+
+        return plan;
+    }
+}
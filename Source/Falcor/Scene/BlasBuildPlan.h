@@ -0,0 +1,88 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Memory requirements of building one BLAS.
+    */
+    struct BlasBuildSize
+    {
+        uint64_t resultByteSize = 0;                ///< Size of the uncompacted result, including padding.
+        uint64_t scratchByteSize = 0;               ///< Size of the scratch data, including padding.
+    };
+
+    /** Plan for building BLASes in groups that fit a memory budget.
+        The groups are built one after the other into two result buffers used alternately, so the compaction of one group
+        can overlap the build of the next. The scratch buffer is shared by all groups.
+    */
+    struct BlasBuildPlan
+    {
+        struct Group
+        {
+            std::vector<uint32_t> blasIndices;      ///< BLASes in the group, in ascending order.
+            uint64_t resultByteSize = 0;            ///< Total result size of the BLASes in the group.
+            uint64_t scratchByteSize = 0;           ///< Total scratch size of the BLASes in the group.
+        };
+
+        struct Placement
+        {
+            uint32_t groupIndex = 0;                ///< Group the BLAS is built in.
+            uint64_t resultByteOffset = 0;          ///< Offset into the result buffer.
+            uint64_t scratchByteOffset = 0;         ///< Offset into the scratch buffer.
+        };
+
+        std::vector<Group> groups;                  ///< Groups in build order.
+        std::vector<Placement> placements;          ///< Placement per BLAS.
+        uint64_t resultBufferByteSize[2] = {};      ///< Required size of the result buffers used by the even and odd groups.
+        uint64_t scratchBufferByteSize = 0;         ///< Required size of the scratch buffer.
+
+        /** Get the result buffer used by a group.
+        */
+        static uint32_t getResultBufferIndex(size_t groupIndex) { return (uint32_t)(groupIndex & 1); }
+
+        /** Get the peak memory of the intermediate buffers, excluding the final compacted BLASes.
+        */
+        uint64_t getPeakByteSize() const { return resultBufferByteSize[0] + resultBufferByteSize[1] + scratchBufferByteSize; }
+    };
+
+    /** Group BLAS builds to minimize the number of groups under a memory budget.
+        BLASes are packed first-fit decreasing by twice their result size plus their scratch size. The buffers are shared by all groups, so a
+        BLAS is only added to a group if two result buffers and the scratch buffer, all sized for the largest group, stay
+        within the budget. A BLAS that does not fit any group starts a new one, which may grow the buffers past the budget
+        if it alone exceeds it or if its result to scratch ratio differs from the previous groups.
+        \param[in] sizes Memory requirements per BLAS.
+        \param[in] memoryBudget Maximum size of the result and scratch buffers.
+        \return Build plan.
+    */
+    FALCOR_API BlasBuildPlan planBlasBuild(const std::vector<BlasBuildSize>& sizes, uint64_t memoryBudget);
+}
@@ -64,6 +64,7 @@ namespace Falcor
             data.posW, normalize(data.cameraU), normalize(data.cameraV), normalize(data.cameraW), data.aspectRatio, fovY, data.nearZ,
             data.farZ
         );
+        mViewProj = camera->getViewProjMatrixNoJitter();
 
         invalidateAllDrawBuffers();
     }
@@ -74,6 +75,7 @@ namespace Falcor
         float3 right = math::normalize(math::cross(front,up));
         float3 u = math::cross(right,front);
         createFrustum(eye, right, u, front, aspect, fovY, near, far);
+        mViewProj = math::mul(math::perspective(fovY, aspect, near, far), math::matrixFromLookAt(eye, center, up));
 
         invalidateAllDrawBuffers();
     }
@@ -84,6 +86,7 @@ namespace Falcor
         float3 r = math::normalize(math::cross(front, up));
         float3 u = math::cross(r, front);
         createFrustum(eye, r, u, front, left, right, bottom, top, near, far);
+        mViewProj = math::mul(math::ortho(left, right, bottom, top, near, far), math::matrixFromLookAt(eye, center, up));
 
         invalidateAllDrawBuffers();
     }
@@ -150,7 +153,26 @@ namespace Falcor
 
         return inPlane;
     }
+
+    void FrustumCulling::cull(const FrustumCullingBounds& bounds, std::vector<uint8_t>& visible) const
+    {
+        auto toFloat4 = [](const Plane& plane) { return float4(plane.normal, plane.distance); };
+        const FrustumCullingBounds::Planes planes = {
+            toFloat4(mFrustum.near), toFloat4(mFrustum.far),
+            toFloat4(mFrustum.top), toFloat4(mFrustum.bottom),
+            toFloat4(mFrustum.left), toFloat4(mFrustum.right),
+        };
+        bounds.cull(planes, visible);
+    }
         
+    void FrustumCulling::setOcclusionCulling(bool enabled)
+    {
+        if (enabled == mOcclusionCulling)
+            return;
+        mOcclusionCulling = enabled;
+        invalidateAllDrawBuffers();
+    }
+
     void FrustumCulling::createDrawBuffer(ref<Device> pDevice, ref<GpuFence> pSceneFence, RenderContext* pRenderContext, const std::vector<ref<Buffer>>& drawBuffer, const std::vector<bool>& isDynamic)
     {
         //Clear / Reset
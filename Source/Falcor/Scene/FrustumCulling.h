@@ -29,6 +29,7 @@
 #include "Utils/Math/Vector.h"
 #include "Utils/Math/Matrix.h"
 #include "Utils/Math/AABB.h"
+#include "FrustumCullingBounds.h"
 #include "Camera/Camera.h"
 #include "Camera/CameraController.h"
 #include "Core/API/Buffer.h"
@@ -65,6 +66,15 @@ namespace Falcor
         // Frustum Culling Test. Assumes AABB is transformed to world coordinates
         bool isInFrustum(const AABB& aabb) const;
 
+        // Batched Frustum Culling Test for many world space AABBs. Sets visible[id] to 1 for all objects intersecting the frustum, 0 otherwise
+        void cull(const FrustumCullingBounds& bounds, std::vector<uint8_t>& visible) const;
+
+        // View-projection matrix of the frustum, used for occlusion culling
+        const float4x4& getViewProjMatrix() const { return mViewProj; }
+
+        // Sets if the draw buffers are occlusion culled. The draw buffers are invalidated if this changes
+        void setOcclusionCulling(bool enabled);
+
         //Returns the number of draw buffers
         size_t getDrawBufferSize() { return mDraw.size(); }
 
@@ -140,6 +150,8 @@ namespace Falcor
         bool isInFrontOfPlane(const Plane& plane, const AABB& aabb) const;
 
         Frustum mFrustum;
+        float4x4 mViewProj;
+        bool mOcclusionCulling = false;
         ref<GpuFence> mpStagingFence;   //Copy of the scenes fence
 
         bool mDrawValid = false;
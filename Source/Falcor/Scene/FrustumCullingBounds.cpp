@@ -0,0 +1,350 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "FrustumCullingBounds.h"
+#include "Core/Errors.h"
+#include "Utils/Math/Common.h"
+#include "Utils/Threading.h"
+#include <algorithm>
+#include <limits>
+
+#if defined(__AVX__)
+#define FALCOR_CULLING_AVX 1
+#include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#define FALCOR_CULLING_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kAllPlanes = 0x3f;
+
+        // Number of batches per work item when testing dynamic boxes in parallel.
+        const size_t kDynamicBatchGrainSize = 512;
+
+        // Box arrays in the order minX, minY, minZ, maxX, maxY, maxZ.
+        using BoundsArrays = std::array<const float*, 6>;
+
+        // Index of the array holding the coordinate of the box corner furthest along the plane normal (the positive vertex).
+        uint32_t positiveVertexArray(float normal, uint32_t axis) { return normal >= 0.f ? axis + 3 : axis; }
+
+        // Signed distance with a fixed evaluation order, so that node, SIMD and scalar tests round identically.
+        float planeDot(const float4& plane, float x, float y, float z) { return (plane.x * x + plane.y * y) + plane.z * z; }
+
+        /** Test a batch of boxes against the planes in planeMask.
+            A box is culled if its positive vertex is behind any plane. Empty boxes (min = +inf, max = -inf) are always culled.
+            \return Bitmask with bit i set if box start + i is in front of all planes.
+        */
+        uint32_t testBatch(const BoundsArrays& arrays, size_t start, const FrustumCullingBounds::Planes& planes, uint32_t planeMask)
+        {
+#if FALCOR_CULLING_AVX
+            __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (uint32_t p = 0; p < 6; p++)
+            {
+                if ((planeMask & (1u << p)) == 0) continue;
+                const float4& plane = planes[p];
+                __m256 x = _mm256_loadu_ps(arrays[positiveVertexArray(plane.x, 0)] + start);
+                __m256 y = _mm256_loadu_ps(arrays[positiveVertexArray(plane.y, 1)] + start);
+                __m256 z = _mm256_loadu_ps(arrays[positiveVertexArray(plane.z, 2)] + start);
+                __m256 xy = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.x), x), _mm256_mul_ps(_mm256_set1_ps(plane.y), y));
+                __m256 dist = _mm256_add_ps(xy, _mm256_mul_ps(_mm256_set1_ps(plane.z), z));
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(dist, _mm256_set1_ps(plane.w), _CMP_GE_OQ));
+            }
+            return (uint32_t)_mm256_movemask_ps(inside);
+#elif FALCOR_CULLING_SSE
+            // Two groups of four boxes.
+            uint32_t result = 0;
+            for (size_t half = 0; half < 2; half++)
+            {
+                const size_t offset = start + half * 4;
+                __m128 inside = _mm_cmpeq_ps(_mm_setzero_ps(), _mm_setzero_ps());
+                for (uint32_t p = 0; p < 6; p++)
+                {
+                    if ((planeMask & (1u << p)) == 0) continue;
+                    const float4& plane = planes[p];
+                    __m128 x = _mm_loadu_ps(arrays[positiveVertexArray(plane.x, 0)] + offset);
+                    __m128 y = _mm_loadu_ps(arrays[positiveVertexArray(plane.y, 1)] + offset);
+                    __m128 z = _mm_loadu_ps(arrays[positiveVertexArray(plane.z, 2)] + offset);
+                    __m128 xy = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), x), _mm_mul_ps(_mm_set1_ps(plane.y), y));
+                    __m128 dist = _mm_add_ps(xy, _mm_mul_ps(_mm_set1_ps(plane.z), z));
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, _mm_set1_ps(plane.w)));
+                }
+                result |= (uint32_t)_mm_movemask_ps(inside) << (half * 4);
+            }
+            return result;
+#else
+            uint32_t result = 0;
+            for (uint32_t i = 0; i < FrustumCullingBounds::kBatchSize; i++)
+            {
+                bool inside = true;
+                for (uint32_t p = 0; p < 6 && inside; p++)
+                {
+                    if ((planeMask & (1u << p)) == 0) continue;
+                    const float4& plane = planes[p];
+                    float x = arrays[positiveVertexArray(plane.x, 0)][start + i];
+                    float y = arrays[positiveVertexArray(plane.y, 1)][start + i];
+                    float z = arrays[positiveVertexArray(plane.z, 2)][start + i];
+                    inside = planeDot(plane, x, y, z) >= plane.w;
+                }
+                if (inside) result |= 1u << i;
+            }
+            return result;
+#endif
+        }
+    }
+
+    void FrustumCullingBounds::BoxArrays::resize(size_t count)
+    {
+        const float inf = std::numeric_limits<float>::infinity();
+        for (auto pArray : { &minX, &minY, &minZ }) pArray->assign(count + kBatchSize, inf);
+        for (auto pArray : { &maxX, &maxY, &maxZ }) pArray->assign(count + kBatchSize, -inf);
+        ids.resize(count);
+    }
+
+    void FrustumCullingBounds::BoxArrays::set(size_t index, const AABB& bounds)
+    {
+        minX[index] = bounds.minPoint.x;
+        minY[index] = bounds.minPoint.y;
+        minZ[index] = bounds.minPoint.z;
+        maxX[index] = bounds.maxPoint.x;
+        maxY[index] = bounds.maxPoint.y;
+        maxZ[index] = bounds.maxPoint.z;
+    }
+
+    AABB FrustumCullingBounds::BoxArrays::get(size_t index) const
+    {
+        return AABB(float3(minX[index], minY[index], minZ[index]), float3(maxX[index], maxY[index], maxZ[index]));
+    }
+
+    void FrustumCullingBounds::build(const std::vector<AABB>& bounds, const std::vector<bool>& isStatic)
+    {
+        checkArgument(bounds.size() == isStatic.size(), "'bounds' and 'isStatic' must have the same size.");
+        checkArgument(bounds.size() < kDynamicBit, "Too many objects for frustum culling ({}).", bounds.size());
+
+        std::vector<uint32_t> staticIDs, dynamicIDs;
+        for (uint32_t id = 0; id < (uint32_t)bounds.size(); id++)
+        {
+            if (isStatic[id] && bounds[id].valid()) staticIDs.push_back(id);
+            else dynamicIDs.push_back(id);
+        }
+
+        mLocations.resize(bounds.size());
+
+        mDynamic.resize(dynamicIDs.size());
+        for (uint32_t i = 0; i < (uint32_t)dynamicIDs.size(); i++)
+        {
+            mDynamic.ids[i] = dynamicIDs[i];
+            mDynamic.set(i, bounds[dynamicIDs[i]]);
+            mLocations[dynamicIDs[i]] = i | kDynamicBit;
+        }
+
+        // Building the BVH reorders the primitives so that the boxes of each subtree are contiguous.
+        std::vector<BuildPrimitive> primitives(staticIDs.size());
+        for (size_t i = 0; i < staticIDs.size(); i++) primitives[i] = { bounds[staticIDs[i]], bounds[staticIDs[i]].center(), staticIDs[i] };
+
+        mNodes.clear();
+        if (!primitives.empty())
+        {
+            mNodes.reserve(2 * div_round_up((uint32_t)primitives.size(), kBatchSize));
+            buildNode(primitives, 0, (uint32_t)primitives.size());
+        }
+
+        mStatic.resize(primitives.size());
+        for (uint32_t i = 0; i < (uint32_t)primitives.size(); i++)
+        {
+            mStatic.ids[i] = primitives[i].id;
+            mStatic.set(i, primitives[i].bounds);
+            mLocations[primitives[i].id] = i;
+        }
+
+        mStaticCount = (uint32_t)staticIDs.size();
+        mRefitNeeded = false;
+    }
+
+    uint32_t FrustumCullingBounds::buildNode(std::vector<BuildPrimitive>& primitives, uint32_t begin, uint32_t end)
+    {
+        const uint32_t nodeIndex = (uint32_t)mNodes.size();
+        mNodes.push_back({});
+
+        AABB nodeBounds;
+        uint32_t rightChild = 0;
+        const uint32_t count = end - begin;
+        if (count <= kBatchSize)
+        {
+            for (uint32_t i = begin; i < end; i++) nodeBounds |= primitives[i].bounds;
+        }
+        else
+        {
+            AABB centroidBounds;
+            for (uint32_t i = begin; i < end; i++) centroidBounds.include(primitives[i].centroid);
+
+            // Split at the centroid median along the largest axis. The left side gets a multiple of the batch size so that leaves are full.
+            const float3 extent = centroidBounds.extent();
+            const uint32_t axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+            uint32_t leftCount = div_round_up(count / 2, kBatchSize) * kBatchSize;
+            if (leftCount >= count) leftCount = count / 2;
+            const uint32_t mid = begin + leftCount;
+            std::nth_element(primitives.begin() + begin, primitives.begin() + mid, primitives.begin() + end,
+                [axis](const BuildPrimitive& a, const BuildPrimitive& b) { return a.centroid[axis] < b.centroid[axis]; });
+
+            const uint32_t leftChild = buildNode(primitives, begin, mid);
+            rightChild = buildNode(primitives, mid, end);
+            nodeBounds = mNodes[leftChild].bounds | mNodes[rightChild].bounds;
+        }
+
+        Node& node = mNodes[nodeIndex];
+        node.bounds = nodeBounds;
+        node.boxBegin = begin;
+        node.boxEnd = end;
+        node.rightChild = rightChild;
+        return nodeIndex;
+    }
+
+    void FrustumCullingBounds::setBounds(uint32_t id, const AABB& bounds)
+    {
+        FALCOR_ASSERT(id < mLocations.size());
+        const uint32_t location = mLocations[id];
+        if (location & kDynamicBit)
+        {
+            mDynamic.set(location & ~kDynamicBit, bounds);
+        }
+        else
+        {
+            mStatic.set(location, bounds);
+            mRefitNeeded = true;
+        }
+    }
+
+    void FrustumCullingBounds::refit()
+    {
+        if (!mRefitNeeded) return;
+
+        // Children are stored after their parents, so a reverse sweep visits children first.
+        for (size_t i = mNodes.size(); i-- > 0;)
+        {
+            Node& node = mNodes[i];
+            if (node.rightChild == 0)
+            {
+                node.bounds = AABB();
+                for (uint32_t box = node.boxBegin; box < node.boxEnd; box++) node.bounds |= mStatic.get(box);
+            }
+            else
+            {
+                node.bounds = mNodes[i + 1].bounds | mNodes[node.rightChild].bounds;
+            }
+        }
+        mRefitNeeded = false;
+    }
+
+    void FrustumCullingBounds::cull(const Planes& planes, std::vector<uint8_t>& visible) const
+    {
+        FALCOR_ASSERT(!mRefitNeeded);
+        visible.assign(mLocations.size(), 0);
+        cullStatic(planes, visible);
+        cullDynamic(planes, visible);
+    }
+
+    void FrustumCullingBounds::cullStatic(const Planes& planes, std::vector<uint8_t>& visible) const
+    {
+        if (mNodes.empty()) return;
+
+        const BoundsArrays arrays = { mStatic.minX.data(), mStatic.minY.data(), mStatic.minZ.data(), mStatic.maxX.data(), mStatic.maxY.data(), mStatic.maxZ.data() };
+
+        struct StackEntry
+        {
+            uint32_t node;
+            uint32_t planeMask;     ///< Planes the node is not known to be completely in front of.
+        };
+        std::vector<StackEntry> stack;
+        stack.push_back({ 0, kAllPlanes });
+
+        while (!stack.empty())
+        {
+            StackEntry entry = stack.back();
+            stack.pop_back();
+            const Node& node = mNodes[entry.node];
+
+            // Reject the subtree if the node is behind any plane. Planes the node is completely in front of don't need to be tested further down.
+            bool culled = false;
+            for (uint32_t p = 0; p < 6 && !culled; p++)
+            {
+                if ((entry.planeMask & (1u << p)) == 0) continue;
+                const float4& plane = planes[p];
+                const float3 positive(plane.x >= 0.f ? node.bounds.maxPoint.x : node.bounds.minPoint.x, plane.y >= 0.f ? node.bounds.maxPoint.y : node.bounds.minPoint.y, plane.z >= 0.f ? node.bounds.maxPoint.z : node.bounds.minPoint.z);
+                const float3 negative(plane.x >= 0.f ? node.bounds.minPoint.x : node.bounds.maxPoint.x, plane.y >= 0.f ? node.bounds.minPoint.y : node.bounds.maxPoint.y, plane.z >= 0.f ? node.bounds.minPoint.z : node.bounds.maxPoint.z);
+                if (!(planeDot(plane, positive.x, positive.y, positive.z) >= plane.w)) culled = true;
+                else if (planeDot(plane, negative.x, negative.y, negative.z) >= plane.w) entry.planeMask &= ~(1u << p);
+            }
+            if (culled) continue;
+
+            if (entry.planeMask == 0)
+            {
+                // Completely inside the frustum.
+                for (uint32_t box = node.boxBegin; box < node.boxEnd; box++) visible[mStatic.ids[box]] = 1;
+            }
+            else if (node.rightChild == 0)
+            {
+                for (uint32_t start = node.boxBegin; start < node.boxEnd; start += kBatchSize)
+                {
+                    const uint32_t mask = testBatch(arrays, start, planes, entry.planeMask);
+                    const uint32_t count = std::min(kBatchSize, node.boxEnd - start);
+                    for (uint32_t i = 0; i < count; i++)
+                    {
+                        if (mask & (1u << i)) visible[mStatic.ids[start + i]] = 1;
+                    }
+                }
+            }
+            else
+            {
+                stack.push_back({ node.rightChild, entry.planeMask });
+                stack.push_back({ entry.node + 1, entry.planeMask });
+            }
+        }
+    }
+
+    void FrustumCullingBounds::cullDynamic(const Planes& planes, std::vector<uint8_t>& visible) const
+    {
+        const BoundsArrays arrays = { mDynamic.minX.data(), mDynamic.minY.data(), mDynamic.minZ.data(), mDynamic.maxX.data(), mDynamic.maxY.data(), mDynamic.maxZ.data() };
+        const size_t boxCount = mDynamic.size();
+        const size_t batchCount = div_round_up(boxCount, (size_t)kBatchSize);
+
+        // Each box belongs to a different object, so batches can write their results concurrently.
+        Threading::parallel_for(size_t(0), batchCount, [&](size_t batch)
+        {
+            const size_t start = batch * kBatchSize;
+            const uint32_t mask = testBatch(arrays, start, planes, kAllPlanes);
+            const size_t count = std::min((size_t)kBatchSize, boxCount - start);
+            for (size_t i = 0; i < count; i++)
+            {
+                if (mask & (1u << i)) visible[mDynamic.ids[start + i]] = 1;
+            }
+        }, kDynamicBatchGrainSize);
+    }
+}
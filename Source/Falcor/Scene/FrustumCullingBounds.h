@@ -0,0 +1,126 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Math/AABB.h"
+#include "Utils/Math/Vector.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** World-space bounding boxes prepared for batched frustum culling.
+        Boxes are stored as structure of arrays, so the frustum test processes 8 boxes per iteration with
+        AVX or SSE instructions (with a scalar fallback). Boxes of static objects are additionally organized
+        in a BVH, which lets the test accept or reject whole subtrees without looking at individual boxes.
+        Culling is const, so the same bounds can be culled against several frusta concurrently.
+    */
+    class FALCOR_API FrustumCullingBounds
+    {
+    public:
+        /** Frustum planes as (normal, distance). A point p is in front of a plane if dot(normal, p) >= distance.
+        */
+        using Planes = std::array<float4, 6>;
+
+        static constexpr uint32_t kBatchSize = 8;   ///< Number of boxes tested per SIMD iteration. Also the maximum BVH leaf size.
+
+        /** Set the bounding boxes of all objects and build the BVH over the static ones.
+            Static objects with invalid bounds are treated as dynamic, so they can still be updated.
+            \param[in] bounds World-space bounding box per object.
+            \param[in] isStatic Flag per object. Static objects are placed in the BVH, the others are tested linearly.
+        */
+        void build(const std::vector<AABB>& bounds, const std::vector<bool>& isStatic);
+
+        /** Update the bounding box of an object. Call refit() after updating static objects.
+            \param[in] id Object ID.
+            \param[in] bounds New world-space bounding box.
+        */
+        void setBounds(uint32_t id, const AABB& bounds);
+
+        /** Refit the BVH after static objects moved. Does nothing if no static object changed.
+        */
+        void refit();
+
+        /** Get the number of objects.
+        */
+        uint32_t getCount() const { return (uint32_t)mLocations.size(); }
+
+        /** Get the number of objects in the BVH.
+        */
+        uint32_t getStaticCount() const { return mStaticCount; }
+
+        /** Test all boxes against a frustum.
+            \param[in] planes Frustum planes.
+            \param[out] visible Resized to getCount(). Set to 1 for objects that intersect the frustum and 0 otherwise.
+        */
+        void cull(const Planes& planes, std::vector<uint8_t>& visible) const;
+
+    private:
+        /** Boxes in SoA layout. The arrays are padded by kBatchSize empty boxes, so a full batch can be loaded at any index.
+        */
+        struct BoxArrays
+        {
+            std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+            std::vector<uint32_t> ids;  ///< Object ID for each box.
+
+            void resize(size_t count);
+            void set(size_t index, const AABB& bounds);
+            AABB get(size_t index) const;
+            size_t size() const { return ids.size(); }
+        };
+
+        struct Node
+        {
+            AABB bounds;
+            uint32_t boxBegin = 0;      ///< First box of the subtree in mStatic. The boxes of a subtree are contiguous.
+            uint32_t boxEnd = 0;        ///< One past the last box of the subtree.
+            uint32_t rightChild = 0;    ///< Index of the right child, or 0 for leaves. The left child directly follows its parent.
+        };
+
+        struct BuildPrimitive
+        {
+            AABB bounds;
+            float3 centroid;
+            uint32_t id;
+        };
+
+        uint32_t buildNode(std::vector<BuildPrimitive>& primitives, uint32_t begin, uint32_t end);
+        void cullStatic(const Planes& planes, std::vector<uint8_t>& visible) const;
+        void cullDynamic(const Planes& planes, std::vector<uint8_t>& visible) const;
+
+        static constexpr uint32_t kDynamicBit = 0x80000000;
+
+        BoxArrays mStatic;                      ///< Static boxes in BVH leaf order.
+        BoxArrays mDynamic;                     ///< Dynamic boxes.
+        std::vector<Node> mNodes;               ///< BVH over the static boxes in depth-first order. Empty if there are no static boxes.
+        std::vector<uint32_t> mLocations;       ///< Index into mStatic, or into mDynamic with kDynamicBit set, per object.
+        uint32_t mStaticCount = 0;
+        bool mRefitNeeded = false;
+    };
+}
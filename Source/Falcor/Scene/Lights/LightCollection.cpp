@@ -31,8 +31,12 @@
 #include "Scene/Scene.h"
 #include "Scene/Material/BasicMaterial.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include "Utils/Math/MathConstants.slangh"
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Timing/Profiler.h"
+#include <algorithm>
 
 namespace Falcor
 {
@@ -46,6 +50,16 @@ namespace Falcor
         const char kBuildTriangleListFile[] = "Scene/Lights/BuildTriangleList.cs.slang";
         const char kUpdateTriangleVerticesFile[] = "Scene/Lights/UpdateTriangleVertices.cs.slang";
         const char kFinalizeIntegrationFile[] = "Scene/Lights/FinalizeIntegration.cs.slang";
+
+        const uint32_t kParallelFluxGrainSize = 4096;   ///< Number of triangles per task when computing the constant emission flux.
+
+        /** Check if a material has an emissive texture, using the same test as MaterialSystem::isEmissiveTextured() on the GPU.
+            The texture handles are valid as the materials are updated when the scene is finalized, before the light collection is created.
+        */
+        bool isEmissiveTextured(const BasicMaterial& material)
+        {
+            return material.getData().texEmissive.getMode() == TextureHandle::Mode::Texture;
+        }
     }
 
     LightCollection::LightCollection(ref<Device> pDevice, RenderContext* pRenderContext, Scene* pScene)
@@ -85,8 +99,7 @@ namespace Falcor
 
         // Update transform matrices and check for updates.
         // TODO: Move per-mesh instance update flags into Scene. Return just a list of mesh lights that have changed.
-        std::vector<uint32_t> updatedLights;
-        updatedLights.reserve(mMeshLights.size());
+        mUpdatedLights.clear();
 
         for (uint32_t lightIdx = 0; lightIdx < mMeshLights.size(); ++lightIdx)
         {
@@ -97,14 +110,14 @@ namespace Falcor
             if (mpScene->getAnimationController()->isMatrixChanged(NodeID{ instanceData.globalMatrixID })) updateFlags |= UpdateFlags::MatrixChanged;
 
             // Store update status.
-            if (updateFlags != UpdateFlags::None) updatedLights.push_back(lightIdx);
+            if (updateFlags != UpdateFlags::None) mUpdatedLights.push_back(lightIdx);
             if (pUpdateStatus) pUpdateStatus->lightsUpdateInfo.push_back(updateFlags);
         }
 
         // Update light data if needed.
-        if (!updatedLights.empty())
+        if (!mUpdatedLights.empty())
         {
-            updateTrianglePositions(pRenderContext, *mpScene, updatedLights);
+            updateTrianglePositions(pRenderContext, *mpScene, mUpdatedLights);
             return true;
         }
 
@@ -170,6 +183,7 @@ namespace Falcor
     void LightCollection::setupMeshLights(const Scene& scene)
     {
         mMeshLights.clear();
+        mMeshLightEmission.clear();
         mpSamplerState = nullptr;
         mTriangleCount = 0;
 
@@ -198,9 +212,14 @@ namespace Falcor
                 mMeshLights.push_back(meshLight);
                 mTriangleCount += meshLight.triangleCount;
 
+                MeshLightEmission emission;
+                emission.isTextured = isEmissiveTextured(*pMaterial);
+                emission.radiance = pMaterial->getEmissiveColor() * pMaterial->getEmissiveFactor();
+                mMeshLightEmission.push_back(emission);
+
                 // Store ptr to texture sampler. We currently assume all the mesh lights' materials have the same sampler, which is true in current Falcor.
                 // If this changes in the future, we'll have to support multiple samplers.
-                if (pMaterial->getEmissiveTexture())
+                if (emission.isTextured)
                 {
                     if (!mpSamplerState)
                     {
@@ -226,6 +245,7 @@ namespace Falcor
             mMeshLightStats = MeshLightStats();
 
             mCPUInvalidData = CPUOutOfDateFlags::None;
+            mCPUInvalidLights.clear();
             mStagingBufferValid = true;
             mStatsValid = true;
         }
@@ -237,18 +257,23 @@ namespace Falcor
             prepareTriangleData(pRenderContext, scene);
             timeReport.measure("LightCollection::build preparation");
 
-            // Pre-integrate emissive triangles.
+            // Pre-integrate textured emissive triangles. The flux of the other triangles was computed on the CPU during preparation.
             // TODO: We might want to redo this in update() for animated meshes or after scale changes as that affects the flux.
-            integrateEmissive(pRenderContext, scene);
+            bool hasTexturedEmission = std::any_of(mMeshLightEmission.begin(), mMeshLightEmission.end(), [](const MeshLightEmission& e) { return e.isTextured; });
+            if (hasTexturedEmission)
+            {
+                integrateEmissive(pRenderContext, scene);
+
+                // Only the flux data of the textured triangles needs to be read back.
+                mCPUInvalidData = CPUOutOfDateFlags::FluxData;
+                mStagingBufferValid = false;
+                prepareSyncCPUData(pRenderContext);
+            }
 
             timeReport.measure("LightCollection::build integrate emissive");
 
             // Build list of active triangles.
-            mCPUInvalidData = CPUOutOfDateFlags::All;
-            mStagingBufferValid = false;
             mStatsValid = false;
-
-            prepareSyncCPUData(pRenderContext);
             updateActiveTriangleList(pRenderContext);
 
             timeReport.measure("LightCollection::build finalize");
@@ -271,6 +296,53 @@ namespace Falcor
 
         // Compute triangle data (vertices, uv-coordinates, materialID) for all mesh lights.
         buildTriangleList(pRenderContext, scene);
+
+        // Compute the flux of the triangles with constant emission.
+        computeConstantEmission(pRenderContext);
+    }
+
+    void LightCollection::computeConstantEmission(RenderContext* pRenderContext)
+    {
+        FALCOR_ASSERT(mTriangleCount > 0);
+        FALCOR_ASSERT(mMeshLightEmission.size() == mMeshLights.size());
+
+        // Read back the triangle data. The areas are needed to compute the flux.
+        mCPUInvalidData = CPUOutOfDateFlags::TriangleData;
+        mCPUInvalidLights.clear();
+        mStagingBufferValid = false;
+        prepareSyncCPUData(pRenderContext);
+        syncCPUData(pRenderContext);
+
+        computeConstantEmissionFlux(mMeshLightEmission, mMeshLightTriangles);
+
+        // Upload the flux data. The entries of textured triangles are written by the GPU integrator later.
+        std::vector<EmissiveFlux> fluxData(mTriangleCount);
+        for (uint32_t triIdx = 0; triIdx < mTriangleCount; triIdx++)
+        {
+            fluxData[triIdx].flux = mMeshLightTriangles[triIdx].flux;
+            fluxData[triIdx].averageRadiance = mMeshLightTriangles[triIdx].averageRadiance;
+        }
+        mpFluxData->setBlob(fluxData.data(), 0, fluxData.size() * sizeof(EmissiveFlux));
+    }
+
+    void LightCollection::computeConstantEmissionFlux(const std::vector<MeshLightEmission>& emission, std::vector<MeshLightTriangle>& triangles, bool parallel)
+    {
+        auto computeFlux = [&](uint32_t triIdx)
+        {
+            MeshLightTriangle& tri = triangles[triIdx];
+            FALCOR_ASSERT(tri.lightIdx < emission.size());
+            const MeshLightEmission& e = emission[tri.lightIdx];
+            if (e.isTextured) return;
+
+            // Same computation as in FinalizeIntegration.cs.slang.
+            // We assume diffuse emitters and integrate per side (hemisphere) => the scale factor is pi.
+            tri.averageRadiance = e.radiance;
+            tri.flux = luminance(e.radiance) * tri.area * (float)M_PI;
+        };
+
+        const uint32_t triCount = (uint32_t)triangles.size();
+        if (parallel) Threading::parallel_for(0u, triCount, computeFlux, kParallelFluxGrainSize);
+        else for (uint32_t triIdx = 0; triIdx < triCount; triIdx++) computeFlux(triIdx);
     }
 
     void LightCollection::prepareMeshData(const Scene& scene)
@@ -315,6 +387,29 @@ namespace Falcor
     {
         FALCOR_ASSERT(mTriangleCount > 0);
         FALCOR_ASSERT(mMeshLights.size() > 0);
+        FALCOR_ASSERT(mMeshLightEmission.size() == mMeshLights.size());
+
+        // Find the ranges of consecutive textured mesh lights. Only these triangles are rasterized.
+        // The triangles of consecutive mesh lights are stored consecutively, so each range is drawn with a single draw call.
+        std::vector<uint2> texturedRanges; // Triangle offset and count.
+        for (uint32_t lightIdx = 0; lightIdx < mMeshLights.size(); ++lightIdx)
+        {
+            if (!mMeshLightEmission[lightIdx].isTextured) continue;
+            const MeshLightData& meshLight = mMeshLights[lightIdx];
+            if (!texturedRanges.empty() && texturedRanges.back().x + texturedRanges.back().y == meshLight.triangleOffset) texturedRanges.back().y += meshLight.triangleCount;
+            else texturedRanges.push_back(uint2(meshLight.triangleOffset, meshLight.triangleCount));
+        }
+        FALCOR_ASSERT(!texturedRanges.empty());
+
+        auto drawTexturedRanges = [&]()
+        {
+            auto var = mIntegrator.pVars->getRootVar();
+            for (const uint2& range : texturedRanges)
+            {
+                var["CB"]["gTriangleOffset"] = range.x;
+                pRenderContext->draw(mIntegrator.pState.get(), mIntegrator.pVars.get(), range.y * 3, 0);
+            }
+        };
 
         // Prepare program vars.
         {
@@ -343,7 +438,7 @@ namespace Falcor
 
             // Execute.
             mIntegrator.pProgram->addDefine("INTEGRATOR_PASS", "1");
-            pRenderContext->draw(mIntegrator.pState.get(), mIntegrator.pVars.get(), mTriangleCount * 3, 0);
+            drawTexturedRanges();
         }
 
         // 2nd pass: Rasterize emissive triangles in texture space to sum up their texels.
@@ -366,10 +461,10 @@ namespace Falcor
 
             // Execute.
             mIntegrator.pProgram->addDefine("INTEGRATOR_PASS", "2");
-            pRenderContext->draw(mIntegrator.pState.get(), mIntegrator.pVars.get(), mTriangleCount * 3, 0);
+            drawTexturedRanges();
         }
 
-        // 3rd pass: Finalize the per-triangle flux values.
+        // 3rd pass: Finalize the per-triangle flux values of the textured triangles.
         {
             auto var = mpFinalizeIntegration->getRootVar();
 
@@ -420,13 +515,10 @@ namespace Falcor
         stats.triangleCount = (uint32_t)mMeshLightTriangles.size();
 
         uint32_t trianglesTotal = 0;
-        for (const auto& meshLight : mMeshLights)
+        for (uint32_t lightIdx = 0; lightIdx < mMeshLights.size(); ++lightIdx)
         {
-            auto pMaterial = mpScene->getMaterial(MaterialID::fromSlang(meshLight.materialID))->toBasicMaterial();
-            FALCOR_ASSERT(pMaterial);
-            bool isTextured = pMaterial->getEmissiveTexture() != nullptr;
-
-            if (isTextured)
+            const MeshLightData& meshLight = mMeshLights[lightIdx];
+            if (mMeshLightEmission[lightIdx].isTextured)
             {
                 stats.meshesTextured++;
                 stats.trianglesTextured += meshLight.triangleCount;
@@ -447,11 +539,7 @@ namespace Falcor
             {
                 // TODO: Currently we don't detect uniform radiance for textured lights, so just look at whether the mesh light is textured or not.
                 // This code will change when we tag individual triangles as textured vs non-textured.
-                auto pMaterial = mpScene->getMaterial(MaterialID::fromSlang(mMeshLights[tri.lightIdx].materialID))->toBasicMaterial();
-                FALCOR_ASSERT(pMaterial);
-                bool isTextured = pMaterial->getEmissiveTexture() != nullptr;
-
-                if (isTextured) stats.trianglesActiveTextured++;
+                if (mMeshLightEmission[tri.lightIdx].isTextured) stats.trianglesActiveTextured++;
                 else stats.trianglesActiveUniform++;
             }
         }
@@ -570,6 +658,13 @@ namespace Falcor
         // Run compute pass to update all triangles.
         mpTrianglePositionUpdater->execute(pRenderContext, mTriangleCount, 1u, 1u);
 
+        // Keep track of the moved mesh lights so that only their triangles are read back, unless all triangle data is already out of date.
+        if (!is_set(mCPUInvalidData, CPUOutOfDateFlags::TriangleData) || !mCPUInvalidLights.empty())
+        {
+            mCPUInvalidLights.insert(mCPUInvalidLights.end(), updatedLights.begin(), updatedLights.end());
+            std::sort(mCPUInvalidLights.begin(), mCPUInvalidLights.end());
+            mCPUInvalidLights.erase(std::unique(mCPUInvalidLights.begin(), mCPUInvalidLights.end()), mCPUInvalidLights.end());
+        }
         mCPUInvalidData |= CPUOutOfDateFlags::TriangleData;
         mStagingBufferValid = false;
     }
@@ -619,6 +714,7 @@ namespace Falcor
             mpStagingBuffer = Buffer::create(mpDevice, stagingSize, Resource::BindFlags::None, Buffer::CpuAccess::Read);
             mpStagingBuffer->setName("LightCollection::mpStagingBuffer");
             mCPUInvalidData = CPUOutOfDateFlags::All;
+            mCPUInvalidLights.clear();
         }
 
         // Schedule the copy operations for data that is invalid.
@@ -629,8 +725,25 @@ namespace Falcor
         bool copyTriangleData = is_set(mCPUInvalidData, CPUOutOfDateFlags::TriangleData);
         bool copyFluxData = is_set(mCPUInvalidData, CPUOutOfDateFlags::FluxData);
 
+        // The triangle data of the moved mesh lights is copied to the same offsets as in the full copy.
         uint64_t offset = 0;
-        if (copyTriangleData) pRenderContext->copyBufferRegion(mpStagingBuffer.get(), offset, mpTriangleData.get(), 0, mpTriangleData->getSize());
+        if (copyTriangleData)
+        {
+            if (mCPUInvalidLights.empty())
+            {
+                pRenderContext->copyBufferRegion(mpStagingBuffer.get(), offset, mpTriangleData.get(), 0, mpTriangleData->getSize());
+            }
+            else
+            {
+                for (uint32_t lightIdx : mCPUInvalidLights)
+                {
+                    const MeshLightData& meshLight = mMeshLights[lightIdx];
+                    const uint64_t regionOffset = offset + (uint64_t)meshLight.triangleOffset * sizeof(PackedEmissiveTriangle);
+                    const uint64_t regionSize = (uint64_t)meshLight.triangleCount * sizeof(PackedEmissiveTriangle);
+                    if (regionSize > 0) pRenderContext->copyBufferRegion(mpStagingBuffer.get(), regionOffset, mpTriangleData.get(), regionOffset, regionSize);
+                }
+            }
+        }
         offset += mpTriangleData->getSize();
         if (copyFluxData) pRenderContext->copyBufferRegion(mpStagingBuffer.get(), offset, mpFluxData.get(), 0, mpFluxData->getSize());
         offset += mpFluxData->getSize();
@@ -677,26 +790,43 @@ namespace Falcor
 
         FALCOR_ASSERT(mTriangleCount > 0);
         FALCOR_ASSERT(mMeshLightTriangles.size() == (size_t)mTriangleCount);
-        for (uint32_t triIdx = 0; triIdx < mTriangleCount; triIdx++)
+        if (updateTriangleData)
         {
-            const auto tri = triangleData[triIdx].unpack();
-            auto& meshLightTri = mMeshLightTriangles[triIdx];
-
-            if (updateTriangleData)
+            auto unpackTriangles = [&](uint32_t triangleOffset, uint32_t triangleCount)
             {
-                meshLightTri.lightIdx = tri.lightIdx;
-                meshLightTri.normal = tri.normal;
-                meshLightTri.area = tri.area;
-
-                for (uint32_t j = 0; j < 3; j++)
+                for (uint32_t triIdx = triangleOffset; triIdx < triangleOffset + triangleCount; triIdx++)
                 {
-                    meshLightTri.vtx[j].pos = tri.posW[j];
-                    meshLightTri.vtx[j].uv = tri.texCoords[j];
+                    const auto tri = triangleData[triIdx].unpack();
+                    auto& meshLightTri = mMeshLightTriangles[triIdx];
+
+                    meshLightTri.lightIdx = tri.lightIdx;
+                    meshLightTri.normal = tri.normal;
+                    meshLightTri.area = tri.area;
+
+                    for (uint32_t j = 0; j < 3; j++)
+                    {
+                        meshLightTri.vtx[j].pos = tri.posW[j];
+                        meshLightTri.vtx[j].uv = tri.texCoords[j];
+                    }
                 }
+            };
+
+            // Only the triangles of the moved mesh lights were copied if they are known.
+            if (mCPUInvalidLights.empty())
+            {
+                unpackTriangles(0, mTriangleCount);
+            }
+            else
+            {
+                for (uint32_t lightIdx : mCPUInvalidLights) unpackTriangles(mMeshLights[lightIdx].triangleOffset, mMeshLights[lightIdx].triangleCount);
             }
+        }
 
-            if (updateFluxData)
+        if (updateFluxData)
+        {
+            for (uint32_t triIdx = 0; triIdx < mTriangleCount; triIdx++)
             {
+                auto& meshLightTri = mMeshLightTriangles[triIdx];
                 meshLightTri.flux = fluxData[triIdx].flux;
                 meshLightTri.averageRadiance = fluxData[triIdx].averageRadiance;
             }
@@ -704,6 +834,7 @@ namespace Falcor
 
         mpStagingBuffer->unmap();
         mCPUInvalidData = CPUOutOfDateFlags::None;
+        mCPUInvalidLights.clear();
     }
 
     uint64_t LightCollection::getMemoryUsageInBytes() const
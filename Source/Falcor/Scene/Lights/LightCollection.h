@@ -114,6 +114,24 @@ namespace Falcor
             }
         };
 
+        /** Emission properties of a mesh light.
+            The flux of triangles with constant emission is computed on the CPU, textured emission is integrated on the GPU.
+        */
+        struct MeshLightEmission
+        {
+            bool            isTextured = false;                 ///< True if the mesh light has an emissive texture.
+            float3          radiance = float3(0);               ///< Emitted radiance (emissive color scaled by the emissive factor). Only used if the emission is not textured.
+        };
+
+        /** Compute the average radiance and flux of all triangles with constant (non-textured) emission.
+            This matches the result of the GPU integration for these triangles. Triangles with zero flux are culled.
+            Triangles of textured mesh lights are left unchanged.
+            \param[in] emission Emission properties per mesh light.
+            \param[in,out] triangles Mesh light triangles. The light indices and areas must be valid.
+            \param[in] parallel Process the triangles in parallel. This doesn't change the result.
+        */
+        static void computeConstantEmissionFlux(const std::vector<MeshLightEmission>& emission, std::vector<MeshLightTriangle>& triangles, bool parallel = true);
+
         /** Creates a light collection for the given scene.
             Note that update() must be called before the collection is ready to use.
             \param[in] pDevice GPU device.
@@ -155,6 +173,7 @@ namespace Falcor
 
         /** Returns a CPU buffer with all emissive triangles in world space.
             Note that update() must have been called before for the data to be valid.
+            If only mesh lights have moved since the last call, only their triangles are read back.
             Call prepareSyncCPUData() ahead of time to avoid stalling the GPU.
         */
         const std::vector<MeshLightTriangle>& getMeshLightTriangles(RenderContext* pRenderContext) const { syncCPUData(pRenderContext); return mMeshLightTriangles; }
@@ -164,6 +183,10 @@ namespace Falcor
         */
         const std::vector<MeshLightData>& getMeshLights() const { return mMeshLights; }
 
+        /** Returns the indices of the mesh lights whose triangles were updated by the last call to update().
+        */
+        const std::vector<uint32_t>& getUpdatedLights() const { return mUpdatedLights; }
+
         /** Prepare for syncing the CPU data.
             If the mesh light triangles will be accessed with getMeshLightTriangles()
             performance can be improved by calling this function ahead of time.
@@ -191,6 +214,7 @@ namespace Falcor
         void build(RenderContext* pRenderContext, const Scene& scene);
         void prepareTriangleData(RenderContext* pRenderContext, const Scene& scene);
         void prepareMeshData(const Scene& scene);
+        void computeConstantEmission(RenderContext* pRenderContext);
         void integrateEmissive(RenderContext* pRenderContext, const Scene& scene);
         void computeStats(RenderContext* pRenderContext) const;
         void buildTriangleList(RenderContext* pRenderContext, const Scene& scene);
@@ -205,6 +229,8 @@ namespace Falcor
         Scene*                                  mpScene;                ///< Unowning pointer to scene (scene owns LightCollection).
 
         std::vector<MeshLightData>              mMeshLights;            ///< List of all mesh lights.
+        std::vector<MeshLightEmission>          mMeshLightEmission;     ///< Emission properties per mesh light.
+        std::vector<uint32_t>                   mUpdatedLights;         ///< Indices of the mesh lights updated by the last call to update().
         uint32_t                                mTriangleCount = 0;     ///< Total number of triangles in all mesh lights (= mMeshLightTriangles.size()). This may include culled triangles.
 
         mutable std::vector<MeshLightTriangle>  mMeshLightTriangles;    ///< List of all pre-processed mesh light triangles.
@@ -242,6 +268,7 @@ namespace Falcor
         ref<ComputePass>                        mpFinalizeIntegration;
 
         mutable CPUOutOfDateFlags               mCPUInvalidData = CPUOutOfDateFlags::None;  ///< Flags indicating which CPU data is valid.
+        mutable std::vector<uint32_t>           mCPUInvalidLights;                          ///< Sorted indices of the mesh lights whose triangle data is out of date on the CPU. Empty if all triangle data needs to be read back.
         mutable bool                            mStagingBufferValid = true;                 ///< Flag to indicate if the contents of the staging buffer is up-to-date.
     };
 
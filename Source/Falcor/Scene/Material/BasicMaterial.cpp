@@ -608,6 +608,26 @@ namespace Falcor
         return true;
     }
 
+    void BasicMaterial::updateContentHash(FNVHash64& hash) const
+    {
+        // Hash the same fields as operator==(). The sampler descs are left out, they rarely differ and are resolved by isEqual().
+        updateBaseContentHash(hash);
+
+        updateHash(hash, mData.flags);
+        updateHash(hash, mData.displacementScale);
+        updateHash(hash, mData.displacementOffset);
+        updateHash(hash, mData.baseColor);
+        updateHash(hash, mData.specular);
+        updateHash(hash, mData.emissive);
+        updateHash(hash, mData.emissiveFactor);
+        updateHash(hash, (float)mData.diffuseTransmission);
+        updateHash(hash, (float)mData.specularTransmission);
+        updateHash(hash, mData.transmission);
+        updateHash(hash, mData.volumeAbsorption);
+        updateHash(hash, (float)mData.volumeAnisotropy);
+        updateHash(hash, mData.volumeScattering);
+    }
+
     void BasicMaterial::updateAlphaMode()
     {
         if (!isAlphaSupported())
@@ -129,6 +129,14 @@ namespace Falcor
         */
         ref<Texture> getEmissiveTexture() const { return getTexture(TextureSlot::Emissive); }
 
+        /** Get the emissive color.
+        */
+        float3 getEmissiveColor() const { return mData.emissive; }
+
+        /** Get the emissive factor.
+        */
+        float getEmissiveFactor() const { return mData.emissiveFactor; }
+
         /** Set the specular transmission texture.
         */
         void setTransmissionTexture(const ref<Texture>& pTransmission) { setTexture(TextureSlot::Transmission, pTransmission); }
@@ -249,6 +257,8 @@ namespace Falcor
     protected:
         BasicMaterial(ref<Device> pDevice, const std::string& name, MaterialType type);
 
+        void updateContentHash(FNVHash64& hash) const override;
+
         bool isAlphaSupported() const;
         void prepareDisplacementMapForRendering();
         void adjustDoubleSidedFlag();
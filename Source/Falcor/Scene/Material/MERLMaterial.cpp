@@ -145,6 +145,12 @@ namespace Falcor
         return true;
     }
 
+    void MERLMaterial::updateContentHash(FNVHash64& hash) const
+    {
+        updateBaseContentHash(hash);
+        updateHash(hash, mPath.string());
+    }
+
     Program::ShaderModuleList MERLMaterial::getShaderModules() const
     {
         return { Program::ShaderModule(kShaderFile) };
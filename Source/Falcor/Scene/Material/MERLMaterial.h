@@ -59,6 +59,8 @@ namespace Falcor
         size_t getMaxBufferCount() const override { return 1; }
 
     protected:
+        void updateContentHash(FNVHash64& hash) const override;
+
         void init(const MERLFile& merlFile);
 
         std::filesystem::path mPath;        ///< Full path to the BRDF loaded.
@@ -235,6 +235,18 @@ namespace Falcor
         return true;
     }
 
+    void MERLMixMaterial::updateContentHash(FNVHash64& hash) const
+    {
+        updateBaseContentHash(hash);
+
+        updateHash(hash, mBRDFs.size());
+        for (const auto& brdf : mBRDFs)
+        {
+            updateHash(hash, brdf.name);
+            updateHash(hash, brdf.path.string());
+        }
+    }
+
     Program::ShaderModuleList MERLMixMaterial::getShaderModules() const
     {
         return { Program::ShaderModule(kShaderFile) };
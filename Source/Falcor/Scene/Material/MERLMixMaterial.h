@@ -67,6 +67,7 @@ namespace Falcor
         ref<Texture> getNormalMap() const { return getTexture(TextureSlot::Normal); }
 
     protected:
+        void updateContentHash(FNVHash64& hash) const override;
         void updateNormalMapType();
         void updateIndexMapType();
 
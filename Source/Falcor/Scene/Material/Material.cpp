@@ -330,6 +330,48 @@ namespace Falcor
         return true;
     }
 
+    uint64_t Material::getContentHash() const
+    {
+        FNVHash64 hash;
+        updateContentHash(hash);
+        return hash.get();
+    }
+
+    void Material::updateBaseContentHash(FNVHash64& hash) const
+    {
+        // This function hashes the same data that isBaseEqual() compares.
+        // Textures are compared by reference, we hash their source path and dimensions to make the hash stable across runs.
+
+        hash.insert(&mHeader.packedData, sizeof(mHeader.packedData));
+        updateHash(hash, mTextureTransform.getTranslation());
+        updateHash(hash, mTextureTransform.getScaling());
+        const quatf& rotation = mTextureTransform.getRotation();
+        updateHash(hash, float4(rotation.x, rotation.y, rotation.z, rotation.w));
+
+        for (size_t i = 0; i < mTextureSlotInfo.size(); i++)
+        {
+            auto slot = (TextureSlot)i;
+            updateHash(hash, hasTextureSlot(slot));
+            if (!hasTextureSlot(slot)) continue;
+
+            const auto& info = mTextureSlotInfo[i];
+            updateHash(hash, info.name);
+            updateHash(hash, (uint32_t)info.mask);
+            updateHash(hash, info.srgb);
+
+            const auto& pTexture = mTextureSlotData[i].pTexture;
+            updateHash(hash, pTexture != nullptr);
+            if (pTexture)
+            {
+                updateHash(hash, pTexture->getSourcePath().string());
+                updateHash(hash, (uint32_t)pTexture->getFormat());
+                updateHash(hash, pTexture->getWidth());
+                updateHash(hash, pTexture->getHeight());
+                updateHash(hash, pTexture->getDepth());
+            }
+        }
+    }
+
     NormalMapType Material::detectNormalMapType(const ref<Texture>& pNormalMap)
     {
         NormalMapType type = NormalMapType::None;
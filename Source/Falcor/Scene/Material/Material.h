@@ -38,12 +38,15 @@
 #include "Utils/Image/TextureAnalyzer.h"
 #include "Utils/UI/Gui.h"
 #include "Scene/Transform.h"
+#include "Utils/Math/FNVHash.h"
 #include "MaterialTypeRegistry.h"
 #include <array>
 #include <filesystem>
 #include <functional>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <type_traits>
 
 namespace Falcor
 {
@@ -155,6 +158,13 @@ namespace Falcor
         */
         virtual bool isEqual(const ref<Material>& pOther) const = 0;
 
+        /** Compute a hash of the material properties.
+            The hash is consistent with isEqual(), i.e. materials that compare equal have the same hash.
+            It only depends on the material content (not on object addresses) and is stable across runs.
+            \return 64-bit content hash.
+        */
+        uint64_t getContentHash() const;
+
         /** Set the double-sided flag. This flag doesn't affect the cull state, just the shading.
         */
         virtual void setDoubleSided(bool doubleSided);
@@ -347,6 +357,39 @@ namespace Falcor
         void updateDefaultTextureSamplerID(MaterialSystem* pOwner, const ref<Sampler>& pSampler);
         bool isBaseEqual(const Material& other) const;
 
+        /** Add all material properties compared by isEqual() to the content hash.
+            Implementations may skip properties, but must not hash properties that isEqual() ignores.
+        */
+        virtual void updateContentHash(FNVHash64& hash) const = 0;
+        void updateBaseContentHash(FNVHash64& hash) const;
+
+        /** Add a value of fundamental type to a content hash.
+        */
+        template<typename T, std::enable_if_t<std::is_fundamental_v<T>, bool> = true>
+        static void updateHash(FNVHash64& hash, T value) { hash.insert(&value, sizeof(value)); }
+
+        /** Add a floating-point value to a content hash. Negative zero is hashed as zero to be consistent with comparisons.
+        */
+        static void updateHash(FNVHash64& hash, float value)
+        {
+            value = value == 0.f ? 0.f : value;
+            hash.insert(&value, sizeof(value));
+        }
+
+        /** Add a string to a content hash. The length is included so that consecutive strings hash unambiguously.
+        */
+        static void updateHash(FNVHash64& hash, std::string_view str)
+        {
+            updateHash(hash, str.size());
+            hash.insert(str.data(), str.size());
+        }
+
+        template<typename T, int N>
+        static void updateHash(FNVHash64& hash, const math::vector<T, N>& value)
+        {
+            for (int i = 0; i < N; i++) updateHash(hash, (float)value[i]);
+        }
+
         static NormalMapType detectNormalMapType(const ref<Texture>& pNormalMap);
 
         template<typename T>
@@ -30,8 +30,11 @@
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
 #include "Utils/StringUtils.h"
+#include "Utils/Threading.h"
+#include "Utils/Timing/CpuTimer.h"
 #include "MaterialTypeRegistry.h"
 #include <numeric>
+#include <unordered_map>
 
 namespace Falcor
 {
@@ -302,23 +305,35 @@ namespace Falcor
 
     size_t MaterialSystem::removeDuplicateMaterials(std::vector<MaterialID>& idMap)
     {
+        auto startTime = CpuTimer::getCurrentTimePoint();
+
         std::vector<ref<Material>> uniqueMaterials;
         idMap.resize(mMaterials.size());
 
-        // Find unique set of materials.
+        // Compute content hashes. Materials that compare equal are guaranteed to have the same hash.
+        std::vector<uint64_t> hashes(mMaterials.size());
+        Threading::parallel_for(size_t(0), mMaterials.size(), [&](size_t i) { hashes[i] = mMaterials[i]->getContentHash(); });
+
+        // Find unique set of materials. Each hash bucket holds the indices of the unique materials with that hash,
+        // so isEqual() is only called to resolve hash collisions.
+        std::unordered_map<uint64_t, std::vector<uint32_t>> buckets;
+        buckets.reserve(mMaterials.size());
+
         for (MaterialID id{ 0 }; id.get() < mMaterials.size(); ++id)
         {
             const auto& pMaterial = mMaterials[id.get()];
-            auto it = std::find_if(uniqueMaterials.begin(), uniqueMaterials.end(), [&pMaterial](const auto& m) { return m->isEqual(pMaterial); });
-            if (it == uniqueMaterials.end())
+            auto& bucket = buckets[hashes[id.get()]];
+            auto it = std::find_if(bucket.begin(), bucket.end(), [&](uint32_t index) { return uniqueMaterials[index]->isEqual(pMaterial); });
+            if (it == bucket.end())
             {
                 idMap[id.get()] = MaterialID{ uniqueMaterials.size() };
+                bucket.push_back((uint32_t)uniqueMaterials.size());
                 uniqueMaterials.push_back(pMaterial);
             }
             else
             {
-                logInfo("Removing duplicate material '{}' (duplicate of '{}').", pMaterial->getName(), (*it)->getName());
-                idMap[id.get()] = MaterialID{ (size_t)std::distance(uniqueMaterials.begin(), it) };
+                logDebug("Removing duplicate material '{}' (duplicate of '{}').", pMaterial->getName(), uniqueMaterials[*it]->getName());
+                idMap[id.get()] = MaterialID{ *it };
             }
         }
 
@@ -329,6 +344,10 @@ namespace Falcor
             mMaterialsChanged = true;
         }
 
+        mDuplicateMaterialCount += removed;
+        mDuplicateMaterialRemovalTime += CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()) * 1e-3;
+        if (removed > 0) logInfo("Removed {} duplicate materials, {} unique materials remaining.", removed, mMaterials.size());
+
         return removed;
     }
 
@@ -571,6 +590,8 @@ namespace Falcor
         s.materialCount = mMaterials.size();
         s.materialOpaqueCount = 0;
         s.materialMemoryInBytes += mpMaterialDataBuffer ? mpMaterialDataBuffer->getSize() : 0;
+        s.materialDuplicateCount = mDuplicateMaterialCount;
+        s.materialDuplicateRemovalTime = mDuplicateMaterialRemovalTime;
 
         for (const auto& pMaterial : mMaterials)
         {
@@ -63,6 +63,8 @@ namespace Falcor
             uint64_t materialCount = 0;                 ///< Number of materials.
             uint64_t materialOpaqueCount = 0;           ///< Number of materials that are opaque.
             uint64_t materialMemoryInBytes = 0;         ///< Total memory in bytes used by the material data.
+            uint64_t materialDuplicateCount = 0;        ///< Number of duplicate materials removed by removeDuplicateMaterials().
+            double materialDuplicateRemovalTime = 0.0;  ///< Time in seconds spent in removeDuplicateMaterials().
             uint64_t textureCount = 0;                  ///< Number of unique textures. A texture can be referenced by multiple materials.
             uint64_t textureCompressedCount = 0;        ///< Number of unique compressed textures.
             uint64_t textureTexelCount = 0;             ///< Total number of texels in all textures.
@@ -207,6 +209,7 @@ namespace Falcor
         ref<Material> getMaterialByName(const std::string& name) const;
 
         /** Remove all duplicate materials.
+            Materials are bucketed by their content hash and compared with Material::isEqual() within each bucket.
             \param[in] idMap Vector that holds for each material the ID of the material that replaces it.
             \return The number of materials removed.
         */
@@ -256,6 +259,9 @@ namespace Falcor
 
         Material::UpdateFlags mMaterialUpdates = Material::UpdateFlags::None; ///< Material updates across all materials since last update.
 
+        uint64_t mDuplicateMaterialCount = 0;                       ///< Number of duplicate materials removed.
+        double mDuplicateMaterialRemovalTime = 0.0;                 ///< Time in seconds spent removing duplicate materials.
+
         // GPU resources
         ref<GpuFence> mpFence;
         ref<ParameterBlock> mpMaterialsBlock;                       ///< Parameter block for binding all material resources.
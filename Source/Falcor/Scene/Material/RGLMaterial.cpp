@@ -133,6 +133,12 @@ namespace Falcor
         return true;
     }
 
+    void RGLMaterial::updateContentHash(FNVHash64& hash) const
+    {
+        updateBaseContentHash(hash);
+        updateHash(hash, mFilePath.string());
+    }
+
     Program::ShaderModuleList RGLMaterial::getShaderModules() const
     {
         return { Program::ShaderModule(kShaderFile) };
@@ -59,6 +59,8 @@ namespace Falcor
         bool loadBRDF(const std::filesystem::path& path);
 
     protected:
+        void updateContentHash(FNVHash64& hash) const override;
+
         void prepareData(const int dims[3], const std::vector<double>& data);
         void prepareAlbedoLUT(RenderContext* pRenderContext);
         void computeAlbedoLUT(RenderContext* pRenderContext);
@@ -116,14 +116,6 @@ namespace Falcor
         */
         void setEmissiveFactor(float factor);
 
-        /** Get the emissive color.
-        */
-        float3 getEmissiveColor() const { return mData.emissive; }
-
-        /** Get the emissive factor.
-        */
-        float getEmissiveFactor() const { return mData.emissiveFactor; }
-
         // DEMO21: The mesh will use the global IES profile (LightProfile) to modulate its emission
         void setLightProfileEnabled( bool enabled )
         {
@@ -0,0 +1,395 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "OcclusionCulling.h"
+#include "Core/Errors.h"
+#include "Utils/Math/MatrixMath.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define FALCOR_OCCLUSION_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace Falcor
+{
+    namespace
+    {
+        const float kInfinity = std::numeric_limits<float>::infinity();
+
+        // Triangles with a smaller doubled screen space area (in pixels) are skipped.
+        const float kMinTriangleArea = 1e-6f;
+
+        /** Edge function E(x, y) = a * x + b * y + c, positive on the inner side of the edge.
+        */
+        struct Edge
+        {
+            float a, b, c;
+
+            Edge(const float3& v0, const float3& v1)
+            {
+                a = v0.y - v1.y;
+                b = v1.x - v0.x;
+                c = -(a * v0.x + b * v0.y);
+            }
+        };
+
+        /** Doubled signed screen space area of a triangle.
+        */
+        float triangleArea(const float3& v0, const float3& v1, const float3& v2)
+        {
+            return (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+        }
+
+        bool lessPosition(const float3& p, const float3& q)
+        {
+            if (p.x != q.x) return p.x < q.x;
+            if (p.y != q.y) return p.y < q.y;
+            return p.z < q.z;
+        }
+    }
+
+    OcclusionCulling::OcclusionCulling(uint32_t width, uint32_t height)
+        : mWidth(width)
+        , mHeight(height)
+    {
+        FALCOR_CHECK_ARG_MSG(width > 0 && height > 0, "Occlusion culling resolution must be non-zero.");
+
+        Level level;
+        level.width = width;
+        level.height = height;
+        level.pitch = (width + 3) & ~3u;
+        level.depth.assign((size_t)level.pitch * height, kInfinity);
+        mOutlineStamps.assign(level.depth.size(), 0);
+        mLevels.push_back(std::move(level));
+
+        while (mLevels.back().width > 1 || mLevels.back().height > 1)
+        {
+            const Level& prev = mLevels.back();
+            Level next;
+            next.width = (prev.width + 1) / 2;
+            next.height = (prev.height + 1) / 2;
+            next.pitch = next.width;
+            next.depth.assign((size_t)next.pitch * next.height, kInfinity);
+            mLevels.push_back(std::move(next));
+        }
+    }
+
+    void OcclusionCulling::clear(const float4x4& viewProj)
+    {
+        mViewProj = viewProj;
+        for (auto& level : mLevels) std::fill(level.depth.begin(), level.depth.end(), kInfinity);
+        mRasterizedTriangleCount = 0;
+    }
+
+    void OcclusionCulling::rasterize(const float4x4& worldMat, const std::vector<float3>& positions, const std::vector<uint32_t>& indices)
+    {
+        FALCOR_ASSERT(indices.size() % 3 == 0);
+
+        // Project all vertices once. Depth is z/w, which is linear in screen space.
+        const float4x4 worldViewProj = mul(mViewProj, worldMat);
+        mScreenPositions.resize(positions.size());
+        for (size_t i = 0; i < positions.size(); i++)
+        {
+            float4 clip = mul(worldViewProj, float4(positions[i], 1.f));
+            if (clip.w <= 0.f || clip.z < 0.f)
+            {
+                mScreenPositions[i] = float4(0.f);
+                continue;
+            }
+            const float invW = 1.f / clip.w;
+            mScreenPositions[i] = float4(
+                (clip.x * invW * 0.5f + 0.5f) * mWidth,
+                (0.5f - clip.y * invW * 0.5f) * mHeight,
+                clip.z * invW,
+                1.f
+            );
+        }
+
+        // Rasterizing the triangles with a pixel center test leaves no holes between adjacent triangles, but lets the
+        // occluder overlap pixels that are only partially covered along its outline. Pixels touched by an outline edge
+        // are therefore excluded, so depth is only written for pixels that are entirely covered by the mesh.
+        if (++mOutlineStamp == 0)
+        {
+            std::fill(mOutlineStamps.begin(), mOutlineStamps.end(), 0);
+            mOutlineStamp = 1;
+        }
+
+        // Vertices at equal positions are merged, so that split vertices (e.g. at UV seams) don't create outline edges.
+        mVertexOrder.resize(positions.size());
+        std::iota(mVertexOrder.begin(), mVertexOrder.end(), 0);
+        std::sort(mVertexOrder.begin(), mVertexOrder.end(), [&](uint32_t a, uint32_t b) { return lessPosition(positions[a], positions[b]); });
+        mVertexIDs.resize(positions.size());
+        for (size_t i = 0; i < mVertexOrder.size(); i++)
+        {
+            const uint32_t index = mVertexOrder[i];
+            const bool merge = i > 0 && !lessPosition(positions[mVertexOrder[i - 1]], positions[index]);
+            mVertexIDs[index] = merge ? mVertexIDs[mVertexOrder[i - 1]] : index;
+        }
+
+        // An edge is interior if it is shared by exactly two rasterized triangles that lie on opposite sides of it on
+        // screen. All other edges, including the silhouette folds of closed meshes, are outline edges.
+        mMeshEdges.clear();
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            FALCOR_ASSERT(indices[i] < positions.size() && indices[i + 1] < positions.size() && indices[i + 2] < positions.size());
+            const uint32_t ids[3] = { mVertexIDs[indices[i]], mVertexIDs[indices[i + 1]], mVertexIDs[indices[i + 2]] };
+            const float4& v0 = mScreenPositions[ids[0]];
+            const float4& v1 = mScreenPositions[ids[1]];
+            const float4& v2 = mScreenPositions[ids[2]];
+            if (v0.w == 0.f || v1.w == 0.f || v2.w == 0.f) continue;
+            const float area = triangleArea(v0.xyz(), v1.xyz(), v2.xyz());
+            if (std::abs(area) < kMinTriangleArea) continue;
+
+            for (uint32_t e = 0; e < 3; e++)
+            {
+                const uint32_t a = ids[e], b = ids[(e + 1) % 3];
+                mMeshEdges.push_back({ std::min(a, b), std::max(a, b), (a < b) == (area > 0.f) });
+            }
+        }
+        std::sort(mMeshEdges.begin(), mMeshEdges.end(), [](const MeshEdge& a, const MeshEdge& b) { return a.v0 != b.v0 ? a.v0 < b.v0 : a.v1 < b.v1; });
+        for (size_t i = 0; i < mMeshEdges.size();)
+        {
+            size_t end = i + 1;
+            while (end < mMeshEdges.size() && mMeshEdges[end].v0 == mMeshEdges[i].v0 && mMeshEdges[end].v1 == mMeshEdges[i].v1) end++;
+            const bool interior = end - i == 2 && mMeshEdges[i].positiveSide != mMeshEdges[i + 1].positiveSide;
+            if (!interior) markOutlineEdge(mScreenPositions[mMeshEdges[i].v0].xyz(), mScreenPositions[mMeshEdges[i].v1].xyz());
+            i = end;
+        }
+
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            const float4& v0 = mScreenPositions[indices[i]];
+            const float4& v1 = mScreenPositions[indices[i + 1]];
+            const float4& v2 = mScreenPositions[indices[i + 2]];
+            if (v0.w == 0.f || v1.w == 0.f || v2.w == 0.f) continue;
+            rasterizeTriangle(v0.xyz(), v1.xyz(), v2.xyz());
+        }
+    }
+
+    void OcclusionCulling::markOutlineEdge(const float3& p, const float3& q)
+    {
+        // Each row of pixels is touched between the intersections of the edge with the top and bottom of the row.
+        const float width = (float)mWidth, height = (float)mHeight;
+        const float yMin = std::min(p.y, q.y), yMax = std::max(p.y, q.y);
+        if (yMax < 0.f || yMin >= height || std::max(p.x, q.x) < 0.f || std::min(p.x, q.x) >= width) return;
+
+        const int y0 = (int)std::floor(std::max(yMin, 0.f));
+        const int y1 = (int)std::floor(std::min(yMax, height - 1.f));
+        const float dxdy = yMax > yMin ? (q.x - p.x) / (q.y - p.y) : 0.f;
+        for (int y = y0; y <= y1; y++)
+        {
+            float xa = p.x, xb = q.x;
+            if (yMax > yMin)
+            {
+                xa = p.x + (std::max(yMin, (float)y) - p.y) * dxdy;
+                xb = p.x + (std::min(yMax, y + 1.f) - p.y) * dxdy;
+            }
+            const float xMin = std::min(xa, xb), xMax = std::max(xa, xb);
+            if (xMax < 0.f || xMin >= width) continue;
+
+            const int x0 = (int)std::floor(std::max(xMin, 0.f));
+            const int x1 = (int)std::floor(std::min(xMax, width - 1.f));
+            uint32_t* pRow = mOutlineStamps.data() + (size_t)y * mLevels[0].pitch;
+            std::fill(pRow + x0, pRow + x1 + 1, mOutlineStamp);
+        }
+    }
+
+    void OcclusionCulling::rasterizeTriangle(const float3& v0, const float3& p1, const float3& p2)
+    {
+        // Orient the triangle so that the inside is on the positive side of all edges. Both windings are occluders.
+        float area = triangleArea(v0, p1, p2);
+        if (std::abs(area) < kMinTriangleArea) return;
+        const float3& v1 = area > 0.f ? p1 : p2;
+        const float3& v2 = area > 0.f ? p2 : p1;
+        area = std::abs(area);
+
+        // Range of pixels with centers inside the bounding box of the triangle.
+        // Clamp before converting to integers, vertices close to the near plane can be far outside the screen.
+        const float width = (float)mWidth, height = (float)mHeight;
+        const int x0 = (int)std::ceil(std::clamp(std::min({ v0.x, v1.x, v2.x }) - 0.5f, 0.f, width));
+        const int x1 = (int)std::floor(std::clamp(std::max({ v0.x, v1.x, v2.x }) - 0.5f, -1.f, width - 1.f)) + 1;
+        const int y0 = (int)std::ceil(std::clamp(std::min({ v0.y, v1.y, v2.y }) - 0.5f, 0.f, height));
+        const int y1 = (int)std::floor(std::clamp(std::max({ v0.y, v1.y, v2.y }) - 0.5f, -1.f, height - 1.f)) + 1;
+        if (x0 >= x1 || y0 >= y1) return;
+
+        mRasterizedTriangleCount++;
+
+        const Edge e0(v1, v2), e1(v2, v0), e2(v0, v1);
+
+        // Depth plane. The farthest depth over a pixel is at one of its corners, which is offset by half the
+        // absolute gradients from the center. It can never exceed the farthest vertex.
+        const float dzdx = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) / area;
+        const float dzdy = ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) / area;
+        const float zOffset = v0.z - dzdx * v0.x - dzdy * v0.y + 0.5f * (std::abs(dzdx) + std::abs(dzdy));
+        const float zMax = std::max({ v0.z, v1.z, v2.z });
+
+        Level& level = mLevels[0];
+        for (int y = y0; y < y1; y++)
+        {
+            const float cy = y + 0.5f;
+            const float row0 = e0.b * cy + e0.c;
+            const float row1 = e1.b * cy + e1.c;
+            const float row2 = e2.b * cy + e2.c;
+            const float rowZ = dzdy * cy + zOffset;
+            float* pRow = level.depth.data() + (size_t)y * level.pitch;
+            const uint32_t* pStampRow = mOutlineStamps.data() + (size_t)y * level.pitch;
+
+#if FALCOR_OCCLUSION_SSE
+            // Process aligned groups of 4 pixels. The rows are padded, so the last group never leaves the row.
+            const __m128 centerOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+            const __m128 zero = _mm_setzero_ps();
+            const __m128i stamp = _mm_set1_epi32((int)mOutlineStamp);
+            for (int x = x0 & ~3; x < x1; x += 4)
+            {
+                const __m128 cx = _mm_add_ps(_mm_set1_ps((float)x), centerOffsets);
+                __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(e0.a), cx), _mm_set1_ps(row0)), zero);
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(e1.a), cx), _mm_set1_ps(row1)), zero));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(e2.a), cx), _mm_set1_ps(row2)), zero));
+                const __m128i outline = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(pStampRow + x)), stamp);
+                inside = _mm_andnot_ps(_mm_castsi128_ps(outline), inside);
+                if (_mm_movemask_ps(inside) == 0) continue;
+
+                __m128 z = _mm_min_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(dzdx), cx), _mm_set1_ps(rowZ)), _mm_set1_ps(zMax));
+                const __m128 depth = _mm_loadu_ps(pRow + x);
+                z = _mm_min_ps(z, depth);
+                _mm_storeu_ps(pRow + x, _mm_or_ps(_mm_and_ps(inside, z), _mm_andnot_ps(inside, depth)));
+            }
+#else
+            for (int x = x0; x < x1; x++)
+            {
+                const float cx = x + 0.5f;
+                if (pStampRow[x] == mOutlineStamp) continue;
+                if (e0.a * cx + row0 < 0.f || e1.a * cx + row1 < 0.f || e2.a * cx + row2 < 0.f) continue;
+                const float z = std::min(dzdx * cx + rowZ, zMax);
+                pRow[x] = std::min(pRow[x], z);
+            }
+#endif
+        }
+    }
+
+    void OcclusionCulling::updateHierarchy()
+    {
+        for (size_t i = 1; i < mLevels.size(); i++)
+        {
+            const Level& src = mLevels[i - 1];
+            Level& dst = mLevels[i];
+            for (uint32_t y = 0; y < dst.height; y++)
+            {
+                const uint32_t sy0 = 2 * y, sy1 = std::min(2 * y + 1, src.height - 1);
+                for (uint32_t x = 0; x < dst.width; x++)
+                {
+                    const uint32_t sx0 = 2 * x, sx1 = std::min(2 * x + 1, src.width - 1);
+                    dst.depth[y * dst.pitch + x] = std::max(
+                        std::max(src.depth[sy0 * src.pitch + sx0], src.depth[sy0 * src.pitch + sx1]),
+                        std::max(src.depth[sy1 * src.pitch + sx0], src.depth[sy1 * src.pitch + sx1])
+                    );
+                }
+            }
+        }
+    }
+
+    bool OcclusionCulling::projectBox(const AABB& aabb, ScreenRect& rect) const
+    {
+        rect.minPoint = float3(kInfinity);
+        rect.maxPoint = float3(-kInfinity);
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            const float3 corner(
+                (i & 1) ? aabb.maxPoint.x : aabb.minPoint.x,
+                (i & 2) ? aabb.maxPoint.y : aabb.minPoint.y,
+                (i & 4) ? aabb.maxPoint.z : aabb.minPoint.z
+            );
+            const float4 clip = mul(mViewProj, float4(corner, 1.f));
+            if (clip.w <= 0.f || clip.z < 0.f) return false;
+            const float invW = 1.f / clip.w;
+            const float3 screen(
+                (clip.x * invW * 0.5f + 0.5f) * mWidth,
+                (0.5f - clip.y * invW * 0.5f) * mHeight,
+                clip.z * invW
+            );
+            rect.minPoint = min(rect.minPoint, screen);
+            rect.maxPoint = max(rect.maxPoint, screen);
+        }
+        return true;
+    }
+
+    bool OcclusionCulling::isRectOccluded(uint32_t levelIndex, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1, float depth) const
+    {
+        // The rectangle is given in full resolution pixels (inclusive). Each texel of the level is either known to
+        // occlude the box, or is refined into the texels of the next finer level that overlap the rectangle.
+        const Level& level = mLevels[levelIndex];
+        for (uint32_t ty = y0 >> levelIndex; ty <= (y1 >> levelIndex); ty++)
+        {
+            for (uint32_t tx = x0 >> levelIndex; tx <= (x1 >> levelIndex); tx++)
+            {
+                if (level.depth[ty * level.pitch + tx] < depth) continue;
+                if (levelIndex == 0) return false;
+
+                const uint32_t cx0 = std::max(x0, tx << levelIndex), cx1 = std::min(x1, ((tx + 1) << levelIndex) - 1);
+                const uint32_t cy0 = std::max(y0, ty << levelIndex), cy1 = std::min(y1, ((ty + 1) << levelIndex) - 1);
+                if (!isRectOccluded(levelIndex - 1, cx0, cy0, cx1, cy1, depth)) return false;
+            }
+        }
+        return true;
+    }
+
+    bool OcclusionCulling::isVisible(const AABB& aabb) const
+    {
+        if (!aabb.valid()) return false;
+
+        ScreenRect rect;
+        if (!projectBox(aabb, rect)) return true;
+        if (rect.maxPoint.x < 0.f || rect.maxPoint.y < 0.f || rect.minPoint.x >= mWidth || rect.minPoint.y >= mHeight) return true;
+
+        const uint32_t x0 = (uint32_t)std::max(0.f, std::floor(rect.minPoint.x));
+        const uint32_t y0 = (uint32_t)std::max(0.f, std::floor(rect.minPoint.y));
+        const uint32_t x1 = (uint32_t)std::min(mWidth - 1.f, std::floor(rect.maxPoint.x));
+        const uint32_t y1 = (uint32_t)std::min(mHeight - 1.f, std::floor(rect.maxPoint.y));
+
+        // Start at the finest level where the rectangle covers at most 2x2 texels.
+        uint32_t levelIndex = 0;
+        while (levelIndex + 1 < mLevels.size() && ((x1 >> levelIndex) - (x0 >> levelIndex) > 1 || (y1 >> levelIndex) - (y0 >> levelIndex) > 1)) levelIndex++;
+
+        return !isRectOccluded(levelIndex, x0, y0, x1, y1, rect.minPoint.z);
+    }
+
+    float OcclusionCulling::getScreenCoverage(const AABB& aabb) const
+    {
+        if (!aabb.valid()) return 0.f;
+
+        ScreenRect rect;
+        if (!projectBox(aabb, rect)) return 1.f;
+
+        const float width = std::clamp(rect.maxPoint.x, 0.f, (float)mWidth) - std::clamp(rect.minPoint.x, 0.f, (float)mWidth);
+        const float height = std::clamp(rect.maxPoint.y, 0.f, (float)mHeight) - std::clamp(rect.minPoint.y, 0.f, (float)mHeight);
+        return width * height / ((float)mWidth * mHeight);
+    }
+}
@@ -0,0 +1,152 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/Object.h"
+#include "Utils/Math/AABB.h"
+#include "Utils/Math/Matrix.h"
+#include "Utils/Math/Vector.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** CPU software occlusion culling with a coarse depth buffer.
+        Occluder triangles cover the pixels whose centers they contain, so adjacent triangles of a mesh leave no holes,
+        except for pixels touched by the outline of the mesh on screen. Depth is thus only written for pixels that are
+        entirely covered by an occluder. Each covered pixel stores the farthest depth of the triangle plane over the pixel. Bounding boxes are then tested
+        against a hierarchy of max-depth mips, starting at the finest level where the box covers at most 2x2 texels.
+        Depth is the normalized device z in [0, 1], so both perspective and orthographic projections are supported.
+        Rasterization processes 4 pixels per iteration with SSE instructions (with a scalar fallback).
+
+        Usage: clear() with the view-projection matrix, rasterize() all occluders, updateHierarchy(), then test boxes
+        with isVisible(). Testing is const, so boxes can be tested concurrently.
+    */
+    class FALCOR_API OcclusionCulling : public Object
+    {
+        FALCOR_OBJECT(OcclusionCulling)
+    public:
+        /** Constructor.
+            \param[in] width Width of the depth buffer in pixels.
+            \param[in] height Height of the depth buffer in pixels.
+        */
+        OcclusionCulling(uint32_t width = 256, uint32_t height = 128);
+
+        /** Clear the depth buffer and set the view-projection matrix used for all following operations.
+            \param[in] viewProj View-projection matrix mapping world space to clip space with depth in [0, 1].
+        */
+        void clear(const float4x4& viewProj);
+
+        /** Rasterize occluder triangles into the depth buffer.
+            Triangles that are not entirely in front of the near plane are skipped.
+            \param[in] worldMat Object to world transform.
+            \param[in] positions Object space vertex positions.
+            \param[in] indices Vertex indices, three per triangle.
+        */
+        void rasterize(const float4x4& worldMat, const std::vector<float3>& positions, const std::vector<uint32_t>& indices);
+
+        /** Build the depth hierarchy. Must be called after rasterizing the occluders and before testing boxes.
+        */
+        void updateHierarchy();
+
+        /** Test if a world space bounding box is potentially visible.
+            Boxes crossing the near plane or lying outside the screen are always reported as visible.
+            \param[in] aabb World space bounding box.
+            \return False if the box is guaranteed to be hidden behind the occluders.
+        */
+        bool isVisible(const AABB& aabb) const;
+
+        /** Get the fraction of the screen covered by the projected bounding rectangle of a world space box.
+            Used to select the occluders that are worth rasterizing.
+            \param[in] aabb World space bounding box.
+            \return Screen coverage in [0, 1]. Boxes crossing the near plane return 1.
+        */
+        float getScreenCoverage(const AABB& aabb) const;
+
+        /** Get the number of triangles rasterized since the last clear.
+        */
+        uint32_t getRasterizedTriangleCount() const { return mRasterizedTriangleCount; }
+
+        uint32_t getWidth() const { return mWidth; }
+        uint32_t getHeight() const { return mHeight; }
+
+        /** Get the depth of a pixel in the full resolution depth buffer. Uncovered pixels are +inf.
+        */
+        float getDepth(uint32_t x, uint32_t y) const { return mLevels[0].depth[y * mLevels[0].pitch + x]; }
+
+        /** Get the number of levels in the depth hierarchy, including the full resolution level.
+        */
+        uint32_t getLevelCount() const { return (uint32_t)mLevels.size(); }
+
+    private:
+        struct Level
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint32_t pitch = 0;         ///< Row pitch in texels. The full resolution rows are padded to a multiple of 4.
+            std::vector<float> depth;   ///< Farthest depth per texel, row major.
+        };
+
+        struct ScreenRect
+        {
+            float3 minPoint;            ///< Minimum screen x, y and depth.
+            float3 maxPoint;            ///< Maximum screen x, y and depth.
+        };
+
+        struct MeshEdge
+        {
+            uint32_t v0;                ///< Smaller vertex ID.
+            uint32_t v1;                ///< Larger vertex ID.
+            bool positiveSide;          ///< True if the triangle is on the left side of the edge from v0 to v1 on screen.
+        };
+
+        /** Project a world space box to screen space.
+            \return False if the box crosses the near plane.
+        */
+        bool projectBox(const AABB& aabb, ScreenRect& rect) const;
+
+        /** Mark all pixels touched by a screen space outline edge of the current occluder.
+        */
+        void markOutlineEdge(const float3& p, const float3& q);
+
+        void rasterizeTriangle(const float3& v0, const float3& v1, const float3& v2);
+        bool isRectOccluded(uint32_t level, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1, float depth) const;
+
+        uint32_t mWidth;
+        uint32_t mHeight;
+        float4x4 mViewProj;
+        std::vector<Level> mLevels;     ///< Level 0 is the depth buffer, each following level stores the max of 2x2 texels.
+        std::vector<float4> mScreenPositions; ///< Scratch buffer for the projected vertices of an occluder. w is 0 for vertices that are not in front of the near plane.
+        std::vector<uint32_t> mVertexOrder;   ///< Scratch buffer for the occluder vertex indices sorted by position.
+        std::vector<uint32_t> mVertexIDs;     ///< Scratch buffer mapping occluder vertices to the first vertex at the same position.
+        std::vector<MeshEdge> mMeshEdges;     ///< Scratch buffer for the edges of the rasterized occluder triangles.
+        std::vector<uint32_t> mOutlineStamps; ///< Per pixel stamp of the last occluder whose outline touches the pixel. Same layout as level 0.
+        uint32_t mOutlineStamp = 0;           ///< Stamp of the current occluder.
+        uint32_t mRasterizedTriangleCount = 0;
+    };
+}
@@ -29,6 +29,7 @@
 #include "SceneDefines.slangh"
 #include "SceneBuilder.h"
 #include "Importer.h"
+#include "BlasBuildPlan.h"
 #include "Curves/CurveConfig.h"
 #include "SDFs/SDFGrid.h"
 #include "SDFs/NormalizedDenseSDFGrid/NDSDFGrid.h"
@@ -39,6 +40,7 @@
 #include "Core/API/RenderContext.h"
 #include "Core/API/IndirectCommands.h"
 #include "Utils/StringUtils.h"
+#include "Utils/Threading.h"
 #include "Utils/ObjectIDPython.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Math/MathHelpers.h"
@@ -47,6 +49,7 @@
 #include "Utils/UI/InputTypes.h"
 #include "Utils/Scripting/ScriptWriter.h"
 
+#include <algorithm>
 #include <fstream>
 #include <numeric>
 #include <sstream>
@@ -63,11 +66,26 @@ namespace Falcor
         // The target is max 0.5GB intermediate memory per BLAS group. Note that this is not a strict limit.
         const size_t kMaxBLASBuildMemory = 1ull << 29;
 
+        // CPU occlusion culling. Occluder geometry is kept for opaque static meshes up to a total triangle budget,
+        // and the occluders covering the largest part of the screen are rasterized up to a per-frame triangle budget.
+        const uint32_t kMaxOccluderMeshTriangleCount = 4096;
+        const uint64_t kMaxOccluderTriangleCount = 1ull << 20;
+        const uint32_t kMaxOccluderTrianglesPerFrame = 1u << 16;
+        const float kMinOccluderScreenCoverage = 0.01f;
+
+        // Matrix ID of instance descs with an identity transform.
+        const uint32_t kIdentityMatrixID = uint32_t(-1);
+
+        // Number of skinned instances per work item when updating their bounds in parallel.
+        const size_t kSkinnedBoundsGrainSize = 16;
+
         const std::string kParameterBlockName = "gScene";
         const std::string kGeometryInstanceBufferName = "geometryInstances";
         const std::string kMeshBufferName = "meshes";
         const std::string kIndexBufferName = "indexData";
         const std::string kVertexBufferName = "vertices";
+        const std::string kCompactVertexBufferName = "compactVertices";
+        const std::string kCompactVertexOffset = "compactVertexOffset";
         const std::string kPrevVertexBufferName = "prevVertices";
         const std::string kProceduralPrimAABBBufferName = "proceduralPrimitiveAABBs";
         const std::string kCurveBufferName = "curves";
@@ -175,6 +193,8 @@ namespace Falcor
         mMeshGroups = std::move(sceneData.meshGroups);
 
         mUseCompressedHitInfo = sceneData.useCompressedHitInfo;
+        mUseCompactVertexData = sceneData.useCompactVertexData;
+        mCompactVertexOffset = sceneData.compactVertexOffset;
         mHas16BitIndices = sceneData.has16BitIndices;
         mHas32BitIndices = sceneData.has32BitIndices;
 
@@ -208,6 +228,11 @@ namespace Falcor
         createMeshVao(sceneData.meshDrawCount, sceneData.meshIndexData, sceneData.meshStaticData, sceneData.meshSkinningData);
         createCurveVao(mCurveIndexData, mCurveStaticData);
         createMeshUVTiles(mMeshDesc, sceneData.meshIndexData, sceneData.meshStaticData);
+        createOccluders(sceneData.meshIndexData, sceneData.meshStaticData);
+        createSkinnedMeshBounds(sceneData.meshSkinningData, sceneData.meshStaticData);
+
+        // The animation system only updates dynamic meshes, which are stored before the compact vertices.
+        if (mUseCompactVertexData) sceneData.meshStaticData.resize(mCompactVertexOffset);
 
         // Create animation controller.
         mpAnimationController = std::make_unique<AnimationController>(mpDevice, this, sceneData.meshStaticData, sceneData.meshSkinningData, sceneData.prevVertexCount, sceneData.animations);
@@ -264,6 +289,7 @@ namespace Falcor
         defines.add("SCENE_HAS_16BIT_INDICES", mHas16BitIndices ? "1" : "0");
         defines.add("SCENE_HAS_32BIT_INDICES", mHas32BitIndices ? "1" : "0");
         defines.add("SCENE_USE_LIGHT_PROFILE", mpLightProfile != nullptr ? "1" : "0");
+        defines.add("SCENE_USE_COMPACT_VERTICES", mUseCompactVertexData ? "1" : "0");
 
         defines.add(mHitInfo.getDefines());
         defines.add(getSceneSDFGridDefines());
@@ -391,7 +417,7 @@ namespace Falcor
                 continue;
 
             // Set state.
-            pState->setVao(draw.ibFormat == ResourceFormat::R16Uint ? mpMeshVao16Bit : mpMeshVao);
+            pState->setVao(getDrawVao(draw.ibFormat, draw.isDynamic));
 
             if (draw.ignoreWinding)
                 pState->setRasterizerState(pRasterizerStateDS);
@@ -421,12 +447,13 @@ namespace Falcor
         RasterizerState::CullMode cullMode,
         RasterizerState::MeshRenderMode meshRenderMode,
         bool drawShadowCastable,
-        ref<FrustumCulling> pFrustumCulling
+        ref<FrustumCulling> pFrustumCulling,
+        ref<OcclusionCulling> pOcclusionCulling
     )
     {
         rasterizeFrustumCulling(
             pRenderContext, pState, pVars, mFrontClockwiseRS[cullMode], mFrontCounterClockwiseRS[cullMode],
-            mFrontCounterClockwiseRS[RasterizerState::CullMode::None], meshRenderMode,drawShadowCastable, pFrustumCulling
+            mFrontCounterClockwiseRS[RasterizerState::CullMode::None], meshRenderMode,drawShadowCastable, pFrustumCulling, pOcclusionCulling
         );
     }
 
@@ -439,7 +466,8 @@ namespace Falcor
         const ref<RasterizerState>& pRasterizerStateDS,
         RasterizerState::MeshRenderMode meshRenderMode,
         bool drawShadowCastable,
-        ref<FrustumCulling> pFrustumCulling
+        ref<FrustumCulling> pFrustumCulling,
+        ref<OcclusionCulling> pOcclusionCulling
     )
     {
         FALCOR_PROFILE(pRenderContext, "rasterizeScene");
@@ -500,8 +528,27 @@ namespace Falcor
             pFrustumCulling->createDrawBuffer(mpDevice, mpFence, pRenderContext, drawBuffers, hasDynamicGeometry);
         }
 
+        // The cached static draw lists depend on the occluders, so they are rebuilt when occlusion culling is toggled or an occluder moved.
+        pFrustumCulling->setOcclusionCulling(pOcclusionCulling != nullptr);
+        if (pOcclusionCulling && mOccludersMoved)
+            pFrustumCulling->invalidateAllDrawBuffers();
+
+        // Cull all instances against the frustum at most once per call, the draw lists below only look up the results.
+        // Instances in the frustum are additionally tested against the occluders, if occlusion culling is enabled.
+        bool visibilityValid = false;
+        auto isVisible = [&](uint32_t instanceID)
+        {
+            if (!visibilityValid)
+            {
+                pFrustumCulling->cull(mCullingBounds, mCullingVisibility);
+                if (pOcclusionCulling) rasterizeOccluders(*pOcclusionCulling, pFrustumCulling->getViewProjMatrix());
+                visibilityValid = true;
+            }
+            if (mCullingVisibility[instanceID] == 0) return false;
+            return !pOcclusionCulling || pOcclusionCulling->isVisible(mInstanceBounds.getLeaf(instanceID));
+        };
+
         // Create an custom draw argument buffer for this frame
-        const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
         auto& pDrawBuffers = pFrustumCulling->getDrawBuffers();
         auto& pDrawBufferCounts = pFrustumCulling->getDrawCounts();
 
@@ -543,20 +590,17 @@ namespace Falcor
                 for (auto& instanceID : mDrawArgsInstanceIDs[i])
                 {
                     const auto& instance = mGeometryInstanceData[instanceID];
-                    const auto& worldMat = globalMatrices[instance.globalMatrixID];
-                    const AABB& meshBB = mMeshBBs[instance.geometryID];
                     const auto& mesh = mMeshDesc[instance.geometryID];
 
                     //If the mesh passes the culling test, add to draw buffer
-                    // TODO: Add a better/functioning precalculated BB for skinned meshes
-                    if (pFrustumCulling->isInFrustum(meshBB.transform(worldMat)) || mesh.isSkinned())
+                    if (isVisible(instanceID))
                     {
                         
                         DrawIndexedArguments drawArg;
                         drawArg.IndexCountPerInstance = mesh.indexCount;
                         drawArg.InstanceCount = 1;
                         drawArg.StartIndexLocation = mesh.ibOffset * (mesh.use16BitIndices() ? 2 : 1);
-                        drawArg.BaseVertexLocation = mesh.vbOffset;
+                        drawArg.BaseVertexLocation = getDrawVertexOffset(mesh);
                         drawArg.StartInstanceLocation = instanceID;
 
                         drawArguments.push_back(drawArg);
@@ -578,18 +622,15 @@ namespace Falcor
                 for (auto& instanceID : mDrawArgsInstanceIDs[i])
                 {
                     const auto& instance = mGeometryInstanceData[instanceID];
-                    const auto& worldMat = globalMatrices[instance.globalMatrixID];
-                    const AABB& meshBB = mMeshBBs[instance.geometryID];
                     const auto& mesh = mMeshDesc[instance.geometryID];
                     // If the mesh passes the culling test, add to draw buffer
-                    // TODO: Add a better/functioning precalculated BB for skinned meshes
-                    if (pFrustumCulling->isInFrustum(meshBB.transform(worldMat)) || mesh.isSkinned())
+                    if (isVisible(instanceID))
                     {
                         
                         DrawArguments drawArg;
                         drawArg.VertexCountPerInstance = mesh.vertexCount;
                         drawArg.InstanceCount = 1;
-                        drawArg.StartVertexLocation = mesh.vbOffset;
+                        drawArg.StartVertexLocation = getDrawVertexOffset(mesh);
                         drawArg.StartInstanceLocation = instanceID;
 
                         drawArguments.push_back(drawArg);
@@ -610,7 +651,7 @@ namespace Falcor
                 continue;
 
             // Set state.
-            pState->setVao(draw.ibFormat == ResourceFormat::R16Uint ? mpMeshVao16Bit : mpMeshVao);
+            pState->setVao(getDrawVao(draw.ibFormat, draw.isDynamic));
 
             if (draw.ignoreWinding)
                 pState->setRasterizerState(pRasterizerStateDS);
@@ -682,10 +723,14 @@ namespace Falcor
             pIB = Buffer::create(mpDevice, ibSize, ibBindFlags, Buffer::CpuAccess::None, indexData.data());
         }
 
-        // Create the vertex data structured buffer.
-        const size_t vertexCount = (uint32_t)staticData.size();
+        // Create the vertex data structured buffers.
+        // With compact vertex data only the vertices of dynamic meshes are stored in the full-precision buffer.
+        // The vertices of static meshes are stored after them in a separate buffer in the compact format.
+        const size_t vertexCount = mUseCompactVertexData ? mCompactVertexOffset : staticData.size();
+        const size_t compactVertexCount = staticData.size() - vertexCount;
         size_t staticVbSize = sizeof(PackedStaticVertexData) * vertexCount;
-        if (staticVbSize > std::numeric_limits<uint32_t>::max())
+        size_t compactVbSize = sizeof(PackedCompactVertexData) * compactVertexCount;
+        if (staticVbSize > std::numeric_limits<uint32_t>::max() || compactVbSize > std::numeric_limits<uint32_t>::max())
         {
             throw RuntimeError("Vertex buffer size exceeds 4GB");
         }
@@ -697,6 +742,19 @@ namespace Falcor
             pStaticBuffer = Buffer::createStructured(mpDevice, sizeof(PackedStaticVertexData), (uint32_t)vertexCount, vbBindFlags, Buffer::CpuAccess::None, nullptr, false);
         }
 
+        ref<Buffer> pCompactBuffer;
+        if (compactVertexCount > 0)
+        {
+            std::vector<PackedCompactVertexData> compactData(compactVertexCount);
+            Threading::parallel_for(size_t(0), compactVertexCount, [&](size_t i)
+            {
+                compactData[i].pack(staticData[vertexCount + i].unpack());
+            });
+
+            ResourceBindFlags vbBindFlags = ResourceBindFlags::ShaderResource | ResourceBindFlags::Vertex;
+            pCompactBuffer = Buffer::createStructured(mpDevice, sizeof(PackedCompactVertexData), (uint32_t)compactVertexCount, vbBindFlags, Buffer::CpuAccess::None, compactData.data(), false);
+        }
+
         Vao::BufferVec pVBs(kVertexBufferCount);
         pVBs[kStaticDataBufferIndex] = pStaticBuffer;
 
@@ -745,6 +803,44 @@ namespace Falcor
         // For drawing the meshes we need separate VAOs for these cases.
         mpMeshVao = Vao::create(Vao::Topology::TriangleList, pLayout, pVBs, pIB, ResourceFormat::R32Uint);
         mpMeshVao16Bit = Vao::create(Vao::Topology::TriangleList, pLayout, pVBs, pIB, ResourceFormat::R16Uint);
+
+        // Create the VAO objects for static meshes with compact vertex data.
+        // They share the index and draw ID buffers. The vertex shader only reads the position from the vertex buffer
+        // and fetches the remaining attributes from the scene, so the layout only needs to match the stride.
+        if (pCompactBuffer)
+        {
+            Vao::BufferVec pCompactVBs = pVBs;
+            pCompactVBs[kStaticDataBufferIndex] = pCompactBuffer;
+
+            ref<VertexLayout> pCompactLayout = VertexLayout::create();
+            ref<VertexBufferLayout> pCompactStaticLayout = VertexBufferLayout::create();
+            pCompactStaticLayout->addElement(VERTEX_POSITION_NAME, offsetof(PackedCompactVertexData, position), ResourceFormat::RGB32Float, 1, VERTEX_POSITION_LOC);
+            pCompactStaticLayout->addElement(VERTEX_PACKED_NORMAL_TANGENT_CURVE_RADIUS_NAME, offsetof(PackedCompactVertexData, packedNormal), ResourceFormat::RG32Uint, 1, VERTEX_PACKED_NORMAL_TANGENT_CURVE_RADIUS_LOC);
+            pCompactStaticLayout->addElement(VERTEX_TEXCOORD_NAME, offsetof(PackedCompactVertexData, packedTexCrd), ResourceFormat::R32Uint, 1, VERTEX_TEXCOORD_LOC);
+            FALCOR_ASSERT(pCompactStaticLayout->getStride() == sizeof(PackedCompactVertexData));
+            pCompactLayout->addBufferLayout(kStaticDataBufferIndex, pCompactStaticLayout);
+            pCompactLayout->addBufferLayout(kDrawIdBufferIndex, pInstLayout);
+
+            mpCompactMeshVao = Vao::create(Vao::Topology::TriangleList, pCompactLayout, pCompactVBs, pIB, ResourceFormat::R32Uint);
+            mpCompactMeshVao16Bit = Vao::create(Vao::Topology::TriangleList, pCompactLayout, pCompactVBs, pIB, ResourceFormat::R16Uint);
+        }
+    }
+
+    const ref<Vao>& Scene::getDrawVao(ResourceFormat ibFormat, bool isDynamic) const
+    {
+        if (mUseCompactVertexData && !isDynamic) return ibFormat == ResourceFormat::R16Uint ? mpCompactMeshVao16Bit : mpCompactMeshVao;
+        return ibFormat == ResourceFormat::R16Uint ? mpMeshVao16Bit : mpMeshVao;
+    }
+
+    uint32_t Scene::getDrawVertexOffset(const MeshDesc& mesh) const
+    {
+        // Vertex offsets are global, but static meshes with compact vertex data are drawn from a separate buffer.
+        if (mUseCompactVertexData && !mesh.isDynamic())
+        {
+            FALCOR_ASSERT(mesh.vbOffset >= mCompactVertexOffset);
+            return mesh.vbOffset - mCompactVertexOffset;
+        }
+        return mesh.vbOffset;
     }
 
     void Scene::createCurveVao(const std::vector<uint32_t>& indexData, const std::vector<StaticCurveVertexData>& staticData)
@@ -1070,6 +1166,12 @@ namespace Falcor
             var[kPrevVertexBufferName] = mpAnimationController->getPrevVertexData(); // Can be nullptr
         }
 
+        if (mUseCompactVertexData)
+        {
+            if (mpCompactMeshVao) var[kCompactVertexBufferName] = mpCompactMeshVao->getVertexBuffer(Scene::kStaticDataBufferIndex);
+            var[kCompactVertexOffset] = mCompactVertexOffset;
+        }
+
         if (mpCurveVao != nullptr)
         {
             var[kCurveIndexBufferName] = mpCurveVao->getIndexBuffer();
@@ -1083,29 +1185,68 @@ namespace Falcor
         getCamera()->setShaderData(mpSceneBlock->getRootVar()[kCamera]);
     }
 
-    void Scene::updateBounds()
+    void Scene::createMatrixInstanceMapping()
     {
-        const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
+        // Counting sort of the instance IDs by global matrix ID.
+        const size_t matrixCount = mpAnimationController->getGlobalMatrices().size();
+        mMatrixInstanceOffsets.assign(matrixCount + 1, 0);
+        for (const auto& inst : mGeometryInstanceData)
+        {
+            FALCOR_ASSERT(inst.globalMatrixID < matrixCount);
+            mMatrixInstanceOffsets[inst.globalMatrixID + 1]++;
+        }
+        for (size_t i = 0; i < matrixCount; i++) mMatrixInstanceOffsets[i + 1] += mMatrixInstanceOffsets[i];
 
-        mSceneBB = AABB();
+        mMatrixInstances.resize(mGeometryInstanceData.size());
+        std::vector<uint32_t> next(mMatrixInstanceOffsets.begin(), mMatrixInstanceOffsets.end() - 1);
+        for (uint32_t instanceID = 0; instanceID < (uint32_t)mGeometryInstanceData.size(); instanceID++)
+        {
+            mMatrixInstances[next[mGeometryInstanceData[instanceID].globalMatrixID]++] = instanceID;
+        }
+    }
 
-        for (const auto& inst : mGeometryInstanceData)
+    bool Scene::collectMovedInstances()
+    {
+        mMovedInstances.clear();
+        for (uint32_t matrixID : mpAnimationController->getChangedMatrices())
         {
+            if (matrixID + 1 >= mMatrixInstanceOffsets.size()) continue;
+            mMovedInstances.insert(mMovedInstances.end(), mMatrixInstances.begin() + mMatrixInstanceOffsets[matrixID], mMatrixInstances.begin() + mMatrixInstanceOffsets[matrixID + 1]);
+        }
+        // Skinned instances also move when only their bones move.
+        if (mpAnimationController->hasSkinnedMeshes()) updateSkinnedInstanceBounds();
+        std::sort(mMovedInstances.begin(), mMovedInstances.end());
+        mMovedInstances.erase(std::unique(mMovedInstances.begin(), mMovedInstances.end()), mMovedInstances.end());
+        return !mMovedInstances.empty();
+    }
+
+    void Scene::updateBounds(bool forceUpdate)
+    {
+        const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
+
+        auto getInstanceBounds = [&](uint32_t instanceID) -> AABB
+        {
+            const GeometryInstanceData& inst = mGeometryInstanceData[instanceID];
             const float4x4& transform = globalMatrices[inst.globalMatrixID];
             switch (inst.getType())
             {
             case GeometryType::TriangleMesh:
             case GeometryType::DisplacedTriangleMesh:
             {
+                // Skinned meshes use the bounds of the current pose instead of the bind pose.
+                if (mMeshDesc[inst.geometryID].isSkinned())
+                {
+                    auto it = std::lower_bound(mSkinnedInstances.begin(), mSkinnedInstances.end(), instanceID);
+                    FALCOR_ASSERT(it != mSkinnedInstances.end() && *it == instanceID);
+                    return mSkinnedInstanceBounds[it - mSkinnedInstances.begin()];
+                }
                 const AABB& meshBB = mMeshBBs[inst.geometryID];
-                mSceneBB |= meshBB.transform(transform);
-                break;
+                return meshBB.transform(transform);
             }
             case GeometryType::Curve:
             {
                 const AABB& curveBB = mCurveBBs[inst.geometryID];
-                mSceneBB |= curveBB.transform(transform);
-                break;
+                return curveBB.transform(transform);
             }
             case GeometryType::SDFGrid:
             {
@@ -1115,11 +1256,38 @@ namespace Falcor
                 transform3x3[2] = abs(transform3x3[2]);
                 float3 center = transform.getCol(3).xyz();
                 float3 halfExtent = transformVector(transform3x3, float3(0.5f));
-                mSceneBB |= AABB(center - halfExtent, center + halfExtent);
-                break;
+                return AABB(center - halfExtent, center + halfExtent);
             }
+            default:
+                return AABB();
+            }
+        };
+
+        const bool updateCullingBounds = mCullingBounds.getCount() == mGeometryInstanceData.size();
+
+        if (forceUpdate || mInstanceBounds.getLeafCount() != mGeometryInstanceData.size())
+        {
+            std::vector<AABB> instanceBounds(mGeometryInstanceData.size());
+            for (uint32_t i = 0; i < (uint32_t)mGeometryInstanceData.size(); i++)
+            {
+                instanceBounds[i] = getInstanceBounds(i);
+                if (updateCullingBounds) mCullingBounds.setBounds(i, instanceBounds[i]);
+            }
+            mInstanceBounds = AABBReductionTree(instanceBounds);
+        }
+        else
+        {
+            // Only the bounds of moved instances change. Each update touches O(log n) nodes of the reduction tree.
+            for (uint32_t instanceID : mMovedInstances)
+            {
+                AABB bounds = getInstanceBounds(instanceID);
+                mInstanceBounds.setLeaf(instanceID, bounds);
+                if (updateCullingBounds) mCullingBounds.setBounds(instanceID, bounds);
             }
         }
+        mCullingBounds.refit();
+
+        mSceneBB = mInstanceBounds.getBounds();
 
         for (const auto& aabb : mCustomPrimitiveAABBs)
         {
@@ -1136,39 +1304,63 @@ namespace Falcor
     {
         if (mGeometryInstanceData.empty()) return;
 
-        bool dataChanged = false;
         const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
 
-        for (auto& inst : mGeometryInstanceData)
+        // Updates the flags of an instance and returns true if they changed.
+        auto updateFlags = [&](GeometryInstanceData& inst)
         {
-            if (inst.getType() == GeometryType::TriangleMesh || inst.getType() == GeometryType::DisplacedTriangleMesh)
-            {
-                uint32_t prevFlags = inst.flags;
+            if (inst.getType() != GeometryType::TriangleMesh && inst.getType() != GeometryType::DisplacedTriangleMesh) return false;
 
-                FALCOR_ASSERT(inst.globalMatrixID < globalMatrices.size());
-                const float4x4& transform = globalMatrices[inst.globalMatrixID];
-                bool isTransformFlipped = doesTransformFlip(transform);
-                bool isObjectFrontFaceCW = getMesh(MeshID::fromSlang(inst.geometryID)).isFrontFaceCW();
-                bool isWorldFrontFaceCW = isObjectFrontFaceCW ^ isTransformFlipped;
+            uint32_t prevFlags = inst.flags;
 
-                if (isTransformFlipped) inst.flags |= (uint32_t)GeometryInstanceFlags::TransformFlipped;
-                else inst.flags &= ~(uint32_t)GeometryInstanceFlags::TransformFlipped;
+            FALCOR_ASSERT(inst.globalMatrixID < globalMatrices.size());
+            const float4x4& transform = globalMatrices[inst.globalMatrixID];
+            bool isTransformFlipped = doesTransformFlip(transform);
+            bool isObjectFrontFaceCW = getMesh(MeshID::fromSlang(inst.geometryID)).isFrontFaceCW();
+            bool isWorldFrontFaceCW = isObjectFrontFaceCW ^ isTransformFlipped;
 
-                if (isObjectFrontFaceCW) inst.flags |= (uint32_t)GeometryInstanceFlags::IsObjectFrontFaceCW;
-                else inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsObjectFrontFaceCW;
+            if (isTransformFlipped) inst.flags |= (uint32_t)GeometryInstanceFlags::TransformFlipped;
+            else inst.flags &= ~(uint32_t)GeometryInstanceFlags::TransformFlipped;
 
-                if (isWorldFrontFaceCW) inst.flags |= (uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
-                else inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
+            if (isObjectFrontFaceCW) inst.flags |= (uint32_t)GeometryInstanceFlags::IsObjectFrontFaceCW;
+            else inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsObjectFrontFaceCW;
 
-                dataChanged |= (inst.flags != prevFlags);
-            }
-        }
+            if (isWorldFrontFaceCW) inst.flags |= (uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
+            else inst.flags &= ~(uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW;
+
+            return inst.flags != prevFlags;
+        };
 
-        if (forceUpdate || dataChanged)
+        if (forceUpdate)
         {
+            for (auto& inst : mGeometryInstanceData) updateFlags(inst);
+
             uint32_t byteSize = (uint32_t)(mGeometryInstanceData.size() * sizeof(GeometryInstanceData));
             mpGeometryInstancesBuffer->setBlob(mGeometryInstanceData.data(), 0, byteSize);
+            return;
         }
+
+        // Only the flags of moved instances can change. Upload ranges of consecutive changed instances.
+        // mMovedInstances is sorted, so the changed instances are visited in ascending order.
+        uint32_t rangeStart = 0;
+        uint32_t rangeEnd = 0;
+        auto uploadRange = [&]()
+        {
+            if (rangeEnd == rangeStart) return;
+            mpGeometryInstancesBuffer->setBlob(&mGeometryInstanceData[rangeStart], rangeStart * sizeof(GeometryInstanceData), (rangeEnd - rangeStart) * sizeof(GeometryInstanceData));
+        };
+
+        for (uint32_t instanceID : mMovedInstances)
+        {
+            if (!updateFlags(mGeometryInstanceData[instanceID])) continue;
+            if (instanceID != rangeEnd)
+            {
+                uploadRange();
+                rangeStart = instanceID;
+            }
+            rangeEnd = instanceID + 1;
+        }
+        uploadRange();
     }
 
     Scene::UpdateFlags Scene::updateRaytracingAABBData(bool forceUpdate)
@@ -1467,7 +1659,9 @@ namespace Falcor
 
         mpAnimationController->animate(pRenderContext, 0); // Requires Scene block to exist
         updateGeometry(pRenderContext, true); // Requires scene defines
+        createMatrixInstanceMapping();
         updateGeometryInstances(true);
+        updateSkinnedInstanceBounds();
 
         // DEMO21: Setup light profile.
         if (mpLightProfile)
@@ -1476,8 +1670,9 @@ namespace Falcor
             mpLightProfile->setShaderData(mpSceneBlock->getRootVar()[kLightProfile]);
         }
 
-        updateBounds();
+        updateBounds(true);
         createDrawList();
+        createCullingBounds();
         if (mCameras.size() == 0)
         {
             // Create a new camera to use in the event of a scene with no cameras
@@ -1612,6 +1807,12 @@ namespace Falcor
             s.geometryMemoryInBytes += pDrawID ? pDrawID->getSize() : 0;
         }
 
+        if (mpCompactMeshVao)
+        {
+            const auto& pCompactVB = mpCompactMeshVao->getVertexBuffer(kStaticDataBufferIndex);
+            s.vertexMemoryInBytes += pCompactVB ? pCompactVB->getSize() : 0;
+        }
+
         s.curveIndexMemoryInBytes = 0;
         s.curveVertexMemoryInBytes = 0;
 
@@ -1692,9 +1893,15 @@ namespace Falcor
         s.tlasCount = 0;
         s.tlasMemoryInBytes = 0;
         s.tlasScratchMemoryInBytes = 0;
+        s.tlasInstanceDescCount = 0;
+        s.tlasInstanceDescUpdatedCount = 0;
+        s.tlasInstanceDescUploadedCount = 0;
 
         for (const auto& [i, tlas] : mTlasCache)
         {
+            s.tlasInstanceDescCount += tlas.instanceDescs.getCount();
+            s.tlasInstanceDescUpdatedCount += tlas.instanceDescs.getUpdatedCount();
+            s.tlasInstanceDescUploadedCount += tlas.instanceDescs.getUploadedCount();
             if (tlas.pTlasBuffer)
             {
                 s.tlasMemoryInBytes += tlas.pTlasBuffer->getSize();
@@ -2051,18 +2258,14 @@ namespace Falcor
         // scene block are placed below this point.
         checkInvariant(!is_set(mUpdates, UpdateFlags::SceneDefinesChanged), "Scene doesn't yet support modifications that change the scene defines.");
 
+        mMovedInstances.clear();
         if (mpAnimationController->animate(pRenderContext, currentTime))
         {
             mUpdates |= UpdateFlags::SceneGraphChanged;
             if (mpAnimationController->hasSkinnedMeshes()) mUpdates |= UpdateFlags::MeshesChanged;
 
-            for (const auto& inst : mGeometryInstanceData)
-            {
-                if (mpAnimationController->isMatrixChanged(NodeID{ inst.globalMatrixID }))
-                {
-                    mUpdates |= UpdateFlags::GeometryMoved;
-                }
-            }
+            // Look up the instances using the changed matrices instead of checking every instance.
+            if (collectMovedInstances()) mUpdates |= UpdateFlags::GeometryMoved;
 
             // We might end up setting the flag even if curves haven't changed (if looping is disabled for example).
             if (mpAnimationController->hasAnimatedCurveCaches()) mUpdates |= UpdateFlags::CurvesMoved;
@@ -2082,10 +2285,16 @@ namespace Falcor
         mUpdates |= updateSDFGrids(pRenderContext);
         pRenderContext->flush();
 
+        mOccludersMoved = false;
         if (is_set(mUpdates, UpdateFlags::GeometryMoved))
         {
-            invalidateTlasCache();
+            updateTlasInstanceTransforms();
             updateGeometryInstances(false);
+            updateBounds(false);
+
+            // Both lists are sorted.
+            mOccludersMoved = std::any_of(mMovedInstances.begin(), mMovedInstances.end(), [this](uint32_t instanceID)
+                { return std::binary_search(mOccluderInstances.begin(), mOccluderInstances.end(), instanceID); });
         }
 
         //Signal Fence for this frame
@@ -2376,6 +2585,9 @@ namespace Falcor
                 << "  TLAS count: " << s.tlasCount << std::endl
                 << "  TLAS memory (final): " << formatByteSize(s.tlasMemoryInBytes) << std::endl
                 << "  TLAS memory (scratch): " << formatByteSize(s.tlasScratchMemoryInBytes) << std::endl
+                << "  TLAS instance descs (total): " << s.tlasInstanceDescCount << std::endl
+                << "  TLAS instance descs (updated in last build): " << s.tlasInstanceDescUpdatedCount << std::endl
+                << "  TLAS instance descs (uploaded in last build): " << s.tlasInstanceDescUploadedCount << std::endl
                 << std::endl;
 
             // Material stats.
@@ -2385,6 +2597,7 @@ namespace Falcor
                 << "  Material count (opaque): " << s.materials.materialOpaqueCount << std::endl
                 << "  Material count (non-opaque): " << (s.materials.materialCount - s.materials.materialOpaqueCount) << std::endl
                 << "  Material memory: " << formatByteSize(s.materials.materialMemoryInBytes) << std::endl
+                << "  Duplicate materials removed: " << s.materials.materialDuplicateCount << " (" << std::fixed << std::setprecision(3) << s.materials.materialDuplicateRemovalTime << " s)" << std::endl
                 << "  Texture count (total): " << s.materials.textureCount << std::endl
                 << "  Texture count (compressed): " << s.materials.textureCompressedCount << std::endl
                 << "  Texture texel count: " << s.materials.textureTexelCount << std::endl
@@ -2875,6 +3088,161 @@ namespace Falcor
         mBlasUpdateMode = mode;
     }
 
+    void Scene::createCullingBounds()
+    {
+        // Instances of meshes drawn with the dynamic draw lists are tested linearly, all others are placed in the BVH.
+        // Uses the world space instance bounds, so updateBounds() must have been called before.
+        std::vector<AABB> bounds(mGeometryInstanceData.size());
+        std::vector<bool> isStatic(mGeometryInstanceData.size(), true);
+        for (uint32_t instanceID = 0; instanceID < (uint32_t)mGeometryInstanceData.size(); instanceID++)
+        {
+            const auto& instance = mGeometryInstanceData[instanceID];
+            bounds[instanceID] = mInstanceBounds.getLeaf(instanceID);
+            if (instance.getType() == GeometryType::TriangleMesh)
+            {
+                const auto& mesh = mMeshDesc[instance.geometryID];
+                isStatic[instanceID] = !mesh.isAnimated() && !mesh.isDynamic();
+            }
+        }
+        mCullingBounds.build(bounds, isStatic);
+    }
+
+    void Scene::createSkinnedMeshBounds(const std::vector<SkinningVertexData>& skinningData, const std::vector<PackedStaticVertexData>& staticData)
+    {
+        std::vector<uint32_t> boundsIndices(mMeshDesc.size(), 0);
+        for (uint32_t meshID = 0; meshID < (uint32_t)mMeshDesc.size(); meshID++)
+        {
+            const auto& mesh = mMeshDesc[meshID];
+            if (!mesh.isSkinned()) continue;
+            FALCOR_ASSERT((size_t)mesh.skinningVbOffset + mesh.vertexCount <= skinningData.size());
+            boundsIndices[meshID] = mSkinnedMeshBounds.addMesh(skinningData.data() + mesh.skinningVbOffset, mesh.vertexCount, staticData);
+        }
+
+        for (uint32_t instanceID = 0; instanceID < (uint32_t)mGeometryInstanceData.size(); instanceID++)
+        {
+            const auto& instance = mGeometryInstanceData[instanceID];
+            if (instance.getType() != GeometryType::TriangleMesh && instance.getType() != GeometryType::DisplacedTriangleMesh) continue;
+            if (!mMeshDesc[instance.geometryID].isSkinned()) continue;
+            mSkinnedInstances.push_back(instanceID);
+            mSkinnedInstanceMeshes.push_back(boundsIndices[instance.geometryID]);
+        }
+        mSkinnedInstanceBounds.resize(mSkinnedInstances.size());
+    }
+
+    bool Scene::updateSkinnedInstanceBounds()
+    {
+        const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
+        const auto& invTransposeGlobalMatrices = mpAnimationController->getInvTransposeGlobalMatrices();
+        const auto& skinningMatrices = mpAnimationController->getSkinningMatrices();
+
+        std::vector<uint8_t> changed(mSkinnedInstances.size(), 0);
+        Threading::parallel_for(size_t(0), mSkinnedInstances.size(), [&](size_t i)
+        {
+            const auto& instance = mGeometryInstanceData[mSkinnedInstances[i]];
+            const uint32_t meshIndex = mSkinnedInstanceMeshes[i];
+
+            // The skinning pass transforms the skinned world space positions back to mesh local space
+            // with the inverse skeleton world matrix and the inverse mesh bind matrix (see Skinning.slang).
+            const float4x4& meshBind = mSceneGraph[mSkinnedMeshBounds.getBindMatrixID(meshIndex)].meshBind;
+            const float4x4 invSkeletonWorld = transpose(invTransposeGlobalMatrices[mSkinnedMeshBounds.getSkeletonMatrixID(meshIndex)]);
+            const float4x4 transform = mul(globalMatrices[instance.globalMatrixID], mul(inverse(meshBind), invSkeletonWorld));
+
+            const AABB bounds = mSkinnedMeshBounds.getBounds(meshIndex, transform, skinningMatrices, meshBind);
+            if (bounds != mSkinnedInstanceBounds[i])
+            {
+                mSkinnedInstanceBounds[i] = bounds;
+                changed[i] = 1;
+            }
+        }, kSkinnedBoundsGrainSize);
+
+        bool anyChanged = false;
+        for (size_t i = 0; i < mSkinnedInstances.size(); i++)
+        {
+            if (!changed[i]) continue;
+            mMovedInstances.push_back(mSkinnedInstances[i]);
+            anyChanged = true;
+        }
+        return anyChanged;
+    }
+
+    void Scene::createOccluders(const std::vector<uint32_t>& indexData, const std::vector<PackedStaticVertexData>& staticData)
+    {
+        // Occluders are opaque meshes without vertex animation. Large meshes with few triangles make the best occluders,
+        // so the candidates are taken in order of decreasing bounding box area until the triangle budget is used up.
+        std::vector<uint32_t> candidates;
+        for (uint32_t meshID = 0; meshID < (uint32_t)mMeshDesc.size(); meshID++)
+        {
+            const auto& mesh = mMeshDesc[meshID];
+            if (mesh.isDynamic() || mesh.isDisplaced() || mesh.getTriangleCount() > kMaxOccluderMeshTriangleCount) continue;
+            if (!getMaterial(MaterialID::fromSlang(mesh.materialID))->isOpaque()) continue;
+            candidates.push_back(meshID);
+        }
+        std::stable_sort(candidates.begin(), candidates.end(), [this](uint32_t a, uint32_t b) { return mMeshBBs[a].area() > mMeshBBs[b].area(); });
+
+        const uint8_t* indexData8 = reinterpret_cast<const uint8_t*>(indexData.data());
+        mOccluderMeshes.clear();
+        mOccluderMeshes.resize(mMeshDesc.size());
+        uint64_t triangleCount = 0;
+        for (uint32_t meshID : candidates)
+        {
+            const auto& mesh = mMeshDesc[meshID];
+            if (triangleCount + mesh.getTriangleCount() > kMaxOccluderTriangleCount) continue;
+            triangleCount += mesh.getTriangleCount();
+
+            OccluderMesh& occluder = mOccluderMeshes[meshID];
+            FALCOR_ASSERT((size_t)mesh.vbOffset + mesh.vertexCount <= staticData.size());
+            occluder.positions.resize(mesh.vertexCount);
+            for (uint32_t i = 0; i < mesh.vertexCount; i++) occluder.positions[i] = staticData[(size_t)mesh.vbOffset + i].position;
+
+            occluder.indices.resize(mesh.getTriangleCount() * 3);
+            for (uint32_t i = 0; i < (uint32_t)occluder.indices.size(); i++)
+            {
+                if (!mesh.useVertexIndices()) occluder.indices[i] = i;
+                else if (mesh.use16BitIndices()) occluder.indices[i] = reinterpret_cast<const uint16_t*>(indexData8 + mesh.ibOffset * 4)[i];
+                else occluder.indices[i] = reinterpret_cast<const uint32_t*>(indexData8 + mesh.ibOffset * 4)[i];
+                FALCOR_ASSERT(occluder.indices[i] < mesh.vertexCount);
+            }
+        }
+
+        mOccluderInstances.clear();
+        for (uint32_t instanceID = 0; instanceID < (uint32_t)mGeometryInstanceData.size(); instanceID++)
+        {
+            const auto& instance = mGeometryInstanceData[instanceID];
+            if (instance.getType() == GeometryType::TriangleMesh && !mOccluderMeshes[instance.geometryID].indices.empty())
+                mOccluderInstances.push_back(instanceID);
+        }
+    }
+
+    void Scene::rasterizeOccluders(OcclusionCulling& occlusionCulling, const float4x4& viewProj)
+    {
+        occlusionCulling.clear(viewProj);
+
+        // Rasterize the occluders in the frustum that cover the largest part of the screen first.
+        // Uses the frustum culling results in mCullingVisibility, so the frustum must have been culled before.
+        std::vector<std::pair<float, uint32_t>> occluders;
+        for (uint32_t instanceID : mOccluderInstances)
+        {
+            if (mCullingVisibility[instanceID] == 0) continue;
+            const float coverage = occlusionCulling.getScreenCoverage(mInstanceBounds.getLeaf(instanceID));
+            if (coverage >= kMinOccluderScreenCoverage) occluders.emplace_back(coverage, instanceID);
+        }
+        std::sort(occluders.begin(), occluders.end(), std::greater<>());
+
+        const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
+        uint32_t triangleCount = 0;
+        for (const auto& [coverage, instanceID] : occluders)
+        {
+            const auto& instance = mGeometryInstanceData[instanceID];
+            const OccluderMesh& occluder = mOccluderMeshes[instance.geometryID];
+            const uint32_t occluderTriangleCount = (uint32_t)occluder.indices.size() / 3;
+            if (triangleCount + occluderTriangleCount > kMaxOccluderTrianglesPerFrame) continue;
+            triangleCount += occluderTriangleCount;
+            occlusionCulling.rasterize(globalMatrices[instance.globalMatrixID], occluder.positions, occluder.indices);
+        }
+
+        occlusionCulling.updateHierarchy();
+    }
+
     void Scene::createDrawList()
     {
         // This function creates argument buffers for draw indirect calls to rasterize the scene.
@@ -2977,7 +3345,7 @@ namespace Falcor
                 draw.IndexCountPerInstance = mesh.indexCount;
                 draw.InstanceCount = 1;
                 draw.StartIndexLocation = mesh.ibOffset * (use16Bit ? 2 : 1);
-                draw.BaseVertexLocation = mesh.vbOffset;
+                draw.BaseVertexLocation = getDrawVertexOffset(mesh);
                 draw.StartInstanceLocation = instanceID;
 
                 int i = use16Bit ? 0 : 1;
@@ -3040,7 +3408,7 @@ namespace Falcor
                 DrawArguments draw;
                 draw.VertexCountPerInstance = mesh.vertexCount;
                 draw.InstanceCount = 1;
-                draw.StartVertexLocation = mesh.vbOffset;
+                draw.StartVertexLocation = getDrawVertexOffset(mesh);
                 draw.StartInstanceLocation = instanceID;
                 uint i = isDynamic ? 1 : 0;
                 
@@ -3093,8 +3461,6 @@ namespace Falcor
         if (!mMeshGroups.empty())
         {
             FALCOR_ASSERT(mpMeshVao);
-            const ref<VertexBufferLayout>& pVbLayout = mpMeshVao->getVertexLayout()->getBufferLayout(kStaticDataBufferIndex);
-            const ref<Buffer>& pVb = mpMeshVao->getVertexBuffer(kStaticDataBufferIndex);
             const ref<Buffer>& pIb = mpMeshVao->getIndexBuffer();
             const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
 
@@ -3178,7 +3544,11 @@ namespace Falcor
                         desc.flags |= mAdditionalASGeometryFlags;
 
                         // Set the position data
-                        desc.content.triangles.vertexData = pVb->getGpuAddress() + (mesh.vbOffset * pVbLayout->getStride());
+                        // Static meshes with compact vertex data are stored in a separate buffer, but the positions are at full precision in both formats.
+                        const ref<Vao>& pVao = getDrawVao(ResourceFormat::R32Uint, mesh.isDynamic());
+                        const ref<VertexBufferLayout>& pVbLayout = pVao->getVertexLayout()->getBufferLayout(kStaticDataBufferIndex);
+                        const ref<Buffer>& pVb = pVao->getVertexBuffer(kStaticDataBufferIndex);
+                        desc.content.triangles.vertexData = pVb->getGpuAddress() + (getDrawVertexOffset(mesh) * pVbLayout->getStride());
                         desc.content.triangles.vertexStride = pVbLayout->getStride();
                         desc.content.triangles.vertexCount = mesh.vertexCount;
                         desc.content.triangles.vertexFormat = pVbLayout->getElementFormat(0);
@@ -3410,36 +3780,38 @@ namespace Falcor
 
     void Scene::computeBlasGroups()
     {
-        mBlasGroups.clear();
-        uint64_t groupSize = 0;
-
-        for (uint32_t blasId = 0; blasId < mBlasData.size(); blasId++)
+        std::vector<BlasBuildSize> sizes(mBlasData.size());
+        for (size_t blasId = 0; blasId < mBlasData.size(); blasId++)
         {
-            auto& blas = mBlasData[blasId];
-            size_t blasSize = blas.resultByteSize + blas.scratchByteSize;
-
-            // Start new BLAS group on first iteration or if group size would exceed the target.
-            if (groupSize == 0 || groupSize + blasSize > kMaxBLASBuildMemory)
-            {
-                mBlasGroups.push_back({});
-                groupSize = 0;
-            }
+            sizes[blasId].resultByteSize = mBlasData[blasId].resultByteSize;
+            sizes[blasId].scratchByteSize = mBlasData[blasId].scratchByteSize;
+        }
 
-            // Add BLAS to current group.
-            FALCOR_ASSERT(mBlasGroups.size() > 0);
-            auto& group = mBlasGroups.back();
-            group.blasIndices.push_back(blasId);
-            blas.blasGroupIndex = (uint32_t)mBlasGroups.size() - 1;
+        // Pack the BLASes into as few groups as possible. Fewer groups means fewer GPU syncs during the build.
+        BlasBuildPlan plan = planBlasBuild(sizes, kMaxBLASBuildMemory);
 
-            // Update data offsets and sizes.
-            blas.resultByteOffset = group.resultByteSize;
-            blas.scratchByteOffset = group.scratchByteSize;
-            group.resultByteSize += blas.resultByteSize;
-            group.scratchByteSize += blas.scratchByteSize;
+        mBlasGroups.clear();
+        mBlasGroups.resize(plan.groups.size());
+        for (size_t blasGroupIndex = 0; blasGroupIndex < plan.groups.size(); blasGroupIndex++)
+        {
+            auto& group = mBlasGroups[blasGroupIndex];
+            group.blasIndices = std::move(plan.groups[blasGroupIndex].blasIndices);
+            group.resultByteSize = plan.groups[blasGroupIndex].resultByteSize;
+            group.scratchByteSize = plan.groups[blasGroupIndex].scratchByteSize;
+        }
 
-            groupSize += blasSize;
+        for (size_t blasId = 0; blasId < mBlasData.size(); blasId++)
+        {
+            auto& blas = mBlasData[blasId];
+            const auto& placement = plan.placements[blasId];
+            blas.blasGroupIndex = placement.groupIndex;
+            blas.resultByteOffset = placement.resultByteOffset;
+            blas.scratchByteOffset = placement.scratchByteOffset;
         }
 
+        logInfo("BLAS build planned intermediate memory: {} (result {} + {}, scratch {})", formatByteSize(plan.getPeakByteSize()),
+            formatByteSize(plan.resultBufferByteSize[0]), formatByteSize(plan.resultBufferByteSize[1]), formatByteSize(plan.scratchBufferByteSize));
+
         // Validation that all offsets and sizes are correct.
         uint64_t totalResultSize = 0;
         uint64_t totalScratchSize = 0;
@@ -3494,10 +3866,16 @@ namespace Falcor
         {
             const ref<Buffer>& pVb = mpMeshVao->getVertexBuffer(kStaticDataBufferIndex);
             const ref<Buffer>& pIb = mpMeshVao->getIndexBuffer();
-            pRenderContext->resourceBarrier(pVb.get(), Resource::State::NonPixelShader);
+            if (pVb) pRenderContext->resourceBarrier(pVb.get(), Resource::State::NonPixelShader);
             if (pIb) pRenderContext->resourceBarrier(pIb.get(), Resource::State::NonPixelShader);
         }
 
+        if (mpCompactMeshVao)
+        {
+            const ref<Buffer>& pCompactVb = mpCompactMeshVao->getVertexBuffer(kStaticDataBufferIndex);
+            pRenderContext->resourceBarrier(pCompactVb.get(), Resource::State::NonPixelShader);
+        }
+
         if (mpCurveVao)
         {
             const ref<Buffer>& pCurveVb = mpCurveVao->getVertexBuffer(kStaticDataBufferIndex);
@@ -3560,19 +3938,22 @@ namespace Falcor
                 logInfo("BLAS build split into {} groups", mBlasGroups.size());
 
                 // Compute the required maximum size of the result and scratch buffers.
-                uint64_t resultByteSize = 0;
+                // Even and odd groups are built into separate result buffers, so one group can be compacted while the next is built.
+                uint64_t resultByteSize[2] = {};
                 uint64_t scratchByteSize = 0;
                 size_t maxBlasCount = 0;
 
-                for (const auto& group : mBlasGroups)
+                for (size_t blasGroupIndex = 0; blasGroupIndex < mBlasGroups.size(); blasGroupIndex++)
                 {
-                    resultByteSize = std::max(resultByteSize, group.resultByteSize);
+                    const auto& group = mBlasGroups[blasGroupIndex];
+                    uint64_t& size = resultByteSize[BlasBuildPlan::getResultBufferIndex(blasGroupIndex)];
+                    size = std::max(size, group.resultByteSize);
                     scratchByteSize = std::max(scratchByteSize, group.scratchByteSize);
                     maxBlasCount = std::max(maxBlasCount, group.blasIndices.size());
                 }
-                FALCOR_ASSERT(resultByteSize > 0 && scratchByteSize > 0);
+                FALCOR_ASSERT(resultByteSize[0] > 0 && scratchByteSize > 0);
 
-                logInfo("BLAS build result buffer size: {}", formatByteSize(resultByteSize));
+                logInfo("BLAS build result buffer size: {}", formatByteSize(resultByteSize[0] + resultByteSize[1]));
                 logInfo("BLAS build scratch buffer size: {}", formatByteSize(scratchByteSize));
 
                 // Allocate result and scratch buffers.
@@ -3584,43 +3965,57 @@ namespace Falcor
                     mpBlasScratch->setName("Scene::mpBlasScratch");
                 }
 
-                ref<Buffer> pResultBuffer = Buffer::create(mpDevice, resultByteSize, Buffer::BindFlags::AccelerationStructure, Buffer::CpuAccess::None);
-                FALCOR_ASSERT(pResultBuffer && mpBlasScratch);
-
-                // Create post-build info pool for readback.
-                RtAccelerationStructurePostBuildInfoPool::Desc compactedSizeInfoPoolDesc;
-                compactedSizeInfoPoolDesc.queryType = RtAccelerationStructurePostBuildInfoQueryType::CompactedSize;
-                compactedSizeInfoPoolDesc.elementCount = (uint32_t)maxBlasCount;
-                ref<RtAccelerationStructurePostBuildInfoPool> compactedSizeInfoPool = RtAccelerationStructurePostBuildInfoPool::create(mpDevice.get(), compactedSizeInfoPoolDesc);
-
-                RtAccelerationStructurePostBuildInfoPool::Desc currentSizeInfoPoolDesc;
-                currentSizeInfoPoolDesc.queryType = RtAccelerationStructurePostBuildInfoQueryType::CurrentSize;
-                currentSizeInfoPoolDesc.elementCount = (uint32_t)maxBlasCount;
-                ref<RtAccelerationStructurePostBuildInfoPool> currentSizeInfoPool = RtAccelerationStructurePostBuildInfoPool::create(mpDevice.get(), currentSizeInfoPoolDesc);
+                // Per result buffer state. Each group keeps its intermediate BLASes and post-build info until it is compacted.
+                struct GroupBuildState
+                {
+                    ref<Buffer> pResultBuffer;
+                    ref<RtAccelerationStructurePostBuildInfoPool> compactedSizeInfoPool;
+                    ref<RtAccelerationStructurePostBuildInfoPool> currentSizeInfoPool;
+                    std::vector<ref<RtAccelerationStructure>> intermediateBlases;
+                };
+                GroupBuildState states[2];
+
+                for (uint32_t i = 0; i < 2; i++)
+                {
+                    if (resultByteSize[i] == 0) continue;
+                    states[i].pResultBuffer = Buffer::create(mpDevice, resultByteSize[i], Buffer::BindFlags::AccelerationStructure, Buffer::CpuAccess::None);
+                    FALCOR_ASSERT(states[i].pResultBuffer);
+
+                    // Create post-build info pools for readback.
+                    RtAccelerationStructurePostBuildInfoPool::Desc compactedSizeInfoPoolDesc;
+                    compactedSizeInfoPoolDesc.queryType = RtAccelerationStructurePostBuildInfoQueryType::CompactedSize;
+                    compactedSizeInfoPoolDesc.elementCount = (uint32_t)maxBlasCount;
+                    states[i].compactedSizeInfoPool = RtAccelerationStructurePostBuildInfoPool::create(mpDevice.get(), compactedSizeInfoPoolDesc);
+
+                    RtAccelerationStructurePostBuildInfoPool::Desc currentSizeInfoPoolDesc;
+                    currentSizeInfoPoolDesc.queryType = RtAccelerationStructurePostBuildInfoQueryType::CurrentSize;
+                    currentSizeInfoPoolDesc.elementCount = (uint32_t)maxBlasCount;
+                    states[i].currentSizeInfoPool = RtAccelerationStructurePostBuildInfoPool::create(mpDevice.get(), currentSizeInfoPoolDesc);
+                }
 
                 bool hasDynamicGeometry = false;
                 bool hasProceduralPrimitives = false;
 
                 mBlasObjects.resize(mBlasData.size());
 
-                // Iterate over BLAS groups. For each group build and compact all BLASes.
-                for (size_t blasGroupIndex = 0; blasGroupIndex < mBlasGroups.size(); blasGroupIndex++)
+                // Build all BLASes of a group into the intermediate result buffer.
+                // We output post-build info in order to find out the final size requirements.
+                auto buildGroup = [&](size_t blasGroupIndex)
                 {
-                    auto& group = mBlasGroups[blasGroupIndex];
+                    const auto& group = mBlasGroups[blasGroupIndex];
+                    auto& state = states[BlasBuildPlan::getResultBufferIndex(blasGroupIndex)];
 
                     // Allocate array to hold intermediate blases for the group.
-                    std::vector<ref<RtAccelerationStructure>> intermediateBlases(group.blasIndices.size());
+                    state.intermediateBlases.assign(group.blasIndices.size(), nullptr);
 
                     // Insert barriers. The buffers are now ready to be written.
-                    pRenderContext->uavBarrier(pResultBuffer.get());
+                    pRenderContext->uavBarrier(state.pResultBuffer.get());
                     pRenderContext->uavBarrier(mpBlasScratch.get());
 
                     // Reset the post-build info pools to receive new info.
-                    compactedSizeInfoPool->reset(pRenderContext);
-                    currentSizeInfoPool->reset(pRenderContext);
+                    state.compactedSizeInfoPool->reset(pRenderContext);
+                    state.currentSizeInfoPool->reset(pRenderContext);
 
-                    // Build the BLASes into the intermediate result buffer.
-                    // We output post-build info in order to find out the final size requirements.
                     for (size_t i = 0; i < group.blasIndices.size(); ++i)
                     {
                         const uint32_t blasId = group.blasIndices[i];
@@ -3630,10 +4025,10 @@ namespace Falcor
                         hasProceduralPrimitives |= blas.hasProceduralPrimitives;
 
                         RtAccelerationStructure::Desc createDesc = {};
-                        createDesc.setBuffer(pResultBuffer, blas.resultByteOffset, blas.resultByteSize);
+                        createDesc.setBuffer(state.pResultBuffer, blas.resultByteOffset, blas.resultByteSize);
                         createDesc.setKind(RtAccelerationStructureKind::BottomLevel);
                         auto blasObject = RtAccelerationStructure::create(mpDevice, createDesc);
-                        intermediateBlases[i] = blasObject;
+                        state.intermediateBlases[i] = blasObject;
 
                         RtAccelerationStructure::BuildDesc asDesc = {};
                         asDesc.inputs = blas.buildInputs;
@@ -3646,20 +4041,33 @@ namespace Falcor
                         {
                             postbuildInfoDesc.type = RtAccelerationStructurePostBuildInfoQueryType::CompactedSize;
                             postbuildInfoDesc.index = (uint32_t)i;
-                            postbuildInfoDesc.pool = compactedSizeInfoPool.get();
+                            postbuildInfoDesc.pool = state.compactedSizeInfoPool.get();
                         }
                         else
                         {
                             postbuildInfoDesc.type = RtAccelerationStructurePostBuildInfoQueryType::CurrentSize;
                             postbuildInfoDesc.index = (uint32_t)i;
-                            postbuildInfoDesc.pool = currentSizeInfoPool.get();
+                            postbuildInfoDesc.pool = state.currentSizeInfoPool.get();
                         }
 
                         pRenderContext->buildAccelerationStructure(asDesc, 1, &postbuildInfoDesc);
                     }
 
-                    // Read back the calculated final size requirements for each BLAS.
+                    // Submit the build without waiting, so the post-build info can be read back once this group is done.
+                    state.compactedSizeInfoPool->submit(pRenderContext);
+                    state.currentSizeInfoPool->submit(pRenderContext);
+                };
 
+                // Read back the final sizes of a group and compact/clone its BLASes to their final location.
+                uint64_t finalByteSize = 0;
+                uint64_t peakByteSize = 0;
+                auto compactGroup = [&](size_t blasGroupIndex)
+                {
+                    auto& group = mBlasGroups[blasGroupIndex];
+                    auto& state = states[BlasBuildPlan::getResultBufferIndex(blasGroupIndex)];
+
+                    // Read back the calculated final size requirements for each BLAS.
+                    // This only waits for the build of this group. The build of the next group keeps running on the GPU.
                     group.finalByteSize = 0;
                     for (size_t i = 0; i < group.blasIndices.size(); i++)
                     {
@@ -3670,11 +4078,11 @@ namespace Falcor
                         uint64_t byteSize = 0;
                         if (blas.useCompaction)
                         {
-                            byteSize = compactedSizeInfoPool->getElement(pRenderContext, (uint32_t)i);
+                            byteSize = state.compactedSizeInfoPool->getElement(pRenderContext, (uint32_t)i);
                         }
                         else
                         {
-                            byteSize = currentSizeInfoPool->getElement(pRenderContext, (uint32_t)i);
+                            byteSize = state.currentSizeInfoPool->getElement(pRenderContext, (uint32_t)i);
                             // For platforms that does not support current size query, use prebuild size.
                             if (byteSize == 0)
                             {
@@ -3705,9 +4113,12 @@ namespace Falcor
                         pRenderContext->uavBarrier(pBlas.get());
                     }
 
+                    // Track the memory high-water mark. The final buffers accumulate next to the intermediate buffers.
+                    finalByteSize += pBlas->getSize();
+                    peakByteSize = std::max(peakByteSize, finalByteSize + resultByteSize[0] + resultByteSize[1] + scratchByteSize);
+
                     // Insert barrier. The result buffer is now ready to be consumed.
-                    // TOOD: This is probably not necessary since we flushed above, but it's not going to hurt.
-                    pRenderContext->uavBarrier(pResultBuffer.get());
+                    pRenderContext->uavBarrier(state.pResultBuffer.get());
 
                     // Compact/clone all BLASes to their final location.
                     for (size_t i = 0; i < group.blasIndices.size(); ++i)
@@ -3722,13 +4133,25 @@ namespace Falcor
 
                         pRenderContext->copyAccelerationStructure(
                             mBlasObjects[blasId].get(),
-                            intermediateBlases[i].get(),
+                            state.intermediateBlases[i].get(),
                             blas.useCompaction ? RenderContext::RtAccelerationStructureCopyMode::Compact : RenderContext::RtAccelerationStructureCopyMode::Clone);
                     }
 
                     // Insert barrier. The BLAS buffer is now ready for use.
                     pRenderContext->uavBarrier(pBlas.get());
+                };
+
+                // Iterate over BLAS groups. Each group is compacted after the next group has been submitted for building,
+                // so the GPU builds group N+1 while the sizes of group N are read back and its compaction is recorded.
+                for (size_t blasGroupIndex = 0; blasGroupIndex < mBlasGroups.size(); blasGroupIndex++)
+                {
+                    buildGroup(blasGroupIndex);
+                    if (blasGroupIndex > 0) compactGroup(blasGroupIndex - 1);
                 }
+                compactGroup(mBlasGroups.size() - 1);
+
+
+                logInfo("BLAS build peak memory: {}", formatByteSize(peakByteSize));
 
                 // Release scratch buffer if there is no animated content. We will not need it.
                 if (!hasDynamicGeometry && !hasProceduralPrimitives) mpBlasScratch.reset();
@@ -3800,9 +4223,10 @@ namespace Falcor
         }
     }
 
-    void Scene::fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, uint32_t rayTypeCount, bool perMeshHitEntry) const
+    void Scene::fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, std::vector<uint32_t>& matrixIDs, uint32_t rayTypeCount, bool perMeshHitEntry) const
     {
         instanceDescs.clear();
+        matrixIDs.clear();
         uint32_t instanceContributionToHitGroupIndex = 0;
         uint32_t instanceID = 0;
 
@@ -3867,11 +4291,12 @@ namespace Falcor
                 instanceID += (uint32_t)meshList.size();
 
                 float4x4 transform4x4 = float4x4::identity();
+                uint32_t matrixId = kIdentityMatrixID;
                 if (!isStatic)
                 {
                     // For non-static meshes, the matrices for all meshes in an instance are guaranteed to be the same.
                     // Just pick the matrix from the first mesh.
-                    const uint32_t matrixId = mGeometryInstanceData[desc.instanceID].globalMatrixID;
+                    matrixId = mGeometryInstanceData[desc.instanceID].globalMatrixID;
                     transform4x4 = mpAnimationController->getGlobalMatrices()[matrixId];
 
                     // Verify that all meshes have matching tranforms.
@@ -3890,6 +4315,7 @@ namespace Falcor
                 }
 
                 instanceDescs.push_back(desc);
+                matrixIDs.push_back(matrixId);
             }
         }
 
@@ -3931,6 +4357,7 @@ namespace Falcor
             }
 
             instanceDescs.push_back(desc);
+            matrixIDs.push_back(matrixId);
         }
 
         // One instance per SDF grid instance.
@@ -3974,6 +4401,7 @@ namespace Falcor
                 FALCOR_ASSERT(0 == instance.geometryIndex);
 
                 instanceDescs.push_back(desc);
+                matrixIDs.push_back(instance.globalMatrixID);
             }
 
             blasDataIndex += (sdfGridInstancesHaveUniqueBLASes ? mSDFGrids.size() : 1);
@@ -4001,7 +4429,10 @@ namespace Falcor
             float4x4 identityMat = float4x4::identity();
             std::memcpy(desc.transform, &identityMat, sizeof(desc.transform));
             instanceDescs.push_back(desc);
+            matrixIDs.push_back(kIdentityMatrixID);
         }
+
+        FALCOR_ASSERT(matrixIDs.size() == instanceDescs.size());
     }
 
     void Scene::invalidateTlasCache()
@@ -4009,6 +4440,29 @@ namespace Falcor
         for (auto& tlas : mTlasCache)
         {
             tlas.second.pTlasObject = nullptr;
+            tlas.second.instanceDescsValid = false;
+        }
+    }
+
+    void Scene::updateTlasInstanceTransforms()
+    {
+        const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
+
+        for (auto& [rayTypeCount, tlas] : mTlasCache)
+        {
+            tlas.pTlasObject = nullptr;
+            if (!tlas.instanceDescsValid) continue;
+
+            // Several geometry instances can share an instance desc. Setting the same transform again doesn't mark it dirty.
+            // Moved skinned instances whose transform didn't change are skipped the same way.
+            for (uint32_t instanceID : mMovedInstances)
+            {
+                const uint32_t descIndex = mGeometryInstanceData[instanceID].instanceIndex;
+                FALCOR_ASSERT(descIndex < mInstanceDescMatrixIDs.size());
+                const uint32_t matrixID = mInstanceDescMatrixIDs[descIndex];
+                if (matrixID == kIdentityMatrixID) continue;
+                tlas.instanceDescs.setTransform(descIndex, globalMatrices[matrixID]);
+            }
         }
     }
 
@@ -4016,17 +4470,23 @@ namespace Falcor
     {
         FALCOR_PROFILE(pRenderContext, "buildTlas");
 
-        TlasData tlas;
-        auto it = mTlasCache.find(rayTypeCount);
-        if (it != mTlasCache.end()) tlas = it->second;
+        // Update the cached entry in place, so the CPU copy of the instance descs isn't copied.
+        TlasData& tlas = mTlasCache[rayTypeCount];
 
         // Prepare instance descs.
         // Note if there are no instances, we'll build an empty TLAS.
-        fillInstanceDesc(mInstanceDescs, rayTypeCount, perMeshHitEntry);
+        // If only instances moved since the last build, the cached descs were already updated and only the changed ones are uploaded.
+        if (!tlas.instanceDescsValid)
+        {
+            fillInstanceDesc(mInstanceDescs, mInstanceDescMatrixIDs, rayTypeCount, perMeshHitEntry);
+            tlas.instanceDescs.update(mInstanceDescs);
+            tlas.instanceDescsValid = true;
+        }
+        const auto& instanceDescs = tlas.instanceDescs.getDescs();
 
         RtAccelerationStructureBuildInputs inputs = {};
         inputs.kind = RtAccelerationStructureKind::TopLevel;
-        inputs.descCount = (uint32_t)mInstanceDescs.size();
+        inputs.descCount = (uint32_t)instanceDescs.size();
         inputs.flags = RtAccelerationStructureBuildFlags::None;
 
         // Add build flags for dynamic scenes if TLAS should be updating instead of rebuilt
@@ -4067,17 +4527,15 @@ namespace Falcor
                     tlas.pTlasBuffer->setName("Scene TLAS buffer");
                 }
             }
-            if (!mInstanceDescs.empty())
+            if (!instanceDescs.empty())
             {
                 // Allocate a new buffer for the TLAS instance desc input only if the existing buffer isn't big enough.
-                if (!tlas.pInstanceDescs || tlas.pInstanceDescs->getSize() < mInstanceDescs.size() * sizeof(RtInstanceDesc))
+                // The buffer lives in GPU memory, so its contents persist between partial uploads.
+                if (!tlas.pInstanceDescs || tlas.pInstanceDescs->getSize() < instanceDescs.size() * sizeof(RtInstanceDesc))
                 {
-                    tlas.pInstanceDescs = Buffer::create(mpDevice, (uint32_t)mInstanceDescs.size() * sizeof(RtInstanceDesc), Buffer::BindFlags::None, Buffer::CpuAccess::Write, mInstanceDescs.data());
+                    tlas.pInstanceDescs = Buffer::create(mpDevice, (uint32_t)instanceDescs.size() * sizeof(RtInstanceDesc), Buffer::BindFlags::None, Buffer::CpuAccess::None, instanceDescs.data());
                     tlas.pInstanceDescs->setName("Scene instance descs buffer");
-                }
-                else
-                {
-                    tlas.pInstanceDescs->setBlob(mInstanceDescs.data(), 0, mInstanceDescs.size() * sizeof(RtInstanceDesc));
+                    tlas.instanceDescs.collectDirtyRanges();
                 }
             }
 
@@ -4092,12 +4550,17 @@ namespace Falcor
             FALCOR_ASSERT(mpAnimationController->hasAnimations() || mpAnimationController->hasAnimatedVertexCaches());
             pRenderContext->uavBarrier(tlas.pTlasBuffer.get());
             pRenderContext->uavBarrier(mpTlasScratch.get());
-            if (tlas.pInstanceDescs)
+            asDesc.source = tlas.pTlasObject.get(); // Perform the update in-place
+        }
+
+        // Upload the instance descs that changed since the last build.
+        if (tlas.pInstanceDescs)
+        {
+            for (const auto& range : tlas.instanceDescs.collectDirtyRanges())
             {
-                FALCOR_ASSERT(!mInstanceDescs.empty());
-                tlas.pInstanceDescs->setBlob(mInstanceDescs.data(), 0, inputs.descCount * sizeof(RtInstanceDesc));
+                const size_t offset = range.begin * sizeof(RtInstanceDesc);
+                pRenderContext->updateBuffer(tlas.pInstanceDescs.get(), instanceDescs.data() + range.begin, offset, (range.end - range.begin) * sizeof(RtInstanceDesc));
             }
-            asDesc.source = tlas.pTlasObject.get(); // Perform the update in-place
         }
 
         FALCOR_ASSERT(tlas.pTlasBuffer && tlas.pTlasBuffer->getGfxResource() && mpTlasScratch->getGfxResource());
@@ -4121,7 +4584,6 @@ namespace Falcor
         pRenderContext->buildAccelerationStructure(asDesc, 0, nullptr);
         pRenderContext->uavBarrier(tlas.pTlasBuffer.get());
 
-        mTlasCache[rayTypeCount] = tlas;
         updateRaytracingTLASStats();
     }
 
@@ -4449,6 +4911,8 @@ namespace Falcor
         d["materialCount"] = stats.materials.materialCount;
         d["materialOpaqueCount"] = stats.materials.materialOpaqueCount;
         d["materialMemoryInBytes"] = stats.materials.materialMemoryInBytes;
+        d["materialDuplicateCount"] = stats.materials.materialDuplicateCount;
+        d["materialDuplicateRemovalTime"] = stats.materials.materialDuplicateRemovalTime;
         d["textureCount"] = stats.materials.textureCount;
         d["textureCompressedCount"] = stats.materials.textureCompressedCount;
         d["textureTexelCount"] = stats.materials.textureTexelCount;
@@ -4467,6 +4931,9 @@ namespace Falcor
         d["tlasCount"] = stats.tlasCount;
         d["tlasMemoryInBytes"] = stats.tlasMemoryInBytes;
         d["tlasScratchMemoryInBytes"] = stats.tlasScratchMemoryInBytes;
+        d["tlasInstanceDescCount"] = stats.tlasInstanceDescCount;
+        d["tlasInstanceDescUpdatedCount"] = stats.tlasInstanceDescUpdatedCount;
+        d["tlasInstanceDescUploadedCount"] = stats.tlasInstanceDescUploadedCount;
 
         // Light stats
         d["activeLightCount"] = stats.activeLightCount;
@@ -30,8 +30,11 @@
 #include "SceneTypes.slang"
 #include "HitInfo.h"
 #include "FrustumCulling.h"
+#include "OcclusionCulling.h"
+#include "TlasInstanceDescs.h"
 #include "Animation/Animation.h"
 #include "Animation/AnimationController.h"
+#include "Animation/SkinnedMeshBounds.h"
 #include "Displacement/DisplacementUpdateTask.slang"
 #include "Lights/Light.h"
 #include "Lights/LightCollection.h"
@@ -50,6 +53,7 @@
 #include "Core/API/RtAccelerationStructure.h"
 #include "Core/API/GpuFence.h"
 #include "Utils/Math/AABB.h"
+#include "Utils/Algorithm/AABBReductionTree.h"
 #include "Utils/Math/Rectangle.h"
 #include "Utils/Math/Vector.h"
 #include "Utils/Math/Matrix.h"
@@ -333,6 +337,8 @@ namespace Falcor
             uint32_t prevVertexCount = 0;                           ///< Number of vertices that the AnimationController needs to allocate to store previous frame vertices.
 
             bool useCompressedHitInfo = false;                      ///< True if scene should used compressed HitInfo (on scenes with triangles meshes only).
+            bool useCompactVertexData = false;                      ///< True if the vertices of static meshes are stored in the compact format.
+            uint32_t compactVertexOffset = 0;                       ///< Index of the first static mesh vertex in 'meshStaticData' if compact vertex data is used. Dynamic mesh vertices are stored before it.
             bool has16BitIndices = false;                           ///< True if 16-bit mesh indices are used.
             bool has32BitIndices = false;                           ///< True if 32-bit mesh indices are used.
             uint32_t meshDrawCount = 0;                             ///< Number of meshes to draw.
@@ -413,6 +419,9 @@ namespace Falcor
             uint64_t tlasCount = 0;                     ///< Number of TLASes.
             uint64_t tlasMemoryInBytes = 0;             ///< Total memory in bytes used by the TLASes.
             uint64_t tlasScratchMemoryInBytes = 0;      ///< Additional memory in bytes kept around for TLAS updates etc.
+            uint64_t tlasInstanceDescCount = 0;         ///< Number of instance descs in all TLASes.
+            uint64_t tlasInstanceDescUpdatedCount = 0;  ///< Number of instance descs rewritten in the last build of each TLAS.
+            uint64_t tlasInstanceDescUploadedCount = 0; ///< Number of instance descs uploaded in the last build of each TLAS, including unchanged descs between nearby changes.
 
             // Light stats
             uint64_t activeLightCount = 0;              ///< Number of active lights.
@@ -717,6 +726,10 @@ namespace Falcor
         */
         const MeshDesc& getMesh(MeshID meshID) const { return mMeshDesc[meshID.get()]; }
 
+        /** Get the mesh groups. Each group maps to a BLAS for ray tracing.
+        */
+        const std::vector<MeshGroup>& getMeshGroups() const { return mMeshGroups; }
+
         /** Get the number of curves.
         */
         uint32_t getCurveCount() const { return (uint32_t)mCurveDesc.size(); }
@@ -997,6 +1010,7 @@ namespace Falcor
            \param[in] cullMode Optional rasterizer cull mode. The default is to cull back-facing primitives.
            \param[in] meshRenderMode Specifies which meshes should be rasterized
            \param[in] Frustum Culling Object. When null, it will be generated from the current selected camera
+           \param[in] pOcclusionCulling Optional CPU occlusion culling. When set, the scene's occluders are rasterized into it with the view-projection of the frustum and hidden instances are not drawn.
        */
         void rasterizeFrustumCulling(RenderContext* pRenderContext,
                                      GraphicsState* pState,
@@ -1004,7 +1018,8 @@ namespace Falcor
                                      RasterizerState::CullMode cullMode = RasterizerState::CullMode::Back,
                                      RasterizerState::MeshRenderMode meshRenderMode = RasterizerState::MeshRenderMode::All,
                                      bool drawShadowThrowable = true,
-                                     ref<FrustumCulling> pFrustumCulling = nullptr
+                                     ref<FrustumCulling> pFrustumCulling = nullptr,
+                                     ref<OcclusionCulling> pOcclusionCulling = nullptr
         );
 
         /** Render the scene using the rasterizer and frustumCulling
@@ -1017,6 +1032,7 @@ namespace Falcor
             \param[in] pRasterizerStateDS Rasterizer state for double sided meshes. Same as Cull mode None.
             \param[in] meshRenderMode Specifies which meshes should be rasterized
             \param[in] Frustum Culling Object. When null, it will be generated from the current selected camera
+            \param[in] pOcclusionCulling Optional CPU occlusion culling. When set, the scene's occluders are rasterized into it with the view-projection of the frustum and hidden instances are not drawn.
         */
         void rasterizeFrustumCulling(
             RenderContext* pRenderContext,
@@ -1027,7 +1043,8 @@ namespace Falcor
             const ref<RasterizerState>& pRasterizerStateDS,
             RasterizerState::MeshRenderMode meshRenderMode = RasterizerState::MeshRenderMode::All,
             bool drawShadowThrowable = true,
-            ref<FrustumCulling> pFrustumCulling = nullptr
+            ref<FrustumCulling> pFrustumCulling = nullptr,
+            ref<OcclusionCulling> pOcclusionCulling = nullptr
         );
 
 
@@ -1182,6 +1199,8 @@ namespace Falcor
 
         void createMeshVao(uint32_t drawCount, const std::vector<uint32_t>& indexData, const std::vector<PackedStaticVertexData>& staticData, const std::vector<SkinningVertexData>& skinningData);
         void createCurveVao(const std::vector<uint32_t>& indexData, const std::vector<StaticCurveVertexData>& staticData);
+        const ref<Vao>& getDrawVao(ResourceFormat ibFormat, bool isDynamic) const;
+        uint32_t getDrawVertexOffset(const MeshDesc& mesh) const;
         void createMeshUVTiles(const std::vector<MeshDesc>& meshDesc, const std::vector<uint32_t>& indexData, const std::vector<PackedStaticVertexData>& staticData);
 
         void updateSceneDefines();
@@ -1207,14 +1226,49 @@ namespace Falcor
         */
         void uploadSelectedCamera();
 
+        /** Create the mapping from global matrices to the geometry instances using them.
+        */
+        void createMatrixInstanceMapping();
+
+        /** Collect the geometry instances whose transform changed in the last animation update into mMovedInstances.
+            \return True if any instance moved.
+        */
+        bool collectMovedInstances();
+
         /** Update the scene's global bounding box.
+            \param[in] forceUpdate Recompute the bounds of all instances. Otherwise only the bounds of moved instances are updated.
         */
-        void updateBounds();
+        void updateBounds(bool forceUpdate);
 
         /** Update geometry instances.
+            \param[in] forceUpdate Update and upload all instances. Otherwise only moved instances are updated and only changed ranges are uploaded.
         */
         void updateGeometryInstances(bool forceUpdate);
 
+        /** Create the bounding boxes used for frustum culling the geometry instances.
+        */
+        void createCullingBounds();
+
+        /** Compute the per-bone bounds of the skinned meshes and collect the skinned instances.
+        */
+        void createSkinnedMeshBounds(const std::vector<SkinningVertexData>& skinningData, const std::vector<PackedStaticVertexData>& staticData);
+
+        /** Update the world space bounds of all skinned instances from the current bone matrices.
+            The instances whose bounds changed are added to mMovedInstances.
+            \return True if the bounds of any skinned instance changed.
+        */
+        bool updateSkinnedInstanceBounds();
+
+        /** Keep CPU copies of the meshes used as occluders for occlusion culling and collect their instances.
+        */
+        void createOccluders(const std::vector<uint32_t>& indexData, const std::vector<PackedStaticVertexData>& staticData);
+
+        /** Rasterize the occluders in the frustum into the occlusion culling depth buffer.
+            \param[in] occlusionCulling Occlusion culling to rasterize into.
+            \param[in] viewProj View-projection matrix of the frustum.
+        */
+        void rasterizeOccluders(OcclusionCulling& occlusionCulling, const float4x4& viewProj);
+
         /** Update geometry type flags.
         */
         void updateGeometryTypes();
@@ -1245,8 +1299,10 @@ namespace Falcor
 
         /** Generate data for creating a TLAS.
             #SCENE TODO: Add argument to build descs based off a draw list.
+            \param[out] instanceDescs Instance descs.
+            \param[out] matrixIDs Global matrix ID that the transform of each instance desc is taken from, or -1 for identity transforms.
         */
-        void fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, uint32_t rayTypeCount, bool perMeshHitEntry) const;
+        void fillInstanceDesc(std::vector<RtInstanceDesc>& instanceDescs, std::vector<uint32_t>& matrixIDs, uint32_t rayTypeCount, bool perMeshHitEntry) const;
 
         /** Generate top level acceleration structure for the scene. Automatically determines whether to build or refit.
             \param[in] rayCount Number of ray types in the shader. Required to setup how instances index into the Shader Table.
@@ -1257,6 +1313,11 @@ namespace Falcor
         */
         void invalidateTlasCache();
 
+        /** Update the transforms of the moved instances in the cached instance descs and mark the TLASes for rebuild.
+            Only the instance descs that actually changed are uploaded on the next TLAS build.
+        */
+        void updateTlasInstanceTransforms();
+
         /** Check whether scene has an index buffer.
         */
         bool hasIndexBuffer() const { return mpMeshVao && mpMeshVao->getIndexBuffer() != nullptr; }
@@ -1315,22 +1376,40 @@ namespace Falcor
         GeometryTypeFlags mGeometryTypes;                           ///< Set of geometry types that exist in the scene.
 
         std::vector<GeometryInstanceData> mGeometryInstanceData;    ///< Geometry instance data (for all types of geometry).
+        std::vector<uint32_t> mMatrixInstanceOffsets;               ///< Offset of the first instance of each global matrix in mMatrixInstances, followed by the total count.
+        std::vector<uint32_t> mMatrixInstances;                     ///< Geometry instance IDs grouped by global matrix ID.
+        std::vector<uint32_t> mMovedInstances;                      ///< Geometry instances whose transform changed in the current update, in ascending order.
 
         bool mUseCompressedHitInfo = false;                         ///< True if scene should used compressed HitInfo (on scenes with triangles meshes only).
+        bool mUseCompactVertexData = false;                         ///< True if the vertices of static meshes are stored in the compact format.
+        uint32_t mCompactVertexOffset = 0;                          ///< Global index of the first vertex stored in the compact format. Vertices before it are stored at full precision.
         bool mHas16BitIndices = false;                              ///< True if any meshes use 16-bit indices.
         bool mHas32BitIndices = false;                              ///< True if any meshes use 32-bit indices.
 
         ref<Vao> mpMeshVao;                                         ///< Vertex array object for the global mesh vertex/index buffers.
         ref<Vao> mpMeshVao16Bit;                                    ///< VAO for drawing meshes with 16-bit vertex indices.
+        ref<Vao> mpCompactMeshVao;                                  ///< VAO for drawing static meshes with compact vertex data. Only created if mUseCompactVertexData is set.
+        ref<Vao> mpCompactMeshVao16Bit;                             ///< VAO for drawing static meshes with compact vertex data and 16-bit vertex indices.
         ref<Vao> mpCurveVao;                                        ///< Vertex array object for the global curve vertex/index buffers.
         std::vector<DrawArgs> mDrawArgs;                            ///< List of draw arguments for rasterizing the meshes in the scene.
 
         //Frustum Culling
         std::vector<std::vector<uint>> mDrawArgsInstanceIDs;        ///< List of draw instance ids fitting to the mDrawArgs
         ref<FrustumCulling> mpCameraCulling = nullptr;              ///< Culling for the camera
+        FrustumCullingBounds mCullingBounds;                        ///< World space bounds of all geometry instances for frustum culling.
+        std::vector<uint8_t> mCullingVisibility;                    ///< Frustum culling result per geometry instance.
         uint mFrustumCullingSelectedCamera = 0;                     ///< Selected Camera for Frustum Culling
         bool mFrustumCullingUpdated = false;                        ///< Records if culling was updated this frame
 
+        struct OccluderMesh
+        {
+            std::vector<float3> positions;                          ///< Object space vertex positions.
+            std::vector<uint32_t> indices;                          ///< Vertex indices, empty if the mesh is not an occluder.
+        };
+        std::vector<OccluderMesh> mOccluderMeshes;                  ///< CPU copy of the occluder geometry per mesh ID.
+        std::vector<uint32_t> mOccluderInstances;                   ///< Sorted IDs of the instances of occluder meshes.
+        bool mOccludersMoved = false;                               ///< True if an occluder instance moved this frame.
+
         //GPU CPU per frame sync
         ref<GpuFence> mpFence;                                      ///< Fence for GPU/CPU sync. Will record the GPU Counter once per update
         uint mFenceSyncLastFrame = 0;                               ///< Sync value for last frame
@@ -1398,6 +1477,11 @@ namespace Falcor
         std::vector<std::vector<uint32_t>> mCurveIdToInstanceIds;   ///< Mapping of what instances belong to which curve.
         HitInfo mHitInfo;                                           ///< Geometry hit info requirements.
         AABB mSceneBB;                                              ///< Bounding boxes of the entire scene in world space.
+        AABBReductionTree mInstanceBounds;                          ///< World space bounds of all geometry instances, indexed by instance ID.
+        SkinnedMeshBounds mSkinnedMeshBounds;                       ///< Per-bone bind pose bounds of the skinned meshes.
+        std::vector<uint32_t> mSkinnedInstances;                    ///< Sorted IDs of the skinned mesh instances.
+        std::vector<uint32_t> mSkinnedInstanceMeshes;               ///< Mesh index in mSkinnedMeshBounds per skinned instance.
+        std::vector<AABB> mSkinnedInstanceBounds;                   ///< World space bounds in the current pose per skinned instance.
         SceneStats mSceneStats;                                     ///< Scene statistics.
         Metadata mMetadata;                                         ///< Importer-provided metadata.
         RenderSettings mRenderSettings;                             ///< Render settings.
@@ -1453,12 +1537,15 @@ namespace Falcor
         UpdateMode mBlasUpdateMode = UpdateMode::Refit;     ///< How the BLAS should be updated when there are changes to meshes.
 
         std::vector<RtInstanceDesc> mInstanceDescs;         ///< Shared between TLAS builds to avoid reallocating CPU memory.
+        std::vector<uint32_t> mInstanceDescMatrixIDs;       ///< Global matrix ID per instance desc, or -1 for identity transforms. Same for all TLASes.
 
         struct TlasData
         {
             ref<RtAccelerationStructure> pTlasObject;
             ref<Buffer> pTlasBuffer;
             ref<Buffer> pInstanceDescs;                     ///< Buffer holding instance descs for the TLAS.
+            TlasInstanceDescs instanceDescs;                ///< CPU copy of the instance descs. Only the dirty descs are uploaded.
+            bool instanceDescsValid = false;                ///< False if the instance descs need to be regenerated, e.g. after the BLASes changed.
             UpdateMode updateMode = UpdateMode::Rebuild;    ///< Update mode this TLAS was created with.
         };
 
@@ -32,7 +32,12 @@
 #include "Material/StandardMaterial.h"
 #include "Utils/Logger.h"
 #include "Utils/Math/Common.h"
+#include "Utils/Math/FNVHash.h"
 #include "Utils/Image/TextureAnalyzer.h"
+#include "Utils/Algorithm/BinnedSAH.h"
+#include "Utils/Algorithm/TaskGraph.h"
+#include "Utils/Geometry/VertexCacheOptimizer.h"
+#include "Utils/Threading.h"
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Utils/Math/MathHelpers.h"
@@ -40,6 +45,9 @@
 #include <mikktspace.h>
 #include <filesystem>
 #include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace Falcor
 {
@@ -47,8 +55,22 @@ namespace Falcor
     {
         // Large mesh groups are split in order to reduce the size of the largest BLAS.
         // The target is max 16M triangles per BLAS (= approx 0.5GB post-compaction). Note that this is not a strict limit.
+        // The limit can be overridden with the 'sceneBuilder:maxTrianglesPerBLAS' setting.
         const size_t kMaxTrianglesPerBLAS = 1ull << 24;
 
+        // Parameters for the SAH mesh group partitioning.
+        const uint32_t kSAHBinCount = 32;
+        const float kSAHOverlapWeight = 1.f;
+        const size_t kSAHTrianglesPerTask = 1ull << 16;
+
+        enum class MeshGroupSplitPolicy
+        {
+            Simple,
+            Median,
+            Midpoint,
+            SAH,
+        };
+
         // Texture coordinates for textured emissive materials are quantized for performance reasons.
         // We'll log a warning if the maximum quantization error exceeds this value.
         const float kMaxTexelError = 0.5f;
@@ -175,6 +197,24 @@ namespace Falcor
             return true;
         }
 
+        // Returns the position used for vertex welding. If 'cellSize' is positive, the position is quantized to a grid cell.
+        float3 getWeldPosition(const float3& position, float cellSize)
+        {
+            float3 p = cellSize > 0.f ? floor(position / cellSize) : position;
+            return p + float3(0.f); // Map -0 to +0 so that both hash to the same key.
+        }
+
+        // Hash of the vertex fields that must match exactly for two vertices to be welded.
+        uint64_t hashWeldKey(const SceneBuilder::Mesh::Vertex& v, const float3& weldPosition)
+        {
+            FNVHash64 hash;
+            hash.insert(&weldPosition, sizeof(weldPosition));
+            hash.insert(&v.tangent.w, sizeof(v.tangent.w));
+            hash.insert(&v.curveRadius, sizeof(v.curveRadius));
+            hash.insert(&v.boneIDs, sizeof(v.boneIDs));
+            return hash.get();
+        }
+
         std::vector<uint32_t> compact16BitIndices(const std::vector<uint32_t>& indices)
         {
             if (indices.empty()) return {};
@@ -189,6 +229,31 @@ namespace Falcor
             return indexData;
         }
 
+        // Resources touched by the post-processing stages in getScene().
+        // Each stage declares which of these it reads and writes, stages without conflicts run concurrently.
+        namespace StageResource
+        {
+            enum : TaskGraph::ResourceMask
+            {
+                Materials       = 1ull << 0,    ///< Material system and material objects.
+                SceneGraph      = 1ull << 1,    ///< Scene graph nodes, node IDs of animatable objects and curve/SDF instance lists.
+                Meshes          = 1ull << 2,    ///< Mesh specs (including mesh instances) and cached mesh/curve references.
+                MeshGroups      = 1ull << 3,    ///< Mesh groups.
+                Curves          = 1ull << 4,    ///< Curve specs (excluding curve instances).
+                SDFGrids        = 1ull << 5,    ///< SDF grids, descriptors, instances and the SDF lists of scene graph nodes.
+                Volumes         = 1ull << 6,    ///< Grid volumes and the collected grids.
+                MeshBuffers     = 1ull << 7,    ///< Global mesh vertex/index buffers.
+                CurveBuffers    = 1ull << 8,    ///< Global curve vertex/index buffers.
+                SceneGraphData  = 1ull << 9,    ///< Runtime scene graph.
+                MeshData        = 1ull << 10,   ///< Runtime mesh descriptors and names.
+                MeshBounds      = 1ull << 11,   ///< Runtime mesh bounding boxes.
+                CurveData       = 1ull << 12,   ///< Runtime curve descriptors.
+                CurveBounds     = 1ull << 13,   ///< Runtime curve bounding boxes.
+                InstanceData    = 1ull << 14,   ///< Geometry instance data and TLAS instance indices.
+                MaterialIDMap   = 1ull << 15,   ///< Map from old to new material IDs after removing duplicate materials.
+            };
+        }
+
         SceneCache::Key computeSceneCacheKey(const std::filesystem::path& path, SceneBuilder::Flags buildFlags)
         {
             SceneBuilder::Flags cacheFlags = buildFlags & (~(SceneBuilder::Flags::UseCache | SceneBuilder::Flags::RebuildCache));
@@ -226,6 +291,7 @@ namespace Falcor
         bool useCache = is_set(flags, Flags::UseCache);
         bool rebuildCache = is_set(flags, Flags::RebuildCache);
         mWriteSceneCache = useCache || rebuildCache;
+        mReadSceneCacheFragments = useCache && !rebuildCache;
 
         // Try to load scene cache if supported, available and requested.
         if (useCache && !rebuildCache && SceneCache::hasValidCache(mSceneCacheKey))
@@ -252,6 +318,12 @@ namespace Falcor
 
     SceneBuilder::~SceneBuilder() {}
 
+    void SceneBuilder::addDependency(const std::filesystem::path& path)
+    {
+        std::filesystem::path fullPath;
+        if (mWriteSceneCache && findFileInDataDirectories(path, fullPath)) recordDependency(fullPath);
+    }
+
     void SceneBuilder::import(const std::filesystem::path& path, const pybind11::dict& dict)
     {
         logInfo("Importing scene: {}", path);
@@ -262,6 +334,7 @@ namespace Falcor
         }
 
         mSceneData.path = fullPath;
+        addDependency(fullPath);
         if (auto importer = Importer::create(getExtensionFromPath(fullPath)))
         {
             importer->importScene(fullPath, *this, dict);
@@ -308,58 +381,101 @@ namespace Falcor
             addMeshInstance(nodeID, meshID);
         }
 
+        // Report the vertex welding done while adding meshes.
+        if (mWeldInputVertexCount > 0)
+        {
+            uint64_t inputCount = mWeldInputVertexCount;
+            uint64_t outputCount = mWeldOutputVertexCount;
+            logInfo("Welded mesh vertices from {} to {} ({:.2f}x reduction).", inputCount, outputCount, (double)inputCount / std::max(outputCount, uint64_t(1)));
+        }
+
         // Post-process the scene data.
+        // The stages are declared in their serial order together with the data they read and write.
+        // Stages touching disjoint data (e.g. materials, curves, SDF grids and volumes vs. the triangle mesh pipeline)
+        // are executed concurrently, producing the same result as running them one after another.
         TimeReport timeReport;
-
-        // Prepare displacement maps. This either removes them (if requested in build flags)
-        // or makes sure that normal maps are removed if displacement is in use.
-        prepareDisplacementMaps();
-
-        prepareSceneGraph();
-        prepareMeshes();
-        removeUnusedMeshes();
-        flattenStaticMeshInstances();
-        pretransformStaticMeshes();
-        unifyTriangleWinding();
-        optimizeSceneGraph();
-        calculateMeshBoundingBoxes();
-        createMeshGroups();
-        optimizeGeometry();
-        sortMeshes();
-        createGlobalBuffers();
-        createCurveGlobalBuffers();
-        collectVolumeGrids();
-        removeDuplicateSDFGrids();
-
-        timeReport.measure("Post processing geometry");
-
-        optimizeMaterials();
-        removeDuplicateMaterials();
-        quantizeTexCoords();
-
-        timeReport.measure("Optimizing materials");
-
-        // Prepare scene resources.
-        createSceneGraph();
-        createMeshData();
-        createMeshBoundingBoxes();
-        createCurveData();
-        calculateCurveBoundingBoxes();
-
-        // Create instance data.
+        TaskGraph stages;
+        std::vector<MaterialID> materialIDMap;
         uint32_t tlasInstanceIndex = 0;
-        createMeshInstanceData(tlasInstanceIndex);
-        createCurveInstanceData(tlasInstanceIndex);
-        // Adjust instance indices of SDF grid instances.
-        for (auto& sdfInstanceData : mSceneData.sdfGridInstances) sdfInstanceData.instanceIndex = tlasInstanceIndex++;
+
+        {
+            namespace Res = StageResource;
+            auto addStage = [&](std::string name, TaskGraph::ResourceMask reads, TaskGraph::ResourceMask writes, std::function<void(void)> func)
+            {
+                stages.addTask(std::move(name), reads, writes, std::move(func));
+            };
+
+            // Prepare displacement maps. This either removes them (if requested in build flags)
+            // or makes sure that normal maps are removed if displacement is in use.
+            addStage("prepareDisplacementMaps", 0, Res::Materials, [&]() { prepareDisplacementMaps(); });
+
+            addStage("prepareSceneGraph", Res::Meshes, Res::SceneGraph, [&]() { prepareSceneGraph(); });
+            addStage("prepareMeshes", 0, Res::Meshes, [&]() { prepareMeshes(); });
+            addStage("removeUnusedMeshes", 0, Res::Meshes | Res::SceneGraph, [&]() { removeUnusedMeshes(); });
+            addStage("instanceDuplicateMeshes", 0, Res::Meshes | Res::SceneGraph, [&]() { instanceDuplicateMeshes(); });
+            addStage("flattenStaticMeshInstances", 0, Res::Meshes | Res::SceneGraph, [&]() { flattenStaticMeshInstances(); });
+            addStage("pretransformStaticMeshes", 0, Res::Meshes | Res::SceneGraph, [&]() { pretransformStaticMeshes(); });
+            addStage("unifyTriangleWinding", 0, Res::Meshes, [&]() { unifyTriangleWinding(); });
+            addStage("optimizeSceneGraph", 0, Res::SceneGraph | Res::Meshes | Res::SDFGrids, [&]() { optimizeSceneGraph(); });
+            addStage("calculateMeshBoundingBoxes", 0, Res::Meshes, [&]() { calculateMeshBoundingBoxes(); });
+            addStage("createMeshGroups", Res::Materials | Res::SceneGraph, Res::Meshes | Res::MeshGroups, [&]() { createMeshGroups(); });
+            addStage("optimizeGeometry", 0, Res::Meshes | Res::MeshGroups | Res::SceneGraph, [&]() { optimizeGeometry(); });
+            addStage("optimizeVertexCache", 0, Res::Meshes, [&]() { optimizeVertexCache(); });
+            addStage("sortMeshes", 0, Res::Meshes | Res::MeshGroups, [&]() { sortMeshes(); });
+            addStage("createGlobalBuffers", 0, Res::Meshes | Res::MeshBuffers, [&]() { createGlobalBuffers(); });
+            addStage("createCurveGlobalBuffers", 0, Res::Curves | Res::CurveBuffers, [&]() { createCurveGlobalBuffers(); });
+            addStage("collectVolumeGrids", 0, Res::Volumes, [&]() { collectVolumeGrids(); });
+            addStage("removeDuplicateSDFGrids", 0, Res::SDFGrids, [&]() { removeDuplicateSDFGrids(); });
+
+            addStage("optimizeMaterials", 0, Res::Materials, [&]() { optimizeMaterials(); });
+            addStage("removeDuplicateMaterials", 0, Res::Materials | Res::MaterialIDMap, [&]() { removeDuplicateMaterials(materialIDMap); });
+            addStage("remapMaterialIDs", Res::MaterialIDMap, Res::Meshes | Res::Curves | Res::SDFGrids, [&]() { remapMaterialIDs(materialIDMap); });
+            addStage("quantizeTexCoords", Res::Materials | Res::Meshes, Res::MeshBuffers, [&]() { quantizeTexCoords(); });
+
+            // Prepare scene resources.
+            addStage("createSceneGraph", Res::SceneGraph, Res::SceneGraphData, [&]() { createSceneGraph(); });
+            addStage("createMeshData", Res::Meshes, Res::MeshData | Res::MeshBuffers, [&]() { createMeshData(); });
+            addStage("createMeshBoundingBoxes", Res::Meshes, Res::MeshBounds, [&]() { createMeshBoundingBoxes(); });
+            addStage("createCurveData", Res::Curves, Res::CurveData, [&]() { createCurveData(); });
+            addStage("calculateCurveBoundingBoxes", Res::Curves | Res::CurveBuffers, Res::CurveBounds, [&]() { calculateCurveBoundingBoxes(); });
+
+            // Create instance data.
+            addStage("createMeshInstanceData", Res::Meshes | Res::MeshGroups, Res::InstanceData, [&]() { createMeshInstanceData(tlasInstanceIndex); });
+            addStage("createCurveInstanceData", Res::Curves | Res::SceneGraph, Res::InstanceData, [&]() { createCurveInstanceData(tlasInstanceIndex); });
+            addStage("createSDFGridInstanceData", 0, Res::InstanceData | Res::SDFGrids, [&]()
+            {
+                // Adjust instance indices of SDF grid instances.
+                for (auto& sdfInstanceData : mSceneData.sdfGridInstances) sdfInstanceData.instanceIndex = tlasInstanceIndex++;
+            });
+        }
+
+        stages.execute();
+
+        for (TaskGraph::TaskID id = 0; id < stages.getTaskCount(); ++id)
+        {
+            timeReport.addMeasurement(stages.getTaskName(id), stages.getTaskDuration(id));
+        }
+        timeReport.measure("Post processing (total)");
 
         mSceneData.useCompressedHitInfo = is_set(mFlags, Flags::UseCompressedHitInfo);
 
         // Write scene cache if requested.
         if (mWriteSceneCache)
         {
-            SceneCache::writeCache(mSceneData, mSceneCacheKey);
-            timeReport.measure("Writing cache");
+            SceneCache::DependencyList dependencies;
+            for (const auto& [path, dependency] : mDependencies) dependencies.push_back(dependency);
+            const bool compressArrays = mSettings.getOption<bool>("sceneCache:compressArrays", true);
+            if (mSettings.getOption("sceneCache:writeInBackground", false))
+            {
+                // Only serialization blocks here, compression and file writing continue after the scene is created.
+                SceneCache::writeCacheAsync(mSceneData, mSceneCacheKey, dependencies, compressArrays);
+                timeReport.measure("Serializing cache");
+            }
+            else
+            {
+                SceneCache::writeCache(mSceneData, mSceneCacheKey, dependencies, compressArrays);
+                timeReport.measure("Writing cache");
+            }
         }
 
         // Create the scene object.
@@ -379,7 +495,56 @@ namespace Falcor
         return addProcessedMesh(processMesh(mesh));
     }
 
+    std::vector<MeshID> SceneBuilder::addMeshes(fstd::span<const Mesh> meshes)
+    {
+        // Pre-process the meshes in parallel. The meshes are then added sequentially
+        // to retain a deterministic order of the meshes in the global scene buffers.
+        std::vector<ProcessedMesh> processedMeshes(meshes.size());
+        Threading::parallel_for(size_t(0), meshes.size(), [&](size_t i) { processedMeshes[i] = processMesh(meshes[i]); }, 1);
+
+        return addProcessedMeshes(processedMeshes);
+    }
+
     MeshID SceneBuilder::addTriangleMesh(const ref<TriangleMesh>& pTriangleMesh, const ref<Material>& pMaterial)
+    {
+        return addProcessedMesh(processTriangleMesh(pTriangleMesh, pMaterial));
+    }
+
+    ref<TriangleMesh> SceneBuilder::loadTriangleMesh(const std::filesystem::path& path, bool smoothNormals)
+    {
+        if (!mWriteSceneCache) return TriangleMesh::createFromFile(path, smoothNormals);
+
+        std::filesystem::path fullPath;
+        if (!findFileInDataDirectories(path, fullPath)) return TriangleMesh::createFromFile(path, smoothNormals);
+
+        auto dependency = recordDependency(fullPath);
+        if (!dependency) return TriangleMesh::createFromFile(path, smoothNormals);
+
+        if (mReadSceneCacheFragments)
+        {
+            if (auto pMesh = SceneCache::readTriangleMeshFragment(*dependency, smoothNormals)) return pMesh;
+        }
+
+        auto pMesh = TriangleMesh::createFromFile(path, smoothNormals);
+        if (pMesh) SceneCache::writeTriangleMeshFragment(*dependency, smoothNormals, pMesh);
+        return pMesh;
+    }
+
+    std::vector<MeshID> SceneBuilder::addTriangleMeshes(fstd::span<const ref<TriangleMesh>> triangleMeshes, fstd::span<const ref<Material>> materials)
+    {
+        checkArgument(triangleMeshes.size() == materials.size(), "'triangleMeshes' and 'materials' must have the same size");
+
+        std::vector<ProcessedMesh> processedMeshes(triangleMeshes.size());
+        Threading::parallel_for(
+            size_t(0), triangleMeshes.size(),
+            [&](size_t i) { processedMeshes[i] = processTriangleMesh(triangleMeshes[i], materials[i]); },
+            1
+        );
+
+        return addProcessedMeshes(processedMeshes);
+    }
+
+    SceneBuilder::ProcessedMesh SceneBuilder::processTriangleMesh(const ref<TriangleMesh>& pTriangleMesh, const ref<Material>& pMaterial) const
     {
         checkArgument(pTriangleMesh != nullptr, "'pTriangleMesh' is missing");
         checkArgument(pMaterial != nullptr, "'pMaterial' is missing");
@@ -409,7 +574,7 @@ namespace Falcor
         mesh.normals = { normals.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
         mesh.texCrds = { texCoords.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
 
-        return addMesh(mesh);
+        return processMesh(mesh);
     }
 
     SceneBuilder::ProcessedMesh SceneBuilder::processMesh(const Mesh& mesh_, MeshAttributeIndices* pAttributeIndices) const
@@ -513,7 +678,75 @@ namespace Falcor
             pAttributeIndices->reserve(mesh.vertexCount);
         }
 
-        if (mesh.mergeDuplicateVertices)
+        if (mesh.mergeDuplicateVertices && is_set(mFlags, Flags::WeldVertices))
+        {
+            // Weld identical vertices across the whole mesh, regardless of their original index.
+            // Vertices are bucketed in a hash table keyed by the fields that need to match exactly.
+            // Each bucket points to the last inserted vertex with that key, and the next-pointers chain
+            // vertices with the same key. If a weld epsilon is set, positions are compared by grid cell
+            // and welded vertices take the position of the first vertex in the cell.
+            const float cellSize = mSettings.getOption("sceneBuilder:weldEpsilon", 0.f);
+
+            vertices.reserve(mesh.vertexCount);
+            std::vector<float3> weldPositions;
+            weldPositions.reserve(mesh.vertexCount);
+            std::unordered_map<uint64_t, uint32_t> buckets;
+            buckets.reserve(mesh.vertexCount);
+
+            for (uint32_t face = 0; face < mesh.faceCount; face++)
+            {
+                for (uint32_t vert = 0; vert < 3; vert++)
+                {
+                    Mesh::Vertex v = mesh.getVertex(face, vert);
+                    const float3 weldPosition = getWeldPosition(v.position, cellSize);
+                    auto [it, inserted] = buckets.try_emplace(hashWeldKey(v, weldPosition), invalidIndex);
+
+                    // Iterate over the bucket to check if the vertex already exists.
+                    uint32_t index = it->second;
+                    bool found = false;
+
+                    while (index != invalidIndex)
+                    {
+                        if (all(weldPositions[index] == weldPosition))
+                        {
+                            const float3 position = v.position;
+                            v.position = vertices[index].first.position;
+                            if (compareVertices(v, vertices[index].first))
+                            {
+                                found = true;
+                                break;
+                            }
+                            v.position = position;
+                        }
+                        index = vertices[index].second;
+                    }
+
+                    // Insert new vertex if we couldn't find it.
+                    if (!found)
+                    {
+                        FALCOR_ASSERT(vertices.size() < std::numeric_limits<uint32_t>::max());
+                        index = (uint32_t)vertices.size();
+                        vertices.push_back({ v, it->second });
+                        weldPositions.push_back(weldPosition);
+
+                        if (pAttributeIndices)
+                        {
+                            pAttributeIndices->push_back(mesh.getAttributeIndices(face, vert));
+                            FALCOR_ASSERT(vertices.size() == pAttributeIndices->size());
+                        }
+
+                        it->second = index;
+                    }
+
+                    // Store new vertex index.
+                    indices[face * 3 + vert] = index;
+                }
+            }
+
+            mWeldInputVertexCount += mesh.vertexCount;
+            mWeldOutputVertexCount += vertices.size();
+        }
+        else if (mesh.mergeDuplicateVertices)
         {
             vertices.reserve(mesh.vertexCount);
 
@@ -717,6 +950,32 @@ namespace Falcor
         return MeshID(mMeshes.size() - 1);
     }
 
+    std::vector<MeshID> SceneBuilder::addProcessedMeshes(std::vector<ProcessedMesh>& meshes)
+    {
+        // Check the limits that addProcessedMesh() enforces up front, so that a failure doesn't leave a partially added batch.
+        // The material count is bounded by assuming all materials of the batch are new.
+        if (mMeshes.size() + meshes.size() > std::numeric_limits<uint32_t>::max())
+        {
+            throw RuntimeError("Trying to build a scene that exceeds supported number of meshes");
+        }
+        std::unordered_set<const Material*> materials;
+        for (const auto& mesh : meshes) materials.insert(mesh.pMaterial.get());
+        if ((size_t)mSceneData.pMaterials->getMaterialCount() + materials.size() > std::numeric_limits<uint32_t>::max())
+        {
+            throw RuntimeError("Too many materials");
+        }
+
+        std::vector<MeshID> meshIDs;
+        meshIDs.reserve(meshes.size());
+        for (auto& mesh : meshes)
+        {
+            FALCOR_ASSERT(mesh.pMaterial != nullptr);
+            meshIDs.push_back(addProcessedMesh(mesh));
+            mesh = {}; // Release the memory as we go.
+        }
+        return meshIDs;
+    }
+
     void SceneBuilder::setCachedMeshes(std::vector<CachedMesh>&& cachedMeshes)
     {
         mSceneData.cachedMeshes = std::move(cachedMeshes);
@@ -865,6 +1124,7 @@ namespace Falcor
         {
             mpMaterialTextureLoader.reset(new MaterialTextureLoader(mSceneData.pMaterials->getTextureManager(), !is_set(mFlags, Flags::AssumeLinearSpaceTextures)));
         }
+        addDependency(path);
         mpMaterialTextureLoader->loadTexture(pMaterial, slot, path);
     }
 
@@ -1069,6 +1329,24 @@ namespace Falcor
         mSceneData.sdfGridInstances.push_back(instance);
     }
 
+    std::optional<SceneCache::Dependency> SceneBuilder::recordDependency(const std::filesystem::path& path)
+    {
+        std::error_code ec;
+        auto absolutePath = std::filesystem::absolute(path, ec);
+        if (ec) return {};
+        {
+            std::lock_guard<std::mutex> lock(mDependencyMutex);
+            if (auto it = mDependencies.find(absolutePath); it != mDependencies.end()) return it->second;
+        }
+
+        // Record the state of the file at the time it is read, so changes made during import invalidate the cache.
+        auto dependency = SceneCache::createDependency(absolutePath, mSettings.getOption("sceneCache:hashDependencies", false));
+        if (!dependency) return {};
+
+        std::lock_guard<std::mutex> lock(mDependencyMutex);
+        return mDependencies.emplace(absolutePath, *dependency).first->second;
+    }
+
     bool SceneBuilder::doesNodeHaveAnimation(NodeID nodeID) const
     {
         FALCOR_ASSERT(nodeID != NodeID::Invalid() && nodeID.get() < mSceneGraph.size());
@@ -1351,51 +1629,270 @@ namespace Falcor
         if (unusedCount > 0)
         {
             logWarning("Scene has {} unused meshes that will be removed.", unusedCount);
+            eraseUnreferencedMeshes();
+        }
+    }
 
-            const size_t meshCount = mMeshes.size();
-            MeshList meshes;
-            meshes.reserve(meshCount);
+    void SceneBuilder::eraseUnreferencedMeshes()
+    {
+        // Removes all meshes that have no instances and updates the mesh IDs referenced by the scene graph and cached meshes.
+        const size_t meshCount = mMeshes.size();
+        size_t unusedCount = 0;
+        for (const auto& mesh : mMeshes)
+        {
+            if (mesh.instances.empty()) unusedCount++;
+        }
+        if (unusedCount == 0) return;
 
-            for (MeshID meshID{ 0 }; meshID.get() < (uint32_t)meshCount; ++meshID)
-            {
-                auto& mesh = mMeshes[meshID.get()];
-                if (mesh.instances.empty()) continue; // Skip unused meshes
+        MeshList meshes;
+        meshes.reserve(meshCount);
 
-                // Get new mesh ID.
-                const MeshID newMeshID(meshes.size());
+        for (MeshID meshID{ 0 }; meshID.get() < (uint32_t)meshCount; ++meshID)
+        {
+            auto& mesh = mMeshes[meshID.get()];
+            if (mesh.instances.empty()) continue; // Skip unused meshes
+
+            // Get new mesh ID.
+            const MeshID newMeshID(meshes.size());
 
-                // Update the mesh IDs in the scene graph nodes.
-                for (const auto& nodeID : mesh.instances)
+            // Update the mesh IDs in the scene graph nodes.
+            for (const auto& nodeID : mesh.instances)
+            {
+                FALCOR_ASSERT(nodeID.get() < mSceneGraph.size());
+                auto& node = mSceneGraph[nodeID.get()];
+                std::replace(node.meshes.begin(), node.meshes.end(), meshID, newMeshID);
+            }
+
+            // Update the mesh IDs of cached meshes.
+            for (auto &cachedMesh : mSceneData.cachedMeshes)
+            {
+                if (cachedMesh.meshID == meshID) cachedMesh.meshID = newMeshID;
+            }
+            for (auto& cache : mSceneData.cachedCurves)
+            {
+                if (cache.tessellationMode != CurveTessellationMode::LinearSweptSphere)
                 {
-                    FALCOR_ASSERT(nodeID.get() < mSceneGraph.size());
-                    auto& node = mSceneGraph[nodeID.get()];
-                    std::replace(node.meshes.begin(), node.meshes.end(), meshID, newMeshID);
+                    if (cache.geometryID == CurveOrMeshID{ meshID }) cache.geometryID = CurveOrMeshID{ newMeshID };
                 }
+            }
+
+            meshes.push_back(std::move(mesh));
+        }
+
+        mMeshes = std::move(meshes);
+
+        // Validate scene graph.
+        FALCOR_ASSERT(mMeshes.size() == meshCount - unusedCount);
+        for (const auto& node : mSceneGraph)
+        {
+            for (MeshID meshID : node.meshes) FALCOR_ASSERT_LT(meshID.get(), mMeshes.size());
+        }
+    }
+
+    void SceneBuilder::instanceDuplicateMeshes()
+    {
+        // This function detects static meshes with identical geometry and material and replaces
+        // them by instances of a single mesh. The duplicates are then handled by the instanced BLAS path
+        // instead of being pre-transformed into the static BLAS, which saves vertex/BLAS memory and build time.
+        //
+        // Meshes are bucketed by a fingerprint of all data that is invariant under rigid transforms
+        // (material, flags, indices, texture coordinates etc.). Without rigid matching the fingerprint covers all vertex data. Meshes in the same bucket are compared
+        // against the unique meshes found so far, first for exact equality and optionally up to a rigid transform.
+        // A rigid transform is estimated from the first non-degenerate triangle of each mesh and verified on all vertices.
+
+        if (!is_set(mFlags, Flags::InstanceDuplicateMeshes) || is_set(mFlags, Flags::FlattenStaticMeshInstances)) return;
+
+        const bool matchRigid = mSettings.getOption("sceneBuilder:instanceRigidMeshes", false);
+        const uint32_t meshCount = (uint32_t)mMeshes.size();
+
+        auto isCandidate = [](const MeshSpec& mesh)
+        {
+            return !mesh.isDynamic() && mesh.skeletonNodeID == NodeID::Invalid() && mesh.topology == Vao::Topology::TriangleList &&
+                !mesh.staticData.empty() && !mesh.instances.empty();
+        };
+
+        // Compute mesh fingerprints.
+        std::vector<uint64_t> fingerprints(meshCount, 0);
+        Threading::parallel_for(uint32_t(0), meshCount, [&](uint32_t i)
+        {
+            const auto& mesh = mMeshes[i];
+            if (!isCandidate(mesh)) return;
 
-                // Update the mesh IDs of cached meshes.
-                for (auto &cachedMesh : mSceneData.cachedMeshes)
+            FNVHash64 hash;
+            const uint32_t header[] = { mesh.materialId.get(), mesh.vertexCount, mesh.indexCount, mesh.use16BitIndices, mesh.isFrontFaceCW, mesh.isDisplaced, mesh.isCastShadow };
+            hash.insert(header, sizeof(header));
+            hash.insert(mesh.indexData.data(), mesh.indexData.size() * sizeof(uint32_t));
+            if (matchRigid)
+            {
+                for (const auto& v : mesh.staticData)
                 {
-                    if (cachedMesh.meshID == meshID) cachedMesh.meshID = newMeshID;
+                    hash.insert(&v.texCrd, sizeof(v.texCrd));
+                    hash.insert(&v.tangent.w, sizeof(v.tangent.w));
+                    hash.insert(&v.curveRadius, sizeof(v.curveRadius));
                 }
-                for (auto& cache : mSceneData.cachedCurves)
+            }
+            else
+            {
+                // Only exact duplicates are matched, so positions, normals and tangents can be hashed too.
+                // This keeps meshes with the same topology and attributes out of each other's buckets.
+                hash.insert(mesh.staticData.data(), mesh.staticData.size() * sizeof(StaticVertexData));
+            }
+            fingerprints[i] = hash.get();
+        });
+
+        std::unordered_map<uint64_t, std::vector<MeshID>> buckets;
+        for (MeshID meshID{ 0 }; meshID.get() < meshCount; ++meshID)
+        {
+            if (isCandidate(mMeshes[meshID.get()])) buckets[fingerprints[meshID.get()]].push_back(meshID);
+        }
+
+        // Returns a rigid transform from the frame of the first non-degenerate triangle to object space.
+        auto computeFrame = [](const MeshSpec& mesh, float4x4& frame)
+        {
+            const uint32_t triangleCount = mesh.getTriangleCount();
+            for (uint32_t t = 0; t < triangleCount; t++)
+            {
+                uint32_t idx[3];
+                for (uint32_t j = 0; j < 3; j++) idx[j] = mesh.indexCount > 0 ? mesh.getIndex(t * 3 + j) : t * 3 + j;
+
+                const float3 p0 = mesh.staticData[idx[0]].position;
+                const float3 e1 = mesh.staticData[idx[1]].position - p0;
+                const float3 n = cross(e1, mesh.staticData[idx[2]].position - p0);
+                if (length(e1) == 0.f || length(n) == 0.f) continue;
+
+                const float3 x = normalize(e1);
+                const float3 z = normalize(n);
+                const float3 y = cross(z, x);
+                frame = matrixFromColumns(float4(x, 0.f), float4(y, 0.f), float4(z, 0.f), float4(p0, 1.f));
+                return true;
+            }
+            return false;
+        };
+
+        auto isIdentical = [](const MeshSpec& a, const MeshSpec& b)
+        {
+            return a.indexData == b.indexData &&
+                std::memcmp(a.staticData.data(), b.staticData.data(), a.staticData.size() * sizeof(StaticVertexData)) == 0;
+        };
+
+        // Returns true if 'b' equals 'a' transformed by the rigid transform 'xform'.
+        auto isRigidTransformed = [](const MeshSpec& a, const MeshSpec& b, const float4x4& xform)
+        {
+            if (a.indexData != b.indexData) return false;
+
+            AABB bounds;
+            for (const auto& v : a.staticData) bounds.include(v.position);
+            const float3 extent = bounds.extent();
+            const float3 positionTolerance = float3(1e-5f * std::max({ extent.x, extent.y, extent.z, 1e-6f }));
+            const float3 directionTolerance = float3(1e-4f);
+            const float3x3 rotation = float3x3(xform);
+
+            for (size_t i = 0; i < a.staticData.size(); i++)
+            {
+                const auto& va = a.staticData[i];
+                const auto& vb = b.staticData[i];
+                if (any(va.texCrd != vb.texCrd) || va.tangent.w != vb.tangent.w || va.curveRadius != vb.curveRadius) return false;
+                if (any(abs(transformPoint(xform, va.position) - vb.position) > positionTolerance)) return false;
+                if (any(abs(transformVector(rotation, va.normal) - vb.normal) > directionTolerance)) return false;
+                if (any(abs(transformVector(rotation, va.tangent.xyz()) - vb.tangent.xyz()) > directionTolerance)) return false;
+            }
+            return true;
+        };
+
+        // Find the unique mesh and the transform for each duplicate. Buckets are processed in parallel.
+        struct Duplicate
+        {
+            MeshID uniqueID{ MeshID::Invalid() };
+            bool isExact = true;
+            float4x4 transform = float4x4::identity();  ///< Transform from the unique mesh to the duplicate.
+        };
+        std::vector<Duplicate> duplicates(meshCount);
+
+        std::vector<const std::vector<MeshID>*> bucketList;
+        bucketList.reserve(buckets.size());
+        for (const auto& [hash, meshIDs] : buckets)
+        {
+            if (meshIDs.size() > 1) bucketList.push_back(&meshIDs);
+        }
+
+        Threading::parallel_for(size_t(0), bucketList.size(), [&](size_t bucketIndex)
+        {
+            struct Unique
+            {
+                MeshID meshID;
+                bool hasFrame;
+                float4x4 frame;
+                float4x4 invFrame;
+            };
+            std::vector<Unique> uniques;
+
+            for (MeshID meshID : *bucketList[bucketIndex])
+            {
+                const auto& mesh = mMeshes[meshID.get()];
+                float4x4 frame;
+                bool hasFrame = matchRigid && computeFrame(mesh, frame);
+                bool found = false;
+
+                for (const auto& unique : uniques)
                 {
-                    if (cache.tessellationMode != CurveTessellationMode::LinearSweptSphere)
+                    const auto& uniqueMesh = mMeshes[unique.meshID.get()];
+                    if (isIdentical(uniqueMesh, mesh))
                     {
-                        if (cache.geometryID == CurveOrMeshID{ meshID }) cache.geometryID = CurveOrMeshID{ newMeshID };
+                        duplicates[meshID.get()].uniqueID = unique.meshID;
+                        found = true;
+                        break;
+                    }
+                    if (hasFrame && unique.hasFrame)
+                    {
+                        const float4x4 xform = mul(frame, unique.invFrame);
+                        if (isRigidTransformed(uniqueMesh, mesh, xform))
+                        {
+                            duplicates[meshID.get()] = { unique.meshID, false, xform };
+                            found = true;
+                            break;
+                        }
                     }
                 }
 
-                meshes.push_back(std::move(mesh));
+                if (!found) uniques.push_back({ meshID, hasFrame, frame, hasFrame ? inverse(frame) : float4x4::identity() });
             }
+        }, 1);
+
+        // Relink the instances of all duplicates to their unique mesh.
+        size_t duplicateCount = 0;
+        for (MeshID meshID{ 0 }; meshID.get() < meshCount; ++meshID)
+        {
+            const auto& duplicate = duplicates[meshID.get()];
+            if (duplicate.uniqueID == MeshID::Invalid()) continue;
 
-            mMeshes = std::move(meshes);
+            const std::set<NodeID> instances = std::move(mMeshes[meshID.get()].instances);
+            mMeshes[meshID.get()].instances.clear();
 
-            // Validate scene graph.
-            FALCOR_ASSERT(mMeshes.size() == meshCount - unusedCount);
-            for (const auto& node : mSceneGraph)
+            for (NodeID nodeID : instances)
             {
-                for (MeshID meshID : node.meshes) FALCOR_ASSERT_LT(meshID.get(), mMeshes.size());
+                auto& nodeMeshes = mSceneGraph[nodeID.get()].meshes;
+                auto it = std::find(nodeMeshes.begin(), nodeMeshes.end(), meshID);
+                FALCOR_ASSERT(it != nodeMeshes.end());
+                nodeMeshes.erase(it);
+
+                // Attach the unique mesh to the node directly if possible, otherwise through a new child node holding the transform.
+                NodeID instanceNodeID = nodeID;
+                const bool isAttached = std::find(nodeMeshes.begin(), nodeMeshes.end(), duplicate.uniqueID) != nodeMeshes.end();
+                if (!duplicate.isExact || isAttached)
+                {
+                    instanceNodeID = addNode(Node{ mMeshes[meshID.get()].name, duplicate.transform, float4x4::identity(), float4x4::identity(), nodeID });
+                }
+                mSceneGraph[instanceNodeID.get()].meshes.push_back(duplicate.uniqueID);
+                mMeshes[duplicate.uniqueID.get()].instances.insert(instanceNodeID);
             }
+
+            duplicateCount++;
+        }
+
+        if (duplicateCount > 0)
+        {
+            eraseUnreferencedMeshes();
+            logInfo("Replaced {} duplicate meshes by instances, {} meshes remaining.", duplicateCount, mMeshes.size());
         }
     }
 
@@ -2107,7 +2604,7 @@ namespace Falcor
 
         triangleCount = countTriangles(meshGroup);
 
-        if (triangleCount <= kMaxTrianglesPerBLAS)
+        if (triangleCount <= getMaxTrianglesPerBLAS())
         {
             return false;
         }
@@ -2122,11 +2619,16 @@ namespace Falcor
             return false;
         }
         FALCOR_ASSERT(meshGroup.meshList.size() > 1);
-        FALCOR_ASSERT(triangleCount > kMaxTrianglesPerBLAS);
+        FALCOR_ASSERT(triangleCount > getMaxTrianglesPerBLAS());
 
         return true;
     }
 
+    size_t SceneBuilder::getMaxTrianglesPerBLAS() const
+    {
+        return std::max(mSettings.getOption<size_t>("sceneBuilder:maxTrianglesPerBLAS", kMaxTrianglesPerBLAS), size_t(1));
+    }
+
     SceneBuilder::MeshGroupList SceneBuilder::splitMeshGroupSimple(MeshGroup& meshGroup) const
     {
         // This function partitions a mesh group into smaller groups based on triangle count.
@@ -2139,7 +2641,7 @@ namespace Falcor
 
         // Each new group holds at least one mesh, or if multiple, up to the target number of triangles.
         FALCOR_ASSERT(triangleCount > 0);
-        size_t targetGroupCount = div_round_up(triangleCount, kMaxTrianglesPerBLAS);
+        size_t targetGroupCount = div_round_up(triangleCount, getMaxTrianglesPerBLAS());
         size_t targetTrianglesPerGroup = triangleCount / targetGroupCount;
 
         triangleCount = 0;
@@ -2264,6 +2766,110 @@ namespace Falcor
         return leftList;
     }
 
+    SceneBuilder::MeshGroupList SceneBuilder::splitMeshGroupSAH(MeshGroup& meshGroup)
+    {
+        // This function recursively splits a mesh group at the plane that minimizes the binned SAH cost.
+        // The cost includes a penalty for the spatial overlap between the two sides, see BinnedSAH.
+        // Small meshes are binned by their bounding box centroid and kept intact. Large meshes are binned
+        // per triangle and split at the chosen plane, in the same way as in splitMeshGroupMidpointMeshes().
+
+        // Early out if splitting is not needed or possible.
+        size_t triangleCount = 0;
+        if (!needsSplit(meshGroup, triangleCount)) return MeshGroupList{ std::move(meshGroup) };
+
+        // Meshes larger than a bin's share of the triangles are split per triangle.
+        const size_t largeMeshThreshold = triangleCount / kSAHBinCount;
+        auto isLargeMesh = [&](MeshID meshID) { return mMeshes[meshID.get()].getTriangleCount() > largeMeshThreshold; };
+
+        // Setup binning tasks. Small meshes are binned in one task, large meshes in chunks of triangles.
+        struct BinningTask
+        {
+            MeshID meshID;
+            uint32_t firstTriangle;
+            uint32_t lastTriangle;
+        };
+        std::vector<BinningTask> tasks{ { MeshID::Invalid(), 0, 0 } };
+        for (MeshID meshID : meshGroup.meshList)
+        {
+            if (!isLargeMesh(meshID)) continue;
+            const uint32_t meshTriangleCount = mMeshes[meshID.get()].getTriangleCount();
+            for (uint32_t first = 0; first < meshTriangleCount; first += (uint32_t)kSAHTrianglesPerTask)
+            {
+                tasks.push_back({ meshID, first, std::min(first + (uint32_t)kSAHTrianglesPerTask, meshTriangleCount) });
+            }
+        }
+
+        const AABB bb = calculateBoundingBox(meshGroup);
+        std::vector<BinnedSAH> binnings(tasks.size(), BinnedSAH(bb, kSAHBinCount, kSAHOverlapWeight));
+
+        Threading::parallel_for(size_t(0), tasks.size(), [&](size_t taskIndex)
+        {
+            const auto& task = tasks[taskIndex];
+            auto& binning = binnings[taskIndex];
+
+            if (task.meshID == MeshID::Invalid())
+            {
+                for (MeshID meshID : meshGroup.meshList)
+                {
+                    if (!isLargeMesh(meshID)) binning.add(mMeshes[meshID.get()].boundingBox, mMeshes[meshID.get()].getTriangleCount());
+                }
+                return;
+            }
+
+            const auto& mesh = mMeshes[task.meshID.get()];
+            auto getPosition = [&](uint32_t i) { return mesh.staticData[mesh.indexCount > 0 ? mesh.getIndex(i) : i].position; };
+            for (uint32_t triangle = task.firstTriangle; triangle < task.lastTriangle; triangle++)
+            {
+                AABB triangleBB(getPosition(triangle * 3));
+                triangleBB.include(getPosition(triangle * 3 + 1));
+                triangleBB.include(getPosition(triangle * 3 + 2));
+                binning.add(triangleBB);
+            }
+        }, 1);
+
+        for (size_t i = 1; i < binnings.size(); i++) binnings[0].merge(binnings[i]);
+        const BinnedSAH::Split split = binnings[0].findBestSplit();
+
+        // Fall back on the midpoint split if no valid SAH split was found.
+        if (!split.isValid()) return splitMeshGroupMidpointMeshes(meshGroup);
+
+        // Partition all meshes by the splitting plane.
+        std::vector<MeshID> leftMeshes, rightMeshes;
+
+        for (auto meshID : meshGroup.meshList)
+        {
+            if (isLargeMesh(meshID))
+            {
+                auto result = splitMesh(meshID, split.axis, split.position);
+                if (auto leftMeshID = result.first) leftMeshes.push_back(*leftMeshID);
+                if (auto rightMeshID = result.second) rightMeshes.push_back(*rightMeshID);
+            }
+            else
+            {
+                if (mMeshes[meshID.get()].boundingBox.center()[split.axis] < split.position) leftMeshes.push_back(meshID);
+                else rightMeshes.push_back(meshID);
+            }
+        }
+
+        // If either side contains all meshes, fall back on the midpoint split.
+        if (leftMeshes.empty() || rightMeshes.empty()) return splitMeshGroupMidpointMeshes(meshGroup);
+
+        // Recursively split the left and right mesh groups.
+        MeshGroup leftGroup{ std::move(leftMeshes), meshGroup.isStatic };
+        MeshGroup rightGroup{ std::move(rightMeshes), meshGroup.isStatic };
+
+        MeshGroupList leftList = splitMeshGroupSAH(leftGroup);
+        MeshGroupList rightList = splitMeshGroupSAH(rightGroup);
+
+        // Move elements into a single list and return.
+        leftList.insert(
+            leftList.end(),
+            std::make_move_iterator(rightList.begin()),
+            std::make_move_iterator(rightList.end()));
+
+        return leftList;
+    }
+
     void SceneBuilder::optimizeGeometry()
     {
         // This function optimizes the geometry for raytracing performance and memory usage.
@@ -2276,14 +2882,29 @@ namespace Falcor
         //  - Split large mesh groups (BLASes) into multiple smaller ones.
         //  - Split large meshes into smaller to reduce spatial overlap between BLASes.
         //  - Sort meshes into BLASes based on spatial locality.
+        //
+        // The partitioning policy is selected with the 'sceneBuilder:blasSplitPolicy' setting
+        // ('simple', 'median', 'midpoint' or 'sah'). The default is 'midpoint'.
+
+        MeshGroupSplitPolicy policy = MeshGroupSplitPolicy::Midpoint;
+        const std::string policyName = mSettings.getOption<std::string>("sceneBuilder:blasSplitPolicy", "midpoint");
+        if (policyName == "simple") policy = MeshGroupSplitPolicy::Simple;
+        else if (policyName == "median") policy = MeshGroupSplitPolicy::Median;
+        else if (policyName == "sah") policy = MeshGroupSplitPolicy::SAH;
+        else if (policyName != "midpoint") logWarning("Unknown BLAS split policy '{}'. Using 'midpoint' instead.", policyName);
 
         MeshGroupList optimizedGroups;
 
         for (auto& meshGroup : mMeshGroups)
         {
-            //auto groups = splitMeshGroupSimple(meshGroup);
-            //auto groups = splitMeshGroupMedian(meshGroup);
-            auto groups = splitMeshGroupMidpointMeshes(meshGroup);
+            MeshGroupList groups;
+            switch (policy)
+            {
+            case MeshGroupSplitPolicy::Simple: groups = splitMeshGroupSimple(meshGroup); break;
+            case MeshGroupSplitPolicy::Median: groups = splitMeshGroupMedian(meshGroup); break;
+            case MeshGroupSplitPolicy::Midpoint: groups = splitMeshGroupMidpointMeshes(meshGroup); break;
+            case MeshGroupSplitPolicy::SAH: groups = splitMeshGroupSAH(meshGroup); break;
+            }
 
             if (groups.size() > 1) logWarning("SceneBuilder::optimizeGeometry() performance warning - Mesh group was split into {} groups.", groups.size());
 
@@ -2296,6 +2917,80 @@ namespace Falcor
         mMeshGroups = std::move(optimizedGroups);
     }
 
+    void SceneBuilder::optimizeVertexCache()
+    {
+        // This function reorders the triangles of each mesh for post-transform vertex cache efficiency
+        // and then reorders the vertices by first use to improve memory locality of vertex fetches.
+        // Meshes with vertex animations are skipped as the cached animation data refers to the original vertex order.
+        // The reordering only depends on the mesh data, so the scene cache output stays stable.
+
+        if (!is_set(mFlags, Flags::OptimizeVertexCache)) return;
+
+        struct MeshStats
+        {
+            bool optimized = false;
+            VertexCacheStats before;
+            VertexCacheStats after;
+        };
+        std::vector<MeshStats> meshStats(mMeshes.size());
+
+        Threading::parallel_for(size_t(0), mMeshes.size(), [&](size_t meshIndex)
+        {
+            auto& mesh = mMeshes[meshIndex];
+            if (mesh.topology != Vao::Topology::TriangleList || mesh.indexCount == 0 || mesh.isAnimated) return;
+            FALCOR_ASSERT(mesh.staticData.size() == mesh.vertexCount);
+            FALCOR_ASSERT(!mesh.isSkinned() || mesh.skinningData.size() == mesh.vertexCount);
+
+            std::vector<uint32_t> indices(mesh.indexCount);
+            for (uint32_t i = 0; i < mesh.indexCount; i++) indices[i] = mesh.getIndex(i);
+
+            auto& stats = meshStats[meshIndex];
+            stats.before = analyzeVertexCache(indices, mesh.vertexCount);
+            indices = Falcor::optimizeVertexCache(indices, mesh.vertexCount);
+            std::vector<uint32_t> remap = optimizeVertexFetch(indices, mesh.vertexCount);
+            stats.after = analyzeVertexCache(indices, mesh.vertexCount);
+            stats.optimized = true;
+
+            auto reorderVertices = [&](auto& vertexData)
+            {
+                std::remove_reference_t<decltype(vertexData)> reordered(vertexData.size());
+                for (size_t i = 0; i < vertexData.size(); i++) reordered[remap[i]] = vertexData[i];
+                vertexData = std::move(reordered);
+            };
+            reorderVertices(mesh.staticData);
+            if (mesh.isSkinned()) reorderVertices(mesh.skinningData);
+
+            mesh.indexData = mesh.use16BitIndices ? compact16BitIndices(indices) : std::move(indices);
+        }, 1);
+
+        // Report the cache efficiency per mesh and in total.
+        VertexCacheStats totalBefore;
+        VertexCacheStats totalAfter;
+        size_t optimizedMeshCount = 0;
+        for (size_t meshIndex = 0; meshIndex < mMeshes.size(); meshIndex++)
+        {
+            const auto& stats = meshStats[meshIndex];
+            if (!stats.optimized) continue;
+
+            logDebug("Optimized vertex cache for mesh '{}': ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}.",
+                mMeshes[meshIndex].name, stats.before.getACMR(), stats.after.getACMR(), stats.before.getATVR(), stats.after.getATVR());
+
+            totalBefore.triangleCount += stats.before.triangleCount;
+            totalBefore.vertexCount += stats.before.vertexCount;
+            totalBefore.transformCount += stats.before.transformCount;
+            totalAfter.triangleCount += stats.after.triangleCount;
+            totalAfter.vertexCount += stats.after.vertexCount;
+            totalAfter.transformCount += stats.after.transformCount;
+            optimizedMeshCount++;
+        }
+
+        if (optimizedMeshCount > 0)
+        {
+            logInfo("Optimized vertex cache for {} meshes: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}.",
+                optimizedMeshCount, totalBefore.getACMR(), totalAfter.getACMR(), totalBefore.getATVR(), totalAfter.getATVR());
+        }
+    }
+
     void SceneBuilder::sortMeshes()
     {
         // This function sorts meshes by the order they are used in the mesh groups.
@@ -2370,20 +3065,37 @@ namespace Falcor
             throw RuntimeError("Trying to build a scene that exceeds supported mesh data size.");
         }
 
+        // With compact vertex data the vertices of dynamic meshes are placed first, followed by the vertices of all static meshes.
+        // The scene keeps the dynamic range at full precision for the animation system and stores the static range in the compact format.
+        const bool useCompactVertexData = is_set(mFlags, Flags::CompactVertexData);
+        mSceneData.useCompactVertexData = useCompactVertexData;
+        mSceneData.compactVertexOffset = 0;
+        if (useCompactVertexData)
+        {
+            for (const auto& mesh : mMeshes)
+            {
+                if (mesh.isDynamic()) mSceneData.compactVertexOffset += (uint32_t)mesh.staticData.size();
+            }
+        }
+        uint32_t dynamicVertexOffset = 0;
+        uint32_t staticVertexOffset = mSceneData.compactVertexOffset;
+
         mSceneData.meshIndexData.reserve(totalIndexDataCount);
-        mSceneData.meshStaticData.reserve(totalStaticVertexCount);
+        mSceneData.meshStaticData.resize(totalStaticVertexCount);
         mSceneData.meshSkinningData.reserve(totalSkinningVertexCount);
 
         // Copy all vertex and index data into the global buffers.
         for (auto& mesh : mMeshes)
         {
-            mesh.staticVertexOffset = (uint32_t)mSceneData.meshStaticData.size();
+            uint32_t& vertexOffset = !useCompactVertexData || mesh.isDynamic() ? dynamicVertexOffset : staticVertexOffset;
+            mesh.staticVertexOffset = vertexOffset;
+            vertexOffset += (uint32_t)mesh.staticData.size();
             mesh.skinningVertexOffset = (uint32_t)mSceneData.meshSkinningData.size();
             mesh.prevVertexOffset = mesh.skinningVertexOffset;
 
-            // Insert the static vertex data in the global array.
+            // Copy the static vertex data to the global array.
             // The vertices are automatically converted to their packed format in this step.
-            mSceneData.meshStaticData.insert(mSceneData.meshStaticData.end(), mesh.staticData.begin(), mesh.staticData.end());
+            std::copy(mesh.staticData.begin(), mesh.staticData.end(), mSceneData.meshStaticData.begin() + mesh.staticVertexOffset);
 
             if (isIndexed)
             {
@@ -2479,20 +3191,25 @@ namespace Falcor
         mSceneData.pMaterials->optimizeMaterials();
     }
 
-    void SceneBuilder::removeDuplicateMaterials()
+    void SceneBuilder::removeDuplicateMaterials(std::vector<MaterialID>& idMap)
     {
         // This pass identifies materials with identical set of parameters.
         // It should run after optimizeMaterials() as materials with different
         // textures may be reduced to identical materials after optimization,
         // increasing the likelihood of finding duplicates here.
 
+        idMap.clear();
         if (is_set(mFlags, Flags::DontMergeMaterials)) return;
 
-        std::vector<MaterialID> idMap;
         size_t removed = mSceneData.pMaterials->removeDuplicateMaterials(idMap);
+        if (removed == 0) idMap.clear();
+    }
 
-        // Reassign material IDs.
-        if (removed > 0)
+    void SceneBuilder::remapMaterialIDs(const std::vector<MaterialID>& idMap)
+    {
+        // Reassign material IDs after removing duplicate materials.
+        // The ID map is empty if no materials were removed.
+        if (!idMap.empty())
         {
             for (auto& mesh : mMeshes)
             {
@@ -2897,6 +3614,10 @@ namespace Falcor
         flags.value("DontUseDisplacement", SceneBuilder::Flags::DontUseDisplacement);
         flags.value("UseCompressedHitInfo", SceneBuilder::Flags::UseCompressedHitInfo);
         flags.value("TessellateCurvesIntoPolyTubes", SceneBuilder::Flags::TessellateCurvesIntoPolyTubes);
+        flags.value("WeldVertices", SceneBuilder::Flags::WeldVertices);
+        flags.value("InstanceDuplicateMeshes", SceneBuilder::Flags::InstanceDuplicateMeshes);
+        flags.value("OptimizeVertexCache", SceneBuilder::Flags::OptimizeVertexCache);
+        flags.value("CompactVertexData", SceneBuilder::Flags::CompactVertexData);
         flags.value("UseCache", SceneBuilder::Flags::UseCache);
         flags.value("RebuildCache", SceneBuilder::Flags::RebuildCache);
         ScriptBindings::addEnumBinaryOperators(flags);
@@ -2915,6 +3636,11 @@ namespace Falcor
         sceneBuilder.def_property("cameraSpeed", &SceneBuilder::getCameraSpeed, &SceneBuilder::setCameraSpeed);
         sceneBuilder.def("importScene", &SceneBuilder::import, "path"_a, "dict"_a = pybind11::dict());
         sceneBuilder.def("addTriangleMesh", &SceneBuilder::addTriangleMesh, "triangleMesh"_a, "material"_a);
+        sceneBuilder.def("addTriangleMeshes", [] (SceneBuilder* pSceneBuilder, const std::vector<ref<TriangleMesh>>& triangleMeshes, const std::vector<ref<Material>>& materials) {
+            return pSceneBuilder->addTriangleMeshes(triangleMeshes, materials);
+        }, "triangleMeshes"_a, "materials"_a);
+        sceneBuilder.def("loadTriangleMesh", &SceneBuilder::loadTriangleMesh, "path"_a, "smoothNormals"_a = false);
+        sceneBuilder.def("addDependency", &SceneBuilder::addDependency, "path"_a);
         sceneBuilder.def("addSDFGrid", &SceneBuilder::addSDFGrid, "sdfGrid"_a, "material"_a);
         sceneBuilder.def("addMaterial", &SceneBuilder::addMaterial, "material"_a);
         sceneBuilder.def("replaceMaterial", &SceneBuilder::replaceMaterial, "material"_a, "replacement"_a);
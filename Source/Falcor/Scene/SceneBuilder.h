@@ -44,8 +44,13 @@
 
 #include <pybind11/pytypes.h>
 
+#include <fstd/span.h>
+
+#include <atomic>
 #include <filesystem>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -76,6 +81,10 @@ namespace Falcor
             DontUseDisplacement             = 0x4000,   ///< Don't use displacement mapping.
             UseCompressedHitInfo            = 0x8000,   ///< Use compressed hit info (on scenes with triangle meshes only).
             TessellateCurvesIntoPolyTubes   = 0x10000,  ///< Tessellate curves into poly-tubes (the default is linear swept spheres).
+            WeldVertices                    = 0x20000,  ///< Merge identical vertices across the whole mesh using a hash table, not only vertices sharing the same original index. Positions can optionally be quantized to a grid with spacing 'sceneBuilder:weldEpsilon' (setting).
+            InstanceDuplicateMeshes         = 0x40000,  ///< Turn static meshes that are exact duplicates (same material, indices and vertex data) into instances of a single mesh. Meshes that only differ by a rigid transform are matched only if the 'sceneBuilder:instanceRigidMeshes' setting is enabled. Ignored if 'FlattenStaticMeshInstances' is set.
+            OptimizeVertexCache             = 0x80000,  ///< Reorder triangles for post-transform vertex cache efficiency and vertices by first use for memory locality. Meshes with vertex animations are not affected.
+            CompactVertexData               = 0x100000, ///< Store the vertices of static meshes in a compact format (24B instead of 32B per vertex) with full-precision positions and quantized normals, tangents and texture coordinates. Dynamic meshes keep using the full-precision format.
 
             UseCache                        = 0x10000000, ///< Enable scene caching. This caches the runtime scene representation on disk to reduce load time.
             RebuildCache                    = 0x20000000, ///< Rebuild scene cache.
@@ -369,6 +378,13 @@ namespace Falcor
         */
         Flags getFlags() const { return mFlags; }
 
+        /** Record a file the scene is created from.
+            Importers call this for every file they read. The scene cache is invalidated when any of these files change.
+            This function is thread-safe.
+            \param[in] path File path. Can also include a full path or relative path from a data directory. Files that don't exist are ignored.
+        */
+        void addDependency(const std::filesystem::path& path);
+
         /** Set the render settings.
         */
         void setRenderSettings(const Scene::RenderSettings& renderSettings) { mSceneData.renderSettings = renderSettings; }
@@ -402,6 +418,16 @@ namespace Falcor
         */
         MeshID addMesh(const Mesh& mesh);
 
+        /** Add a batch of meshes.
+            The meshes are pre-processed in parallel and then added in order, so the assigned mesh IDs are
+            identical to calling addMesh() for each mesh in sequence.
+            Throws an exception if something went wrong. All meshes are validated before the first one is added,
+            so in that case none of the meshes are added.
+            \param meshes The meshes to add.
+            \return The IDs of the meshes in the scene, in the same order as the input.
+        */
+        std::vector<MeshID> addMeshes(fstd::span<const Mesh> meshes);
+
         /** Add a triangle mesh.
             \param The triangle mesh to add.
             \param pMaterial The material to use for the mesh.
@@ -409,6 +435,22 @@ namespace Falcor
         */
         MeshID addTriangleMesh(const ref<TriangleMesh>& pTriangleMesh, const ref<Material>& pMaterial);
 
+        /** Load a triangle mesh from a file and record the file as a dependency.
+            When the scene cache is in use, the loaded mesh is also cached per file and reused until the file changes.
+            \param[in] path File path to load mesh from.
+            \param[in] smoothNormals If no normals are defined in the model, generate smooth instead of facet normals.
+            \return Returns the triangle mesh or nullptr if the mesh failed to load.
+        */
+        ref<TriangleMesh> loadTriangleMesh(const std::filesystem::path& path, bool smoothNormals = false);
+
+        /** Add a batch of triangle meshes.
+            The meshes are pre-processed in parallel, see addMeshes().
+            \param triangleMeshes The triangle meshes to add.
+            \param materials The materials to use for the meshes. Must have the same size as triangleMeshes.
+            \return The IDs of the meshes in the scene, in the same order as the input.
+        */
+        std::vector<MeshID> addTriangleMeshes(fstd::span<const ref<TriangleMesh>> triangleMeshes, fstd::span<const ref<Material>> materials);
+
         /** Pre-process a mesh into the data format that is used in the global scene buffers.
             Throws an exception if something went wrong.
             \param mesh The mesh to pre-process.
@@ -423,6 +465,13 @@ namespace Falcor
         */
         void generateTangents(Mesh& mesh, std::vector<float4>& tangents) const;
 
+        /** Pre-process a triangle mesh, see processMesh().
+            \param pTriangleMesh The triangle mesh to pre-process.
+            \param pMaterial The material to use for the mesh.
+            \return The pre-processed mesh.
+        */
+        ProcessedMesh processTriangleMesh(const ref<TriangleMesh>& pTriangleMesh, const ref<Material>& pMaterial) const;
+
         /** Add a pre-processed mesh.
             \param mesh The pre-processed mesh.
             \return The ID of the mesh in the scene. Note that all of the instances share the same mesh ID.
@@ -758,10 +807,18 @@ namespace Falcor
         Settings mSettings;
         const Flags mFlags;
 
+        // Vertex welding statistics. These are updated by processMesh(), which may run concurrently.
+        mutable std::atomic<uint64_t> mWeldInputVertexCount{ 0 };   ///< Number of vertices in meshes processed with Flags::WeldVertices.
+        mutable std::atomic<uint64_t> mWeldOutputVertexCount{ 0 };  ///< Number of vertices remaining after welding.
+
         Scene::SceneData mSceneData;
         ref<Scene> mpScene;
         SceneCache::Key mSceneCacheKey;
         bool mWriteSceneCache = false;  ///< True if scene cache should be written after import.
+        bool mReadSceneCacheFragments = false;  ///< True if cached asset fragments may be used during import.
+
+        std::map<std::filesystem::path, SceneCache::Dependency> mDependencies;  ///< Files the scene is created from, keyed by absolute path.
+        std::mutex mDependencyMutex;
 
         SceneGraph mSceneGraph;
 
@@ -774,6 +831,7 @@ namespace Falcor
         ref<GpuFence> mpFence;
 
         // Helpers
+        std::optional<SceneCache::Dependency> recordDependency(const std::filesystem::path& path);
         bool doesNodeHaveAnimation(NodeID nodeID) const;
         void updateLinkedObjects(NodeID oldNodeID, NodeID newNodeID);
         bool collapseNodes(NodeID parentNodeID, NodeID childNodeID);
@@ -789,6 +847,11 @@ namespace Falcor
         void splitIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos);
         void splitNonIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos);
 
+        /** Add a batch of pre-processed meshes. Checks the scene limits before adding any mesh.
+            The meshes are released as they are added.
+        */
+        std::vector<MeshID> addProcessedMeshes(std::vector<ProcessedMesh>& meshes);
+
         // Mesh group helpers
         size_t countTriangles(const MeshGroup& meshGroup) const;
         AABB calculateBoundingBox(const MeshGroup& meshGroup) const;
@@ -796,12 +859,16 @@ namespace Falcor
         MeshGroupList splitMeshGroupSimple(MeshGroup& meshGroup) const;
         MeshGroupList splitMeshGroupMedian(MeshGroup& meshGroup) const;
         MeshGroupList splitMeshGroupMidpointMeshes(MeshGroup& meshGroup);
+        MeshGroupList splitMeshGroupSAH(MeshGroup& meshGroup);
+        size_t getMaxTrianglesPerBLAS() const;
 
         // Post processing
         void prepareDisplacementMaps();
         void prepareSceneGraph();
         void prepareMeshes();
         void removeUnusedMeshes();
+        void eraseUnreferencedMeshes();
+        void instanceDuplicateMeshes();
         void flattenStaticMeshInstances();
         void optimizeSceneGraph();
         void pretransformStaticMeshes();
@@ -809,11 +876,13 @@ namespace Falcor
         void calculateMeshBoundingBoxes();
         void createMeshGroups();
         void optimizeGeometry();
+        void optimizeVertexCache();
         void sortMeshes();
         void createGlobalBuffers();
         void createCurveGlobalBuffers();
         void optimizeMaterials();
-        void removeDuplicateMaterials();
+        void removeDuplicateMaterials(std::vector<MaterialID>& idMap);
+        void remapMaterialIDs(const std::vector<MaterialID>& idMap);
         void collectVolumeGrids();
         void quantizeTexCoords();
         void removeDuplicateSDFGrids();
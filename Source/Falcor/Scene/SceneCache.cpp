@@ -30,11 +30,20 @@
 #include "Material/HairMaterial.h"
 #include "Material/ClothMaterial.h"
 #include "Material/MaterialTextureLoader.h"
+#include "Core/Platform/LockFile.h"
+#include "Core/Platform/MemoryMappedFile.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
+#include "Utils/Math/FNVHash.h"
 
-#include <lz4_stream/lz4_stream.h>
+#include <lz4.h>
 
+#include <atomic>
+#include <cstring>
+#include <deque>
 #include <fstream>
+#include <memory>
+#include <random>
 
 namespace Falcor
 {
@@ -43,37 +52,140 @@ namespace Falcor
         /** Specfies the current cache file version.
             This needs to be incremented every time the file format changes!
         */
-        const uint32_t kVersion = 25;
+        const uint32_t kVersion = 30;
 
         /** Scene cache directory (subdirectory in the application data directory).
         */
         const std::string kDirectory = "NVIDIA/Falcor/SceneCache";
 
-        const size_t kBlockSize = 1 * 1024 * 1024;
+        /** Asset fragment directory (subdirectory in the scene cache directory).
+        */
+        const std::string kFragmentDirectory = "Fragments";
+
+        /** Sections are split into blocks of this size, which are compressed and decompressed independently.
+        */
+        const size_t kBlockSize = 4 * 1024 * 1024;
+
+        /** Alignment of blocks in the file.
+        */
+        const size_t kBlockAlignment = 64;
 
         const char* kMagic = "FalcorS$";
         struct Header
         {
             uint8_t magic[8]{};
             uint32_t version{};
+            uint32_t sectionCount{};
+            uint64_t manifestSize{};    ///< Size of the dependency manifest following the header in bytes.
 
             bool isValid() const
             {
                 return std::memcmp(magic, kMagic, sizeof(Header::magic)) == 0 && version == kVersion;
             }
         };
+
+        const char* kFragmentMagic = "FalcorF$";
+        struct FragmentHeader
+        {
+            uint8_t magic[8]{};
+            uint32_t version{};
+            uint32_t reserved{};
+
+            bool isValid() const
+            {
+                return std::memcmp(magic, kFragmentMagic, sizeof(FragmentHeader::magic)) == 0 && version == kVersion;
+            }
+        };
+
+        /** Entry in the section directory following the header.
+        */
+        struct SectionDesc
+        {
+            char name[32]{};
+            uint64_t size{};            ///< Uncompressed size in bytes.
+            uint32_t firstBlock{};      ///< Index of the first block in the block directory.
+            uint32_t blockCount{};      ///< Number of blocks.
+        };
+
+        /** Entry in the block directory following the section directory.
+            Blocks that don't compress are stored uncompressed, which is indicated by storedSize == size.
+        */
+        struct BlockDesc
+        {
+            uint64_t offset{};          ///< Offset from the start of the file in bytes.
+            uint32_t storedSize{};      ///< Size in the file in bytes.
+            uint32_t size{};            ///< Uncompressed size in bytes.
+        };
+
+        size_t alignOffset(size_t offset)
+        {
+            return (offset + kBlockAlignment - 1) & ~(kBlockAlignment - 1);
+        }
+
+        /** Get the path of the lock file guarding a cache file.
+            Readers hold a shared lock while the file is open, writers hold an exclusive lock while replacing it.
+        */
+        std::filesystem::path getLockPath(const std::filesystem::path& path)
+        {
+            return path.string() + ".lock";
+        }
+
+        /** Get a unique temporary path in the same directory as the given file.
+        */
+        std::filesystem::path getTempPath(const std::filesystem::path& path)
+        {
+            std::random_device rd;
+            return fmt::format("{}.{:08x}{:08x}.tmp", path.string(), rd(), rd());
+        }
+
+        /** Replace a file with a completely written temporary file.
+            The rename is atomic, so other processes sharing the cache directory either see the old or the new file.
+        */
+        void replaceFile(const std::filesystem::path& tempPath, const std::filesystem::path& path)
+        {
+            std::error_code ec;
+            LockFile lockFile(getLockPath(path));
+            if (!lockFile.isOpen() || !lockFile.lock(LockFile::LockType::Exclusive))
+            {
+                std::filesystem::remove(tempPath, ec);
+                throw RuntimeError("Failed to lock scene cache file '{}'.", path);
+            }
+            std::filesystem::rename(tempPath, path, ec);
+            lockFile.unlock();
+            if (ec)
+            {
+                std::filesystem::remove(tempPath, ec);
+                throw RuntimeError("Failed to replace scene cache file '{}'.", path);
+            }
+        }
+
+        uint64_t hashFileContent(const std::filesystem::path& path)
+        {
+            std::ifstream fs(path, std::ios_base::binary);
+            if (!fs) throw RuntimeError("Failed to read from file '{}'.", path);
+
+            FNVHash64 hash;
+            std::vector<char> buffer(1024 * 1024);
+            while (fs)
+            {
+                fs.read(buffer.data(), buffer.size());
+                hash.insert(buffer.data(), (size_t)fs.gcount());
+            }
+            return hash.get();
+        }
     }
 
-    /** Wrapper around std::ostream to ease serialization of basic types.
+    /** Helper for serializing basic types into a memory buffer.
     */
     class SceneCache::OutputStream
     {
     public:
-        OutputStream(std::ostream& stream) : mStream(stream) {}
+        OutputStream(std::vector<uint8_t>& buffer) : mBuffer(buffer) {}
 
         void write(const void* data, size_t len)
         {
-            mStream.write(reinterpret_cast<const char*>(data), len);
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+            mBuffer.insert(mBuffer.end(), bytes, bytes + len);
         }
 
         template<typename T>
@@ -118,19 +230,21 @@ namespace Falcor
         }
 
     private:
-        std::ostream& mStream;
+        std::vector<uint8_t>& mBuffer;
     };
 
-    /** Wrapper around std::istream to ease serialization of basic types.
+    /** Helper for deserializing basic types from a memory buffer.
     */
     class SceneCache::InputStream
     {
     public:
-        InputStream(std::istream& stream) : mStream(stream) {}
+        InputStream(const uint8_t* data, size_t size) : mData(data), mSize(size) {}
 
         void read(void* data, size_t len)
         {
-            mStream.read(reinterpret_cast<char*>(data), len);
+            if (len > mSize - mOffset) throw RuntimeError("Unexpected end of scene cache section.");
+            std::memcpy(data, mData + mOffset, len);
+            mOffset += len;
         }
 
         template<typename T>
@@ -188,49 +302,471 @@ namespace Falcor
             }
         }
 
+        bool isAtEnd() const { return mOffset == mSize; }
+
     private:
-        std::istream& mStream;
+        const uint8_t* mData;
+        size_t mSize;
+        size_t mOffset = 0;
     };
 
+    /** Collects the sections of a scene cache and writes them to a file.
+    */
+    class SceneCache::SectionWriter
+    {
+    public:
+        SectionWriter(bool compressArrays) : mCompressArrays(compressArrays) {}
+
+        /** Add a section that is serialized into the returned stream.
+            The stream is valid for the lifetime of the writer.
+        */
+        OutputStream& addSection(const std::string& name)
+        {
+            auto& section = addSection(name, true);
+            mStreams.emplace_back(section.storage);
+            return mStreams.back();
+        }
+
+        /** Add a section storing the raw contents of an array.
+            The array is referenced and must stay alive until the file is written.
+        */
+        template<typename T>
+        void addArraySection(const std::string& name, const std::vector<T>& vec)
+        {
+            static_assert(std::is_trivially_copyable<T>::value);
+            auto& section = addSection(name, mCompressArrays);
+            section.pData = reinterpret_cast<const uint8_t*>(vec.data());
+            section.size = vec.size() * sizeof(T);
+        }
+
+        /** Set the serialized dependency manifest stored after the file header.
+        */
+        void setManifest(std::vector<uint8_t> manifest) { mManifest = std::move(manifest); }
+
+        /** Copy all referenced arrays into storage owned by the writer.
+            After this call the writer no longer references the scene data.
+        */
+        void copyArrays()
+        {
+            for (auto& section : mSections)
+            {
+                if (!section.pData) continue;
+                section.storage.assign(section.pData, section.pData + section.size);
+                section.pData = nullptr;
+                section.size = 0;
+            }
+        }
+
+        /** Compress all blocks in parallel and write the file.
+            The file is first written to a temporary file, which then atomically replaces the cache file.
+        */
+        void writeFile(const std::filesystem::path& path) const
+        {
+            // Split sections into blocks.
+            std::vector<SectionDesc> sectionDescs;
+            std::vector<BlockDesc> blockDescs;
+            std::vector<const uint8_t*> blockData;
+            std::vector<uint8_t> blockCompress;
+
+            for (const auto& section : mSections)
+            {
+                const uint8_t* pData = section.pData ? section.pData : section.storage.data();
+                const size_t size = section.pData ? section.size : section.storage.size();
+
+                SectionDesc sectionDesc;
+                std::strncpy(sectionDesc.name, section.name.c_str(), sizeof(sectionDesc.name) - 1);
+                sectionDesc.size = size;
+                sectionDesc.firstBlock = (uint32_t)blockDescs.size();
+                sectionDesc.blockCount = (uint32_t)((size + kBlockSize - 1) / kBlockSize);
+                sectionDescs.push_back(sectionDesc);
+
+                for (size_t offset = 0; offset < size; offset += kBlockSize)
+                {
+                    BlockDesc blockDesc;
+                    blockDesc.size = (uint32_t)std::min(kBlockSize, size - offset);
+                    blockDesc.storedSize = blockDesc.size;
+                    blockDescs.push_back(blockDesc);
+                    blockData.push_back(pData + offset);
+                    blockCompress.push_back(section.compress ? 1 : 0);
+                }
+            }
+
+            // Compress blocks in parallel.
+            std::vector<std::vector<uint8_t>> compressedBlocks(blockDescs.size());
+            Threading::parallel_for(size_t(0), blockDescs.size(), [&](size_t i)
+            {
+                if (!blockCompress[i]) return;
+                auto& blockDesc = blockDescs[i];
+                auto& compressed = compressedBlocks[i];
+                compressed.resize(LZ4_compressBound((int)blockDesc.size));
+                int compressedSize = LZ4_compress_default(
+                    reinterpret_cast<const char*>(blockData[i]), reinterpret_cast<char*>(compressed.data()), (int)blockDesc.size, (int)compressed.size()
+                );
+                // Store the block uncompressed if compression doesn't reduce its size.
+                if (compressedSize > 0 && (uint32_t)compressedSize < blockDesc.size)
+                {
+                    blockDesc.storedSize = (uint32_t)compressedSize;
+                    compressed.resize(blockDesc.storedSize);
+                    compressed.shrink_to_fit();
+                    blockData[i] = compressed.data();
+                }
+                else
+                {
+                    compressed = {};
+                }
+            }, 1);
+
+            // Assign aligned file offsets to the blocks.
+            size_t fileOffset = sizeof(Header) + mManifest.size() + sectionDescs.size() * sizeof(SectionDesc) + blockDescs.size() * sizeof(BlockDesc);
+            for (auto& blockDesc : blockDescs)
+            {
+                fileOffset = alignOffset(fileOffset);
+                blockDesc.offset = fileOffset;
+                fileOffset += blockDesc.storedSize;
+            }
+
+            std::filesystem::create_directories(path.parent_path());
+            auto tempPath = getTempPath(path);
+
+            {
+                std::ofstream fs(tempPath, std::ios_base::binary);
+                if (fs.bad()) throw RuntimeError("Failed to create scene cache file '{}'.", tempPath);
+
+                Header header;
+                std::memcpy(header.magic, kMagic, sizeof(Header::magic));
+                header.version = kVersion;
+                header.sectionCount = (uint32_t)sectionDescs.size();
+                header.manifestSize = mManifest.size();
+                fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                fs.write(reinterpret_cast<const char*>(mManifest.data()), mManifest.size());
+                fs.write(reinterpret_cast<const char*>(sectionDescs.data()), sectionDescs.size() * sizeof(SectionDesc));
+                fs.write(reinterpret_cast<const char*>(blockDescs.data()), blockDescs.size() * sizeof(BlockDesc));
+
+                const char padding[kBlockAlignment] = {};
+                for (size_t i = 0; i < blockDescs.size(); i++)
+                {
+                    size_t paddingSize = blockDescs[i].offset - (size_t)fs.tellp();
+                    fs.write(padding, paddingSize);
+                    fs.write(reinterpret_cast<const char*>(blockData[i]), blockDescs[i].storedSize);
+                }
+
+                fs.close();
+                if (fs.fail())
+                {
+                    std::error_code ec;
+                    std::filesystem::remove(tempPath, ec);
+                    throw RuntimeError("Failed to write scene cache file to '{}'.", tempPath);
+                }
+            }
+
+            replaceFile(tempPath, path);
+        }
+
+    private:
+        struct Section
+        {
+            std::string name;
+            bool compress = true;
+            std::vector<uint8_t> storage;       ///< Serialized data owned by the section.
+            const uint8_t* pData = nullptr;     ///< Referenced array data, or nullptr if data is stored in 'storage'.
+            size_t size = 0;                    ///< Size of referenced array data in bytes.
+        };
+
+        Section& addSection(const std::string& name, bool compress)
+        {
+            FALCOR_ASSERT(name.size() < sizeof(SectionDesc::name));
+            auto& section = mSections.emplace_back();
+            section.name = name;
+            section.compress = compress;
+            return section;
+        }
+
+        bool mCompressArrays;
+        std::vector<uint8_t> mManifest;
+        std::deque<Section> mSections;
+        std::deque<OutputStream> mStreams;
+    };
+
+    /** Reads the sections of a scene cache from a memory-mapped file.
+        Array destinations are registered first, then all blocks are decompressed in parallel
+        before the remaining sections are deserialized.
+    */
+    class SceneCache::SectionReader
+    {
+    public:
+        SectionReader(const std::filesystem::path& path)
+            : mPath(path)
+        {
+            // Hold a shared lock while the file is mapped so it is not replaced by a concurrent writer.
+            if (mLockFile.open(getLockPath(path))) mLockFile.lock(LockFile::LockType::Shared);
+
+            if (!mFile.open(path)) throw RuntimeError("Failed to open scene cache file '{}'.", path);
+
+            const uint8_t* pData = getFileData();
+            const size_t fileSize = mFile.getSize();
+
+            Header header;
+            if (fileSize < sizeof(header)) throw RuntimeError("Invalid header in scene cache file '{}'.", path);
+            std::memcpy(&header, pData, sizeof(header));
+            if (!header.isValid()) throw RuntimeError("Invalid header in scene cache file '{}'.", path);
+
+            if (header.manifestSize > fileSize - sizeof(header)) throw RuntimeError("Invalid dependency manifest in scene cache file '{}'.", path);
+            size_t offset = sizeof(header) + header.manifestSize;
+            if (header.sectionCount * sizeof(SectionDesc) > fileSize - offset) throw RuntimeError("Invalid section directory in scene cache file '{}'.", path);
+            mSections.resize(header.sectionCount);
+            uint64_t blockCount = 0;
+            for (auto& section : mSections)
+            {
+                std::memcpy(&section.desc, pData + offset, sizeof(SectionDesc));
+                section.desc.name[sizeof(SectionDesc::name) - 1] = 0;
+                offset += sizeof(SectionDesc);
+                if (section.desc.firstBlock != blockCount) throw RuntimeError("Invalid section directory in scene cache file '{}'.", path);
+                blockCount += section.desc.blockCount;
+            }
+
+            if (blockCount * sizeof(BlockDesc) > fileSize - offset) throw RuntimeError("Invalid block directory in scene cache file '{}'.", path);
+            mBlocks.resize(blockCount);
+            std::memcpy(mBlocks.data(), pData + offset, mBlocks.size() * sizeof(BlockDesc));
+
+            for (const auto& section : mSections)
+            {
+                uint64_t size = 0;
+                for (uint32_t i = 0; i < section.desc.blockCount; i++)
+                {
+                    const auto& block = mBlocks[section.desc.firstBlock + i];
+                    bool isLastBlock = i + 1 == section.desc.blockCount;
+                    if (block.offset > fileSize || block.storedSize > fileSize - block.offset || block.storedSize > block.size ||
+                        (isLastBlock ? block.size > kBlockSize : block.size != kBlockSize))
+                    {
+                        throw RuntimeError("Invalid block in section '{}' of scene cache file '{}'.", section.desc.name, path);
+                    }
+                    size += block.size;
+                }
+                if (size != section.desc.size) throw RuntimeError("Invalid size of section '{}' in scene cache file '{}'.", section.desc.name, path);
+            }
+        }
+
+        /** Decompress an array section directly into the given vector when calling decompress().
+        */
+        template<typename T>
+        void setArrayDestination(const std::string& name, std::vector<T>& vec)
+        {
+            static_assert(std::is_trivially_copyable<T>::value);
+            auto& section = findSection(name);
+            if (section.desc.size % sizeof(T) != 0) throw RuntimeError("Invalid size of section '{}' in scene cache file '{}'.", name, mPath);
+            vec.resize(section.desc.size / sizeof(T));
+            section.pDst = reinterpret_cast<uint8_t*>(vec.data());
+        }
+
+        /** Decompress all blocks in parallel.
+            Sections without a registered array destination are decompressed into internal buffers.
+        */
+        void decompress()
+        {
+            for (auto& section : mSections)
+            {
+                if (section.pDst) continue;
+                section.buffer.resize(section.desc.size);
+                section.pDst = section.buffer.data();
+            }
+
+            struct Task
+            {
+                const BlockDesc* pBlock;
+                uint8_t* pDst;
+            };
+            std::vector<Task> tasks;
+            tasks.reserve(mBlocks.size());
+            for (const auto& section : mSections)
+            {
+                for (uint32_t i = 0; i < section.desc.blockCount; i++)
+                {
+                    tasks.push_back({ &mBlocks[section.desc.firstBlock + i], section.pDst + i * kBlockSize });
+                }
+            }
+
+            const uint8_t* pData = getFileData();
+            std::atomic<bool> failed{ false };
+            Threading::parallel_for(size_t(0), tasks.size(), [&](size_t i)
+            {
+                const auto& block = *tasks[i].pBlock;
+                const uint8_t* pSrc = pData + block.offset;
+                if (block.storedSize == block.size)
+                {
+                    std::memcpy(tasks[i].pDst, pSrc, block.size);
+                }
+                else
+                {
+                    int size = LZ4_decompress_safe(reinterpret_cast<const char*>(pSrc), reinterpret_cast<char*>(tasks[i].pDst), (int)block.storedSize, (int)block.size);
+                    if (size != (int)block.size) failed = true;
+                }
+            }, 1);
+
+            mFile.close();
+            mLockFile.close();
+            if (failed) throw RuntimeError("Failed to decompress scene cache file '{}'.", mPath);
+        }
+
+        /** Get a stream for deserializing a section. Must be called after decompress().
+        */
+        InputStream getSection(const std::string& name)
+        {
+            const auto& section = findSection(name);
+            return InputStream(section.pDst, section.desc.size);
+        }
+
+    private:
+        struct Section
+        {
+            SectionDesc desc;
+            uint8_t* pDst = nullptr;
+            std::vector<uint8_t> buffer;
+        };
+
+        const uint8_t* getFileData() const { return reinterpret_cast<const uint8_t*>(mFile.getData()); }
+
+        Section& findSection(const std::string& name)
+        {
+            for (auto& section : mSections)
+            {
+                if (name == section.desc.name) return section;
+            }
+            throw RuntimeError("Missing section '{}' in scene cache file '{}'.", name, mPath);
+        }
+
+        std::filesystem::path mPath;
+        LockFile mLockFile;
+        MemoryMappedFile mFile;
+        std::vector<Section> mSections;
+        std::vector<BlockDesc> mBlocks;
+    };
+
+    std::optional<SceneCache::Dependency> SceneCache::createDependency(const std::filesystem::path& path, bool hashContent)
+    {
+        std::error_code ec;
+        if (!std::filesystem::is_regular_file(path, ec)) return {};
+
+        Dependency dependency;
+        dependency.path = std::filesystem::absolute(path, ec);
+        if (ec) return {};
+        dependency.size = std::filesystem::file_size(path, ec);
+        if (ec) return {};
+        auto modifiedTime = std::filesystem::last_write_time(path, ec);
+        if (ec) return {};
+        dependency.modifiedTime = (int64_t)modifiedTime.time_since_epoch().count();
+        if (hashContent) dependency.contentHash = hashFileContent(path);
+        return dependency;
+    }
+
+    bool SceneCache::isDependencyValid(const Dependency& dependency)
+    {
+        std::error_code ec;
+        uint64_t size = std::filesystem::file_size(dependency.path, ec);
+        if (ec || size != dependency.size) return false;
+        auto modifiedTime = std::filesystem::last_write_time(dependency.path, ec);
+        if (ec) return false;
+        if ((int64_t)modifiedTime.time_since_epoch().count() == dependency.modifiedTime) return true;
+
+        // The file was touched. It is still valid if its content is unchanged.
+        if (!dependency.contentHash) return false;
+        try
+        {
+            return hashFileContent(dependency.path) == *dependency.contentHash;
+        }
+        catch (const RuntimeError&)
+        {
+            return false;
+        }
+    }
+
     bool SceneCache::hasValidCache(const Key& key)
     {
         auto cachePath = getCachePath(key);
         if (!std::filesystem::exists(cachePath)) return false;
 
-        // Open file.
-        std::ifstream fs(cachePath.c_str(), std::ios_base::binary);
-        if (fs.bad()) return false;
+        std::vector<uint8_t> manifest;
+        {
+            // Hold a shared lock while the file is open so it is not replaced by a concurrent writer.
+            LockFile lockFile;
+            if (lockFile.open(getLockPath(cachePath))) lockFile.lock(LockFile::LockType::Shared);
+
+            // Open file.
+            std::ifstream fs(cachePath.c_str(), std::ios_base::binary);
+            if (fs.bad()) return false;
+
+            // Verify header.
+            Header header;
+            fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+            if (fs.eof() || !header.isValid()) return false;
+
+            std::error_code ec;
+            uint64_t fileSize = std::filesystem::file_size(cachePath, ec);
+            if (ec || header.manifestSize > fileSize - sizeof(header)) return false;
+
+            manifest.resize(header.manifestSize);
+            fs.read(reinterpret_cast<char*>(manifest.data()), manifest.size());
+            if (!fs) return false;
+        }
 
-        // Verify header.
-        Header header;
-        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
-        return !fs.eof() && header.isValid();
+        // Verify dependencies.
+        try
+        {
+            InputStream stream(manifest.data(), manifest.size());
+            uint32_t dependencyCount = stream.read<uint32_t>();
+            for (uint32_t i = 0; i < dependencyCount; i++)
+            {
+                auto dependency = readDependency(stream);
+                if (!isDependencyValid(dependency))
+                {
+                    logInfo("Scene cache '{}' is out of date, '{}' has changed.", cachePath, dependency.path);
+                    return false;
+                }
+            }
+            return stream.isAtEnd();
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
     }
 
-    void SceneCache::writeCache(const Scene::SceneData& sceneData, const Key& key)
+    void SceneCache::writeCache(const Scene::SceneData& sceneData, const Key& key, const DependencyList& dependencies, bool compressArrays)
     {
         auto cachePath = getCachePath(key);
 
         logInfo("Writing scene cache to '{}'.", cachePath);
 
-        // Create directories if not existing.
-        std::filesystem::create_directories(cachePath.parent_path());
+        SectionWriter writer(compressArrays);
+        writeManifest(writer, dependencies);
+        writeSceneData(writer, sceneData);
+        writer.writeFile(cachePath);
+    }
+
+    Threading::Task SceneCache::writeCacheAsync(const Scene::SceneData& sceneData, const Key& key, const DependencyList& dependencies, bool compressArrays)
+    {
+        auto cachePath = getCachePath(key);
 
-        // Open file.
-        std::ofstream fs(cachePath.c_str(), std::ios_base::binary);
-        if (fs.bad()) throw RuntimeError("Failed to create scene cache file '{}'.", cachePath);
+        logInfo("Writing scene cache to '{}' in the background.", cachePath);
 
-        // Write header (uncompressed).
-        Header header;
-        std::memcpy(header.magic, kMagic, sizeof(Header::magic));
-        header.version = kVersion;
-        fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        // Serialize on the calling thread. The scene data is released after this function returns,
+        // so the writer takes a copy of the arrays it would otherwise reference.
+        auto pWriter = std::make_shared<SectionWriter>(compressArrays);
+        writeManifest(*pWriter, dependencies);
+        writeSceneData(*pWriter, sceneData);
+        pWriter->copyArrays();
 
-        // Write cache (compressed).
-        lz4_stream::basic_ostream<kBlockSize> zs(fs);
-        OutputStream stream(zs);
-        writeSceneData(stream, sceneData);
-        if (fs.bad()) throw RuntimeError("Failed to write scene cache file to '{}'.", cachePath);
+        return Threading::dispatchTask([pWriter, cachePath]()
+        {
+            try
+            {
+                pWriter->writeFile(cachePath);
+                logInfo("Finished writing scene cache to '{}'.", cachePath);
+            }
+            catch (const std::exception& e)
+            {
+                logWarning("Failed to write scene cache to '{}': {}", cachePath, e.what());
+            }
+        });
     }
 
     Scene::SceneData SceneCache::readCache(ref<Device> pDevice, const Key& key)
@@ -239,21 +775,96 @@ namespace Falcor
 
         logInfo("Loading scene cache from '{}'.", cachePath);
 
-        // Open file.
-        std::ifstream fs(cachePath.c_str(), std::ios_base::binary);
-        if (fs.bad()) throw RuntimeError("Failed to open scene cache file '{}'.", cachePath);
+        SectionReader reader(cachePath);
+        return readSceneData(reader, pDevice);
+    }
 
-        // Read header (uncompressed).
-        Header header;
-        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
-        if (!header.isValid()) throw RuntimeError("Invalid header in scene cache file '{}'.", cachePath);
+    ref<TriangleMesh> SceneCache::readTriangleMeshFragment(const Dependency& dependency, bool smoothNormals)
+    {
+        auto fragmentPath = getFragmentPath(dependency.path, "TriangleMesh", smoothNormals);
+        std::error_code ec;
+        if (!std::filesystem::exists(fragmentPath, ec)) return nullptr;
 
-        // Read cache (compressed).
-        lz4_stream::basic_istream<kBlockSize, kBlockSize> zs(fs);
-        InputStream stream(zs);
-        auto sceneData = readSceneData(stream, pDevice);
-        if (fs.bad()) throw RuntimeError("Failed to read scene cache file from '{}'.", cachePath);
-        return sceneData;
+        try
+        {
+            std::string data;
+            {
+                LockFile lockFile;
+                if (lockFile.open(getLockPath(fragmentPath))) lockFile.lock(LockFile::LockType::Shared);
+                data = readFile(fragmentPath);
+            }
+            InputStream stream(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+
+            FragmentHeader header;
+            stream.read(header);
+            if (!header.isValid()) return nullptr;
+
+            // The fragment is valid if it was created from the same state of the asset file.
+            auto cached = readDependency(stream);
+            if (cached.path != dependency.path || cached.size != dependency.size) return nullptr;
+            if (cached.modifiedTime != dependency.modifiedTime)
+            {
+                if (!cached.contentHash || !dependency.contentHash || *cached.contentHash != *dependency.contentHash) return nullptr;
+            }
+
+            std::string name = stream.read<std::string>();
+            bool frontFaceCW = stream.read<bool>();
+            TriangleMesh::VertexList vertices;
+            stream.read(vertices);
+            TriangleMesh::IndexList indices;
+            stream.read(indices);
+            if (!stream.isAtEnd()) return nullptr;
+
+            auto pMesh = TriangleMesh::create(vertices, indices, frontFaceCW);
+            pMesh->setName(name);
+            return pMesh;
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to read scene cache fragment '{}': {}", fragmentPath, e.what());
+            return nullptr;
+        }
+    }
+
+    void SceneCache::writeTriangleMeshFragment(const Dependency& dependency, bool smoothNormals, const ref<TriangleMesh>& pMesh)
+    {
+        FALCOR_ASSERT(pMesh);
+        auto fragmentPath = getFragmentPath(dependency.path, "TriangleMesh", smoothNormals);
+
+        std::vector<uint8_t> data;
+        OutputStream stream(data);
+
+        FragmentHeader header;
+        std::memcpy(header.magic, kFragmentMagic, sizeof(FragmentHeader::magic));
+        header.version = kVersion;
+        stream.write(header);
+        writeDependency(stream, dependency);
+        stream.write(pMesh->getName());
+        stream.write(pMesh->getFrontFaceCW());
+        stream.write(pMesh->getVertices());
+        stream.write(pMesh->getIndices());
+
+        try
+        {
+            std::filesystem::create_directories(fragmentPath.parent_path());
+            auto tempPath = getTempPath(fragmentPath);
+            {
+                std::ofstream fs(tempPath, std::ios_base::binary);
+                fs.write(reinterpret_cast<const char*>(data.data()), data.size());
+                fs.close();
+                if (fs.fail())
+                {
+                    std::error_code ec;
+                    std::filesystem::remove(tempPath, ec);
+                    throw RuntimeError("Failed to write file '{}'.", tempPath);
+                }
+            }
+            replaceFile(tempPath, fragmentPath);
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to write scene cache fragment '{}': {}", fragmentPath, e.what());
+        }
     }
 
     std::filesystem::path SceneCache::getCachePath(const Key& key)
@@ -261,153 +872,247 @@ namespace Falcor
         return getAppDataDirectory() / kDirectory / SHA1::toString(key);
     }
 
+    std::filesystem::path SceneCache::getFragmentPath(const std::filesystem::path& assetPath, const std::string& type, bool smoothNormals)
+    {
+        SHA1 sha1;
+        sha1.update(type.data(), type.size());
+        auto pathStr = assetPath.string();
+        sha1.update(pathStr.data(), pathStr.size());
+        sha1.update(&smoothNormals, sizeof(smoothNormals));
+        return getAppDataDirectory() / kDirectory / kFragmentDirectory / SHA1::toString(sha1.finalize());
+    }
+
+    void SceneCache::writeManifest(SectionWriter& writer, const DependencyList& dependencies)
+    {
+        std::vector<uint8_t> manifest;
+        OutputStream stream(manifest);
+        stream.write((uint32_t)dependencies.size());
+        for (const auto& dependency : dependencies) writeDependency(stream, dependency);
+        writer.setManifest(std::move(manifest));
+    }
+
+    void SceneCache::writeDependency(OutputStream& stream, const Dependency& dependency)
+    {
+        stream.write(dependency.path);
+        stream.write(dependency.size);
+        stream.write(dependency.modifiedTime);
+        stream.write(dependency.contentHash);
+    }
+
+    SceneCache::Dependency SceneCache::readDependency(InputStream& stream)
+    {
+        Dependency dependency;
+        stream.read(dependency.path);
+        stream.read(dependency.size);
+        stream.read(dependency.modifiedTime);
+        stream.read(dependency.contentHash);
+        return dependency;
+    }
+
     // SceneData
 
-    void SceneCache::writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData)
+    void SceneCache::writeSceneData(SectionWriter& writer, const Scene::SceneData& sceneData)
     {
-        writeMarker(stream, "Path");
-        stream.write(sceneData.path);
+        {
+            auto& stream = writer.addSection("Scene");
 
-        writeMarker(stream, "RenderSettings");
-        stream.write(sceneData.renderSettings);
+            writeMarker(stream, "Path");
+            stream.write(sceneData.path);
 
-        writeMarker(stream, "Cameras");
-        stream.write((uint32_t)sceneData.cameras.size());
-        for (const auto& pCamera : sceneData.cameras) writeCamera(stream, pCamera);
-        stream.write(sceneData.selectedCamera);
-        stream.write(sceneData.cameraSpeed);
+            writeMarker(stream, "RenderSettings");
+            stream.write(sceneData.renderSettings);
 
-        writeMarker(stream, "Lights");
-        stream.write((uint32_t)sceneData.lights.size());
-        for (const auto& pLight : sceneData.lights) writeLight(stream, pLight);
+            writeMarker(stream, "Cameras");
+            stream.write((uint32_t)sceneData.cameras.size());
+            for (const auto& pCamera : sceneData.cameras) writeCamera(stream, pCamera);
+            stream.write(sceneData.selectedCamera);
+            stream.write(sceneData.cameraSpeed);
 
-        writeMarker(stream, "Grids");
-        stream.write((uint32_t)sceneData.grids.size());
-        for (const auto& pGrid : sceneData.grids) writeGrid(stream, pGrid);
+            writeMarker(stream, "Lights");
+            stream.write((uint32_t)sceneData.lights.size());
+            for (const auto& pLight : sceneData.lights) writeLight(stream, pLight);
 
-        writeMarker(stream, "GridVolumes");
-        stream.write((uint32_t)sceneData.gridVolumes.size());
-        for (const auto& pGridVolume : sceneData.gridVolumes) writeGridVolume(stream, pGridVolume, sceneData.grids);
+            writeMarker(stream, "EnvMap");
+            bool hasEnvMap = sceneData.pEnvMap != nullptr;
+            stream.write(hasEnvMap);
+            if (hasEnvMap) writeEnvMap(stream, sceneData.pEnvMap);
 
-        writeMarker(stream, "EnvMap");
-        bool hasEnvMap = sceneData.pEnvMap != nullptr;
-        stream.write(hasEnvMap);
-        if (hasEnvMap) writeEnvMap(stream, sceneData.pEnvMap);
+            writeMarker(stream, "SceneGraph");
+            stream.write((uint32_t)sceneData.sceneGraph.size());
+            for (const auto& node : sceneData.sceneGraph)
+            {
+                stream.write(node.name);
+                stream.write(node.parent);
+                stream.write(node.transform);
+                stream.write(node.meshBind);
+                stream.write(node.localToBindSpace);
+            }
 
-        writeMarker(stream, "Materials");
-        writeMaterials(stream, *sceneData.pMaterials);
+            writeMarker(stream, "Metadata");
+            writeMetadata(stream, sceneData.metadata);
+        }
 
-        writeMarker(stream, "SceneGraph");
-        stream.write((uint32_t)sceneData.sceneGraph.size());
-        for (const auto& node : sceneData.sceneGraph)
         {
-            stream.write(node.name);
-            stream.write(node.parent);
-            stream.write(node.transform);
-            stream.write(node.meshBind);
-            stream.write(node.localToBindSpace);
+            auto& stream = writer.addSection("Grids");
+
+            writeMarker(stream, "Grids");
+            stream.write((uint32_t)sceneData.grids.size());
+            for (const auto& pGrid : sceneData.grids) writeGrid(stream, pGrid);
+
+            writeMarker(stream, "GridVolumes");
+            stream.write((uint32_t)sceneData.gridVolumes.size());
+            for (const auto& pGridVolume : sceneData.gridVolumes) writeGridVolume(stream, pGridVolume, sceneData.grids);
         }
 
-        writeMarker(stream, "Animations");
-        stream.write((uint32_t)sceneData.animations.size());
-        for (const auto& pAnimation : sceneData.animations)
         {
-            writeAnimation(stream, pAnimation);
+            auto& stream = writer.addSection("Materials");
+            writeMaterials(stream, *sceneData.pMaterials);
         }
 
-        writeMarker(stream, "Metadata");
-        writeMetadata(stream, sceneData.metadata);
-
-        writeMarker(stream, "Meshes");
-        stream.write(sceneData.meshDesc);
-        stream.write(sceneData.meshNames);
-        stream.write(sceneData.meshBBs);
-        stream.write(sceneData.meshInstanceData);
-        stream.write((uint32_t)sceneData.meshIdToInstanceIds.size());
-        for (const auto& item : sceneData.meshIdToInstanceIds)
         {
-            stream.write(item);
+            auto& stream = writer.addSection("Animations");
+            stream.write((uint32_t)sceneData.animations.size());
+            for (const auto& pAnimation : sceneData.animations)
+            {
+                writeAnimation(stream, pAnimation);
+            }
         }
-        stream.write((uint32_t)sceneData.meshGroups.size());
-        for (const auto& group : sceneData.meshGroups)
+
         {
-            stream.write(group.meshList);
-            stream.write(group.isStatic);
-            stream.write(group.isDisplaced);
+            auto& stream = writer.addSection("Meshes");
+            stream.write(sceneData.meshDesc);
+            stream.write(sceneData.meshNames);
+            stream.write(sceneData.meshBBs);
+            stream.write(sceneData.meshInstanceData);
+            stream.write((uint32_t)sceneData.meshIdToInstanceIds.size());
+            for (const auto& item : sceneData.meshIdToInstanceIds)
+            {
+                stream.write(item);
+            }
+            stream.write((uint32_t)sceneData.meshGroups.size());
+            for (const auto& group : sceneData.meshGroups)
+            {
+                stream.write(group.meshList);
+                stream.write(group.isStatic);
+                stream.write(group.isDisplaced);
+            }
+            stream.write((uint32_t)sceneData.cachedMeshes.size());
+            for (const auto& cachedMesh : sceneData.cachedMeshes)
+            {
+                stream.write(cachedMesh.meshID);
+                stream.write(cachedMesh.timeSamples);
+                stream.write((uint32_t)cachedMesh.vertexData.size());
+                for (const auto& data : cachedMesh.vertexData) stream.write(data);
+            }
+            stream.write(sceneData.useCompressedHitInfo);
+            stream.write(sceneData.useCompactVertexData);
+            stream.write(sceneData.compactVertexOffset);
+            stream.write(sceneData.has16BitIndices);
+            stream.write(sceneData.has32BitIndices);
+            stream.write(sceneData.meshDrawCount);
         }
-        stream.write((uint32_t)sceneData.cachedMeshes.size());
-        for (const auto& cachedMesh : sceneData.cachedMeshes)
+        writer.addArraySection("MeshIndexData", sceneData.meshIndexData);
+        writer.addArraySection("MeshStaticData", sceneData.meshStaticData);
+        writer.addArraySection("MeshSkinningData", sceneData.meshSkinningData);
+
         {
-            stream.write(cachedMesh.meshID);
-            stream.write(cachedMesh.timeSamples);
-            stream.write((uint32_t)cachedMesh.vertexData.size());
-            for (const auto& data : cachedMesh.vertexData) stream.write(data);
-        }
-        stream.write(sceneData.useCompressedHitInfo);
-        stream.write(sceneData.has16BitIndices);
-        stream.write(sceneData.has32BitIndices);
-        stream.write(sceneData.meshDrawCount);
-        stream.write(sceneData.meshIndexData);
-        stream.write(sceneData.meshStaticData);
-        stream.write(sceneData.meshSkinningData);
+            auto& stream = writer.addSection("Curves");
+            stream.write(sceneData.curveDesc);
+            stream.write(sceneData.curveBBs);
+            stream.write(sceneData.curveInstanceData);
 
-        writeMarker(stream, "Curves");
-        stream.write(sceneData.curveDesc);
-        stream.write(sceneData.curveBBs);
-        stream.write(sceneData.curveInstanceData);
-        stream.write(sceneData.curveIndexData);
-        stream.write(sceneData.curveStaticData);
+            stream.write((uint32_t)sceneData.cachedCurves.size());
+            for (const auto& cachedCurve : sceneData.cachedCurves)
+            {
+                stream.write(cachedCurve.tessellationMode);
+                stream.write(cachedCurve.geometryID);
+                stream.write(cachedCurve.timeSamples);
+                stream.write(cachedCurve.indexData);
+                stream.write((uint32_t)cachedCurve.vertexData.size());
+                for (const auto& data : cachedCurve.vertexData) stream.write(data);
+            }
+        }
+        writer.addArraySection("CurveIndexData", sceneData.curveIndexData);
+        writer.addArraySection("CurveStaticData", sceneData.curveStaticData);
 
-        stream.write((uint32_t)sceneData.cachedCurves.size());
-        for (const auto& cachedCurve : sceneData.cachedCurves)
         {
-            stream.write(cachedCurve.tessellationMode);
-            stream.write(cachedCurve.geometryID);
-            stream.write(cachedCurve.timeSamples);
-            stream.write(cachedCurve.indexData);
-            stream.write((uint32_t)cachedCurve.vertexData.size());
-            for (const auto& data : cachedCurve.vertexData) stream.write(data);
+            auto& stream = writer.addSection("CustomPrimitives");
+            stream.write(sceneData.customPrimitiveDesc);
+            stream.write(sceneData.customPrimitiveAABBs);
         }
-
-        writeMarker(stream, "CustomPrimitives");
-        stream.write(sceneData.customPrimitiveDesc);
-        stream.write(sceneData.customPrimitiveAABBs);
-
-        writeMarker(stream, "End");
     }
 
-    Scene::SceneData SceneCache::readSceneData(InputStream& stream, ref<Device> pDevice)
+    Scene::SceneData SceneCache::readSceneData(SectionReader& reader, ref<Device> pDevice)
     {
         Scene::SceneData sceneData;
         sceneData.pMaterials = std::make_unique<MaterialSystem>(pDevice);
 
-        readMarker(stream, "Path");
-        stream.read(sceneData.path);
+        // Decompress all sections in parallel. Large arrays are decompressed directly into the scene data.
+        reader.setArrayDestination("MeshIndexData", sceneData.meshIndexData);
+        reader.setArrayDestination("MeshStaticData", sceneData.meshStaticData);
+        reader.setArrayDestination("MeshSkinningData", sceneData.meshSkinningData);
+        reader.setArrayDestination("CurveIndexData", sceneData.curveIndexData);
+        reader.setArrayDestination("CurveStaticData", sceneData.curveStaticData);
+        reader.decompress();
 
-        readMarker(stream, "RenderSettings");
-        stream.read(sceneData.renderSettings);
+        auto endSection = [](const InputStream& stream, const std::string& name)
+        {
+            if (!stream.isAtEnd()) throw RuntimeError("Found trailing data in scene cache section '{}'.", name);
+        };
 
-        readMarker(stream, "Cameras");
-        sceneData.cameras.resize(stream.read<uint32_t>());
-        for (auto& pCamera : sceneData.cameras) pCamera = readCamera(stream);
-        stream.read(sceneData.selectedCamera);
-        stream.read(sceneData.cameraSpeed);
+        {
+            auto stream = reader.getSection("Scene");
 
-        readMarker(stream, "Lights");
-        sceneData.lights.resize(stream.read<uint32_t>());
-        for (auto& pLight : sceneData.lights) pLight = readLight(stream);
+            readMarker(stream, "Path");
+            stream.read(sceneData.path);
 
-        readMarker(stream, "Grids");
-        sceneData.grids.resize(stream.read<uint32_t>());
-        for (auto& pGrid : sceneData.grids) pGrid = readGrid(stream, pDevice);
+            readMarker(stream, "RenderSettings");
+            stream.read(sceneData.renderSettings);
 
-        readMarker(stream, "GridVolumes");
-        sceneData.gridVolumes.resize(stream.read<uint32_t>());
-        for (auto& pGridVolume : sceneData.gridVolumes) pGridVolume = readGridVolume(stream, sceneData.grids, pDevice);
+            readMarker(stream, "Cameras");
+            sceneData.cameras.resize(stream.read<uint32_t>());
+            for (auto& pCamera : sceneData.cameras) pCamera = readCamera(stream);
+            stream.read(sceneData.selectedCamera);
+            stream.read(sceneData.cameraSpeed);
 
-        readMarker(stream, "EnvMap");
-        auto hasEnvMap = stream.read<bool>();
-        if (hasEnvMap) sceneData.pEnvMap = readEnvMap(stream, pDevice);
+            readMarker(stream, "Lights");
+            sceneData.lights.resize(stream.read<uint32_t>());
+            for (auto& pLight : sceneData.lights) pLight = readLight(stream);
+
+            readMarker(stream, "EnvMap");
+            auto hasEnvMap = stream.read<bool>();
+            if (hasEnvMap) sceneData.pEnvMap = readEnvMap(stream, pDevice);
+
+            readMarker(stream, "SceneGraph");
+            sceneData.sceneGraph.resize(stream.read<uint32_t>());
+            for (auto &node : sceneData.sceneGraph)
+            {
+                stream.read(node.name);
+                stream.read(node.parent);
+                stream.read(node.transform);
+                stream.read(node.meshBind);
+                stream.read(node.localToBindSpace);
+            }
+
+            readMarker(stream, "Metadata");
+            sceneData.metadata = readMetadata(stream);
+
+            endSection(stream, "Scene");
+        }
+
+        {
+            auto stream = reader.getSection("Grids");
+
+            readMarker(stream, "Grids");
+            sceneData.grids.resize(stream.read<uint32_t>());
+            for (auto& pGrid : sceneData.grids) pGrid = readGrid(stream, pDevice);
+
+            readMarker(stream, "GridVolumes");
+            sceneData.gridVolumes.resize(stream.read<uint32_t>());
+            for (auto& pGridVolume : sceneData.gridVolumes) pGridVolume = readGridVolume(stream, sceneData.grids, pDevice);
+
+            endSection(stream, "Grids");
+        }
 
         // Material textures are loaded asynchronously to allow loading other data
         // in parallel while loading textures from files and uploading them to the GPU.
@@ -418,84 +1123,80 @@ namespace Falcor
         // further down which blocks until all textures are loaded.
         auto pMaterialTextureLoader = std::make_unique<MaterialTextureLoader>(sceneData.pMaterials->getTextureManager(), true);
 
-        readMarker(stream, "Materials");
-        readMaterials(stream, *sceneData.pMaterials, *pMaterialTextureLoader, pDevice);
-
-        readMarker(stream, "SceneGraph");
-        sceneData.sceneGraph.resize(stream.read<uint32_t>());
-        for (auto &node : sceneData.sceneGraph)
         {
-            stream.read(node.name);
-            stream.read(node.parent);
-            stream.read(node.transform);
-            stream.read(node.meshBind);
-            stream.read(node.localToBindSpace);
+            auto stream = reader.getSection("Materials");
+            readMaterials(stream, *sceneData.pMaterials, *pMaterialTextureLoader, pDevice);
+            endSection(stream, "Materials");
         }
 
-        readMarker(stream, "Animations");
-        sceneData.animations.resize(stream.read<uint32_t>());
-        for (auto& pAnimation : sceneData.animations) pAnimation = readAnimation(stream);
-
-        readMarker(stream, "Metadata");
-        sceneData.metadata = readMetadata(stream);
-
-        readMarker(stream, "Meshes");
-        stream.read(sceneData.meshDesc);
-        stream.read(sceneData.meshNames);
-        stream.read(sceneData.meshBBs);
-        stream.read(sceneData.meshInstanceData);
-        sceneData.meshIdToInstanceIds.resize(stream.read<uint32_t>());
-        for (auto& item : sceneData.meshIdToInstanceIds)
         {
-            stream.read(item);
+            auto stream = reader.getSection("Animations");
+            sceneData.animations.resize(stream.read<uint32_t>());
+            for (auto& pAnimation : sceneData.animations) pAnimation = readAnimation(stream);
+            endSection(stream, "Animations");
         }
-        sceneData.meshGroups.resize(stream.read<uint32_t>());
-        for (auto& group : sceneData.meshGroups)
+
         {
-            stream.read(group.meshList);
-            stream.read(group.isStatic);
-            stream.read(group.isDisplaced);
+            auto stream = reader.getSection("Meshes");
+            stream.read(sceneData.meshDesc);
+            stream.read(sceneData.meshNames);
+            stream.read(sceneData.meshBBs);
+            stream.read(sceneData.meshInstanceData);
+            sceneData.meshIdToInstanceIds.resize(stream.read<uint32_t>());
+            for (auto& item : sceneData.meshIdToInstanceIds)
+            {
+                stream.read(item);
+            }
+            sceneData.meshGroups.resize(stream.read<uint32_t>());
+            for (auto& group : sceneData.meshGroups)
+            {
+                stream.read(group.meshList);
+                stream.read(group.isStatic);
+                stream.read(group.isDisplaced);
+            }
+            sceneData.cachedMeshes.resize(stream.read<uint32_t>());
+            for (auto& cachedMesh : sceneData.cachedMeshes)
+            {
+                stream.read(cachedMesh.meshID);
+                stream.read(cachedMesh.timeSamples);
+                cachedMesh.vertexData.resize(stream.read<uint32_t>());
+                for (auto& data : cachedMesh.vertexData) stream.read(data);
+            }
+            stream.read(sceneData.useCompressedHitInfo);
+            stream.read(sceneData.useCompactVertexData);
+            stream.read(sceneData.compactVertexOffset);
+            stream.read(sceneData.has16BitIndices);
+            stream.read(sceneData.has32BitIndices);
+            stream.read(sceneData.meshDrawCount);
+            endSection(stream, "Meshes");
         }
-        sceneData.cachedMeshes.resize(stream.read<uint32_t>());
-        for (auto& cachedMesh : sceneData.cachedMeshes)
+
         {
-            stream.read(cachedMesh.meshID);
-            stream.read(cachedMesh.timeSamples);
-            cachedMesh.vertexData.resize(stream.read<uint32_t>());
-            for (auto& data : cachedMesh.vertexData) stream.read(data);
-        }
-        stream.read(sceneData.useCompressedHitInfo);
-        stream.read(sceneData.has16BitIndices);
-        stream.read(sceneData.has32BitIndices);
-        stream.read(sceneData.meshDrawCount);
-        stream.read(sceneData.meshIndexData);
-        stream.read(sceneData.meshStaticData);
-        stream.read(sceneData.meshSkinningData);
+            auto stream = reader.getSection("Curves");
+            stream.read(sceneData.curveDesc);
+            stream.read(sceneData.curveBBs);
+            stream.read(sceneData.curveInstanceData);
 
-        readMarker(stream, "Curves");
-        stream.read(sceneData.curveDesc);
-        stream.read(sceneData.curveBBs);
-        stream.read(sceneData.curveInstanceData);
-        stream.read(sceneData.curveIndexData);
-        stream.read(sceneData.curveStaticData);
+            sceneData.cachedCurves.resize(stream.read<uint32_t>());
+            for (auto& cachedCurve : sceneData.cachedCurves)
+            {
+                stream.read(cachedCurve.tessellationMode);
+                stream.read(cachedCurve.geometryID);
+                stream.read(cachedCurve.timeSamples);
+                stream.read(cachedCurve.indexData);
+                cachedCurve.vertexData.resize(stream.read<uint32_t>());
+                for (auto& data : cachedCurve.vertexData) stream.read(data);
+            }
+            endSection(stream, "Curves");
+        }
 
-        sceneData.cachedCurves.resize(stream.read<uint32_t>());
-        for (auto& cachedCurve : sceneData.cachedCurves)
         {
-            stream.read(cachedCurve.tessellationMode);
-            stream.read(cachedCurve.geometryID);
-            stream.read(cachedCurve.timeSamples);
-            stream.read(cachedCurve.indexData);
-            cachedCurve.vertexData.resize(stream.read<uint32_t>());
-            for (auto& data : cachedCurve.vertexData) stream.read(data);
+            auto stream = reader.getSection("CustomPrimitives");
+            stream.read(sceneData.customPrimitiveDesc);
+            stream.read(sceneData.customPrimitiveAABBs);
+            endSection(stream, "CustomPrimitives");
         }
 
-        readMarker(stream, "CustomPrimitives");
-        stream.read(sceneData.customPrimitiveDesc);
-        stream.read(sceneData.customPrimitiveAABBs);
-
-        readMarker(stream, "End");
-
         pMaterialTextureLoader.reset();
 
         return sceneData;
@@ -918,7 +1619,10 @@ namespace Falcor
         stream.write(pAnimation->mPostInfinityBehavior);
         stream.write(pAnimation->mInterpolationMode);
         stream.write(pAnimation->mEnableWarping);
-        stream.write(pAnimation->mKeyframes);
+        stream.write(pAnimation->mKeyframeTimes);
+        stream.write(pAnimation->mKeyframeTranslations);
+        stream.write(pAnimation->mKeyframeScalings);
+        stream.write(pAnimation->mKeyframeRotations);
     }
 
     ref<Animation> SceneCache::readAnimation(InputStream& stream)
@@ -931,7 +1635,10 @@ namespace Falcor
         stream.read(pAnimation->mPostInfinityBehavior);
         stream.read(pAnimation->mInterpolationMode);
         stream.read(pAnimation->mEnableWarping);
-        stream.read(pAnimation->mKeyframes);
+        stream.read(pAnimation->mKeyframeTimes);
+        stream.read(pAnimation->mKeyframeTranslations);
+        stream.read(pAnimation->mKeyframeScalings);
+        stream.read(pAnimation->mKeyframeRotations);
         return pAnimation;
     }
 
@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "Scene.h"
+#include "TriangleMesh.h"
 #include "Animation/Animation.h"
 #include "Camera/Camera.h"
 #include "Lights/EnvMap.h"
@@ -40,8 +41,10 @@
 #include "Core/Macros.h"
 #include "Core/API/fwd.h"
 #include "Utils/CryptoUtils.h"
+#include "Utils/Threading.h"
 
 #include <filesystem>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -50,13 +53,55 @@ namespace Falcor
     /** Helper class for reading and writing scene cache files.
         The scene cache is used to heavily reduce load times of more complex assets.
         The cache stores a binary representation of `Scene::SceneData` which contains everything to re-create a `Scene`.
+
+        The file is split into named sections (e.g. materials, meshes, vertex data) listed in a directory
+        at the start of the file. Each section is stored as a sequence of independently LZ4-compressed
+        blocks at aligned file offsets, which are compressed in parallel when writing. This allows the cache to be read through a memory-mapped file
+        with all blocks decompressed in parallel, and large arrays decompressed directly into their
+        final location in `Scene::SceneData`.
+
+        The header is followed by a manifest of all files the importers read while building the scene.
+        A cache is only considered valid if none of these files has changed since the cache was written.
+
+        In addition to full scene caches, individual assets (e.g. meshes loaded from PLY files) can be cached
+        as fragments. These are keyed by the asset path and validated against the asset file, so when a single
+        asset changes only that asset needs to be processed again on the next import.
+
+        Files are written to a temporary file first and then renamed, guarded by a lock file next to the cache file.
+        This allows multiple processes to share a cache directory without ever reading partially written files.
     */
     class FALCOR_API SceneCache
     {
     public:
         using Key = SHA1::MD;
 
+        /** A file the cached data was created from.
+        */
+        struct Dependency
+        {
+            std::filesystem::path path;             ///< Absolute file path.
+            uint64_t size = 0;                      ///< File size in bytes.
+            int64_t modifiedTime = 0;               ///< Last write time in ticks of the file clock.
+            std::optional<uint64_t> contentHash;    ///< Optional FNV-1a hash of the file content.
+        };
+
+        using DependencyList = std::vector<Dependency>;
+
+        /** Create a dependency record for the current state of a file.
+            \param[in] path File path.
+            \param[in] hashContent Compute a content hash. This allows the dependency to remain valid if only the modification time changes.
+            \return Returns the dependency or an empty optional if the file does not exist.
+        */
+        static std::optional<Dependency> createDependency(const std::filesystem::path& path, bool hashContent);
+
+        /** Check if a file is unchanged since its dependency record was created.
+            \param[in] dependency Dependency record.
+            \return Returns true if the file still exists and is unchanged.
+        */
+        static bool isDependencyValid(const Dependency& dependency);
+
         /** Check if there is a valid scene cache for a given cache key.
+            All dependencies recorded in the cache are checked for modifications.
             \param[in] key Cache key.
             \return Returns true if a valid cache exists.
         */
@@ -65,8 +110,22 @@ namespace Falcor
         /** Write a scene cache.
             \param[in] sceneData Scene data.
             \param[in] key Cache key.
+            \param[in] dependencies Files the scene data was created from.
+            \param[in] compressArrays Compress large arrays such as vertex and index data. If false, these are stored uncompressed
+                        and read with a plain copy from the mapped file, trading file size for load time.
         */
-        static void writeCache(const Scene::SceneData& sceneData, const Key& key);
+        static void writeCache(const Scene::SceneData& sceneData, const Key& key, const DependencyList& dependencies, bool compressArrays = true);
+
+        /** Write a scene cache in the background.
+            The scene data is serialized on the calling thread and can be released once this function returns.
+            Compressing and writing the file runs in a background task. Errors are logged as warnings.
+            \param[in] sceneData Scene data.
+            \param[in] key Cache key.
+            \param[in] dependencies Files the scene data was created from.
+            \param[in] compressArrays Compress large arrays such as vertex and index data.
+            \return Returns the background task.
+        */
+        static Threading::Task writeCacheAsync(const Scene::SceneData& sceneData, const Key& key, const DependencyList& dependencies, bool compressArrays = true);
 
         /** Read a scene cache.
             \param[in] pDevice GPU device.
@@ -75,14 +134,35 @@ namespace Falcor
         */
         static Scene::SceneData readCache(ref<Device> pDevice, const Key& key);
 
+        /** Read a cached triangle mesh fragment.
+            \param[in] dependency Dependency record of the file the mesh is loaded from.
+            \param[in] smoothNormals Smooth normals option the mesh is loaded with.
+            \return Returns the cached mesh or nullptr if there is no valid fragment for the current state of the file.
+        */
+        static ref<TriangleMesh> readTriangleMeshFragment(const Dependency& dependency, bool smoothNormals);
+
+        /** Write a cached triangle mesh fragment.
+            \param[in] dependency Dependency record of the file the mesh was loaded from.
+            \param[in] smoothNormals Smooth normals option the mesh was loaded with.
+            \param[in] pMesh Triangle mesh.
+        */
+        static void writeTriangleMeshFragment(const Dependency& dependency, bool smoothNormals, const ref<TriangleMesh>& pMesh);
+
     private:
         class OutputStream;
         class InputStream;
+        class SectionWriter;
+        class SectionReader;
 
         static std::filesystem::path getCachePath(const Key& key);
+        static std::filesystem::path getFragmentPath(const std::filesystem::path& assetPath, const std::string& type, bool smoothNormals);
+
+        static void writeManifest(SectionWriter& writer, const DependencyList& dependencies);
+        static void writeDependency(OutputStream& stream, const Dependency& dependency);
+        static Dependency readDependency(InputStream& stream);
 
-        static void writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData);
-        static Scene::SceneData readSceneData(InputStream& stream, ref<Device> pDevice);
+        static void writeSceneData(SectionWriter& writer, const Scene::SceneData& sceneData);
+        static Scene::SceneData readSceneData(SectionReader& reader, ref<Device> pDevice);
 
         static void writeMetadata(OutputStream& stream, const Scene::Metadata& metadata);
         static Scene::Metadata readMetadata(InputStream& stream);
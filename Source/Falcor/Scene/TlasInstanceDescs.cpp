@@ -0,0 +1,108 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "TlasInstanceDescs.h"
+#include "Core/Errors.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Falcor
+{
+    namespace
+    {
+        bool isEqual(const RtInstanceDesc& a, const RtInstanceDesc& b)
+        {
+            // The desc has no padding, so comparing the bytes compares all fields including the bitfields.
+            static_assert(sizeof(RtInstanceDesc) == 64);
+            return std::memcmp(&a, &b, sizeof(RtInstanceDesc)) == 0;
+        }
+    }
+
+    void TlasInstanceDescs::update(const std::vector<RtInstanceDesc>& descs)
+    {
+        if (descs.size() != mDescs.size())
+        {
+            mDescs = descs;
+            invalidate();
+            return;
+        }
+
+        for (uint32_t i = 0; i < (uint32_t)descs.size(); i++) set(i, descs[i]);
+    }
+
+    bool TlasInstanceDescs::set(uint32_t index, const RtInstanceDesc& desc)
+    {
+        FALCOR_CHECK_ARG_MSG(index < mDescs.size(), "Instance desc index {} is out of range.", index);
+        if (isEqual(mDescs[index], desc)) return false;
+        mDescs[index] = desc;
+        markDirty(index);
+        return true;
+    }
+
+    bool TlasInstanceDescs::setTransform(uint32_t index, const float4x4& transform)
+    {
+        FALCOR_CHECK_ARG_MSG(index < mDescs.size(), "Instance desc index {} is out of range.", index);
+        RtInstanceDesc desc = mDescs[index];
+        desc.setTransform(transform);
+        return set(index, desc);
+    }
+
+    void TlasInstanceDescs::invalidate()
+    {
+        mIsDirty.assign(mDescs.size(), 1);
+        mDirty.resize(mDescs.size());
+        for (uint32_t i = 0; i < (uint32_t)mDescs.size(); i++) mDirty[i] = i;
+    }
+
+    std::vector<TlasInstanceDescs::Range> TlasInstanceDescs::collectDirtyRanges(uint32_t mergeGap)
+    {
+        std::sort(mDirty.begin(), mDirty.end());
+
+        std::vector<Range> ranges;
+        for (uint32_t index : mDirty)
+        {
+            if (!ranges.empty() && index - ranges.back().end <= mergeGap) ranges.back().end = index + 1;
+            else ranges.push_back({ index, index + 1 });
+            mIsDirty[index] = 0;
+        }
+
+        mUpdatedCount = (uint32_t)mDirty.size();
+        mUploadedCount = 0;
+        for (const auto& range : ranges) mUploadedCount += range.end - range.begin;
+
+        mDirty.clear();
+        return ranges;
+    }
+
+    void TlasInstanceDescs::markDirty(uint32_t index)
+    {
+        if (mIsDirty.size() != mDescs.size()) mIsDirty.resize(mDescs.size(), 0);
+        if (mIsDirty[index]) return;
+        mIsDirty[index] = 1;
+        mDirty.push_back(index);
+    }
+}
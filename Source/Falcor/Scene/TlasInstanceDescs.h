@@ -0,0 +1,107 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/API/RtAccelerationStructure.h"
+#include "Utils/Math/Matrix.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Persistent CPU copy of the instance descs of a TLAS with change tracking.
+        Descs are only marked dirty if their contents change, so the GPU copy can be updated by uploading the dirty
+        ranges instead of the whole array. The class has no GPU dependencies; uploading is left to the caller.
+    */
+    class FALCOR_API TlasInstanceDescs
+    {
+    public:
+        /** Range of descs [begin, end).
+        */
+        struct Range
+        {
+            uint32_t begin;
+            uint32_t end;
+        };
+
+        static constexpr uint32_t kDefaultMergeGap = 16; ///< Dirty ranges separated by fewer clean descs are uploaded together.
+
+        /** Replace all descs. Descs that differ from the current ones are marked dirty.
+            If the number of descs changes, all descs are marked dirty.
+            \param[in] descs New instance descs.
+        */
+        void update(const std::vector<RtInstanceDesc>& descs);
+
+        /** Set a desc. It is marked dirty if it differs from the current one.
+            \param[in] index Desc index.
+            \param[in] desc New instance desc.
+            \return True if the desc changed.
+        */
+        bool set(uint32_t index, const RtInstanceDesc& desc);
+
+        /** Set the transform of a desc. It is marked dirty if the transform differs from the current one.
+            \param[in] index Desc index.
+            \param[in] transform New instance transform.
+            \return True if the desc changed.
+        */
+        bool setTransform(uint32_t index, const float4x4& transform);
+
+        /** Mark all descs dirty, for example after the GPU copy was reallocated.
+        */
+        void invalidate();
+
+        /** Get the ranges of dirty descs in ascending order and clear the dirty state.
+            Ranges separated by fewer than mergeGap clean descs are merged to reduce the number of uploads.
+            \param[in] mergeGap Maximum number of clean descs between two ranges that are merged.
+            \return Ranges to upload.
+        */
+        std::vector<Range> collectDirtyRanges(uint32_t mergeGap = kDefaultMergeGap);
+
+        const std::vector<RtInstanceDesc>& getDescs() const { return mDescs; }
+        uint32_t getCount() const { return (uint32_t)mDescs.size(); }
+        bool isDirty() const { return !mDirty.empty(); }
+
+        /** Get the number of descs that were dirty in the last call to collectDirtyRanges().
+        */
+        uint32_t getUpdatedCount() const { return mUpdatedCount; }
+
+        /** Get the number of descs covered by the ranges returned by the last call to collectDirtyRanges().
+            This includes the clean descs in merged gaps.
+        */
+        uint32_t getUploadedCount() const { return mUploadedCount; }
+
+    private:
+        void markDirty(uint32_t index);
+
+        std::vector<RtInstanceDesc> mDescs;
+        std::vector<uint8_t> mIsDirty;      ///< Flag per desc, to add each desc only once to mDirty.
+        std::vector<uint32_t> mDirty;       ///< Indices of the dirty descs, unsorted.
+        uint32_t mUpdatedCount = 0;
+        uint32_t mUploadedCount = 0;
+    };
+}
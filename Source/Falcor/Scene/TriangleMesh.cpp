@@ -30,6 +30,7 @@
 #include "Core/Platform/OS.h"
 #include "Utils/Logger.h"
 #include "Utils/Scripting/ScriptBindings.h"
+#include "GlobalState.h"
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
@@ -337,6 +338,12 @@ namespace Falcor
         triangleMesh.def_static("createDisk", &TriangleMesh::createDisk, "radius"_a = 1.f, "segments"_a = 32);
         triangleMesh.def_static("createCube", &TriangleMesh::createCube, "size"_a = float3(1.f));
         triangleMesh.def_static("createSphere", &TriangleMesh::createSphere, "radius"_a = 1.f, "segmentsU"_a = 32, "segmentsV"_a = 32);
-        triangleMesh.def_static("createFromFile", &TriangleMesh::createFromFile, "path"_a, "smoothNormals"_a = false);
+        auto createFromFile = [] (const std::filesystem::path& path, bool smoothNormals)
+        {
+            // Load through the scene builder when building a Python scene, so the file is recorded as a scene dependency.
+            if (SceneBuilder* pBuilder = getActivePythonSceneBuilder()) return pBuilder->loadTriangleMesh(path, smoothNormals);
+            return TriangleMesh::createFromFile(path, smoothNormals);
+        };
+        triangleMesh.def_static("createFromFile", createFromFile, "path"_a, "smoothNormals"_a = false);
     }
 }
@@ -49,6 +49,52 @@ namespace Falcor
         const float kMaxAnisotropy = 0.99f;
         const double kMinFrameRate = 1.0;
         const double kMaxFrameRate = 1000.0;
+
+        /** Find the grid files in a directory.
+            \param[in] path Directory path. Can also include a full path or relative path from a data directory.
+            \param[out] paths Grid files sorted by length first, then alpha-numerically.
+            \return True if the directory was found.
+        */
+        bool findGridSequenceFiles(const std::filesystem::path& path, std::vector<std::filesystem::path>& paths)
+        {
+            std::filesystem::path fullPath;
+            if (!findFileInDataDirectories(path, fullPath))
+            {
+                logWarning("Cannot find directory '{}'.", path);
+                return false;
+            }
+            if (!std::filesystem::is_directory(fullPath))
+            {
+                logWarning("'{}' is not a directory.", path);
+                return false;
+            }
+
+            // Enumerate grid files.
+            paths.clear();
+            for (auto it : std::filesystem::directory_iterator(fullPath))
+            {
+                if (hasExtension(it.path(), "nvdb") || hasExtension(it.path(), "vdb")) paths.push_back(it.path());
+            }
+
+            // Sort by length first, then alpha-numerically.
+            auto cmp = [](const std::filesystem::path& a, const std::filesystem::path& b) {
+                auto sa = a.string();
+                auto sb = b.string();
+                return sa.length() != sb.length() ? sa.length() < sb.length() : sa < sb;
+            };
+            std::sort(paths.begin(), paths.end(), cmp);
+            return true;
+        }
+
+        /** Record grid files loaded from a Python scene as scene dependencies.
+        */
+        void addPythonSceneDependencies(const std::vector<std::filesystem::path>& paths)
+        {
+            if (SceneBuilder* pBuilder = getActivePythonSceneBuilder())
+            {
+                for (const auto& path : paths) pBuilder->addDependency(path);
+            }
+        }
     }
 
     static_assert(sizeof(GridVolumeData) % 16 == 0, "GridVolumeData size should be a multiple of 16");
@@ -146,33 +192,8 @@ namespace Falcor
 
     uint32_t GridVolume::loadGridSequence(GridSlot slot, const std::filesystem::path& path, const std::string& gridname, bool keepEmpty)
     {
-        std::filesystem::path fullPath;
-        if (!findFileInDataDirectories(path, fullPath))
-        {
-            logWarning("Cannot find directory '{}'.", path);
-            return 0;
-        }
-        if (!std::filesystem::is_directory(fullPath))
-        {
-            logWarning("'{}' is not a directory.", path);
-            return 0;
-        }
-
-        // Enumerate grid files.
         std::vector<std::filesystem::path> paths;
-        for (auto it : std::filesystem::directory_iterator(fullPath))
-        {
-            if (hasExtension(it.path(), "nvdb") || hasExtension(it.path(), "vdb")) paths.push_back(it.path());
-        }
-
-        // Sort by length first, then alpha-numerically.
-        auto cmp = [](const std::filesystem::path& a, const std::filesystem::path& b) {
-            auto sa = a.string();
-            auto sb = b.string();
-            return sa.length() != sb.length() ? sa.length() < sb.length() : sa < sb;
-        };
-        std::sort(paths.begin(), paths.end(), cmp);
-
+        if (!findGridSequenceFiles(path, paths)) return 0;
         return loadGridSequence(slot, paths, gridname, keepEmpty);
     }
 
@@ -402,13 +423,26 @@ namespace Falcor
             return GridVolume::create(accessActivePythonSceneBuilder().getDevice(), name);
         };
         volume.def(pybind11::init(create), "name"_a); // PYTHONDEPRECATED
-        volume.def("loadGrid", &GridVolume::loadGrid, "slot"_a, "path"_a, "gridname"_a);
-        volume.def("loadGridSequence",
-            pybind11::overload_cast<GridVolume::GridSlot, const std::vector<std::filesystem::path>&, const std::string&, bool>(&GridVolume::loadGridSequence),
-            "slot"_a, "paths"_a, "gridname"_a, "keepEmpty"_a = true);
-        volume.def("loadGridSequence",
-            pybind11::overload_cast<GridVolume::GridSlot, const std::filesystem::path&, const std::string&, bool>(&GridVolume::loadGridSequence),
-            "slot"_a, "path"_a, "gridnames"_a, "keepEmpty"_a = true);
+        auto loadGrid = [] (GridVolume& volume, GridVolume::GridSlot slot, const std::filesystem::path& path, const std::string& gridname)
+        {
+            addPythonSceneDependencies({ path });
+            return volume.loadGrid(slot, path, gridname);
+        };
+        volume.def("loadGrid", loadGrid, "slot"_a, "path"_a, "gridname"_a);
+        auto loadGridSequence = [] (GridVolume& volume, GridVolume::GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, bool keepEmpty)
+        {
+            addPythonSceneDependencies(paths);
+            return volume.loadGridSequence(slot, paths, gridname, keepEmpty);
+        };
+        volume.def("loadGridSequence", loadGridSequence, "slot"_a, "paths"_a, "gridname"_a, "keepEmpty"_a = true);
+        auto loadGridSequenceFromDirectory = [] (GridVolume& volume, GridVolume::GridSlot slot, const std::filesystem::path& path, const std::string& gridname, bool keepEmpty)
+        {
+            std::vector<std::filesystem::path> paths;
+            if (!findGridSequenceFiles(path, paths)) return 0u;
+            addPythonSceneDependencies(paths);
+            return volume.loadGridSequence(slot, paths, gridname, keepEmpty);
+        };
+        volume.def("loadGridSequence", loadGridSequenceFromDirectory, "slot"_a, "path"_a, "gridnames"_a, "keepEmpty"_a = true);
 
         m.attr("Volume") = m.attr("GridVolume"); // PYTHONDEPRECATED
     }
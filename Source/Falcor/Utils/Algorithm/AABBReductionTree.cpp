@@ -0,0 +1,69 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "AABBReductionTree.h"
+#include "Core/Errors.h"
+#include <algorithm>
+
+namespace Falcor
+{
+AABBReductionTree::AABBReductionTree(const std::vector<AABB>& leaves) : mLeafCount(leaves.size())
+{
+    mFirstLeaf = 1;
+    while (mFirstLeaf < mLeafCount)
+        mFirstLeaf *= 2;
+
+    // Padding leaves are left empty so they don't contribute to the union.
+    mNodes.resize(2 * mFirstLeaf);
+    std::copy(leaves.begin(), leaves.end(), mNodes.begin() + mFirstLeaf);
+    for (size_t i = mFirstLeaf - 1; i > 0; i--)
+        mNodes[i] = mNodes[2 * i] | mNodes[2 * i + 1];
+}
+
+const AABB& AABBReductionTree::getLeaf(size_t index) const
+{
+    FALCOR_ASSERT(index < mLeafCount);
+    return mNodes[mFirstLeaf + index];
+}
+
+void AABBReductionTree::setLeaf(size_t index, const AABB& bounds)
+{
+    FALCOR_ASSERT(index < mLeafCount);
+    size_t node = mFirstLeaf + index;
+    if (mNodes[node] == bounds)
+        return;
+    mNodes[node] = bounds;
+
+    for (node /= 2; node > 0; node /= 2)
+    {
+        AABB nodeBounds = mNodes[2 * node] | mNodes[2 * node + 1];
+        if (nodeBounds == mNodes[node])
+            break;
+        mNodes[node] = nodeBounds;
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,76 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Math/AABB.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Maintains the union of a fixed number of bounding boxes under updates.
+ *
+ * The boxes are stored as the leaves of a complete binary tree where each inner node holds the union
+ * of its children. Changing a box only updates its ancestors, so the total bounds are kept current in
+ * O(log n) per changed box instead of O(n) for recomputing the union from scratch.
+ */
+class FALCOR_API AABBReductionTree
+{
+public:
+    AABBReductionTree() = default;
+
+    /**
+     * Build the tree in O(n).
+     * @param[in] leaves Bounding box for each leaf. Leaves may be empty (invalid) boxes.
+     */
+    explicit AABBReductionTree(const std::vector<AABB>& leaves);
+
+    /// Get the number of leaves.
+    size_t getLeafCount() const { return mLeafCount; }
+
+    /// Get the bounding box of a leaf.
+    const AABB& getLeaf(size_t index) const;
+
+    /**
+     * Set the bounding box of a leaf and update the bounds of its ancestors.
+     * Propagation stops early at the first ancestor whose bounds don't change.
+     * @param[in] index Leaf index.
+     * @param[in] bounds New bounding box.
+     */
+    void setLeaf(size_t index, const AABB& bounds);
+
+    /// Get the union of all leaves.
+    AABB getBounds() const { return mLeafCount > 0 ? mNodes[1] : AABB(); }
+
+private:
+    size_t mLeafCount = 0;
+    size_t mFirstLeaf = 0;      ///< Index of the first leaf in mNodes. Number of leaves rounded up to a power of two.
+    std::vector<AABB> mNodes;   ///< Implicit binary tree. Node i has children 2i and 2i+1, the root is at index 1.
+};
+} // namespace Falcor
@@ -0,0 +1,164 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "BinnedSAH.h"
+#include "Core/Errors.h"
+#include <algorithm>
+#include <limits>
+
+namespace Falcor
+{
+namespace
+{
+float getArea(const AABB& bounds)
+{
+    return bounds.valid() ? bounds.area() : 0.f;
+}
+
+// Returns the surface area of the overlap between the two sides of a split along the given axis.
+// Sides that only touch at the split plane do not overlap.
+float getOverlapArea(const AABB& left, const AABB& right, uint32_t axis)
+{
+    const AABB overlap = left & right;
+    return overlap.valid() && overlap.extent()[axis] > 0.f ? overlap.area() : 0.f;
+}
+} // namespace
+
+BinnedSAH::BinnedSAH(const AABB& range, uint32_t binCount, float overlapWeight)
+    : mRange(range), mBinCount(binCount), mOverlapWeight(overlapWeight)
+{
+    checkArgument(binCount >= 2, "'binCount' must be at least 2");
+    checkArgument(overlapWeight >= 0.f, "'overlapWeight' must not be negative");
+    mBins.resize(3 * (size_t)mBinCount);
+}
+
+uint32_t BinnedSAH::getBinIndex(uint32_t axis, float centroid) const
+{
+    const float extent = mRange.maxPoint[axis] - mRange.minPoint[axis];
+    if (!(extent > 0.f))
+        return 0;
+    const float t = (centroid - mRange.minPoint[axis]) / extent * mBinCount;
+    return (uint32_t)std::clamp(t, 0.f, (float)(mBinCount - 1));
+}
+
+void BinnedSAH::add(const AABB& bounds, uint64_t weight)
+{
+    const float3 centroid = bounds.center();
+    for (uint32_t axis = 0; axis < 3; axis++)
+    {
+        Bin& bin = getBin(axis, getBinIndex(axis, centroid[axis]));
+        bin.bounds.include(bounds);
+        bin.weight += weight;
+    }
+}
+
+void BinnedSAH::merge(const BinnedSAH& other)
+{
+    checkArgument(other.mBinCount == mBinCount && other.mRange == mRange, "Cannot merge binnings with different parameters");
+    for (size_t i = 0; i < mBins.size(); i++)
+    {
+        mBins[i].bounds.include(other.mBins[i].bounds);
+        mBins[i].weight += other.mBins[i].weight;
+    }
+}
+
+BinnedSAH::Split BinnedSAH::findBestSplit() const
+{
+    Split best;
+    best.cost = std::numeric_limits<float>::infinity();
+
+    std::vector<Bin> right(mBinCount);
+
+    for (uint32_t axis = 0; axis < 3; axis++)
+    {
+        const float extent = mRange.maxPoint[axis] - mRange.minPoint[axis];
+        if (!(extent > 0.f))
+            continue;
+
+        // Sweep from the right to accumulate the bins to the right of each candidate plane.
+        right[mBinCount - 1] = getBin(axis, mBinCount - 1);
+        for (uint32_t i = mBinCount - 1; i > 0; i--)
+        {
+            right[i - 1].bounds = right[i].bounds;
+            right[i - 1].bounds.include(getBin(axis, i - 1).bounds);
+            right[i - 1].weight = right[i].weight + getBin(axis, i - 1).weight;
+        }
+
+        // Sweep from the left and evaluate the plane after each bin.
+        Bin left;
+        for (uint32_t i = 0; i + 1 < mBinCount; i++)
+        {
+            left.bounds.include(getBin(axis, i).bounds);
+            left.weight += getBin(axis, i).weight;
+
+            const Bin& r = right[i + 1];
+            if (left.weight == 0 || r.weight == 0)
+                continue;
+
+            const float overlapArea = getOverlapArea(left.bounds, r.bounds, axis);
+            const float cost = getArea(left.bounds) * left.weight + getArea(r.bounds) * r.weight +
+                               mOverlapWeight * overlapArea * (left.weight + r.weight);
+
+            if (cost < best.cost)
+            {
+                best.axis = (int)axis;
+                best.position = mRange.minPoint[axis] + extent * (float)(i + 1) / mBinCount;
+                best.cost = cost;
+                best.leftWeight = left.weight;
+                best.rightWeight = r.weight;
+                best.leftBounds = left.bounds;
+                best.rightBounds = r.bounds;
+            }
+        }
+    }
+
+    if (!best.isValid())
+        best.cost = 0.f;
+    return best;
+}
+
+float BinnedSAH::getLeafCost() const
+{
+    return getArea(getBounds()) * getWeight();
+}
+
+AABB BinnedSAH::getBounds() const
+{
+    AABB bounds;
+    for (uint32_t i = 0; i < mBinCount; i++)
+        bounds.include(getBin(0, i).bounds);
+    return bounds;
+}
+
+uint64_t BinnedSAH::getWeight() const
+{
+    uint64_t weight = 0;
+    for (uint32_t i = 0; i < mBinCount; i++)
+        weight += getBin(0, i).weight;
+    return weight;
+}
+} // namespace Falcor
@@ -0,0 +1,126 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Math/AABB.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Helper for finding axis-aligned split planes with the binned surface area heuristic (SAH).
+ *
+ * Primitives are binned by their bounding box centroids into equally sized bins along each axis
+ * of a given range. Candidate planes between bins are evaluated with the cost
+ *
+ *   cost = A(L) * N(L) + A(R) * N(R) + overlapWeight * A(L & R) * (N(L) + N(R))
+ *
+ * where A() is the surface area of the bounds on each side, N() the total primitive weight and
+ * A(L & R) the surface area of the overlap between the two sides. The overlap term penalizes
+ * splits whose two halves overlap spatially, which is important when the halves are built into
+ * separate acceleration structures.
+ *
+ * Binning can be distributed over several instances (e.g. one per thread) that are merged before
+ * searching for the best split.
+ */
+class FALCOR_API BinnedSAH
+{
+public:
+    struct Split
+    {
+        int axis = -1;              ///< Split axis, or -1 if no valid split exists.
+        float position = 0.f;       ///< Split plane position. Primitives with centroid < position are on the left side.
+        float cost = 0.f;           ///< SAH cost of the split.
+        uint64_t leftWeight = 0;    ///< Total weight on the left side.
+        uint64_t rightWeight = 0;   ///< Total weight on the right side.
+        AABB leftBounds;            ///< Bounds of the primitives on the left side.
+        AABB rightBounds;           ///< Bounds of the primitives on the right side.
+
+        bool isValid() const { return axis >= 0; }
+    };
+
+    /**
+     * Create an empty binning.
+     * @param[in] range Range over which centroids are binned. Centroids outside are clamped to the first/last bin.
+     * @param[in] binCount Number of bins per axis (at least 2).
+     * @param[in] overlapWeight Weight of the overlap term in the cost function.
+     */
+    BinnedSAH(const AABB& range, uint32_t binCount = 32, float overlapWeight = 1.f);
+
+    /**
+     * Add a primitive.
+     * @param[in] bounds Bounding box of the primitive. The centroid of the box determines the bin.
+     * @param[in] weight Weight of the primitive, e.g. its triangle count.
+     */
+    void add(const AABB& bounds, uint64_t weight = 1);
+
+    /**
+     * Merge the primitives binned by another instance created with the same parameters.
+     */
+    void merge(const BinnedSAH& other);
+
+    /**
+     * Find the split with the lowest cost.
+     * Only splits with primitives on both sides are considered.
+     * @return The best split, or an invalid split if all primitives fall into a single bin on all axes.
+     */
+    Split findBestSplit() const;
+
+    /**
+     * Returns the cost of not splitting, i.e. A * N of all primitives.
+     */
+    float getLeafCost() const;
+
+    /**
+     * Returns the bounds of all added primitives.
+     */
+    AABB getBounds() const;
+
+    /**
+     * Returns the total weight of all added primitives.
+     */
+    uint64_t getWeight() const;
+
+private:
+    struct Bin
+    {
+        AABB bounds;
+        uint64_t weight = 0;
+    };
+
+    uint32_t getBinIndex(uint32_t axis, float centroid) const;
+    Bin& getBin(uint32_t axis, uint32_t index) { return mBins[axis * mBinCount + index]; }
+    const Bin& getBin(uint32_t axis, uint32_t index) const { return mBins[axis * mBinCount + index]; }
+
+    AABB mRange;
+    uint32_t mBinCount;
+    float mOverlapWeight;
+    std::vector<Bin> mBins;
+};
+} // namespace Falcor
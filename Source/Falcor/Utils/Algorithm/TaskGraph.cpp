@@ -0,0 +1,148 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "TaskGraph.h"
+#include "Core/Assert.h"
+#include "Utils/Threading.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+namespace Falcor
+{
+TaskGraph::TaskID TaskGraph::addTask(std::string name, ResourceMask reads, ResourceMask writes, std::function<void(void)> func)
+{
+    TaskID id = (TaskID)mTasks.size();
+
+    Task task;
+    task.name = std::move(name);
+    task.reads = reads;
+    task.writes = writes;
+    task.func = std::move(func);
+
+    // Read-after-write, write-after-read and write-after-write hazards all create a dependency.
+    for (TaskID prevID = 0; prevID < id; ++prevID)
+    {
+        auto& prev = mTasks[prevID];
+        if ((prev.writes & (reads | writes)) || (prev.reads & writes))
+        {
+            task.dependencies.push_back(prevID);
+            prev.dependents.push_back(id);
+        }
+    }
+
+    mTasks.push_back(std::move(task));
+    return id;
+}
+
+void TaskGraph::execute(bool parallel)
+{
+    auto runTask = [this](Task& task)
+    {
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        task.func();
+        task.duration = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()) * 1e-3;
+    };
+
+    // Tasks are added in a valid topological order, so serial execution simply runs them in order.
+    // Blocking a worker thread on the graph could starve the pool, so nested graphs also run serially.
+    if (!parallel || !Threading::isStarted() || Threading::isWorkerThread() || mTasks.size() <= 1)
+    {
+        for (auto& task : mTasks)
+            runTask(task);
+        return;
+    }
+
+    struct ExecutionState
+    {
+        std::unique_ptr<std::atomic<uint32_t>[]> pendingDependencies;
+        size_t remainingTasks = 0;
+        std::atomic<bool> failed{false};
+        std::exception_ptr exception;
+        std::mutex mutex;
+        std::condition_variable finished;
+    } state;
+
+    state.pendingDependencies = std::make_unique<std::atomic<uint32_t>[]>(mTasks.size());
+    for (size_t i = 0; i < mTasks.size(); ++i)
+        state.pendingDependencies[i] = (uint32_t)mTasks[i].dependencies.size();
+    state.remainingTasks = mTasks.size();
+
+    std::function<void(TaskID)> dispatch = [&](TaskID id)
+    {
+        Threading::dispatchTask(
+            [&, id]()
+            {
+                Task& task = mTasks[id];
+                if (!state.failed)
+                {
+                    try
+                    {
+                        runTask(task);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock(state.mutex);
+                        if (!state.exception)
+                            state.exception = std::current_exception();
+                        state.failed = true;
+                    }
+                }
+
+                // Release dependents. Skipped tasks still complete so that the graph always drains.
+                for (TaskID dependentID : task.dependents)
+                {
+                    if (state.pendingDependencies[dependentID].fetch_sub(1) == 1)
+                        dispatch(dependentID);
+                }
+
+                // Decrement under the lock so that the state is not destroyed before notifying.
+                std::lock_guard<std::mutex> lock(state.mutex);
+                if (--state.remainingTasks == 0)
+                    state.finished.notify_all();
+            }
+        );
+    };
+
+    for (TaskID id = 0; id < (TaskID)mTasks.size(); ++id)
+    {
+        if (mTasks[id].dependencies.empty())
+            dispatch(id);
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(state.mutex);
+        state.finished.wait(lock, [&]() { return state.remainingTasks == 0; });
+    }
+
+    if (state.exception)
+        std::rethrow_exception(state.exception);
+}
+} // namespace Falcor
@@ -0,0 +1,93 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Graph of CPU tasks with explicit resource read/write sets.
+ *
+ * Tasks are added in a serial program order. A task depends on every previously added task it
+ * conflicts with, i.e. one writes a resource that the other reads or writes. Executing the graph
+ * runs independent tasks concurrently on the global thread pool while producing the same result
+ * as running the tasks one after another in the order they were added.
+ *
+ * Resources are identified by bits in a 64-bit mask, the meaning of each bit is up to the user.
+ */
+class FALCOR_API TaskGraph
+{
+public:
+    using ResourceMask = uint64_t;
+    using TaskID = uint32_t;
+
+    /**
+     * Add a task to the graph.
+     * @param[in] name Name of the task (used for reporting).
+     * @param[in] reads Mask of resources the task reads.
+     * @param[in] writes Mask of resources the task writes.
+     * @param[in] func Function to execute.
+     * @return ID of the task.
+     */
+    TaskID addTask(std::string name, ResourceMask reads, ResourceMask writes, std::function<void(void)> func);
+
+    /**
+     * Execute all tasks and wait for them to finish.
+     * If a task throws, tasks that have not been started yet are skipped and the first exception is rethrown.
+     * @param[in] parallel Run independent tasks concurrently. Otherwise tasks run in the order they were added.
+     */
+    void execute(bool parallel = true);
+
+    size_t getTaskCount() const { return mTasks.size(); }
+    const std::string& getTaskName(TaskID id) const { return mTasks[id].name; }
+
+    /// Returns the IDs of the tasks the given task directly depends on.
+    const std::vector<TaskID>& getDependencies(TaskID id) const { return mTasks[id].dependencies; }
+
+    /// Returns the execution time of a task in seconds measured during the last call to execute().
+    double getTaskDuration(TaskID id) const { return mTasks[id].duration; }
+
+private:
+    struct Task
+    {
+        std::string name;
+        ResourceMask reads = 0;
+        ResourceMask writes = 0;
+        std::function<void(void)> func;
+        std::vector<TaskID> dependencies;
+        std::vector<TaskID> dependents;
+        double duration = 0.0;
+    };
+
+    std::vector<Task> mTasks;
+};
+} // namespace Falcor
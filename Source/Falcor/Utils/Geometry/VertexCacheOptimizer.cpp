@@ -0,0 +1,276 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "VertexCacheOptimizer.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+// Scoring parameters from Forsyth's "Linear-Speed Vertex Cache Optimisation".
+const uint32_t kCacheSize = 32;
+const float kCacheDecayPower = 1.5f;
+const float kLastTriangleScore = 0.75f;
+const float kValenceBoostScale = 2.f;
+const float kValenceBoostPower = 0.5f;
+const uint32_t kMaxTabulatedValence = 32;
+
+struct ScoreTables
+{
+    float cache[kCacheSize];
+    float valence[kMaxTabulatedValence + 1];
+
+    ScoreTables()
+    {
+        for (uint32_t i = 0; i < kCacheSize; i++)
+        {
+            // The vertices of the most recently emitted triangle get a fixed score to avoid
+            // favoring a particular winding order.
+            if (i < 3)
+                cache[i] = kLastTriangleScore;
+            else
+                cache[i] = std::pow(1.f - float(i - 3) / float(kCacheSize - 3), kCacheDecayPower);
+        }
+        valence[0] = 0.f;
+        for (uint32_t i = 1; i <= kMaxTabulatedValence; i++)
+            valence[i] = computeValenceScore(i);
+    }
+
+    static float computeValenceScore(uint32_t valence) { return kValenceBoostScale * std::pow(float(valence), -kValenceBoostPower); }
+};
+
+float computeVertexScore(int32_t cachePosition, uint32_t valence)
+{
+    static const ScoreTables kTables;
+
+    // Vertices without remaining triangles don't contribute to any score.
+    if (valence == 0)
+        return -1.f;
+
+    float score = cachePosition >= 0 ? kTables.cache[cachePosition] : 0.f;
+    score += valence <= kMaxTabulatedValence ? kTables.valence[valence] : ScoreTables::computeValenceScore(valence);
+    return score;
+}
+
+void checkIndices(fstd::span<const uint32_t> indices, uint32_t vertexCount)
+{
+    checkArgument(indices.size() % 3 == 0, "Index count ({}) must be a multiple of 3.", indices.size());
+    for (uint32_t index : indices)
+        checkArgument(index < vertexCount, "Vertex index {} is out of range (vertex count {}).", index, vertexCount);
+}
+} // namespace
+
+VertexCacheStats analyzeVertexCache(fstd::span<const uint32_t> indices, uint32_t vertexCount, uint32_t cacheSize)
+{
+    checkIndices(indices, vertexCount);
+    checkArgument(cacheSize > 0, "Cache size must be larger than zero.");
+
+    VertexCacheStats stats;
+    stats.triangleCount = uint32_t(indices.size() / 3);
+
+    // Track the time each vertex was last inserted into the FIFO. A vertex is in the cache if
+    // fewer than 'cacheSize' vertices have been inserted after it. Zero means never referenced.
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    uint32_t time = 1;
+
+    for (uint32_t index : indices)
+    {
+        if (timestamps[index] == 0)
+            stats.vertexCount++;
+        if (timestamps[index] == 0 || time - timestamps[index] > cacheSize)
+        {
+            timestamps[index] = time++;
+            stats.transformCount++;
+        }
+    }
+
+    return stats;
+}
+
+std::vector<uint32_t> optimizeVertexCache(fstd::span<const uint32_t> indices, uint32_t vertexCount)
+{
+    checkIndices(indices, vertexCount);
+
+    const uint32_t triangleCount = uint32_t(indices.size() / 3);
+    if (triangleCount == 0)
+        return {};
+
+    // Build vertex to triangle adjacency. The first 'valence[v]' entries of each vertex's list are
+    // the triangles not yet emitted.
+    std::vector<uint32_t> valence(vertexCount, 0);
+    for (uint32_t index : indices)
+        valence[index]++;
+
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (uint32_t v = 0; v < vertexCount; v++)
+        adjacencyOffsets[v + 1] = adjacencyOffsets[v] + valence[v];
+
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fillOffsets(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++)
+            adjacency[fillOffsets[indices[i]]++] = uint32_t(i / 3);
+    }
+
+    std::vector<int32_t> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; v++)
+        vertexScores[v] = computeVertexScore(-1, valence[v]);
+
+    auto getTriangleScore = [&](uint32_t triangle)
+    {
+        const uint32_t* tri = &indices[triangle * 3];
+        return vertexScores[tri[0]] + vertexScores[tri[1]] + vertexScores[tri[2]];
+    };
+
+    // Start with the highest scoring triangle. Strict comparison picks the lowest index on ties.
+    uint32_t bestTriangle = 0;
+    float bestScore = getTriangleScore(0);
+    for (uint32_t t = 1; t < triangleCount; t++)
+    {
+        float score = getTriangleScore(t);
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestTriangle = t;
+        }
+    }
+
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    uint32_t nextCandidate = 0;
+
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> newCache;
+    cache.reserve(kCacheSize + 3);
+    newCache.reserve(kCacheSize + 3);
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+
+    for (uint32_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+    {
+        if (bestTriangle == kInvalidIndex)
+        {
+            // Dead end: no remaining triangle uses a cached vertex. Continue with the first remaining triangle in input order.
+            while (emitted[nextCandidate])
+                nextCandidate++;
+            bestTriangle = nextCandidate;
+        }
+
+        const uint32_t* tri = &indices[bestTriangle * 3];
+        result.insert(result.end(), tri, tri + 3);
+        emitted[bestTriangle] = 1;
+
+        // Remove the triangle from the adjacency lists of its vertices.
+        for (uint32_t j = 0; j < 3; j++)
+        {
+            const uint32_t v = tri[j];
+            auto begin = adjacency.begin() + adjacencyOffsets[v];
+            auto end = begin + valence[v];
+            auto it = std::find(begin, end, bestTriangle);
+            FALCOR_ASSERT(it != end);
+            *it = *(end - 1);
+            valence[v]--;
+        }
+
+        // Move the triangle's vertices to the front of the LRU cache.
+        newCache.clear();
+        for (uint32_t j = 0; j < 3; j++)
+        {
+            if (std::find(newCache.begin(), newCache.end(), tri[j]) == newCache.end())
+                newCache.push_back(tri[j]);
+        }
+        for (uint32_t v : cache)
+        {
+            if (v != tri[0] && v != tri[1] && v != tri[2])
+                newCache.push_back(v);
+        }
+
+        // Update the scores of all vertices that moved in the cache, including the ones pushed out of it.
+        for (size_t i = 0; i < newCache.size(); i++)
+        {
+            const uint32_t v = newCache[i];
+            cachePositions[v] = i < kCacheSize ? int32_t(i) : -1;
+            vertexScores[v] = computeVertexScore(cachePositions[v], valence[v]);
+        }
+
+        // Pick the next triangle among the remaining triangles around the updated vertices.
+        bestTriangle = kInvalidIndex;
+        bestScore = -std::numeric_limits<float>::infinity();
+        for (uint32_t v : newCache)
+        {
+            const uint32_t* adjacent = &adjacency[adjacencyOffsets[v]];
+            for (uint32_t k = 0; k < valence[v]; k++)
+            {
+                const uint32_t t = adjacent[k];
+                float score = getTriangleScore(t);
+                if (score > bestScore || (score == bestScore && t < bestTriangle))
+                {
+                    bestScore = score;
+                    bestTriangle = t;
+                }
+            }
+        }
+
+        if (newCache.size() > kCacheSize)
+            newCache.resize(kCacheSize);
+        std::swap(cache, newCache);
+    }
+
+    return result;
+}
+
+std::vector<uint32_t> optimizeVertexFetch(std::vector<uint32_t>& indices, uint32_t vertexCount)
+{
+    checkIndices(indices, vertexCount);
+
+    std::vector<uint32_t> remap(vertexCount, kInvalidIndex);
+    uint32_t nextIndex = 0;
+
+    for (uint32_t& index : indices)
+    {
+        if (remap[index] == kInvalidIndex)
+            remap[index] = nextIndex++;
+        index = remap[index];
+    }
+
+    for (uint32_t& newIndex : remap)
+    {
+        if (newIndex == kInvalidIndex)
+            newIndex = nextIndex++;
+    }
+
+    return remap;
+}
+} // namespace Falcor
@@ -0,0 +1,88 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <fstd/span.h>
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Post-transform vertex cache statistics for an indexed triangle list.
+ */
+struct VertexCacheStats
+{
+    uint32_t triangleCount = 0;     ///< Number of triangles.
+    uint32_t vertexCount = 0;       ///< Number of unique vertices referenced by the triangles.
+    uint32_t transformCount = 0;    ///< Number of simulated vertex shader invocations (cache misses).
+
+    /// Average cache miss ratio, i.e. transformed vertices per triangle. Lower is better, 0.5 is optimal for large regular meshes.
+    float getACMR() const { return triangleCount > 0 ? float(transformCount) / float(triangleCount) : 0.f; }
+    /// Average transform to vertex ratio, i.e. transformed vertices per unique vertex. Lower is better, 1.0 is optimal.
+    float getATVR() const { return vertexCount > 0 ? float(transformCount) / float(vertexCount) : 0.f; }
+};
+
+/// Cache size used when simulating a post-transform vertex cache.
+static constexpr uint32_t kDefaultVertexCacheSize = 32;
+
+/**
+ * Simulate a FIFO post-transform vertex cache for an indexed triangle list.
+ * @param[in] indices Vertex indices, three per triangle.
+ * @param[in] vertexCount Number of vertices. All indices must be smaller than this.
+ * @param[in] cacheSize Number of entries in the simulated cache.
+ * @return Cache statistics.
+ */
+FALCOR_API VertexCacheStats analyzeVertexCache(
+    fstd::span<const uint32_t> indices,
+    uint32_t vertexCount,
+    uint32_t cacheSize = kDefaultVertexCacheSize
+);
+
+/**
+ * Reorder the triangles of an indexed triangle list for post-transform vertex cache efficiency.
+ * This implements Tom Forsyth's "Linear-Speed Vertex Cache Optimisation", which greedily emits the
+ * triangle with the highest score based on the positions of its vertices in a simulated LRU cache
+ * and the number of remaining triangles using them. Ties are broken by the lowest triangle index
+ * so the result only depends on the input.
+ * @param[in] indices Vertex indices, three per triangle.
+ * @param[in] vertexCount Number of vertices. All indices must be smaller than this.
+ * @return Reordered vertex indices. The winding of each triangle is preserved.
+ */
+FALCOR_API std::vector<uint32_t> optimizeVertexCache(fstd::span<const uint32_t> indices, uint32_t vertexCount);
+
+/**
+ * Compute a vertex order for memory locality, where vertices are numbered in the order they are first
+ * referenced by the triangles. Unreferenced vertices are placed last in their original order.
+ * The indices are rewritten to refer to the new vertex order.
+ * @param[in,out] indices Vertex indices, three per triangle.
+ * @param[in] vertexCount Number of vertices. All indices must be smaller than this.
+ * @return Remap table from old to new vertex index. The vertex data should be reordered as newData[remap[i]] = oldData[i].
+ */
+FALCOR_API std::vector<uint32_t> optimizeVertexFetch(std::vector<uint32_t>& indices, uint32_t vertexCount);
+} // namespace Falcor
@@ -28,9 +28,8 @@
 #include "TextureManager.h"
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
-#include "Utils/NumericRange.h"
+#include "Utils/Threading.h"
 
-#include <execution>
 
 // Temporarily disable asynchronous texture loader until Falcor supports parallel GPU work submission.
 // Until then `TextureManager` should only called from the main thread.
@@ -382,10 +381,9 @@ void TextureManager::endDeferredLoading()
         return;
 
     // Load textures in parallel.
-    std::atomic<size_t> texturesLoaded;
-    NumericRange<size_t> jobRange(0, jobs.size());
-    std::for_each(
-        std::execution::par_unseq, jobRange.begin(), jobRange.end(),
+    std::atomic<size_t> texturesLoaded{0};
+    Threading::parallel_for(
+        size_t(0), jobs.size(),
         [&](size_t i)
         {
             const auto& job = jobs[i];
@@ -408,7 +406,8 @@ void TextureManager::endDeferredLoading()
                 std::lock_guard<std::mutex> lock(mpDevice->getGlobalGfxMutex());
                 mpDevice->flushAndSync();
             }
-        }
+        },
+        1
     );
     mpDevice->flushAndSync();
 
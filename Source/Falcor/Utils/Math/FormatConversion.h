@@ -90,4 +90,40 @@ inline uint packSnorm2x16(float2 v)
     return (floatToSnorm16(v.x) & 0x0000ffff) | (floatToSnorm16(v.y) << 16);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+//                              8-bit snorm
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Convert float value to 8-bit snorm value.
+ * Values outside [-1,1] are clamped and NaN is encoded as zero.
+ * @return 8-bit snorm value in low bits, high bits are all zeros or ones depending on sign.
+ */
+inline int floatToSnorm8(float v)
+{
+    v = math::isnan(v) ? 0.f : math::min(math::max(v, -1.f), 1.f);
+    return (int)math::trunc(v * 127.f + (v >= 0.f ? 0.5f : -0.5f));
+}
+
+/**
+ * Unpack two 8-bit snorm values from the lo bits of a dword.
+ * @param[in] packed Two 8-bit snorm in low bits, high bits don't care.
+ * @return Two float values in [-1,1].
+ */
+inline float2 unpackSnorm2x8(uint packed)
+{
+    int2 bits = int2((int)(packed << 24), (int)(packed << 16)) >> 24;
+    float2 unpacked = math::max((float2)bits / 127.f, float2(-1.0f));
+    return unpacked;
+}
+
+/**
+ * Pack two floats into 8-bit snorm values in the lo bits of a dword.
+ * @return Two 8-bit snorm in low bits, high bits all zero.
+ */
+inline uint packSnorm2x8(float2 v)
+{
+    return (floatToSnorm8(v.x) & 0x000000ff) | ((floatToSnorm8(v.y) << 8) & 0x0000ff00);
+}
+
 } // namespace Falcor
@@ -313,6 +313,43 @@ template<typename T>
     return inverse * oneOverDet;
 }
 
+/// Check if a 4x4 matrix is affine, i.e. its last row is (0, 0, 0, 1).
+template<typename T>
+[[nodiscard]] inline bool isAffine(const matrix<T, 4, 4>& m)
+{
+    return m[3][0] == T(0) && m[3][1] == T(0) && m[3][2] == T(0) && m[3][3] == T(1);
+}
+
+/**
+ * Compute the inverse transpose of an affine 4x4 matrix.
+ * This is equal to transpose(inverse(m)) but only inverts the upper 3x3 part using cross products.
+ * The result is undefined if m is not affine (see isAffine()).
+ */
+template<typename T>
+[[nodiscard]] inline matrix<T, 4, 4> inverseTransposeAffine(const matrix<T, 4, 4>& m)
+{
+    vector<T, 3> r0(m[0][0], m[0][1], m[0][2]);
+    vector<T, 3> r1(m[1][0], m[1][1], m[1][2]);
+    vector<T, 3> r2(m[2][0], m[2][1], m[2][2]);
+    vector<T, 3> t(m[0][3], m[1][3], m[2][3]);
+
+    // The rows of the inverse transpose of the 3x3 part are the cross products of its rows divided by the determinant.
+    vector<T, 3> c0 = cross(r1, r2);
+    vector<T, 3> c1 = cross(r2, r0);
+    vector<T, 3> c2 = cross(r0, r1);
+    T oneOverDet = T(1) / dot(r0, c0);
+    c0 *= oneOverDet;
+    c1 *= oneOverDet;
+    c2 *= oneOverDet;
+
+    matrix<T, 4, 4> result;
+    result.setRow(0, vector<T, 4>(c0, T(0)));
+    result.setRow(1, vector<T, 4>(c1, T(0)));
+    result.setRow(2, vector<T, 4>(c2, T(0)));
+    result.setRow(3, vector<T, 4>(-(c0 * t.x + c1 * t.y + c2 * t.z), T(1)));
+    return result;
+}
+
 /// Compute the (X * Y * Z) euler angles of a 4x4 matrix.
 template<typename T>
 void extractEulerAngleXYZ(const matrix<T, 4, 4>& m, float& angleX, float& angleY, float& angleZ)
@@ -0,0 +1,230 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "AliasTableBuilder.h"
+#include "Core/Assert.h"
+#include "Utils/Threading.h"
+#include <algorithm>
+
+namespace Falcor
+{
+namespace
+{
+// Number of elements processed per chunk. This determines the summation order of the prefix sums.
+const uint32_t kChunkSize = 16384;
+
+uint32_t getChunkCount(uint32_t count)
+{
+    return (count + kChunkSize - 1) / kChunkSize;
+}
+
+template<typename Func>
+void forEachChunk(uint32_t count, bool parallel, Func func)
+{
+    const uint32_t chunkCount = getChunkCount(count);
+    if (parallel && chunkCount > 1)
+    {
+        Threading::parallel_for(0u, chunkCount, [&](uint32_t chunk) { func(chunk * kChunkSize, std::min(count, (chunk + 1) * kChunkSize)); }, 1);
+    }
+    else
+    {
+        for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+            func(chunk * kChunkSize, std::min(count, (chunk + 1) * kChunkSize));
+    }
+}
+} // namespace
+
+// The table is built with the sweeping variant of Vose's algorithm, see Hübschle-Schneider and Sanders 2022,
+// "Parallel Weighted Random Sampling," ACM Transactions on Mathematical Software 48(3).
+//
+// Entries with below-average weight (light) have a deficit, entries with above-average weight (heavy) an excess.
+// The sequential sweep walks through the light entries in order and fills the deficit of each light entry from
+// the current heavy entry. Once the residual weight of the heavy entry drops below the average, it becomes a light
+// entry itself, whose deficit is filled from the next heavy entry. Laying out the deficits (prefix sums D) and the
+// excesses (prefix sums E) along a line, the residual weight of heavy entry j before light entry i is
+// avg + E[j + 1] - D[i]. This gives a closed form for the pairing:
+// - Light entry i is paired with the first heavy entry j with E[j + 1] >= D[i].
+// - Heavy entry j is paired with heavy entry j + 1. Its threshold follows from the first light entry i crossing the
+//   end of its excess, i.e. D[i + 1] > E[j + 1]. If there is no such entry, it is never used up.
+// Each pairing is found with a binary search at the start of a chunk followed by a linear merge.
+double AliasTableBuilder::build(const float* weights, uint32_t count, Entry* entries, bool parallel)
+{
+    if (count == 0)
+        return 0.0;
+
+    // Sum the weights in chunks, use double to minimize precision issues.
+    const uint32_t chunkCount = getChunkCount(count);
+    std::vector<double> chunkWeightSums(chunkCount, 0.0);
+    forEachChunk(
+        count, parallel,
+        [&](uint32_t begin, uint32_t end)
+        {
+            double sum = 0.0;
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                FALCOR_ASSERT(weights[i] >= 0.f);
+                sum += weights[i];
+            }
+            chunkWeightSums[begin / kChunkSize] = sum;
+        }
+    );
+    double weightSum = 0.0;
+    for (double sum : chunkWeightSums)
+        weightSum += sum;
+    const double avgWeight = weightSum / count;
+
+    // Count the light entries and sum up the deficits and excesses per chunk.
+    struct ChunkData
+    {
+        uint32_t lightCount = 0;
+        double deficit = 0.0;
+        double excess = 0.0;
+    };
+    std::vector<ChunkData> chunks(chunkCount);
+    forEachChunk(
+        count, parallel,
+        [&](uint32_t begin, uint32_t end)
+        {
+            ChunkData& chunk = chunks[begin / kChunkSize];
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                if (weights[i] < avgWeight)
+                {
+                    chunk.lightCount++;
+                    chunk.deficit += avgWeight - weights[i];
+                }
+                else
+                {
+                    chunk.excess += weights[i] - avgWeight;
+                }
+            }
+        }
+    );
+
+    // Compute the chunk offsets.
+    std::vector<ChunkData> offsets(chunkCount + 1);
+    for (uint32_t c = 0; c < chunkCount; ++c)
+    {
+        offsets[c + 1].lightCount = offsets[c].lightCount + chunks[c].lightCount;
+        offsets[c + 1].deficit = offsets[c].deficit + chunks[c].deficit;
+        offsets[c + 1].excess = offsets[c].excess + chunks[c].excess;
+    }
+    const uint32_t lightCount = offsets.back().lightCount;
+    const uint32_t heavyCount = count - lightCount;
+
+    // Without heavy entries, all weights are equal up to numerical precision.
+    if (heavyCount == 0)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+            entries[i] = {1.f, i};
+        return weightSum;
+    }
+
+    // Separate the light and heavy entries in index order and compute the prefix sums of the deficits and excesses.
+    std::vector<uint32_t> lights(lightCount);
+    std::vector<uint32_t> heavies(heavyCount);
+    std::vector<double> D(lightCount + 1);
+    std::vector<double> E(heavyCount + 1);
+    D[lightCount] = offsets.back().deficit;
+    E[heavyCount] = offsets.back().excess;
+    forEachChunk(
+        count, parallel,
+        [&](uint32_t begin, uint32_t end)
+        {
+            const ChunkData& offset = offsets[begin / kChunkSize];
+            uint32_t lightIndex = offset.lightCount;
+            uint32_t heavyIndex = begin - offset.lightCount;
+            double deficit = offset.deficit;
+            double excess = offset.excess;
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                if (weights[i] < avgWeight)
+                {
+                    lights[lightIndex] = i;
+                    D[lightIndex++] = deficit;
+                    deficit += avgWeight - weights[i];
+                }
+                else
+                {
+                    heavies[heavyIndex] = i;
+                    E[heavyIndex++] = excess;
+                    excess += weights[i] - avgWeight;
+                }
+            }
+        }
+    );
+
+    // Pair each light entry with a heavy entry.
+    forEachChunk(
+        lightCount, parallel,
+        [&](uint32_t begin, uint32_t end)
+        {
+            uint32_t j = (uint32_t)(std::lower_bound(E.begin() + 1, E.end(), D[begin]) - (E.begin() + 1));
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                while (j + 1 < heavyCount && E[j + 1] < D[i])
+                    ++j;
+                j = std::min(j, heavyCount - 1); // Guard against numerical errors
+                const uint32_t index = lights[i];
+                entries[index] = {(float)(weights[index] / avgWeight), heavies[j]};
+            }
+        }
+    );
+
+    // Pair each heavy entry with the next one. The last heavy entry is never used up.
+    forEachChunk(
+        heavyCount, parallel,
+        [&](uint32_t begin, uint32_t end)
+        {
+            uint32_t i = (uint32_t)(std::upper_bound(D.begin() + 1, D.end(), E[begin + 1]) - (D.begin() + 1));
+            for (uint32_t j = begin; j < end; ++j)
+            {
+                while (i < lightCount && D[i + 1] <= E[j + 1])
+                    ++i;
+                const uint32_t index = heavies[j];
+                if (j + 1 < heavyCount && i < lightCount)
+                {
+                    const double residual = avgWeight + E[j + 1] - D[i + 1];
+                    entries[index] = {(float)std::clamp(residual / avgWeight, 0.0, 1.0), heavies[j + 1]};
+                }
+                else
+                {
+                    entries[index] = {1.f, index};
+                }
+            }
+        }
+    );
+
+    return weightSum;
+}
+
+double AliasTableBuilder::build(const std::vector<float>& weights, std::vector<Entry>& entries, bool parallel)
+{
+    entries.resize(weights.size());
+    return build(weights.data(), (uint32_t)weights.size(), entries.data(), parallel);
+}
+} // namespace Falcor
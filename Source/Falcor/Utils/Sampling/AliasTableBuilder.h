@@ -0,0 +1,90 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * CPU construction of alias tables for sampling from a discrete probability distribution.
+ *
+ * The table is built in O(N) with the sweeping variant of Vose's algorithm, which pairs each below-average
+ * entry with the above-average entry whose excess weight it consumes. The pairing only depends on prefix sums of
+ * the deficits and excesses, so the sweep is split into independent chunks that are processed in parallel.
+ * The chunk size is fixed, so the result does not depend on the number of threads.
+ */
+class FALCOR_API AliasTableBuilder
+{
+public:
+    /**
+     * Alias table entry. The entry is picked with probability threshold, otherwise its alias is picked.
+     */
+    struct Entry
+    {
+        float threshold;
+        uint32_t alias;
+    };
+
+    /**
+     * Build an alias table.
+     * The weights don't need to be normalized to sum up to 1. If all weights are zero, entries are sampled uniformly.
+     * @param[in] weights Non-negative weights we'd like to sample each entry proportional to.
+     * @param[in] count Number of weights.
+     * @param[out] entries Table entries (count elements).
+     * @param[in] parallel Build the table in parallel. This doesn't change the result.
+     * @return Sum of all weights.
+     */
+    static double build(const float* weights, uint32_t count, Entry* entries, bool parallel = true);
+
+    /**
+     * Build an alias table.
+     * @param[in] weights Non-negative weights we'd like to sample each entry proportional to.
+     * @param[out] entries Table entries, resized to the number of weights.
+     * @param[in] parallel Build the table in parallel. This doesn't change the result.
+     * @return Sum of all weights.
+     */
+    static double build(const std::vector<float>& weights, std::vector<Entry>& entries, bool parallel = true);
+
+    /**
+     * Sample an alias table.
+     * @param[in] entries Table entries.
+     * @param[in] count Number of entries.
+     * @param[in] u0 Uniform random number in [0,1) selecting the entry.
+     * @param[in] u1 Uniform random number in [0,1) selecting between the entry and its alias.
+     * @return Sampled index.
+     */
+    static uint32_t sample(const Entry* entries, uint32_t count, float u0, float u1)
+    {
+        const uint32_t index = std::min(count - 1, (uint32_t)(u0 * count));
+        return u1 < entries[index].threshold ? index : entries[index].alias;
+    }
+};
+} // namespace Falcor
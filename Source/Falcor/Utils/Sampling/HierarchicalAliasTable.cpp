@@ -0,0 +1,180 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "HierarchicalAliasTable.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Utils/Threading.h"
+#include <algorithm>
+#include <limits>
+
+namespace Falcor
+{
+HierarchicalAliasTable::HierarchicalAliasTable(uint32_t blockSize) : mBlockSize(blockSize)
+{
+    if (blockSize == 0)
+        throw ArgumentError("Block size must be larger than zero.");
+}
+
+void HierarchicalAliasTable::build(const std::vector<float>& weights)
+{
+    if (weights.size() >= std::numeric_limits<uint32_t>::max())
+        throw RuntimeError("Too many entries for alias table.");
+
+    const uint32_t blockCount = ((uint32_t)weights.size() + mBlockSize - 1) / mBlockSize;
+    mWeights = weights;
+    mEntries.resize(weights.size());
+    mBlockWeights.assign(blockCount, 0.0);
+    mIsDirty.assign(blockCount, 0);
+    mDirty.clear();
+
+    std::vector<uint32_t> blocks(blockCount);
+    for (uint32_t block = 0; block < blockCount; ++block)
+        blocks[block] = block;
+    rebuildBlocks(blocks);
+}
+
+uint32_t HierarchicalAliasTable::update(const std::vector<float>& weights)
+{
+    if (weights.size() != mWeights.size())
+        throw ArgumentError("Expected {} weights, got {}.", mWeights.size(), weights.size());
+
+    // Compare the blocks in parallel and copy the changed weights.
+    std::vector<uint8_t> isChanged(getBlockCount(), 0);
+    Threading::parallel_for(
+        0u, getBlockCount(),
+        [&](uint32_t block)
+        {
+            const size_t begin = (size_t)block * mBlockSize;
+            const size_t end = std::min(mWeights.size(), begin + mBlockSize);
+            if (!std::equal(weights.begin() + begin, weights.begin() + end, mWeights.begin() + begin))
+            {
+                std::copy(weights.begin() + begin, weights.begin() + end, mWeights.begin() + begin);
+                isChanged[block] = 1;
+            }
+        }
+    );
+
+    std::vector<uint32_t> blocks;
+    for (uint32_t block = 0; block < getBlockCount(); ++block)
+    {
+        if (isChanged[block])
+            blocks.push_back(block);
+    }
+    return rebuildBlocks(blocks);
+}
+
+uint32_t HierarchicalAliasTable::update(const std::vector<uint32_t>& indices, const std::vector<float>& weights)
+{
+    if (indices.size() != weights.size())
+        throw ArgumentError("Expected {} weights, got {}.", indices.size(), weights.size());
+
+    std::vector<uint32_t> blocks;
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        if (indices[i] >= mWeights.size())
+            throw ArgumentError("Entry index {} is out of range.", indices[i]);
+        if (mWeights[indices[i]] == weights[i])
+            continue;
+        mWeights[indices[i]] = weights[i];
+        blocks.push_back(indices[i] / mBlockSize);
+    }
+    std::sort(blocks.begin(), blocks.end());
+    blocks.erase(std::unique(blocks.begin(), blocks.end()), blocks.end());
+    return rebuildBlocks(blocks);
+}
+
+uint32_t HierarchicalAliasTable::sample(float u0, float u1, float u2, float u3) const
+{
+    FALCOR_ASSERT(!mWeights.empty());
+    const uint32_t block = AliasTableBuilder::sample(mBlockEntries.data(), getBlockCount(), u0, u1);
+    const uint32_t begin = block * mBlockSize;
+    const uint32_t count = std::min(getCount() - begin, mBlockSize);
+    return begin + AliasTableBuilder::sample(mEntries.data() + begin, count, u2, u3);
+}
+
+std::vector<HierarchicalAliasTable::Range> HierarchicalAliasTable::collectDirtyRanges()
+{
+    std::sort(mDirty.begin(), mDirty.end());
+
+    std::vector<Range> ranges;
+    for (uint32_t block : mDirty)
+    {
+        const uint32_t begin = block * mBlockSize;
+        const uint32_t end = std::min(getCount(), begin + mBlockSize);
+        if (!ranges.empty() && ranges.back().end == begin)
+            ranges.back().end = end;
+        else
+            ranges.push_back({begin, end});
+        mIsDirty[block] = 0;
+    }
+
+    mDirty.clear();
+    return ranges;
+}
+
+uint32_t HierarchicalAliasTable::rebuildBlocks(const std::vector<uint32_t>& blocks)
+{
+    if (blocks.empty())
+        return 0;
+
+    // Each block is small, so the blocks are built serially and distributed over the threads.
+    Threading::parallel_for(0u, (uint32_t)blocks.size(), [&](uint32_t i) { buildBlock(blocks[i]); });
+
+    for (uint32_t block : blocks)
+    {
+        if (!mIsDirty[block])
+        {
+            mIsDirty[block] = 1;
+            mDirty.push_back(block);
+        }
+    }
+
+    buildBlockTable();
+    return (uint32_t)blocks.size();
+}
+
+void HierarchicalAliasTable::buildBlock(uint32_t block)
+{
+    const uint32_t begin = block * mBlockSize;
+    const uint32_t count = std::min(getCount() - begin, mBlockSize);
+    mBlockWeights[block] = AliasTableBuilder::build(mWeights.data() + begin, count, mEntries.data() + begin, false);
+}
+
+void HierarchicalAliasTable::buildBlockTable()
+{
+    // Sum the block weights in order, so that the result doesn't depend on which blocks were rebuilt.
+    mWeightSum = 0.0;
+    std::vector<float> blockWeights(mBlockWeights.size());
+    for (size_t block = 0; block < mBlockWeights.size(); ++block)
+    {
+        mWeightSum += mBlockWeights[block];
+        blockWeights[block] = (float)mBlockWeights[block];
+    }
+    AliasTableBuilder::build(blockWeights, mBlockEntries);
+}
+} // namespace Falcor
@@ -0,0 +1,138 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "AliasTableBuilder.h"
+#include "Core/Macros.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Two-level alias table for sampling from a discrete probability distribution with frequently changing weights.
+ *
+ * The entries are split into fixed-size blocks. Each block has its own alias table over its entries, and a
+ * top-level alias table selects blocks proportional to their total weight. Changing a weight only requires
+ * rebuilding the table of its block and the small top-level table, instead of the full table.
+ * Sampling takes two alias table lookups.
+ */
+class FALCOR_API HierarchicalAliasTable
+{
+public:
+    /**
+     * Range of entries [begin, end).
+     */
+    struct Range
+    {
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    static constexpr uint32_t kDefaultBlockSize = 1024;
+
+    /**
+     * Constructor.
+     * @param[in] blockSize Number of entries per block.
+     */
+    HierarchicalAliasTable(uint32_t blockSize = kDefaultBlockSize);
+
+    /**
+     * Build the table from scratch.
+     * @param[in] weights Non-negative weights we'd like to sample each entry proportional to.
+     */
+    void build(const std::vector<float>& weights);
+
+    /**
+     * Update the table to a new set of weights with the same number of entries.
+     * Only the blocks containing changed weights are rebuilt. The blocks are compared in parallel.
+     * @param[in] weights New weights.
+     * @return Number of rebuilt blocks.
+     */
+    uint32_t update(const std::vector<float>& weights);
+
+    /**
+     * Update the weights of a few entries. Only the blocks containing them are rebuilt.
+     * @param[in] indices Entry indices.
+     * @param[in] weights New weights of the entries.
+     * @return Number of rebuilt blocks.
+     */
+    uint32_t update(const std::vector<uint32_t>& indices, const std::vector<float>& weights);
+
+    /**
+     * Sample the table proportional to the weights.
+     * @param[in] u0 Uniform random number in [0,1) selecting the block table entry.
+     * @param[in] u1 Uniform random number in [0,1) selecting between the block table entry and its alias.
+     * @param[in] u2 Uniform random number in [0,1) selecting the entry within the block.
+     * @param[in] u3 Uniform random number in [0,1) selecting between the entry and its alias.
+     * @return Sampled index.
+     */
+    uint32_t sample(float u0, float u1, float u2, float u3) const;
+
+    /**
+     * Get the probability of sampling an entry.
+     */
+    double getPdf(uint32_t index) const { return mWeightSum > 0.0 ? mWeights[index] / mWeightSum : 1.0 / getCount(); }
+
+    /**
+     * Get the ranges of entries whose table data was modified since the last call in ascending order and clear the dirty state.
+     * The top-level table is rebuilt on every change.
+     * @return Ranges to upload.
+     */
+    std::vector<Range> collectDirtyRanges();
+
+    uint32_t getCount() const { return (uint32_t)mWeights.size(); }
+    uint32_t getBlockSize() const { return mBlockSize; }
+    uint32_t getBlockCount() const { return (uint32_t)mBlockWeights.size(); }
+    double getWeightSum() const { return mWeightSum; }
+    const std::vector<float>& getWeights() const { return mWeights; }
+
+    /**
+     * Get the per-block tables. Aliases are relative to the start of the block.
+     */
+    const std::vector<AliasTableBuilder::Entry>& getEntries() const { return mEntries; }
+
+    /**
+     * Get the top-level table over the blocks.
+     */
+    const std::vector<AliasTableBuilder::Entry>& getBlockEntries() const { return mBlockEntries; }
+
+private:
+    uint32_t rebuildBlocks(const std::vector<uint32_t>& blocks);
+    void buildBlock(uint32_t block);
+    void buildBlockTable();
+
+    uint32_t mBlockSize;
+    std::vector<float> mWeights;                            ///< Weight per entry.
+    std::vector<AliasTableBuilder::Entry> mEntries;         ///< Alias table per block.
+    std::vector<double> mBlockWeights;                      ///< Total weight per block.
+    std::vector<AliasTableBuilder::Entry> mBlockEntries;    ///< Alias table over the blocks.
+    double mWeightSum = 0.0;
+    std::vector<uint8_t> mIsDirty;                          ///< Flag per block, to add each block only once to mDirty.
+    std::vector<uint32_t> mDirty;                           ///< Indices of the modified blocks, unsorted.
+};
+} // namespace Falcor
@@ -27,17 +27,177 @@
  **************************************************************************/
 #include "Threading.h"
 #include "Core/Assert.h"
+#include <atomic>
+#include <deque>
+#include <exception>
 
 namespace Falcor
 {
+struct Threading::Task::State
+{
+    std::function<void(void)> func;
+    std::exception_ptr exception;
+    std::atomic<bool> done{false};
+    std::mutex mutex; ///< Protects continuations and is used with the condition variable.
+    std::condition_variable condition;
+    std::vector<std::shared_ptr<State>> continuations;
+};
+
 namespace
 {
+using TaskStatePtr = std::shared_ptr<Threading::Task::State>;
+
+struct TaskQueue
+{
+    std::mutex mutex;
+    std::deque<TaskStatePtr> tasks;
+};
+
 struct ThreadingData
 {
     bool initialized = false;
+    bool stop = false;
     std::vector<std::thread> threads;
-    uint32_t current;
+    std::vector<std::unique_ptr<TaskQueue>> localQueues; ///< One queue per worker thread.
+    TaskQueue globalQueue;                               ///< Queue for tasks dispatched from non-worker threads.
+
+    std::mutex mutex; ///< Protects stop flag and sleeping/idle conditions.
+    std::condition_variable workAvailable;
+    std::condition_variable idle;
+    std::atomic<size_t> queuedCount{0}; ///< Number of tasks in any queue.
+    std::atomic<size_t> activeCount{0}; ///< Number of tasks queued or executing.
 } gData; // TODO: REMOVEGLOBAL
+
+/// Index of the worker thread in the pool or -1 for non-worker threads.
+thread_local int32_t tWorkerIndex = -1;
+
+void enqueue(TaskStatePtr pTask)
+{
+    gData.activeCount.fetch_add(1);
+    TaskQueue& queue = tWorkerIndex >= 0 ? *gData.localQueues[tWorkerIndex] : gData.globalQueue;
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(pTask));
+    }
+    {
+        std::lock_guard<std::mutex> lock(gData.mutex);
+        gData.queuedCount.fetch_add(1);
+    }
+    gData.workAvailable.notify_one();
+}
+
+TaskStatePtr popFront(TaskQueue& queue)
+{
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+        return nullptr;
+    TaskStatePtr pTask = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    return pTask;
+}
+
+TaskStatePtr popBack(TaskQueue& queue)
+{
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+        return nullptr;
+    TaskStatePtr pTask = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return pTask;
+}
+
+/**
+ * Fetch the next task to execute on the calling thread.
+ * Workers take the most recently pushed task from their own queue first (depth first on nested tasks),
+ * then the oldest task from the shared queue and finally steal the oldest task from other workers.
+ */
+TaskStatePtr popTask()
+{
+    if (gData.queuedCount.load() == 0)
+        return nullptr;
+
+    TaskStatePtr pTask;
+    const int32_t workerIndex = tWorkerIndex;
+    const size_t workerCount = gData.localQueues.size();
+    if (workerIndex >= 0)
+        pTask = popBack(*gData.localQueues[workerIndex]);
+    if (!pTask)
+        pTask = popFront(gData.globalQueue);
+    for (size_t i = 1; !pTask && i <= workerCount; ++i)
+    {
+        size_t victim = (size_t(workerIndex + 1) + i - 1) % workerCount;
+        if (int32_t(victim) != workerIndex)
+            pTask = popFront(*gData.localQueues[victim]);
+    }
+
+    if (pTask)
+        gData.queuedCount.fetch_sub(1);
+    return pTask;
+}
+
+void runTask(const TaskStatePtr& pTask);
+
+void completeTask(const TaskStatePtr& pTask)
+{
+    std::vector<TaskStatePtr> continuations;
+    {
+        std::lock_guard<std::mutex> lock(pTask->mutex);
+        pTask->done = true;
+        continuations = std::move(pTask->continuations);
+    }
+    pTask->condition.notify_all();
+
+    for (auto& pContinuation : continuations)
+    {
+        if (gData.initialized)
+            enqueue(std::move(pContinuation));
+        else
+            runTask(pContinuation);
+    }
+}
+
+void runTask(const TaskStatePtr& pTask)
+{
+    try
+    {
+        pTask->func();
+    }
+    catch (...)
+    {
+        pTask->exception = std::current_exception();
+    }
+    pTask->func = nullptr;
+    completeTask(pTask);
+}
+
+void runQueuedTask(const TaskStatePtr& pTask)
+{
+    runTask(pTask);
+    if (gData.activeCount.fetch_sub(1) == 1)
+    {
+        std::lock_guard<std::mutex> lock(gData.mutex);
+        gData.idle.notify_all();
+    }
+}
+
+void workerMain(int32_t workerIndex)
+{
+    tWorkerIndex = workerIndex;
+    while (true)
+    {
+        if (TaskStatePtr pTask = popTask())
+        {
+            runQueuedTask(pTask);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(gData.mutex);
+        gData.workAvailable.wait(lock, []() { return gData.stop || gData.queuedCount.load() > 0; });
+        if (gData.stop && gData.queuedCount.load() == 0)
+            break;
+    }
+    tWorkerIndex = -1;
+}
 } // namespace
 
 void Threading::start(uint32_t threadCount)
@@ -45,52 +205,191 @@ void Threading::start(uint32_t threadCount)
     if (gData.initialized)
         return;
 
-    gData.threads.resize(threadCount);
+    if (threadCount == 0)
+        threadCount = getLogicalThreadCount();
+
+    gData.stop = false;
+    gData.localQueues.clear();
+    for (uint32_t i = 0; i < threadCount; ++i)
+        gData.localQueues.push_back(std::make_unique<TaskQueue>());
+    gData.threads.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; ++i)
+        gData.threads.emplace_back(workerMain, int32_t(i));
     gData.initialized = true;
 }
 
 void Threading::shutdown()
 {
+    if (!gData.initialized)
+        return;
+
+    finish();
+
+    {
+        std::lock_guard<std::mutex> lock(gData.mutex);
+        gData.stop = true;
+    }
+    gData.workAvailable.notify_all();
+
     for (auto& t : gData.threads)
     {
         if (t.joinable())
             t.join();
     }
 
+    gData.threads.clear();
+    gData.localQueues.clear();
     gData.initialized = false;
 }
 
+bool Threading::isStarted()
+{
+    return gData.initialized;
+}
+
+uint32_t Threading::getThreadCount()
+{
+    return (uint32_t)gData.threads.size();
+}
+
+bool Threading::isWorkerThread()
+{
+    return tWorkerIndex >= 0;
+}
+
 Threading::Task Threading::dispatchTask(const std::function<void(void)>& func)
 {
-    FALCOR_ASSERT(gData.initialized);
+    auto pTask = std::make_shared<Task::State>();
+    pTask->func = func;
 
-    std::thread& t = gData.threads[gData.current];
-    if (t.joinable())
-        t.join();
-    t = std::thread(func);
-    gData.current = (gData.current + 1) % gData.threads.size();
+    if (gData.initialized)
+        enqueue(pTask);
+    else
+        runTask(pTask);
 
-    return Task();
+    return Task(pTask);
 }
 
 void Threading::finish()
 {
-    for (auto& t : gData.threads)
+    if (!gData.initialized)
+        return;
+
+    // Waiting for the pool to drain from within a task would never return.
+    FALCOR_ASSERT(!isWorkerThread());
+
+    // Help executing tasks until all queues are drained, then wait for the running ones.
+    while (TaskStatePtr pTask = popTask())
+        runQueuedTask(pTask);
+
+    std::unique_lock<std::mutex> lock(gData.mutex);
+    gData.idle.wait(lock, []() { return gData.activeCount.load() == 0; });
+}
+
+size_t Threading::getGrainSize(size_t count, size_t grainSize)
+{
+    if (grainSize > 0)
+        return grainSize;
+    // Aim for a few chunks per thread to balance the load.
+    size_t chunkCount = size_t(std::max(1u, getThreadCount())) * 4;
+    return std::max<size_t>(1, (count + chunkCount - 1) / chunkCount);
+}
+
+void Threading::parallelForChunks(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& func)
+{
+    grainSize = getGrainSize(count, grainSize);
+    const size_t chunkCount = (count + grainSize - 1) / grainSize;
+
+    if (!gData.initialized || chunkCount == 1)
     {
-        if (t.joinable())
-            t.join();
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+            func(chunk * grainSize, std::min(count, (chunk + 1) * grainSize));
+        return;
     }
-}
 
-Threading::Task::Task() {}
+    // Chunks are handed out through an atomic counter, helper tasks that start late simply find no work left.
+    std::atomic<size_t> nextChunk{0};
+    std::exception_ptr exception;
+    std::mutex exceptionMutex;
+    auto processChunks = [&]()
+    {
+        size_t chunk;
+        while ((chunk = nextChunk.fetch_add(1)) < chunkCount)
+        {
+            try
+            {
+                func(chunk * grainSize, std::min(count, (chunk + 1) * grainSize));
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(exceptionMutex);
+                if (!exception)
+                    exception = std::current_exception();
+            }
+        }
+    };
 
-bool Threading::Task::isRunning()
+    size_t helperCount = std::min<size_t>(getThreadCount(), chunkCount - 1);
+    std::vector<Task> helpers;
+    helpers.reserve(helperCount);
+    for (size_t i = 0; i < helperCount; ++i)
+        helpers.push_back(dispatchTask(processChunks));
+
+    processChunks();
+    for (auto& helper : helpers)
+        helper.finish();
+
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+bool Threading::Task::isRunning() const
 {
-    FALCOR_UNIMPLEMENTED();
+    return mpState && !mpState->done.load();
 }
 
 void Threading::Task::finish()
 {
-    FALCOR_UNIMPLEMENTED();
+    if (!mpState)
+        return;
+
+    while (!mpState->done.load())
+    {
+        // Help executing pending tasks instead of blocking the thread.
+        if (TaskStatePtr pTask = popTask())
+        {
+            runQueuedTask(pTask);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mpState->mutex);
+        mpState->condition.wait_for(lock, std::chrono::milliseconds(1), [this]() { return mpState->done.load(); });
+    }
+
+    if (mpState->exception)
+        std::rethrow_exception(mpState->exception);
+}
+
+Threading::Task Threading::Task::then(const std::function<void(void)>& func)
+{
+    FALCOR_ASSERT(mpState);
+
+    auto pContinuation = std::make_shared<State>();
+    pContinuation->func = func;
+
+    {
+        std::lock_guard<std::mutex> lock(mpState->mutex);
+        if (!mpState->done)
+        {
+            mpState->continuations.push_back(pContinuation);
+            return Task(pContinuation);
+        }
+    }
+
+    if (gData.initialized)
+        enqueue(pContinuation);
+    else
+        runTask(pContinuation);
+    return Task(pContinuation);
 }
 } // namespace Falcor
@@ -27,43 +27,76 @@
  **************************************************************************/
 #pragma once
 #include "Core/Macros.h"
+#include <algorithm>
 #include <condition_variable>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 #include <cstdint>
 
 namespace Falcor
 {
+/**
+ * Global work-stealing thread pool.
+ *
+ * The pool owns a fixed set of worker threads, each with its own task queue. Tasks dispatched from
+ * a worker thread are pushed to that worker's queue (nested tasks), tasks dispatched from any other
+ * thread go to a shared queue. Idle workers steal from the shared queue and from other workers.
+ * Threads waiting on a task help executing pending tasks, so it is safe to dispatch and wait
+ * on tasks from within tasks.
+ *
+ * If the pool is not started, tasks are executed synchronously on the calling thread.
+ */
 class FALCOR_API Threading
 {
 public:
     const static uint32_t kDefaultThreadCount = 16;
 
     /**
-     * Handle to a dispatched task
-     *
-     * TODO: Implementation
+     * Handle to a dispatched task.
      */
-    class Task
+    class FALCOR_API Task
     {
     public:
-        ///  Check if task is still executing
-        bool isRunning();
+        /// Create an empty (invalid) task handle.
+        Task() = default;
+
+        /// Check if the handle refers to a task.
+        bool isValid() const { return mpState != nullptr; }
+
+        /// Check if task is still executing (or waiting to be executed).
+        bool isRunning() const;
 
-        /// Wait for task to finish executing
+        /**
+         * Wait for task to finish executing.
+         * While waiting, the calling thread helps executing other pending tasks.
+         * If the task has thrown an exception, it is rethrown here.
+         */
         void finish();
 
+        /**
+         * Add a continuation that is dispatched once this task has finished.
+         * The continuation runs even if this task has thrown an exception.
+         * @param[in] func Function to execute.
+         * @return Handle to the continuation task.
+         */
+        Task then(const std::function<void(void)>& func);
+
+        struct State;
+
     private:
-        Task();
+        Task(std::shared_ptr<State> pState) : mpState(std::move(pState)) {}
+        std::shared_ptr<State> mpState;
         friend class Threading;
     };
 
     /**
      * Initializes the global thread pool
-     * @param[in] threadCount Number of threads in the pool
+     * @param[in] threadCount Number of threads in the pool. If zero, the logical thread count is used.
      */
-    static void start(uint32_t threadCount = kDefaultThreadCount);
+    static void start(uint32_t threadCount = 0);
 
     /**
      * Waits for all currently executing threads to finish
@@ -75,16 +108,102 @@ public:
      */
     static void shutdown();
 
+    /**
+     * Returns true if the thread pool is running.
+     */
+    static bool isStarted();
+
+    /**
+     * Returns the number of worker threads in the pool (zero if the pool is not started).
+     */
+    static uint32_t getThreadCount();
+
+    /**
+     * Returns true if the calling thread is one of the pool's worker threads.
+     */
+    static bool isWorkerThread();
+
     /**
      * Returns the maximum number of concurrent threads supported by the hardware
      */
-    static uint32_t getLogicalThreadCount() { return std::thread::hardware_concurrency(); }
+    static uint32_t getLogicalThreadCount() { return std::max(1u, std::thread::hardware_concurrency()); }
 
     /**
      * Starts a task on an available thread.
      * @return Handle to the task
      */
     static Task dispatchTask(const std::function<void(void)>& func);
+
+    /**
+     * Execute a function for every index in [begin, end) in parallel.
+     * The calling thread participates in the work and returns once all iterations have finished.
+     * @param[in] begin First index.
+     * @param[in] end One past the last index.
+     * @param[in] func Function called as func(i) for each index.
+     * @param[in] grainSize Minimum number of iterations per work item (zero picks a default).
+     */
+    template<typename T, typename Func>
+    static void parallel_for(T begin, T end, Func&& func, size_t grainSize = 0)
+    {
+        if (end <= begin)
+            return;
+        parallelForChunks(
+            size_t(end - begin), grainSize,
+            [&](size_t first, size_t last)
+            {
+                for (size_t i = first; i < last; ++i)
+                    func(T(begin + i));
+            }
+        );
+    }
+
+    /**
+     * Compute a reduction over [begin, end) in parallel.
+     * The range is split into contiguous chunks. Each chunk is reduced in index order starting from
+     * the identity value and the chunk results are then combined in chunk order. The result is
+     * deterministic for a given thread count and grain size.
+     * @param[in] begin First index.
+     * @param[in] end One past the last index.
+     * @param[in] identity Identity value of the reduction.
+     * @param[in] map Function called as map(i) returning the value for index i.
+     * @param[in] reduce Function called as reduce(a, b) combining two values.
+     * @param[in] grainSize Minimum number of iterations per work item (zero picks a default).
+     * @return Reduced value.
+     */
+    template<typename T, typename V, typename Map, typename Reduce>
+    static V parallel_reduce(T begin, T end, const V& identity, Map&& map, Reduce&& reduce, size_t grainSize = 0)
+    {
+        if (end <= begin)
+            return identity;
+        const size_t count = size_t(end - begin);
+        grainSize = getGrainSize(count, grainSize);
+        const size_t chunkCount = (count + grainSize - 1) / grainSize;
+        std::vector<V> partial(chunkCount, identity);
+        parallelForChunks(
+            count, grainSize,
+            [&](size_t first, size_t last)
+            {
+                V value = identity;
+                for (size_t i = first; i < last; ++i)
+                    value = reduce(value, map(T(begin + i)));
+                partial[first / grainSize] = std::move(value);
+            }
+        );
+        V result = identity;
+        for (auto& value : partial)
+            result = reduce(result, value);
+        return result;
+    }
+
+private:
+    /// Returns the grain size to use for a range of the given size.
+    static size_t getGrainSize(size_t count, size_t grainSize);
+
+    /**
+     * Split [0, count) into chunks of grainSize iterations and process them in parallel.
+     * Chunk boundaries are multiples of the grain size.
+     */
+    static void parallelForChunks(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& func);
 };
 
 /**
@@ -69,6 +69,11 @@ void TimeReport::measure(const std::string& name)
     mMeasurements.push_back({name, duration.count()});
 }
 
+void TimeReport::addMeasurement(const std::string& name, double duration)
+{
+    mMeasurements.push_back({name, duration});
+}
+
 void TimeReport::addTotal(const std::string name)
 {
     mTotal = std::accumulate(mMeasurements.begin(), mMeasurements.end(), 0.0, [](double t, auto&& m) { return t + m.second; });
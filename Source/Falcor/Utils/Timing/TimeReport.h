@@ -65,6 +65,14 @@ public:
      */
     void measure(const std::string& name);
 
+    /**
+     * Records a time measurement that was taken externally.
+     * This does not reset the internal timer.
+     * @param[in] name Name of the record.
+     * @param[in] duration Duration in seconds.
+     */
+    void addMeasurement(const std::string& name, double duration);
+
     /**
      * Add a record containing the total of all measurements.
      * @param[in] name Name of the record.
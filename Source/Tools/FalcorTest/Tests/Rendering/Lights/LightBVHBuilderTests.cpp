@@ -0,0 +1,146 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "LightBVHTestUtils.h"
+#include "Utils/Threading.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+using namespace LightBVHTest;
+
+BuildResult build(const std::vector<MeshLightTriangle>& triangles, LightBVHBuilder::Options options, bool parallel, double* pTime = nullptr)
+{
+    options.useParallelBuild = parallel;
+    auto startTime = CpuTimer::getCurrentTimePoint();
+    BuildResult result = buildLightBVH(triangles, options);
+    if (pTime)
+        *pTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+    return result;
+}
+
+// Check that all triangles with flux are included exactly once.
+void validateTriangles(CPUUnitTestContext& ctx, const std::vector<MeshLightTriangle>& triangles, const BuildResult& result)
+{
+    uint32_t includedCount = 0;
+    for (const auto& tri : triangles)
+        includedCount += tri.flux > 0.f ? 1 : 0;
+    ASSERT_EQ(result.triangleIndices.size(), includedCount);
+    for (uint32_t i = 0; i < triangles.size(); i++)
+        EXPECT_EQ(result.triangleBitmasks[i] != std::numeric_limits<uint64_t>::max(), triangles[i].flux > 0.f) << "i = " << i;
+
+    std::vector<uint32_t> sortedIndices = result.triangleIndices;
+    std::sort(sortedIndices.begin(), sortedIndices.end());
+    EXPECT(std::adjacent_find(sortedIndices.begin(), sortedIndices.end()) == sortedIndices.end());
+}
+
+void expectIdentical(CPUUnitTestContext& ctx, const BuildResult& a, const BuildResult& b)
+{
+    ASSERT_EQ(a.nodes.size(), b.nodes.size());
+    EXPECT(std::memcmp(a.nodes.data(), b.nodes.data(), a.nodes.size() * sizeof(PackedNode)) == 0);
+    EXPECT(a.triangleIndices == b.triangleIndices);
+    EXPECT(a.triangleBitmasks == b.triangleBitmasks);
+}
+
+// A soup of small emissive triangles distributed over a few clusters. A few culled triangles have no flux.
+const TriangleSoupDesc kSoupDesc = { float3(100.f), 16, 17 };
+
+void testParallelMatchesSerial(CPUUnitTestContext& ctx, const LightBVHBuilder::Options& options)
+{
+    // Large enough to build subtrees in parallel, but reduced in a single chunk.
+    const auto triangles = generateTriangleSoup(12000, 1, kSoupDesc);
+
+    const BuildResult serial = build(triangles, options, false);
+    const BuildResult parallel = build(triangles, options, true);
+    validateTriangles(ctx, triangles, serial);
+    expectIdentical(ctx, parallel, serial);
+}
+
+void testParallelMatchesSerialMultiChunk(CPUUnitTestContext& ctx, const LightBVHBuilder::Options& options)
+{
+    // Large enough that the nodes near the root are reduced in multiple chunks of 16384 triangles.
+    // The serial build sums in the same chunk order, so both builds are bit-identical.
+    const auto triangles = generateTriangleSoup(60000, 1, kSoupDesc);
+
+    const BuildResult serial = build(triangles, options, false);
+    const BuildResult parallel = build(triangles, options, true);
+    validateTriangles(ctx, triangles, serial);
+    expectIdentical(ctx, parallel, serial);
+    for (uint32_t i = 0; i < 3; i++)
+        expectIdentical(ctx, build(triangles, options, true), serial);
+}
+} // namespace
+
+CPU_TEST(LightBVHBuilder_ParallelMatchesSerialSAOH)
+{
+    LightBVHBuilder::Options options;
+    options.splitHeuristicSelection = LightBVHBuilder::SplitHeuristic::BinnedSAOH;
+    testParallelMatchesSerial(ctx, options);
+    testParallelMatchesSerialMultiChunk(ctx, options);
+}
+
+CPU_TEST(LightBVHBuilder_ParallelMatchesSerialSAH)
+{
+    LightBVHBuilder::Options options;
+    options.splitHeuristicSelection = LightBVHBuilder::SplitHeuristic::BinnedSAH;
+    testParallelMatchesSerial(ctx, options);
+    testParallelMatchesSerialMultiChunk(ctx, options);
+}
+
+CPU_TEST(LightBVHBuilder_ParallelMatchesSerialEqual)
+{
+    LightBVHBuilder::Options options;
+    options.splitHeuristicSelection = LightBVHBuilder::SplitHeuristic::Equal;
+    testParallelMatchesSerial(ctx, options);
+    testParallelMatchesSerialMultiChunk(ctx, options);
+}
+
+CPU_TEST(LightBVHBuilder_Benchmark)
+{
+    // Compare serial and parallel build times on a large triangle soup with the default options.
+    const auto triangles = generateTriangleSoup(200000, 2, kSoupDesc);
+    const LightBVHBuilder::Options options;
+
+    double serialTime = 0.0, parallelTime = 0.0;
+    const BuildResult serial = build(triangles, options, false, &serialTime);
+    const BuildResult parallel = build(triangles, options, true, &parallelTime);
+    logInfo(
+        "Light BVH build of {} triangles: {} nodes, serial {:.1f} ms, parallel {:.1f} ms ({} threads)", triangles.size(), serial.nodes.size(),
+        serialTime, parallelTime, Threading::getThreadCount()
+    );
+
+    validateTriangles(ctx, triangles, parallel);
+}
+} // namespace Falcor
@@ -0,0 +1,197 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "LightBVHTestUtils.h"
+#include "Rendering/Lights/LightBVHRefitter.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+using namespace LightBVHTest;
+
+// Every 17th triangle has no flux and is culled from the BVH.
+const TriangleSoupDesc kSoupDesc = { float3(100.f), 0, 17 };
+
+// Moves and flips the given triangles, as an animated mesh light would.
+void moveTriangles(std::vector<MeshLightTriangle>& triangles, const std::vector<uint32_t>& indices, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> u(-1.f, 1.f);
+
+    for (uint32_t i : indices)
+    {
+        MeshLightTriangle& tri = triangles[i];
+        const float3 offset = float3(u(rng), u(rng), u(rng)) * 5.f;
+        for (auto& vtx : tri.vtx)
+            vtx.pos += offset;
+        std::swap(tri.vtx[1], tri.vtx[2]);
+        tri.normal = -tri.normal;
+    }
+}
+
+bool equal(const std::vector<PackedNode>& a, const std::vector<PackedNode>& b)
+{
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(PackedNode)) == 0;
+}
+
+void testIncrementalRefit(CPUUnitTestContext& ctx, uint32_t triangleCount, uint32_t updatedStride)
+{
+    auto triangles = generateTriangleSoup(triangleCount, 1, kSoupDesc);
+
+    BuildResult bvh = buildLightBVH(triangles);
+    std::vector<PackedNode>& nodes = bvh.nodes;
+
+    std::vector<uint32_t> allTriangles(triangleCount);
+    std::iota(allTriangles.begin(), allTriangles.end(), 0);
+
+    // Start from fully refit nodes, as the builder computes the cones differently.
+    LightBVHRefitter refitter;
+    refitter.init(nodes, bvh.triangleIndices, triangleCount);
+    ASSERT(refitter.isInitialized());
+    refitter.refit(nodes, triangles, allTriangles);
+    refitter.collectDirtyRanges();
+
+    std::vector<uint32_t> updatedTriangles;
+    for (uint32_t i = 3; i < triangleCount; i += updatedStride)
+        updatedTriangles.push_back(i);
+    moveTriangles(triangles, updatedTriangles, 2);
+
+    // Incremental refit, in parallel and serially.
+    std::vector<PackedNode> parallelNodes = nodes;
+    refitter.refit(parallelNodes, triangles, updatedTriangles, true);
+    const uint32_t refitNodeCount = refitter.getRefitNodeCount();
+    const auto ranges = refitter.collectDirtyRanges();
+
+    std::vector<PackedNode> serialNodes = nodes;
+    refitter.refit(serialNodes, triangles, updatedTriangles, false);
+    refitter.collectDirtyRanges();
+    EXPECT(equal(parallelNodes, serialNodes));
+
+    // Full refit for reference.
+    std::vector<PackedNode> fullNodes = nodes;
+    LightBVHRefitter fullRefitter;
+    fullRefitter.init(fullNodes, bvh.triangleIndices, triangleCount);
+    fullRefitter.refit(fullNodes, triangles, allTriangles, false);
+    EXPECT(equal(parallelNodes, fullNodes));
+
+    // Only the ancestors of the updated leaves are refit.
+    EXPECT_LE(refitNodeCount, (uint32_t)updatedTriangles.size() * (getTreeHeight(nodes) + 1));
+    EXPECT_LT(refitNodeCount, (uint32_t)nodes.size());
+
+    // All modified nodes are covered by the dirty ranges.
+    uint32_t rangeIndex = 0;
+    for (uint32_t i = 0; i < nodes.size(); i++)
+    {
+        while (rangeIndex < ranges.size() && ranges[rangeIndex].end <= i)
+            rangeIndex++;
+        const bool inRange = rangeIndex < ranges.size() && ranges[rangeIndex].begin <= i;
+        if (std::memcmp(&nodes[i], &parallelNodes[i], sizeof(PackedNode)) != 0)
+            EXPECT(inRange) << "i = " << i;
+    }
+    for (uint32_t i = 1; i < ranges.size(); i++)
+        EXPECT_LT(ranges[i - 1].end + LightBVHRefitter::kDefaultMergeGap, ranges[i].begin);
+}
+} // namespace
+
+CPU_TEST(LightBVHRefitter_FewTriangles)
+{
+    testIncrementalRefit(ctx, 20000, 997);
+}
+
+CPU_TEST(LightBVHRefitter_ManyTriangles)
+{
+    // Enough updated leaves to refit the lower levels in parallel.
+    testIncrementalRefit(ctx, 20000, 3);
+}
+
+CPU_TEST(LightBVHRefitter_CulledTriangle)
+{
+    auto triangles = generateTriangleSoup(1000, 3, kSoupDesc);
+
+    BuildResult bvh = buildLightBVH(triangles);
+    std::vector<PackedNode>& nodes = bvh.nodes;
+
+    // Moving a triangle without flux doesn't affect the BVH.
+    LightBVHRefitter refitter;
+    refitter.init(nodes, bvh.triangleIndices, (uint32_t)triangles.size());
+    moveTriangles(triangles, { 17 }, 4);
+    const std::vector<PackedNode> oldNodes = nodes;
+    refitter.refit(nodes, triangles, { 17 });
+    EXPECT_EQ(refitter.getRefitNodeCount(), 0);
+    EXPECT(refitter.collectDirtyRanges().empty());
+    EXPECT(equal(oldNodes, nodes));
+}
+
+CPU_TEST(LightBVHRefitter_Benchmark)
+{
+    const uint32_t triangleCount = 200000;
+    auto triangles = generateTriangleSoup(triangleCount, 5, kSoupDesc);
+
+    BuildResult bvh = buildLightBVH(triangles);
+    std::vector<PackedNode>& nodes = bvh.nodes;
+
+    LightBVHRefitter refitter;
+    refitter.init(nodes, bvh.triangleIndices, triangleCount);
+
+    std::vector<uint32_t> allTriangles(triangleCount);
+    std::iota(allTriangles.begin(), allTriangles.end(), 0);
+    std::vector<uint32_t> updatedTriangles;
+    for (uint32_t i = 1; i < triangleCount; i += 1000)
+        updatedTriangles.push_back(i);
+    moveTriangles(triangles, updatedTriangles, 6);
+
+    auto startTime = CpuTimer::getCurrentTimePoint();
+    refitter.refit(nodes, triangles, allTriangles);
+    const double fullTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+    refitter.collectDirtyRanges();
+
+    moveTriangles(triangles, updatedTriangles, 7);
+    startTime = CpuTimer::getCurrentTimePoint();
+    refitter.refit(nodes, triangles, updatedTriangles);
+    const double incrementalTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+    const auto ranges = refitter.collectDirtyRanges();
+
+    uint32_t uploadNodeCount = 0;
+    for (const auto& range : ranges)
+        uploadNodeCount += range.end - range.begin;
+    logInfo(
+        "Light BVH refit of {} nodes: full {:.2f} ms, {} updated triangles {:.2f} ms ({} nodes refit, {} nodes in {} upload ranges)", nodes.size(),
+        fullTime, updatedTriangles.size(), incrementalTime, refitter.getRefitNodeCount(), uploadNodeCount, ranges.size()
+    );
+
+    EXPECT_LT(uploadNodeCount, (uint32_t)nodes.size());
+}
+} // namespace Falcor
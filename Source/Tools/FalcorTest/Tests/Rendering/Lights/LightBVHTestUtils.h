@@ -0,0 +1,115 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Rendering/Lights/LightBVHBuilder.h"
+
+#include <algorithm>
+#include <random>
+#include <stack>
+#include <utility>
+#include <vector>
+
+namespace Falcor
+{
+namespace LightBVHTest
+{
+using MeshLightTriangle = LightCollection::MeshLightTriangle;
+
+struct TriangleSoupDesc
+{
+    float3 extent = float3(100.f); ///< Extent of the box the triangles are distributed in.
+    uint32_t clusterCount = 0;     ///< Number of clusters to group the triangles in, or 0 to distribute them uniformly.
+    uint32_t culledStride = 0;     ///< Every n-th triangle has no flux and is culled from the BVH, or 0 to give all triangles flux.
+};
+
+// Generates a soup of small emissive triangles with random orientations and flux.
+inline std::vector<MeshLightTriangle> generateTriangleSoup(uint32_t triangleCount, uint32_t seed, const TriangleSoupDesc& desc = {})
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+
+    std::vector<float3> clusterCenters(desc.clusterCount);
+    for (auto& center : clusterCenters)
+        center = float3(u(rng), u(rng), u(rng)) * desc.extent;
+
+    std::vector<MeshLightTriangle> triangles(triangleCount);
+    for (uint32_t i = 0; i < triangleCount; i++)
+    {
+        MeshLightTriangle& tri = triangles[i];
+        const float3 center = clusterCenters.empty() ? float3(u(rng), u(rng), u(rng)) * desc.extent
+                                                     : clusterCenters[i % clusterCenters.size()] + float3(u(rng), u(rng), u(rng)) * desc.extent * 0.2f;
+        for (uint32_t j = 0; j < 3; j++)
+            tri.vtx[j].pos = center + (float3(u(rng), u(rng), u(rng)) - 0.5f) * 0.5f;
+
+        const float3 n = cross(tri.vtx[1].pos - tri.vtx[0].pos, tri.vtx[2].pos - tri.vtx[0].pos);
+        tri.area = 0.5f * length(n);
+        tri.normal = tri.area > 0.f ? normalize(n) : float3(0.f, 1.f, 0.f);
+        tri.flux = desc.culledStride > 0 && i % desc.culledStride == 0 ? 0.f : 0.1f + u(rng) * 10.f;
+    }
+    return triangles;
+}
+
+// CPU side of a light BVH as produced by LightBVHBuilder::buildNodes().
+struct BuildResult
+{
+    std::vector<PackedNode> nodes;
+    std::vector<uint32_t> triangleIndices;
+    std::vector<uint64_t> triangleBitmasks;
+};
+
+inline BuildResult buildLightBVH(const std::vector<MeshLightTriangle>& triangles, const LightBVHBuilder::Options& options = {})
+{
+    BuildResult result;
+    LightBVHBuilder builder(options);
+    builder.buildNodes(triangles, result.nodes, result.triangleIndices, result.triangleBitmasks);
+    return result;
+}
+
+// Returns the height of a binary light BVH, where a single leaf has height 0.
+inline uint32_t getTreeHeight(const std::vector<PackedNode>& nodes)
+{
+    uint32_t height = 0;
+    std::stack<std::pair<uint32_t, uint32_t>> stack({ { 0u, 0u } });
+    while (!stack.empty())
+    {
+        auto [nodeIndex, depth] = stack.top();
+        stack.pop();
+        if (nodes[nodeIndex].isLeaf())
+        {
+            height = std::max(height, depth);
+        }
+        else
+        {
+            stack.push({ nodeIndex + 1, depth + 1 });
+            stack.push({ nodes[nodeIndex].getInternalNode().rightChildIdx, depth + 1 });
+        }
+    }
+    return height;
+}
+} // namespace LightBVHTest
+} // namespace Falcor
@@ -0,0 +1,274 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "LightBVHTestUtils.h"
+#include "Rendering/Lights/WideLightBVH.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <cmath>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+using namespace LightBVHTest;
+
+// A flat slab of emissive triangles.
+const TriangleSoupDesc kSoupDesc = { float3(100.f, 20.f, 100.f) };
+
+AABB getBounds(const SharedNodeAttributes& attribs)
+{
+    return AABB(attribs.origin - attribs.extent, attribs.origin + attribs.extent);
+}
+
+bool contains(const AABB& outer, const AABB& inner)
+{
+    return all(outer.minPoint <= inner.minPoint) && all(inner.maxPoint <= outer.maxPoint);
+}
+
+// Importance of a subtree for a shading point, similar in spirit to the light BVH sampler.
+float evalImportance(const float3& p, const AABB& bounds, float flux)
+{
+    const float3 d = bounds.center() - p;
+    return flux / std::max(dot(d, d), 0.25f * dot(bounds.extent(), bounds.extent()));
+}
+
+// Stochastically traverses the binary BVH for a shading point and returns the number of nodes fetched.
+uint32_t sampleBinary(const std::vector<PackedNode>& nodes, const float3& p, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    uint32_t nodeIndex = 0, fetchCount = 1;
+    while (!nodes[nodeIndex].isLeaf())
+    {
+        const uint32_t leftIndex = nodeIndex + 1;
+        const uint32_t rightIndex = nodes[nodeIndex].getInternalNode().rightChildIdx;
+        const auto left = nodes[leftIndex].getNodeAttributes();
+        const auto right = nodes[rightIndex].getNodeAttributes();
+        const float wl = evalImportance(p, getBounds(left), left.flux);
+        const float wr = evalImportance(p, getBounds(right), right.flux);
+        nodeIndex = u(rng) * (wl + wr) < wl ? leftIndex : rightIndex;
+        fetchCount += 2;
+    }
+    return fetchCount;
+}
+
+// Stochastically traverses a wide BVH for a shading point and returns the number of nodes fetched.
+template<uint32_t kWidth>
+uint32_t sampleWide(const WideLightBVH<kWidth>& bvh, const float3& p, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    const auto& nodes = bvh.getNodes();
+    uint32_t nodeIndex = 0, fetchCount = 0;
+    while (true)
+    {
+        const auto& node = nodes[nodeIndex];
+        fetchCount++;
+
+        float weights[kWidth];
+        float weightSum = 0.f;
+        for (uint32_t slot = 0; slot < node.childCount; slot++)
+        {
+            const auto attribs = node.getChildAttributes(slot);
+            weights[slot] = evalImportance(p, attribs.bounds, attribs.flux);
+            weightSum += weights[slot];
+        }
+        float x = u(rng) * weightSum;
+        uint32_t slot = 0;
+        while (slot + 1 < node.childCount && x >= weights[slot])
+            x -= weights[slot++];
+
+        if (node.isLeaf(slot))
+            return fetchCount;
+        nodeIndex = node.getChildIndex(slot);
+    }
+}
+
+template<uint32_t kWidth>
+void testCollapse(CPUUnitTestContext& ctx)
+{
+    const auto triangles = generateTriangleSoup(20000, 1, kSoupDesc);
+    const BuildResult binary = buildLightBVH(triangles);
+    ASSERT(!binary.nodes.empty());
+
+    WideLightBVH<kWidth> bvh;
+    bvh.build(binary.nodes);
+    ASSERT(bvh.isValid());
+
+    // Map the binary leaves by triangle offset.
+    std::map<uint32_t, LeafNode> binaryLeaves;
+    for (const auto& node : binary.nodes)
+    {
+        if (node.isLeaf())
+            binaryLeaves[node.getLeafNode().triangleOffset] = node.getLeafNode();
+    }
+
+    // Every binary leaf appears exactly once with conservative attributes.
+    uint32_t leafCount = 0;
+    bvh.traverseBVH(
+        [&](const typename WideLightBVH<kWidth>::NodeLocation& location)
+        {
+            const auto& node = bvh.getNodes()[location.nodeIndex];
+            EXPECT_GE(node.childCount, 1u);
+            EXPECT_LE(node.childCount, kWidth);
+            return true;
+        },
+        [&](const typename WideLightBVH<kWidth>::LeafLocation& location)
+        {
+            const auto& node = bvh.getNodes()[location.nodeIndex];
+            auto it = binaryLeaves.find(node.getTriangleOffset(location.slot));
+            EXPECT(it != binaryLeaves.end());
+            if (it == binaryLeaves.end())
+                return true;
+            const LeafNode& leaf = it->second;
+            EXPECT_EQ(node.getTriangleCount(location.slot), leaf.triangleCount);
+
+            const auto attribs = node.getChildAttributes(location.slot);
+            EXPECT(contains(attribs.bounds, getBounds(leaf.attribs)));
+            EXPECT_EQ(attribs.flux, leaf.attribs.flux);
+            if (leaf.attribs.cosConeAngle != kInvalidCosConeAngle && attribs.cosConeAngle != kInvalidCosConeAngle)
+            {
+                // The binary cone must be inside the wide cone.
+                const float angle = std::acos(std::clamp(dot(attribs.coneDirection, normalize(leaf.attribs.coneDirection)), -1.f, 1.f)) +
+                                    std::acos(leaf.attribs.cosConeAngle);
+                EXPECT_LE(angle, std::acos(attribs.cosConeAngle));
+            }
+            leafCount++;
+            return true;
+        }
+    );
+    EXPECT_EQ(leafCount, binaryLeaves.size());
+    EXPECT_EQ(bvh.getStats().leafCount, binaryLeaves.size());
+    EXPECT_EQ(bvh.getStats().triangleCount, binary.triangleIndices.size());
+    EXPECT_LT(bvh.getStats().treeHeight, getTreeHeight(binary.nodes));
+
+    // Following the bitmask of a triangle leads to the leaf containing it.
+    const auto bitmasks = bvh.computeTriangleBitmasks(binary.triangleIndices, triangles.size());
+    for (uint32_t i = 0; i < triangles.size(); i += 7)
+    {
+        uint64_t bitmask = bitmasks[i];
+        uint32_t nodeIndex = 0;
+        bool found = false;
+        for (uint32_t depth = 0; depth < WideLightBVH<kWidth>::kMaxDepth && !found; depth++)
+        {
+            const auto& node = bvh.getNodes()[nodeIndex];
+            const uint32_t slot = bitmask & (kWidth - 1);
+            bitmask >>= WideLightBVH<kWidth>::kBitsPerLevel;
+            if (slot >= node.childCount)
+                break;
+            if (node.isLeaf(slot))
+            {
+                for (uint32_t j = 0; j < node.getTriangleCount(slot); j++)
+                    found |= binary.triangleIndices[node.getTriangleOffset(slot) + j] == i;
+                break;
+            }
+            nodeIndex = node.getChildIndex(slot);
+        }
+        EXPECT(found) << "triangle " << i;
+    }
+}
+
+template<uint32_t kWidth>
+void logWideStats(const std::vector<MeshLightTriangle>& triangles, const BuildResult& binary, const std::vector<float3>& points)
+{
+    WideLightBVH<kWidth> bvh;
+    auto startTime = CpuTimer::getCurrentTimePoint();
+    bvh.build(binary.nodes);
+    const double buildTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+    std::mt19937 rng(3);
+    uint64_t fetchCount = 0;
+    startTime = CpuTimer::getCurrentTimePoint();
+    for (const float3& p : points)
+        fetchCount += sampleWide(bvh, p, rng);
+    const double sampleTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+    const auto& stats = bvh.getStats();
+    logInfo(
+        "{}-wide light BVH: height {}, {} nodes, {} bytes, collapse {:.1f} ms, {:.2f} node fetches ({:.0f} bytes) and {:.3f} us per sample",
+        kWidth, stats.treeHeight, stats.nodeCount, stats.byteSize, buildTime, double(fetchCount) / points.size(),
+        double(fetchCount) * sizeof(typename WideLightBVH<kWidth>::Node) / points.size(), sampleTime * 1000.0 / points.size()
+    );
+}
+} // namespace
+
+CPU_TEST(WideLightBVH_Collapse4)
+{
+    testCollapse<4>(ctx);
+}
+
+CPU_TEST(WideLightBVH_Collapse8)
+{
+    testCollapse<8>(ctx);
+}
+
+CPU_TEST(WideLightBVH_SingleLeaf)
+{
+    const auto triangles = generateTriangleSoup(3, 2, kSoupDesc);
+    const BuildResult binary = buildLightBVH(triangles);
+    ASSERT_EQ(binary.nodes.size(), 1u);
+
+    LightBVH8 bvh;
+    bvh.build(binary.nodes);
+    ASSERT_EQ(bvh.getNodes().size(), 1u);
+    const auto& root = bvh.getNodes()[0];
+    EXPECT_EQ(root.childCount, 1u);
+    EXPECT(root.isLeaf(0));
+    EXPECT_EQ(root.getTriangleCount(0), 3u);
+    EXPECT_EQ(bvh.getStats().triangleCount, 3u);
+}
+
+CPU_TEST(WideLightBVH_Benchmark)
+{
+    // Compare depth, memory and stochastic traversal cost of the binary and wide BVHs.
+    const auto triangles = generateTriangleSoup(200000, 4, kSoupDesc);
+    const BuildResult binary = buildLightBVH(triangles);
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    std::vector<float3> points(100000);
+    for (auto& p : points)
+        p = float3(u(rng), u(rng) * 0.2f, u(rng)) * 100.f;
+
+    uint64_t fetchCount = 0;
+    auto startTime = CpuTimer::getCurrentTimePoint();
+    for (const float3& p : points)
+        fetchCount += sampleBinary(binary.nodes, p, rng);
+    const double sampleTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+    logInfo(
+        "Binary light BVH: height {}, {} nodes, {} bytes, {:.2f} node fetches ({:.0f} bytes) and {:.3f} us per sample",
+        getTreeHeight(binary.nodes), binary.nodes.size(), binary.nodes.size() * sizeof(PackedNode), double(fetchCount) / points.size(),
+        double(fetchCount) * sizeof(PackedNode) / points.size(), sampleTime * 1000.0 / points.size()
+    );
+
+    logWideStats<4>(triangles, binary, points);
+    logWideStats<8>(triangles, binary, points);
+}
+} // namespace Falcor
@@ -0,0 +1,286 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Sampling/AliasTableBuilder.h"
+#include "Utils/Sampling/HierarchicalAliasTable.h"
+#include "Utils/Threading.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <hypothesis/hypothesis.h>
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+using Entry = AliasTableBuilder::Entry;
+
+std::vector<float> generateWeights(uint32_t N, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> uniform;
+
+    // Wide range of weights with a few zeros.
+    std::vector<float> weights(N);
+    for (uint32_t i = 0; i < N; ++i)
+        weights[i] = i % 50 == 7 ? 0.f : std::pow(uniform(rng), 4.f) * 100.f;
+    return weights;
+}
+
+double sumWeights(const std::vector<float>& weights)
+{
+    double sum = 0.0;
+    for (float weight : weights)
+        sum += weight;
+    return sum;
+}
+
+// Computes the exact sampling probabilities of an alias table.
+std::vector<double> computeProbabilities(const Entry* entries, uint32_t count)
+{
+    std::vector<double> probabilities(count, 0.0);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        probabilities[i] += entries[i].threshold / (double)count;
+        probabilities[entries[i].alias] += (1.0 - entries[i].threshold) / (double)count;
+    }
+    return probabilities;
+}
+
+void expectProbabilities(CPUUnitTestContext& ctx, const std::vector<double>& probabilities, const std::vector<float>& weights)
+{
+    const double weightSum = sumWeights(weights);
+    for (uint32_t i = 0; i < weights.size(); ++i)
+    {
+        const double expected = weightSum > 0.0 ? weights[i] / weightSum : 1.0 / weights.size();
+        EXPECT_LE(std::abs(probabilities[i] - expected), 1e-6 * expected + 1e-12) << "i = " << i;
+    }
+}
+
+template<typename SampleFunc>
+void expectChi2(CPUUnitTestContext& ctx, const std::vector<float>& weights, uint32_t sampleCount, SampleFunc sample)
+{
+    const uint32_t N = (uint32_t)weights.size();
+    std::vector<double> obsFrequencies(N, 0.0);
+    std::mt19937 rng(123);
+    std::uniform_real_distribution<float> uniform;
+    for (uint32_t s = 0; s < sampleCount; ++s)
+    {
+        const uint32_t index = sample(rng, uniform);
+        ASSERT_LT(index, N);
+        obsFrequencies[index]++;
+    }
+
+    const double weightSum = sumWeights(weights);
+    std::vector<double> expFrequencies(N);
+    for (uint32_t i = 0; i < N; ++i)
+        expFrequencies[i] = weights[i] / weightSum * sampleCount;
+
+    const auto& [success, report] = hypothesis::chi2_test(N, obsFrequencies.data(), expFrequencies.data(), sampleCount, 5, 0.01);
+    if (!success)
+        std::cout << report << std::endl;
+    EXPECT(success);
+}
+
+void testBuild(CPUUnitTestContext& ctx, const std::vector<float>& weights)
+{
+    std::vector<Entry> entries;
+    const double weightSum = AliasTableBuilder::build(weights, entries);
+    ASSERT_EQ(entries.size(), weights.size());
+    EXPECT_LE(std::abs(weightSum - sumWeights(weights)), 1e-9 * weightSum);
+
+    for (uint32_t i = 0; i < entries.size(); ++i)
+    {
+        EXPECT(entries[i].threshold >= 0.f && entries[i].threshold <= 1.f) << "i = " << i;
+        EXPECT_LT(entries[i].alias, (uint32_t)entries.size()) << "i = " << i;
+    }
+    expectProbabilities(ctx, computeProbabilities(entries.data(), (uint32_t)entries.size()), weights);
+
+    // The parallel build is bit-identical.
+    std::vector<Entry> serialEntries;
+    AliasTableBuilder::build(weights, serialEntries, false);
+    EXPECT(std::memcmp(entries.data(), serialEntries.data(), entries.size() * sizeof(Entry)) == 0);
+}
+
+// Computes the exact sampling probabilities of a hierarchical alias table.
+std::vector<double> computeProbabilities(const HierarchicalAliasTable& table)
+{
+    const auto blockProbabilities = computeProbabilities(table.getBlockEntries().data(), table.getBlockCount());
+    std::vector<double> probabilities(table.getCount());
+    for (uint32_t block = 0; block < table.getBlockCount(); ++block)
+    {
+        const uint32_t begin = block * table.getBlockSize();
+        const uint32_t count = std::min(table.getCount() - begin, table.getBlockSize());
+        const auto entryProbabilities = computeProbabilities(table.getEntries().data() + begin, count);
+        for (uint32_t i = 0; i < count; ++i)
+            probabilities[begin + i] = blockProbabilities[block] * entryProbabilities[i];
+    }
+    return probabilities;
+}
+
+void expectEqualTables(CPUUnitTestContext& ctx, const HierarchicalAliasTable& a, const HierarchicalAliasTable& b)
+{
+    ASSERT_EQ(a.getCount(), b.getCount());
+    ASSERT_EQ(a.getBlockCount(), b.getBlockCount());
+    EXPECT_EQ(a.getWeightSum(), b.getWeightSum());
+    EXPECT(std::memcmp(a.getEntries().data(), b.getEntries().data(), a.getCount() * sizeof(Entry)) == 0);
+    EXPECT(std::memcmp(a.getBlockEntries().data(), b.getBlockEntries().data(), a.getBlockCount() * sizeof(Entry)) == 0);
+}
+} // namespace
+
+CPU_TEST(AliasTableBuilder_Build)
+{
+    testBuild(ctx, {1.f});
+    testBuild(ctx, {1.f, 2.f});
+    testBuild(ctx, {0.f, 0.f, 0.f});
+    testBuild(ctx, std::vector<float>(1000, 0.3f));
+    testBuild(ctx, {0.f, 0.f, 5.f, 0.f, 1e-30f, 0.f});
+    testBuild(ctx, generateWeights(1000, 1));
+    // Multiple chunks.
+    testBuild(ctx, generateWeights(100000, 2));
+}
+
+CPU_TEST(AliasTableBuilder_Sample)
+{
+    const std::vector<float> weights = generateWeights(1000, 3);
+    std::vector<Entry> entries;
+    AliasTableBuilder::build(weights, entries);
+
+    expectChi2(
+        ctx, weights, 2000000,
+        [&](std::mt19937& rng, std::uniform_real_distribution<float>& uniform)
+        {
+            const float u0 = uniform(rng);
+            const float u1 = uniform(rng);
+            return AliasTableBuilder::sample(entries.data(), (uint32_t)entries.size(), u0, u1);
+        }
+    );
+}
+
+CPU_TEST(HierarchicalAliasTable_Sample)
+{
+    const std::vector<float> weights = generateWeights(5000, 4);
+    HierarchicalAliasTable table(64);
+    table.build(weights);
+    EXPECT_EQ(table.getBlockCount(), 79);
+    expectProbabilities(ctx, computeProbabilities(table), weights);
+
+    expectChi2(
+        ctx, weights, 2000000,
+        [&](std::mt19937& rng, std::uniform_real_distribution<float>& uniform)
+        {
+            const float u0 = uniform(rng);
+            const float u1 = uniform(rng);
+            const float u2 = uniform(rng);
+            const float u3 = uniform(rng);
+            return table.sample(u0, u1, u2, u3);
+        }
+    );
+}
+
+CPU_TEST(HierarchicalAliasTable_Update)
+{
+    std::vector<float> weights = generateWeights(5000, 5);
+    HierarchicalAliasTable table(64);
+    table.build(weights);
+    EXPECT_EQ(table.collectDirtyRanges().size(), 1);
+
+    // Unchanged weights don't rebuild anything.
+    EXPECT_EQ(table.update(weights), 0);
+    EXPECT(table.collectDirtyRanges().empty());
+
+    // Sparse update of entries in three blocks.
+    const std::vector<uint32_t> indices = {10, 20, 700, 4999};
+    const std::vector<float> newWeights = {500.f, 0.f, 3.f, 1.f};
+    EXPECT_EQ(table.update(indices, newWeights), 3);
+    for (size_t i = 0; i < indices.size(); ++i)
+        weights[indices[i]] = newWeights[i];
+
+    const auto ranges = table.collectDirtyRanges();
+    ASSERT_EQ(ranges.size(), 3);
+    EXPECT(ranges[0].begin == 0 && ranges[0].end == 64);
+    EXPECT(ranges[1].begin == 640 && ranges[1].end == 704);
+    EXPECT(ranges[2].begin == 4992 && ranges[2].end == 5000);
+
+    HierarchicalAliasTable reference(64);
+    reference.build(weights);
+    expectEqualTables(ctx, table, reference);
+    expectProbabilities(ctx, computeProbabilities(table), weights);
+
+    // Dense update with changes in two blocks.
+    weights[100] *= 2.f;
+    weights[4000] = 0.f;
+    weights[4001] = 0.f;
+    EXPECT_EQ(table.update(weights), 2);
+    reference.build(weights);
+    expectEqualTables(ctx, table, reference);
+}
+
+CPU_TEST(AliasTableBuilder_Benchmark)
+{
+    const uint32_t N = 5000000;
+    std::vector<float> weights = generateWeights(N, 6);
+    std::vector<Entry> entries;
+
+    auto startTime = CpuTimer::getCurrentTimePoint();
+    AliasTableBuilder::build(weights, entries, false);
+    const double serialTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+    startTime = CpuTimer::getCurrentTimePoint();
+    AliasTableBuilder::build(weights, entries, true);
+    const double parallelTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+    HierarchicalAliasTable table;
+    startTime = CpuTimer::getCurrentTimePoint();
+    table.build(weights);
+    const double hierarchicalTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+    // Animate the weights of 1000 scattered entries.
+    std::vector<uint32_t> indices;
+    std::vector<float> newWeights;
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        indices.push_back(i * 4999);
+        newWeights.push_back(weights[i * 4999] + 1.f);
+    }
+    startTime = CpuTimer::getCurrentTimePoint();
+    const uint32_t blockCount = table.update(indices, newWeights);
+    const double updateTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+    logInfo(
+        "Alias table with {} entries: serial build {:.1f} ms, parallel build {:.1f} ms ({} threads), hierarchical build {:.1f} ms, "
+        "update of {} entries in {} blocks {:.2f} ms",
+        N, serialTime, parallelTime, Threading::getThreadCount(), hierarchicalTime, indices.size(), blockCount, updateTime
+    );
+    EXPECT_EQ(blockCount, 1000);
+}
+} // namespace Falcor
@@ -31,6 +31,7 @@
 #include <hypothesis/hypothesis.h>
 
 #include <iostream>
+#include <random>
 
 namespace Falcor
 {
@@ -56,7 +57,7 @@ void testAliasTable(GPUUnitTestContext& ctx, uint32_t N, std::vector<float> spec
     }
 
     // Create alias table.
-    AliasTable aliasTable(pDevice, weights, rng);
+    AliasTable aliasTable(pDevice, weights);
 
     // Compute weight sum.
     double weightSum = 0.0;
@@ -0,0 +1,151 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Animation/Animation.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+// Creates a motion-capture like animation with many densely spaced keyframes.
+ref<Animation> createAnimation(uint32_t index, uint32_t keyframeCount)
+{
+    std::mt19937 rng(index);
+    std::uniform_real_distribution<float> u(-1.f, 1.f);
+    const double duration = (keyframeCount - 1) / 30.0;
+    ref<Animation> pAnimation = Animation::create("anim" + std::to_string(index), NodeID(index), duration);
+    for (uint32_t i = 0; i < keyframeCount; i++)
+    {
+        Animation::Keyframe keyframe;
+        keyframe.time = i / 30.0;
+        keyframe.translation = float3(u(rng), u(rng), u(rng));
+        keyframe.scaling = float3(1.f) + 0.1f * float3(u(rng), u(rng), u(rng));
+        keyframe.rotation = normalize(quatf(u(rng), u(rng), u(rng), 1.f));
+        pAnimation->addKeyframe(keyframe);
+    }
+    pAnimation->setInterpolationMode(index % 2 ? Animation::InterpolationMode::Hermite : Animation::InterpolationMode::Linear);
+    pAnimation->setPostInfinityBehavior(Animation::Behavior((index / 2) % 4));
+    pAnimation->setPreInfinityBehavior(Animation::Behavior((index / 8) % 4));
+    return pAnimation;
+}
+
+bool isEqual(const float4x4& a, const float4x4& b)
+{
+    return std::memcmp(&a, &b, sizeof(float4x4)) == 0;
+}
+} // namespace
+
+CPU_TEST(Animation_Keyframes)
+{
+    ref<Animation> pAnimation = Animation::create("test", NodeID(0), 4.0);
+    pAnimation->addKeyframe({ 2.0, float3(2.f, 0.f, 0.f) });
+    pAnimation->addKeyframe({ 0.0, float3(0.f, 0.f, 0.f) });
+    pAnimation->addKeyframe({ 4.0, float3(4.f, 0.f, 0.f) });
+    pAnimation->addKeyframe({ 1.0, float3(5.f, 0.f, 0.f) });
+    pAnimation->addKeyframe({ 1.0, float3(1.f, 0.f, 0.f) }); // Replaces the previous keyframe.
+
+    EXPECT_EQ(pAnimation->getKeyframeCount(), 4u);
+    EXPECT(pAnimation->doesKeyframeExists(1.0));
+    EXPECT(!pAnimation->doesKeyframeExists(3.0));
+    EXPECT_EQ(pAnimation->getKeyframe(1.0).translation.x, 1.f);
+
+    // Evaluate forward, backward and with jumps. Translation is linear in time.
+    for (double time : { 0.5, 1.5, 2.5, 3.5, 0.25, 3.75, 1.0, 2.0 })
+    {
+        float4x4 transform = pAnimation->animate(time);
+        EXPECT_EQ(transform[0][3], (float)time) << "time=" << time;
+    }
+}
+
+CPU_TEST(Animation_CursorMatchesSearch)
+{
+    // Evaluating an animation with a warm cursor must give the same results as evaluating it from scratch.
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    for (uint32_t index = 0; index < 32; index++)
+    {
+        ref<Animation> pAnimation = createAnimation(index, 100);
+        const double duration = pAnimation->getDuration();
+        double time = -0.5;
+        for (uint32_t i = 0; i < 1000; i++)
+        {
+            // Mostly advance time, sometimes jump anywhere including outside the keyframe range.
+            time = u(rng) < 0.05 ? (u(rng) * 3.0 - 1.0) * duration : time + u(rng) * 0.1;
+            ref<Animation> pFresh = createAnimation(index, 100);
+            EXPECT(isEqual(pAnimation->animate(time), pFresh->animate(time))) << "index=" << index << " time=" << time;
+        }
+    }
+}
+
+CPU_TEST(Animation_BatchBenchmark)
+{
+    // Play back long motion capture animations and compare per-animation evaluation against batched evaluation.
+    const uint32_t animationCount = 256;
+    const uint32_t keyframeCount = 4096;
+    const uint32_t frameCount = 200;
+
+    std::vector<ref<Animation>> animations;
+    for (uint32_t i = 0; i < animationCount; i++)
+        animations.push_back(createAnimation(i, keyframeCount));
+    const double duration = animations[0]->getDuration();
+
+    std::vector<float4x4> serial(animationCount), batched(animationCount);
+    double serialTime = 0.0, batchedTime = 0.0;
+    bool equal = true;
+    for (uint32_t frame = 0; frame < frameCount; frame++)
+    {
+        const double time = 1.7 * duration * frame / frameCount;
+
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        for (uint32_t i = 0; i < animationCount; i++)
+            serial[i] = animations[i]->animate(time);
+        serialTime += CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+        startTime = CpuTimer::getCurrentTimePoint();
+        Animation::animate(animations, time, batched.data());
+        batchedTime += CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+        for (uint32_t i = 0; i < animationCount; i++)
+            equal = equal && isEqual(serial[i], batched[i]);
+    }
+    EXPECT(equal);
+
+    logInfo(
+        "Animation evaluation of {} animations with {} keyframes: serial {:.3f} ms/frame, batched {:.3f} ms/frame",
+        animationCount,
+        keyframeCount,
+        serialTime / frameCount,
+        batchedTime / frameCount
+    );
+}
+} // namespace Falcor
@@ -0,0 +1,159 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/BlasBuildPlan.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+// Check that every BLAS is placed exactly once and that the offsets and buffer sizes are consistent.
+void validatePlan(CPUUnitTestContext& ctx, const std::vector<BlasBuildSize>& sizes, const BlasBuildPlan& plan)
+{
+    EXPECT_EQ(plan.placements.size(), sizes.size());
+    std::vector<uint32_t> count(sizes.size(), 0);
+    uint64_t resultBufferByteSize[2] = {};
+    uint64_t scratchBufferByteSize = 0;
+
+    for (uint32_t groupIndex = 0; groupIndex < (uint32_t)plan.groups.size(); groupIndex++)
+    {
+        const auto& group = plan.groups[groupIndex];
+        EXPECT(!group.blasIndices.empty());
+        EXPECT(std::is_sorted(group.blasIndices.begin(), group.blasIndices.end()));
+
+        uint64_t resultByteSize = 0;
+        uint64_t scratchByteSize = 0;
+        for (uint32_t blasIndex : group.blasIndices)
+        {
+            count[blasIndex]++;
+            const auto& placement = plan.placements[blasIndex];
+            EXPECT_EQ(placement.groupIndex, groupIndex);
+            EXPECT_EQ(placement.resultByteOffset, resultByteSize);
+            EXPECT_EQ(placement.scratchByteOffset, scratchByteSize);
+            resultByteSize += sizes[blasIndex].resultByteSize;
+            scratchByteSize += sizes[blasIndex].scratchByteSize;
+        }
+        EXPECT_EQ(group.resultByteSize, resultByteSize);
+        EXPECT_EQ(group.scratchByteSize, scratchByteSize);
+
+        uint64_t& bufferByteSize = resultBufferByteSize[BlasBuildPlan::getResultBufferIndex(groupIndex)];
+        bufferByteSize = std::max(bufferByteSize, resultByteSize);
+        scratchBufferByteSize = std::max(scratchBufferByteSize, scratchByteSize);
+    }
+
+    for (uint32_t c : count) EXPECT_EQ(c, 1u);
+    EXPECT_EQ(plan.resultBufferByteSize[0], resultBufferByteSize[0]);
+    EXPECT_EQ(plan.resultBufferByteSize[1], resultBufferByteSize[1]);
+    EXPECT_EQ(plan.scratchBufferByteSize, scratchBufferByteSize);
+}
+} // namespace
+
+CPU_TEST(BlasBuildPlan_Basic)
+{
+    // Everything fits in one group.
+    std::vector<BlasBuildSize> sizes = { { 10, 5 }, { 20, 5 }, { 5, 5 } };
+    BlasBuildPlan plan = planBlasBuild(sizes, 100);
+    validatePlan(ctx, sizes, plan);
+    EXPECT_EQ(plan.groups.size(), 1u);
+    EXPECT_EQ(plan.resultBufferByteSize[0], 35u);
+    EXPECT_EQ(plan.resultBufferByteSize[1], 0u);
+    EXPECT_EQ(plan.getPeakByteSize(), 50u);
+
+    // No BLASes.
+    plan = planBlasBuild({}, 100);
+    EXPECT(plan.groups.empty());
+    EXPECT_EQ(plan.getPeakByteSize(), 0u);
+}
+
+CPU_TEST(BlasBuildPlan_FirstFitDecreasing)
+{
+    // Both result buffers are budgeted, so a group holds at most 50 bytes of results here. Packing in index order needs
+    // three groups (30 + 10 | 20 + 20 | 20), sorting by size allows two (30 + 20 | 10 + 20 + 20).
+    std::vector<BlasBuildSize> sizes = { { 30, 0 }, { 10, 0 }, { 20, 0 }, { 20, 0 }, { 20, 0 } };
+    BlasBuildPlan plan = planBlasBuild(sizes, 100);
+    validatePlan(ctx, sizes, plan);
+    EXPECT_EQ(plan.groups.size(), 2u);
+    EXPECT_LE(plan.getPeakByteSize(), 100u);
+
+    // A BLAS larger than the budget gets a group of its own. It sets the size of the first result buffer and the scratch
+    // buffer, the other BLASes only add the second result buffer.
+    sizes = { { 10, 10 }, { 300, 100 }, { 10, 10 } };
+    plan = planBlasBuild(sizes, 100);
+    validatePlan(ctx, sizes, plan);
+    EXPECT_EQ(plan.groups.size(), 2u);
+    EXPECT_EQ(plan.groups[0].blasIndices.size(), 1u);
+    EXPECT_EQ(plan.groups[0].blasIndices[0], 1u);
+    EXPECT_EQ(plan.getPeakByteSize(), 420u);
+}
+
+CPU_TEST(BlasBuildPlan_SharedBuffers)
+{
+    // The last BLAS fits in the first group by itself (2 * 45 + 5), but the scratch buffer is sized 15 by the second
+    // group, which would grow the buffers to 2 * 45 + 15. It is placed in the second group instead.
+    std::vector<BlasBuildSize> sizes = { { 5, 5 }, { 5, 15 }, { 40, 0 } };
+    BlasBuildPlan plan = planBlasBuild(sizes, 100);
+    validatePlan(ctx, sizes, plan);
+    EXPECT_EQ(plan.groups.size(), 2u);
+    EXPECT_EQ(plan.placements[0].groupIndex, 1u);
+    EXPECT_EQ(plan.resultBufferByteSize[0], 40u);
+    EXPECT_EQ(plan.resultBufferByteSize[1], 10u);
+    EXPECT_EQ(plan.scratchBufferByteSize, 20u);
+    EXPECT_EQ(plan.getPeakByteSize(), 70u);
+}
+
+CPU_TEST(BlasBuildPlan_Random)
+{
+    // A few huge BLASes among many tiny ones.
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<uint64_t> smallSize(1, 1000);
+    std::uniform_int_distribution<uint64_t> largeSize(100000, 300000);
+    const uint64_t budget = 1000000;
+
+    std::vector<BlasBuildSize> sizes(5000);
+    uint64_t totalSize = 0;
+    for (size_t i = 0; i < sizes.size(); i++)
+    {
+        const bool isLarge = i % 500 == 0;
+        sizes[i].resultByteSize = isLarge ? largeSize(rng) : smallSize(rng);
+        sizes[i].scratchByteSize = sizes[i].resultByteSize / 4;
+        totalSize += 2 * sizes[i].resultByteSize + sizes[i].scratchByteSize;
+    }
+
+    BlasBuildPlan plan = planBlasBuild(sizes, budget);
+    validatePlan(ctx, sizes, plan);
+
+    // First-fit decreasing uses at most 11/9 of the optimal number of groups plus one.
+    const uint64_t lowerBound = (totalSize + budget - 1) / budget;
+    EXPECT_LE(plan.groups.size(), (11 * lowerBound) / 9 + 1);
+    EXPECT_LE(plan.getPeakByteSize(), budget);
+}
+} // namespace Falcor
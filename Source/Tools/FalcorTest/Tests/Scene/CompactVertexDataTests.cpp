@@ -0,0 +1,154 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneTypes.slang"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+static_assert(sizeof(PackedCompactVertexData) == 24, "PackedCompactVertexData size should be 24B");
+
+float3 sampleDirection(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> u;
+    float z = 1.f - 2.f * u(rng);
+    float r = std::sqrt(std::max(0.f, 1.f - z * z));
+    float phi = 2.f * (float)M_PI * u(rng);
+    return float3(r * std::cos(phi), r * std::sin(phi), z);
+}
+
+std::vector<StaticVertexData> createTestVertices(size_t count)
+{
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> u;
+
+    std::vector<StaticVertexData> vertices(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        auto& v = vertices[i];
+        v.position = (float3(u(rng), u(rng), u(rng)) * 2.f - 1.f) * float3(30.f, 0.25f, 1000.f);
+        v.normal = sampleDirection(rng);
+        v.tangent = float4(sampleDirection(rng), u(rng) < 0.5f ? -1.f : 1.f);
+        v.texCrd = float2(u(rng), u(rng)) * 8.f - 4.f;
+        v.curveRadius = 0.f;
+    }
+
+    // Curve vertex.
+    vertices[0].curveRadius = 0.37f;
+
+    return vertices;
+}
+
+/// Check that a decoded vertex is within the error bounds of the compact format.
+void checkErrorBounds(UnitTestContext& ctx, const StaticVertexData& ref, const StaticVertexData& result, size_t i)
+{
+    // Positions are stored at full precision.
+    EXPECT_EQ(result.position, ref.position) << "i = " << i;
+
+    // 16-bit octahedral encoding has an angular error of roughly 1e-4 radians or less, 8-bit of roughly 0.02.
+    EXPECT_LE(length(result.normal - ref.normal), 1e-4f) << "i = " << i;
+    EXPECT_LE(length(result.tangent.xyz() - ref.tangent.xyz()), 2e-2f) << "i = " << i;
+    EXPECT_EQ(result.tangent.w, ref.tangent.w) << "i = " << i;
+
+    // fp16 has a relative rounding error of at most 2^-11 for normal numbers.
+    const float2 texCrdError = abs(result.texCrd - ref.texCrd);
+    EXPECT_LE(texCrdError.x, std::abs(ref.texCrd.x) * std::ldexp(1.f, -11) + std::ldexp(1.f, -25)) << "i = " << i;
+    EXPECT_LE(texCrdError.y, std::abs(ref.texCrd.y) * std::ldexp(1.f, -11) + std::ldexp(1.f, -25)) << "i = " << i;
+
+    // The curve radius shares storage with the tangent sign and is only meaningful for curve vertices.
+    if (ref.curveRadius > 0.f)
+        EXPECT_LE(std::abs(result.curveRadius - ref.curveRadius), ref.curveRadius * std::ldexp(1.f, -11)) << "i = " << i;
+}
+} // namespace
+
+CPU_TEST(CompactVertexData_ErrorBounds)
+{
+    const std::vector<StaticVertexData> vertices = createTestVertices(10000);
+
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        PackedCompactVertexData packed(vertices[i]);
+        StaticVertexData result = packed.unpack();
+        checkErrorBounds(ctx, vertices[i], result, i);
+    }
+}
+
+CPU_TEST(CompactVertexData_InvalidTangent)
+{
+    // A zero tangent sign marks the tangent as invalid and must be preserved.
+    StaticVertexData v = {};
+    v.position = float3(5.f, 2.f, 3.f);
+    v.normal = float3(0.f, 1.f, 0.f);
+    v.tangent = float4(1.f, 0.f, 0.f, 0.f);
+
+    StaticVertexData result = PackedCompactVertexData(v).unpack();
+    EXPECT_EQ(result.position, v.position);
+    EXPECT_EQ(result.normal, v.normal);
+    EXPECT_EQ(result.tangent, v.tangent);
+    EXPECT_EQ(result.curveRadius, 0.f);
+}
+
+GPU_TEST(CompactVertexData_ShaderDecode)
+{
+    const std::vector<StaticVertexData> vertices = createTestVertices(4096);
+
+    std::vector<PackedCompactVertexData> packed(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++)
+        packed[i].pack(vertices[i]);
+
+    ctx.createProgram("Tests/Scene/CompactVertexDataTests.cs.slang", "testCompactVertexData");
+    ctx.allocateStructuredBuffer("vertices", (uint32_t)vertices.size(), vertices.data(), vertices.size() * sizeof(vertices[0]));
+    ctx.allocateStructuredBuffer("packed", (uint32_t)packed.size(), packed.data(), packed.size() * sizeof(packed[0]));
+    ctx.allocateStructuredBuffer("decoded", (uint32_t)vertices.size());
+    ctx.allocateStructuredBuffer("roundTrip", (uint32_t)vertices.size());
+    ctx["CB"]["count"] = (uint32_t)vertices.size();
+    ctx.runProgram((uint32_t)vertices.size());
+
+    // Vertices packed on the host and decoded in the shader must match host decoding.
+    std::vector<StaticVertexData> decoded = ctx.readBuffer<StaticVertexData>("decoded");
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        StaticVertexData ref = packed[i].unpack();
+        EXPECT_EQ(decoded[i].position, ref.position) << "i = " << i;
+        EXPECT_LE(length(decoded[i].normal - ref.normal), 1e-6f) << "i = " << i;
+        EXPECT_LE(length(decoded[i].tangent - ref.tangent), 1e-6f) << "i = " << i;
+        EXPECT_EQ(decoded[i].texCrd, ref.texCrd) << "i = " << i;
+        EXPECT_EQ(decoded[i].curveRadius, ref.curveRadius) << "i = " << i;
+    }
+
+    // Vertices packed and decoded in the shader must be within the error bounds.
+    std::vector<StaticVertexData> roundTrip = ctx.readBuffer<StaticVertexData>("roundTrip");
+    for (size_t i = 0; i < vertices.size(); i++)
+        checkErrorBounds(ctx, vertices[i], roundTrip[i], i);
+}
+} // namespace Falcor
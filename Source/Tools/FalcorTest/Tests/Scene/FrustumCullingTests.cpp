@@ -0,0 +1,167 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/FrustumCulling.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+// Camera looking down the x-axis from the origin.
+ref<FrustumCulling> createFrustum()
+{
+    return make_ref<FrustumCulling>(float3(0.f), float3(1.f, 0.f, 0.f), float3(0.f, 1.f, 0.f), 16.f / 9.f, 1.f, 0.1f, 500.f);
+}
+
+std::vector<AABB> generateBoxes(size_t count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> u(-1.f, 1.f);
+    std::vector<AABB> boxes(count);
+    for (auto& box : boxes)
+    {
+        float3 center = 600.f * float3(u(rng), u(rng), u(rng));
+        float3 halfExtent = float3(0.5f) + 2.f * abs(float3(u(rng), u(rng), u(rng)));
+        box = AABB(center - halfExtent, center + halfExtent);
+    }
+    return boxes;
+}
+
+AABB grow(const AABB& box, float amount)
+{
+    return AABB(box.minPoint - float3(amount), box.maxPoint + float3(amount));
+}
+
+// Returns the number of boxes where the batched result differs from the scalar test.
+// Boxes touching a plane within floating point precision may go either way and are not counted.
+size_t countMismatches(const FrustumCulling& frustum, const std::vector<AABB>& boxes, const std::vector<uint8_t>& visible)
+{
+    size_t mismatches = 0;
+    for (size_t i = 0; i < boxes.size(); i++)
+    {
+        if ((visible[i] != 0) == frustum.isInFrustum(boxes[i]))
+            continue;
+        if (frustum.isInFrustum(grow(boxes[i], 1e-3f)) != frustum.isInFrustum(grow(boxes[i], -1e-3f)))
+            continue;
+        mismatches++;
+    }
+    return mismatches;
+}
+} // namespace
+
+CPU_TEST(FrustumCulling_BatchMatchesScalar)
+{
+    ref<FrustumCulling> pFrustum = createFrustum();
+    std::vector<AABB> boxes = generateBoxes(20000, 1);
+    std::vector<bool> isStatic(boxes.size());
+    for (size_t i = 0; i < boxes.size(); i++)
+        isStatic[i] = i % 3 != 0;
+    boxes[5] = AABB(); // Invalid boxes are never visible.
+    boxes[6] = AABB();
+
+    FrustumCullingBounds bounds;
+    bounds.build(boxes, isStatic);
+    EXPECT_EQ(bounds.getCount(), boxes.size());
+    EXPECT_LT(bounds.getStaticCount(), boxes.size());
+
+    std::vector<uint8_t> visible;
+    pFrustum->cull(bounds, visible);
+    ASSERT_EQ(visible.size(), boxes.size());
+    EXPECT_EQ(countMismatches(*pFrustum, boxes, visible), 0u);
+    EXPECT_EQ(visible[5], 0);
+
+    size_t visibleCount = 0;
+    for (uint8_t v : visible)
+        visibleCount += v;
+    EXPECT_GT(visibleCount, 0u);
+    EXPECT_LT(visibleCount, boxes.size());
+
+    // Move static and dynamic boxes, including into and out of the frustum.
+    std::mt19937 rng(2);
+    std::vector<AABB> moved = generateBoxes(boxes.size(), 3);
+    for (uint32_t i = 0; i < 2000; i++)
+    {
+        uint32_t id = rng() % (uint32_t)boxes.size();
+        boxes[id] = moved[id];
+        bounds.setBounds(id, boxes[id]);
+    }
+    boxes[6] = AABB(float3(10.f, -1.f, -1.f), float3(12.f, 1.f, 1.f));
+    bounds.setBounds(6, boxes[6]);
+    bounds.refit();
+
+    pFrustum->cull(bounds, visible);
+    EXPECT_EQ(countMismatches(*pFrustum, boxes, visible), 0u);
+    EXPECT_EQ(visible[6], 1);
+}
+
+CPU_TEST(FrustumCulling_Benchmark)
+{
+    // 1M instances spread around the camera, compare the per-instance test against the batched test with and without BVH.
+    const size_t instanceCount = 1 << 20;
+    ref<FrustumCulling> pFrustum = createFrustum();
+    const std::vector<AABB> boxes = generateBoxes(instanceCount, 4);
+
+    std::vector<uint8_t> scalarVisible(instanceCount);
+    auto startTime = CpuTimer::getCurrentTimePoint();
+    for (size_t i = 0; i < instanceCount; i++)
+        scalarVisible[i] = pFrustum->isInFrustum(boxes[i].transform(float4x4::identity())) ? 1 : 0;
+    double scalarTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+    FrustumCullingBounds dynamicBounds;
+    dynamicBounds.build(boxes, std::vector<bool>(instanceCount, false));
+    std::vector<uint8_t> dynamicVisible;
+    startTime = CpuTimer::getCurrentTimePoint();
+    pFrustum->cull(dynamicBounds, dynamicVisible);
+    double dynamicTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+    startTime = CpuTimer::getCurrentTimePoint();
+    FrustumCullingBounds staticBounds;
+    staticBounds.build(boxes, std::vector<bool>(instanceCount, true));
+    double buildTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+    std::vector<uint8_t> staticVisible;
+    startTime = CpuTimer::getCurrentTimePoint();
+    pFrustum->cull(staticBounds, staticVisible);
+    double staticTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+    EXPECT_EQ(countMismatches(*pFrustum, boxes, dynamicVisible), 0u);
+    EXPECT(dynamicVisible == staticVisible);
+
+    logInfo(
+        "Frustum culling {} instances: per-instance {:.3f} ms, batched {:.3f} ms, BVH {:.3f} ms (build {:.3f} ms)",
+        instanceCount,
+        scalarTime,
+        dynamicTime,
+        staticTime,
+        buildTime
+    );
+}
+} // namespace Falcor
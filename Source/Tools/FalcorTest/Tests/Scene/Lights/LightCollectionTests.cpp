@@ -0,0 +1,135 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Lights/LightCollection.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include "Utils/Math/MathConstants.slangh"
+
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+using MeshLightEmission = LightCollection::MeshLightEmission;
+using MeshLightTriangle = LightCollection::MeshLightTriangle;
+
+MeshLightEmission createEmission(bool isTextured, float3 radiance)
+{
+    MeshLightEmission emission;
+    emission.isTextured = isTextured;
+    emission.radiance = radiance;
+    return emission;
+}
+
+MeshLightTriangle createTriangle(uint32_t lightIdx, float area)
+{
+    MeshLightTriangle tri;
+    tri.lightIdx = lightIdx;
+    tri.area = area;
+    return tri;
+}
+} // namespace
+
+CPU_TEST(LightCollection_ConstantEmissionFlux)
+{
+    std::vector<MeshLightEmission> emission = {
+        createEmission(false, float3(1.f, 2.f, 3.f)),
+        createEmission(true, float3(5.f)),
+        createEmission(false, float3(0.f)),
+    };
+
+    std::vector<MeshLightTriangle> triangles = {
+        createTriangle(0, 2.f),
+        createTriangle(1, 1.f),
+        createTriangle(2, 1.f),
+        createTriangle(0, 0.f),
+    };
+
+    // Textured triangles must be left unchanged, as their flux is integrated on the GPU.
+    triangles[1].flux = 7.f;
+    triangles[1].averageRadiance = float3(0.5f);
+
+    LightCollection::computeConstantEmissionFlux(emission, triangles);
+
+    const float expectedFlux = luminance(float3(1.f, 2.f, 3.f)) * 2.f * (float)M_PI;
+    EXPECT_EQ(triangles[0].flux, expectedFlux);
+    EXPECT(all(triangles[0].averageRadiance == float3(1.f, 2.f, 3.f)));
+
+    EXPECT_EQ(triangles[1].flux, 7.f);
+    EXPECT(all(triangles[1].averageRadiance == float3(0.5f)));
+
+    // Zero radiance or zero area results in zero flux, which culls the triangle.
+    EXPECT_EQ(triangles[2].flux, 0.f);
+    EXPECT_EQ(triangles[3].flux, 0.f);
+    EXPECT(all(triangles[3].averageRadiance == float3(1.f, 2.f, 3.f)));
+}
+
+CPU_TEST(LightCollection_ConstantEmissionFluxParallel)
+{
+    const uint32_t lightCount = 100;
+    const uint32_t triangleCount = 100000;
+
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> dist(0.f, 10.f);
+
+    std::vector<MeshLightEmission> emission(lightCount);
+    for (uint32_t lightIdx = 0; lightIdx < lightCount; lightIdx++)
+    {
+        emission[lightIdx] = createEmission(lightIdx % 3 == 0, float3(dist(rng), dist(rng), dist(rng)));
+    }
+
+    std::vector<MeshLightTriangle> triangles(triangleCount);
+    for (uint32_t triIdx = 0; triIdx < triangleCount; triIdx++)
+    {
+        triangles[triIdx] = createTriangle(rng() % lightCount, dist(rng));
+        triangles[triIdx].flux = -1.f;
+    }
+
+    std::vector<MeshLightTriangle> serialTriangles = triangles;
+    LightCollection::computeConstantEmissionFlux(emission, serialTriangles, false);
+    LightCollection::computeConstantEmissionFlux(emission, triangles, true);
+
+    for (uint32_t triIdx = 0; triIdx < triangleCount; triIdx++)
+    {
+        const MeshLightTriangle& tri = triangles[triIdx];
+        const MeshLightEmission& e = emission[tri.lightIdx];
+        EXPECT_EQ(tri.flux, serialTriangles[triIdx].flux) << "triIdx=" << triIdx;
+        if (e.isTextured)
+        {
+            EXPECT_EQ(tri.flux, -1.f) << "triIdx=" << triIdx;
+        }
+        else
+        {
+            EXPECT_EQ(tri.flux, luminance(e.radiance) * tri.area * (float)M_PI) << "triIdx=" << triIdx;
+            EXPECT(all(tri.averageRadiance == e.radiance)) << "triIdx=" << triIdx;
+        }
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,78 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Material/MaterialSystem.h"
+#include "Scene/Material/StandardMaterial.h"
+
+namespace Falcor
+{
+GPU_TEST(MaterialContentHash)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    auto pMaterialA = StandardMaterial::create(pDevice, "A");
+    auto pMaterialB = StandardMaterial::create(pDevice, "B");
+    pMaterialA->setBaseColor(float4(0.5f, 0.f, 0.25f, 1.f));
+    pMaterialB->setBaseColor(float4(0.5f, -0.f, 0.25f, 1.f));
+
+    // Equal materials must have equal hashes, the name is ignored.
+    EXPECT(pMaterialA->isEqual(pMaterialB));
+    EXPECT_EQ(pMaterialA->getContentHash(), pMaterialB->getContentHash());
+
+    pMaterialB->setRoughness(0.75f);
+    EXPECT(!pMaterialA->isEqual(pMaterialB));
+    EXPECT_NE(pMaterialA->getContentHash(), pMaterialB->getContentHash());
+}
+
+GPU_TEST(MaterialSystemRemoveDuplicates)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    MaterialSystem materialSystem(pDevice);
+
+    // Add materials with three distinct sets of parameters.
+    const uint32_t kMaterialCount = 30;
+    for (uint32_t i = 0; i < kMaterialCount; i++)
+    {
+        auto pMaterial = StandardMaterial::create(pDevice, "Material" + std::to_string(i));
+        pMaterial->setBaseColor(float4(float(i % 3) / 3.f, 0.f, 0.f, 1.f));
+        materialSystem.addMaterial(pMaterial);
+    }
+
+    std::vector<MaterialID> idMap;
+    size_t removed = materialSystem.removeDuplicateMaterials(idMap);
+    EXPECT_EQ(removed, kMaterialCount - 3);
+    EXPECT_EQ(materialSystem.getMaterialCount(), 3u);
+    ASSERT_EQ(idMap.size(), kMaterialCount);
+
+    // The first occurrence of each set of parameters is kept.
+    for (uint32_t i = 0; i < kMaterialCount; i++)
+    {
+        EXPECT_EQ(idMap[i], MaterialID{ i % 3 }) << "i = " << i;
+    }
+}
+} // namespace Falcor
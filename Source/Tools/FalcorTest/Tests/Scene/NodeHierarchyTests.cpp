@@ -0,0 +1,218 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Animation/NodeHierarchy.h"
+#include "Utils/Math/Matrix.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+struct WorldMatrices
+{
+    std::vector<float4x4> global;
+    std::vector<float4x4> invTransposeGlobal;
+};
+
+/**
+ * Synthetic scene graph with both deep and wide parts: a few long chains (e.g. skeletons)
+ * and many shallow subtrees (e.g. crowd agents or vegetation instances with a handful of child nodes).
+ * Nodes are shuffled so parents don't necessarily precede their children.
+ */
+std::vector<NodeID> generateHierarchy(uint32_t chainCount, uint32_t chainLength, uint32_t treeCount, uint32_t treeSize)
+{
+    std::vector<NodeID> parents;
+    for (uint32_t c = 0; c < chainCount; c++)
+    {
+        for (uint32_t i = 0; i < chainLength; i++)
+            parents.push_back(i == 0 ? NodeID::Invalid() : NodeID(uint32_t(parents.size() - 1)));
+    }
+    for (uint32_t t = 0; t < treeCount; t++)
+    {
+        uint32_t root = uint32_t(parents.size());
+        parents.push_back(NodeID::Invalid());
+        for (uint32_t i = 1; i < treeSize; i++)
+            parents.push_back(NodeID(root + (i - 1) / 2));
+    }
+
+    std::mt19937 rng(1);
+    std::vector<uint32_t> permutation(parents.size());
+    for (uint32_t i = 0; i < permutation.size(); i++)
+        permutation[i] = i;
+    std::shuffle(permutation.begin(), permutation.end(), rng);
+
+    std::vector<NodeID> shuffled(parents.size());
+    for (uint32_t i = 0; i < parents.size(); i++)
+        shuffled[permutation[i]] = parents[i] == NodeID::Invalid() ? NodeID::Invalid() : NodeID(permutation[parents[i].get()]);
+    return shuffled;
+}
+
+std::vector<float4x4> generateLocalMatrices(size_t count)
+{
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> u(-1.f, 1.f);
+    std::vector<float4x4> matrices(count);
+    for (auto& m : matrices)
+    {
+        m = math::matrixFromTranslation(float3(u(rng), u(rng), u(rng)));
+        m = mul(m, math::matrixFromRotation(u(rng) * 3.f, normalize(float3(u(rng), u(rng), u(rng)) + float3(0.f, 0.f, 2.f))));
+        m = math::scale(m, float3(1.f) + 0.05f * float3(u(rng), u(rng), u(rng)));
+    }
+    return matrices;
+}
+
+// Reference: repeatedly sweep over the nodes in index order with the general inverse until all nodes are resolved.
+WorldMatrices computeReference(const std::vector<NodeID>& parents, const std::vector<float4x4>& local)
+{
+    WorldMatrices result{std::vector<float4x4>(parents.size()), std::vector<float4x4>(parents.size())};
+    std::vector<bool> done(parents.size(), false);
+    size_t remaining = parents.size();
+    while (remaining > 0)
+    {
+        for (size_t i = 0; i < parents.size(); i++)
+        {
+            if (done[i])
+                continue;
+            NodeID parent = parents[i];
+            if (parent != NodeID::Invalid() && !done[parent.get()])
+                continue;
+            result.global[i] = parent == NodeID::Invalid() ? local[i] : mul(result.global[parent.get()], local[i]);
+            result.invTransposeGlobal[i] = transpose(inverse(result.global[i]));
+            done[i] = true;
+            remaining--;
+        }
+    }
+    return result;
+}
+
+WorldMatrices computeLevelOrdered(const NodeHierarchy& hierarchy, const std::vector<NodeID>& parents, const std::vector<float4x4>& local)
+{
+    WorldMatrices result{std::vector<float4x4>(parents.size()), std::vector<float4x4>(parents.size())};
+    hierarchy.parallelForEachNode(
+        [&](uint32_t i)
+        {
+            NodeID parent = parents[i];
+            result.global[i] = parent == NodeID::Invalid() ? local[i] : mul(result.global[parent.get()], local[i]);
+            result.invTransposeGlobal[i] = inverseTransposeAffine(result.global[i]);
+        }
+    );
+    return result;
+}
+
+float maxDifference(const std::vector<float4x4>& a, const std::vector<float4x4>& b)
+{
+    float maxDiff = 0.f;
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        for (int r = 0; r < 4; r++)
+            for (int c = 0; c < 4; c++)
+                maxDiff = std::max(maxDiff, std::abs(a[i][r][c] - b[i][r][c]));
+    }
+    return maxDiff;
+}
+} // namespace
+
+CPU_TEST(NodeHierarchy_LevelOrder)
+{
+    // 0 -> 2 -> 1, 3 -> 4, 5 (root). Parents are stored after their children on purpose.
+    std::vector<NodeID> parents = {NodeID(2), NodeID::Invalid(), NodeID(1), NodeID(4), NodeID::Invalid(), NodeID::Invalid()};
+    NodeHierarchy hierarchy(parents);
+
+    EXPECT_EQ(hierarchy.getNodeCount(), 6u);
+    EXPECT_EQ(hierarchy.getLevelCount(), 3u);
+    const std::vector<uint32_t> expected = {1, 4, 5, 2, 3, 0};
+    EXPECT(hierarchy.getOrderedNodes() == expected);
+
+    EXPECT_EQ(NodeHierarchy(std::vector<NodeID>()).getLevelCount(), 0u);
+}
+
+CPU_TEST(NodeHierarchy_InvalidHierarchy)
+{
+    auto throws = [](const std::vector<NodeID>& parents)
+    {
+        try
+        {
+            NodeHierarchy hierarchy(parents);
+        }
+        catch (const Exception&)
+        {
+            return true;
+        }
+        return false;
+    };
+
+    EXPECT(throws({NodeID(1), NodeID(2), NodeID(0)}));
+    EXPECT(throws({NodeID(0)}));
+    EXPECT(throws({NodeID::Invalid(), NodeID(5)}));
+}
+
+CPU_TEST(NodeHierarchy_WorldMatricesBenchmark)
+{
+    // 16 skeleton-like chains of 256 nodes and 16k subtrees of 7 nodes.
+    const std::vector<NodeID> parents = generateHierarchy(16, 256, 16384, 7);
+    const std::vector<float4x4> local = generateLocalMatrices(parents.size());
+
+    auto startTime = CpuTimer::getCurrentTimePoint();
+    NodeHierarchy hierarchy(parents);
+    double buildTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+    EXPECT_EQ(hierarchy.getLevelCount(), 256u);
+
+    // The reference sweep is only used for validation, time a single serial pass in level order with the general inverse instead.
+    startTime = CpuTimer::getCurrentTimePoint();
+    WorldMatrices serial{std::vector<float4x4>(parents.size()), std::vector<float4x4>(parents.size())};
+    for (uint32_t i : hierarchy.getOrderedNodes())
+    {
+        NodeID parent = parents[i];
+        serial.global[i] = parent == NodeID::Invalid() ? local[i] : mul(serial.global[parent.get()], local[i]);
+        serial.invTransposeGlobal[i] = transpose(inverse(serial.global[i]));
+    }
+    double serialTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+    startTime = CpuTimer::getCurrentTimePoint();
+    WorldMatrices parallel = computeLevelOrdered(hierarchy, parents, local);
+    double parallelTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+    logInfo(
+        "World matrix update for {} nodes on {} levels: build {:.3f} ms, serial {:.3f} ms, level-parallel affine {:.3f} ms",
+        parents.size(),
+        hierarchy.getLevelCount(),
+        buildTime,
+        serialTime,
+        parallelTime
+    );
+
+    WorldMatrices reference = computeReference(parents, local);
+    EXPECT_EQ(maxDifference(serial.global, reference.global), 0.f);
+    EXPECT_EQ(maxDifference(parallel.global, reference.global), 0.f);
+    EXPECT_LE(maxDifference(parallel.invTransposeGlobal, reference.invTransposeGlobal), 1e-3f);
+}
+} // namespace Falcor
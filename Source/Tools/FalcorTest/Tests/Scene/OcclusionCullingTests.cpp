@@ -0,0 +1,331 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/OcclusionCulling.h"
+#include "Utils/Math/MatrixMath.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kWidth = 256;
+const uint32_t kHeight = 128;
+
+// Camera at the origin looking down the negative z-axis.
+float4x4 createViewProj()
+{
+    float4x4 view = math::matrixFromLookAt(float3(0.f), float3(0.f, 0.f, -1.f), float3(0.f, 1.f, 0.f));
+    float4x4 proj = math::perspective(1.f, float(kWidth) / kHeight, 0.1f, 1000.f);
+    return mul(proj, view);
+}
+
+// Box mesh with 8 vertices and 12 triangles.
+void createBoxMesh(const AABB& box, std::vector<float3>& positions, std::vector<uint32_t>& indices)
+{
+    const uint32_t base = (uint32_t)positions.size();
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        positions.push_back(float3(
+            (i & 1) ? box.maxPoint.x : box.minPoint.x,
+            (i & 2) ? box.maxPoint.y : box.minPoint.y,
+            (i & 4) ? box.maxPoint.z : box.minPoint.z
+        ));
+    }
+    const uint32_t faces[6][4] = { { 0, 2, 6, 4 }, { 1, 5, 7, 3 }, { 0, 4, 5, 1 }, { 2, 3, 7, 6 }, { 0, 1, 3, 2 }, { 4, 6, 7, 5 } };
+    for (const auto& f : faces)
+    {
+        for (uint32_t i : { f[0], f[1], f[2], f[0], f[2], f[3] })
+            indices.push_back(base + i);
+    }
+}
+
+AABB makeBox(float3 center, float3 halfExtent)
+{
+    return AABB(center - halfExtent, center + halfExtent);
+}
+
+float3 projectToScreen(const float4x4& viewProj, const float3& p)
+{
+    float4 clip = mul(viewProj, float4(p, 1.f));
+    return float3((clip.x / clip.w * 0.5f + 0.5f) * kWidth, (0.5f - clip.y / clip.w * 0.5f) * kHeight, clip.z / clip.w);
+}
+
+float3 unprojectFromScreen(const float4x4& viewProj, const float3& screen)
+{
+    float4 p = mul(math::inverse(viewProj), float4(screen.x / kWidth * 2.f - 1.f, 1.f - screen.y / kHeight * 2.f, screen.z, 1.f));
+    return p.xyz() / p.w;
+}
+} // namespace
+
+CPU_TEST(OcclusionCulling_Wall)
+{
+    const float4x4 viewProj = createViewProj();
+    OcclusionCulling culling(kWidth, kHeight);
+    culling.clear(viewProj);
+
+    // Nothing is occluded before rasterizing any occluder.
+    culling.updateHierarchy();
+    EXPECT(culling.isVisible(makeBox(float3(0.f, 0.f, -50.f), float3(1.f))));
+
+    // Wall covering the center of the screen.
+    std::vector<float3> positions;
+    std::vector<uint32_t> indices;
+    createBoxMesh(AABB(float3(-10.f, -5.f, -11.f), float3(10.f, 5.f, -10.f)), positions, indices);
+    culling.rasterize(float4x4::identity(), positions, indices);
+    culling.updateHierarchy();
+    EXPECT_GT(culling.getRasterizedTriangleCount(), 0u);
+    EXPECT_EQ(culling.getLevelCount(), 9u);
+
+    EXPECT(!culling.isVisible(makeBox(float3(0.f, 0.f, -30.f), float3(2.f)))) << "Box behind the wall";
+    EXPECT(!culling.isVisible(makeBox(float3(1.f, -1.f, -500.f), float3(100.f)))) << "Large distant box behind the wall";
+    EXPECT(culling.isVisible(makeBox(float3(0.f, 0.f, -5.f), float3(1.f)))) << "Box in front of the wall";
+    EXPECT(culling.isVisible(makeBox(float3(0.f, 0.f, -10.5f), float3(1.f)))) << "Box intersecting the wall";
+    EXPECT(culling.isVisible(makeBox(float3(40.f, 0.f, -30.f), float3(2.f)))) << "Box next to the wall";
+    EXPECT(culling.isVisible(makeBox(float3(30.f, 0.f, -30.f), float3(2.f)))) << "Box partially behind the wall";
+    EXPECT(culling.isVisible(makeBox(float3(0.f, 0.f, 5.f), float3(1.f)))) << "Box behind the camera";
+    EXPECT(culling.isVisible(makeBox(float3(0.f, 0.f, 0.f), float3(1.f)))) << "Box around the camera";
+
+    // The wall is rasterized into the depth buffer with the wall depth.
+    const float wallDepth = projectToScreen(viewProj, float3(0.f, 0.f, -10.f)).z;
+    EXPECT_GE(culling.getDepth(kWidth / 2, kHeight / 2), wallDepth);
+    EXPECT_LT(culling.getDepth(kWidth / 2, kHeight / 2), projectToScreen(viewProj, float3(0.f, 0.f, -11.f)).z);
+    EXPECT_EQ(culling.getDepth(0, 0), std::numeric_limits<float>::infinity());
+
+    // Clearing removes all occluders.
+    culling.clear(viewProj);
+    culling.updateHierarchy();
+    EXPECT(culling.isVisible(makeBox(float3(0.f, 0.f, -30.f), float3(2.f))));
+    EXPECT_EQ(culling.getRasterizedTriangleCount(), 0u);
+}
+
+CPU_TEST(OcclusionCulling_ScreenCoverage)
+{
+    OcclusionCulling culling(kWidth, kHeight);
+    culling.clear(createViewProj());
+
+    EXPECT_EQ(culling.getScreenCoverage(makeBox(float3(0.f, 0.f, 1.f), float3(2.f))), 1.f);
+    EXPECT_EQ(culling.getScreenCoverage(makeBox(float3(0.f, 0.f, -10.f), float3(100.f, 100.f, 1.f))), 1.f);
+    EXPECT_EQ(culling.getScreenCoverage(makeBox(float3(500.f, 0.f, -10.f), float3(1.f))), 0.f);
+    EXPECT_EQ(culling.getScreenCoverage(AABB()), 0.f);
+
+    float nearCoverage = culling.getScreenCoverage(makeBox(float3(0.f, 0.f, -10.f), float3(1.f)));
+    float farCoverage = culling.getScreenCoverage(makeBox(float3(0.f, 0.f, -20.f), float3(1.f)));
+    EXPECT_GT(nearCoverage, farCoverage);
+    EXPECT_GT(farCoverage, 0.f);
+}
+
+CPU_TEST(OcclusionCulling_Conservative)
+{
+    // Rasterize random occluders, then check that every box reported as occluded is behind the
+    // depth buffer at all sample points, and that every written pixel is behind a rasterized triangle.
+    const float4x4 viewProj = createViewProj();
+    OcclusionCulling culling(kWidth, kHeight);
+    culling.clear(viewProj);
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    std::vector<float3> positions;
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i < 40; i++)
+    {
+        float3 center(80.f * u(rng) - 40.f, 40.f * u(rng) - 20.f, -5.f - 40.f * u(rng));
+        createBoxMesh(makeBox(center, float3(0.5f) + 6.f * float3(u(rng), u(rng), u(rng))), positions, indices);
+    }
+    culling.rasterize(float4x4::identity(), positions, indices);
+    culling.updateHierarchy();
+
+    std::vector<float3> screenPositions;
+    for (const auto& p : positions)
+        screenPositions.push_back(projectToScreen(viewProj, p));
+
+    // The center of every covered pixel must be inside a triangle that is at least as close as the stored depth.
+    uint32_t coveredCount = 0;
+    uint32_t invalidCount = 0;
+    for (uint32_t y = 0; y < kHeight; y++)
+    {
+        for (uint32_t x = 0; x < kWidth; x++)
+        {
+            const float depth = culling.getDepth(x, y);
+            if (depth == std::numeric_limits<float>::infinity())
+                continue;
+            coveredCount++;
+
+            bool valid = false;
+            const double px = x + 0.5, py = y + 0.5;
+            for (size_t t = 0; t < indices.size() && !valid; t += 3)
+            {
+                const float3& a = screenPositions[indices[t]];
+                const float3& b = screenPositions[indices[t + 1]];
+                const float3& c = screenPositions[indices[t + 2]];
+                const double area = double(b.x - a.x) * (c.y - a.y) - double(b.y - a.y) * (c.x - a.x);
+                if (area == 0.0)
+                    continue;
+
+                const double wa = (double(b.x - px) * (c.y - py) - double(b.y - py) * (c.x - px)) / area;
+                const double wb = (double(c.x - px) * (a.y - py) - double(c.y - py) * (a.x - px)) / area;
+                const double wc = 1.0 - wa - wb;
+                const double z = wa * a.z + wb * b.z + wc * c.z;
+                valid = wa >= -1e-4 && wb >= -1e-4 && wc >= -1e-4 && z <= depth + 1e-6;
+            }
+            if (!valid)
+                invalidCount++;
+        }
+    }
+    EXPECT_GT(coveredCount, 0u);
+    EXPECT_EQ(invalidCount, 0u);
+
+    // Boxes reported as occluded must be behind the depth buffer at every sample point on screen.
+    uint32_t occludedCount = 0;
+    for (uint32_t i = 0; i < 2000; i++)
+    {
+        float3 center(100.f * u(rng) - 50.f, 50.f * u(rng) - 25.f, -5.f - 80.f * u(rng));
+        AABB box = makeBox(center, float3(0.1f) + 2.f * float3(u(rng), u(rng), u(rng)));
+        if (culling.isVisible(box))
+            continue;
+        occludedCount++;
+
+        bool behind = true;
+        for (uint32_t s = 0; s < 64 && behind; s++)
+        {
+            float3 p = box.minPoint + box.extent() * float3(u(rng), u(rng), u(rng));
+            float3 screen = projectToScreen(viewProj, p);
+            if (screen.x < 0.f || screen.y < 0.f || screen.x >= kWidth || screen.y >= kHeight)
+                continue;
+            behind = culling.getDepth((uint32_t)screen.x, (uint32_t)screen.y) < screen.z;
+        }
+        EXPECT(behind) << "Box " << i << " is reported as occluded but is not behind the depth buffer.";
+    }
+    EXPECT_GT(occludedCount, 0u);
+}
+
+CPU_TEST(OcclusionCulling_Silhouette)
+{
+    // Quad whose edges cross pixels (x 40..100, y 30..89) without touching their centers. Only the pixels that are
+    // entirely covered by the quad are occluders, without holes along the diagonal between the two triangles.
+    const float4x4 viewProj = createViewProj();
+    OcclusionCulling culling(kWidth, kHeight);
+
+    const float quadDepth = projectToScreen(viewProj, float3(0.f, 0.f, -10.f)).z;
+    const std::vector<float3> quad = {
+        unprojectFromScreen(viewProj, float3(40.3f, 30.3f, quadDepth)),
+        unprojectFromScreen(viewProj, float3(100.7f, 30.3f, quadDepth)),
+        unprojectFromScreen(viewProj, float3(100.7f, 89.7f, quadDepth)),
+        unprojectFromScreen(viewProj, float3(40.3f, 89.7f, quadDepth)),
+    };
+
+    // Both with shared vertices and with the vertices split per triangle.
+    const std::vector<std::vector<uint32_t>> indices = { { 0, 1, 2, 0, 2, 3 }, { 0, 1, 2, 3, 4, 5 } };
+    const std::vector<std::vector<float3>> positions = { quad, { quad[0], quad[1], quad[2], quad[0], quad[2], quad[3] } };
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        culling.clear(viewProj);
+        culling.rasterize(float4x4::identity(), positions[i], indices[i]);
+        culling.updateHierarchy();
+
+        uint32_t invalidCount = 0;
+        for (uint32_t y = 0; y < kHeight; y++)
+        {
+            for (uint32_t x = 0; x < kWidth; x++)
+            {
+                const bool covered = x >= 41 && x <= 99 && y >= 31 && y <= 88;
+                if ((culling.getDepth(x, y) != std::numeric_limits<float>::infinity()) != covered)
+                    invalidCount++;
+            }
+        }
+        EXPECT_EQ(invalidCount, 0u) << "Quad " << i;
+
+        // Thin boxes behind the quad that only overlap the partially covered pixels along its edges.
+        const float boxDepth = projectToScreen(viewProj, float3(0.f, 0.f, -30.f)).z;
+        auto makeScreenBox = [&](float x0, float y0, float x1, float y1)
+        {
+            AABB box(unprojectFromScreen(viewProj, float3(x0, y0, boxDepth)));
+            box.include(unprojectFromScreen(viewProj, float3(x1, y1, boxDepth)));
+            box.minPoint.z = -30.01f;
+            box.maxPoint.z = -30.f;
+            return box;
+        };
+        EXPECT(culling.isVisible(makeScreenBox(100.75f, 50.f, 100.95f, 60.f))) << "Box along the right edge of quad " << i;
+        EXPECT(culling.isVisible(makeScreenBox(40.05f, 50.f, 40.25f, 60.f))) << "Box along the left edge of quad " << i;
+        EXPECT(culling.isVisible(makeScreenBox(60.f, 89.75f, 70.f, 89.95f))) << "Box along the bottom edge of quad " << i;
+        EXPECT(!culling.isVisible(makeScreenBox(50.f, 40.f, 90.f, 80.f))) << "Box behind quad " << i;
+    }
+}
+
+CPU_TEST(OcclusionCulling_Benchmark)
+{
+    // City block: a grid of buildings as occluders and many small objects scattered between and behind them.
+    const float4x4 viewProj = createViewProj();
+    OcclusionCulling culling(kWidth, kHeight);
+
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    std::vector<float3> positions;
+    std::vector<uint32_t> indices;
+    for (int z = 0; z < 20; z++)
+    {
+        for (int x = -10; x < 10; x++)
+        {
+            float height = 10.f + 30.f * u(rng);
+            float3 center(x * 20.f + 10.f, height * 0.5f - 5.f, -15.f - z * 20.f);
+            createBoxMesh(makeBox(center, float3(7.f, height * 0.5f, 7.f)), positions, indices);
+        }
+    }
+
+    std::vector<AABB> boxes(100000);
+    for (auto& box : boxes)
+    {
+        float3 center(400.f * u(rng) - 200.f, 10.f * u(rng) - 5.f, -10.f - 400.f * u(rng));
+        box = makeBox(center, float3(0.2f) + float3(u(rng), u(rng), u(rng)));
+    }
+
+    auto startTime = CpuTimer::getCurrentTimePoint();
+    culling.clear(viewProj);
+    culling.rasterize(float4x4::identity(), positions, indices);
+    culling.updateHierarchy();
+    double rasterTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+    startTime = CpuTimer::getCurrentTimePoint();
+    size_t visibleCount = 0;
+    for (const auto& box : boxes)
+        visibleCount += culling.isVisible(box) ? 1 : 0;
+    double testTime = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+    logInfo(
+        "Occlusion culling: {} occluder triangles rasterized in {:.3f} ms, {} of {} boxes visible, tested in {:.3f} ms",
+        culling.getRasterizedTriangleCount(), rasterTime, visibleCount, boxes.size(), testTime
+    );
+
+    EXPECT_GT(visibleCount, 0u);
+    EXPECT_LT(visibleCount, boxes.size());
+}
+} // namespace Falcor
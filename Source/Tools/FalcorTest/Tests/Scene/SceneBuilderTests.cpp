@@ -0,0 +1,124 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Platform/OS.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Utils/Settings.h"
+
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+GPU_TEST(SceneBuilder_RemapDuplicateMaterials)
+{
+    // Pairs of identical materials are merged by removeDuplicateMaterials(). remapMaterialIDs() runs in the post-processing
+    // task graph after it and must see the complete ID map, so every mesh ends up with a material of its original color.
+    const uint32_t materialCount = 128;
+    const uint32_t meshCount = 1024;
+
+    SceneBuilder builder(ctx.getDevice(), Settings());
+    std::vector<ref<Material>> materials;
+    for (uint32_t i = 0; i < materialCount; i++)
+    {
+        ref<StandardMaterial> pMaterial = StandardMaterial::create(ctx.getDevice(), "Material" + std::to_string(i));
+        pMaterial->setBaseColor(float4((i / 2) / float(materialCount), 0.5f, 0.25f, 1.f));
+        materials.push_back(pMaterial);
+    }
+
+    // Each mesh is a unit cube at x = 2 * i, so it can be identified by its bounds after pre-transformation.
+    for (uint32_t i = 0; i < meshCount; i++)
+    {
+        MeshID meshID = builder.addTriangleMesh(TriangleMesh::createCube(), materials[i % materialCount]);
+        NodeID nodeID = builder.addNode(SceneBuilder::Node{ "Cube", math::matrixFromTranslation(float3(2.f * i, 0.f, 0.f)), float4x4::identity() });
+        builder.addMeshInstance(nodeID, meshID);
+    }
+
+    ref<Scene> pScene = builder.getScene();
+    ASSERT(pScene);
+    EXPECT_EQ(pScene->getMaterialCount(), materialCount / 2);
+    ASSERT_EQ(pScene->getGeometryInstanceCount(), meshCount);
+
+    for (uint32_t instanceID = 0; instanceID < pScene->getGeometryInstanceCount(); instanceID++)
+    {
+        const GeometryInstanceData& instance = pScene->getGeometryInstance(instanceID);
+        const uint32_t meshIndex = (uint32_t)std::lround(pScene->getMeshBounds(instance.geometryID).center().x / 2.f);
+        ASSERT_LT(meshIndex, meshCount);
+        ASSERT_LT(instance.materialID, pScene->getMaterialCount());
+
+        auto pMaterial = static_ref_cast<StandardMaterial>(pScene->getMaterial(MaterialID{ instance.materialID }));
+        EXPECT_EQ(pMaterial->getBaseColor().x, ((meshIndex % materialCount) / 2) / float(materialCount)) << "mesh " << meshIndex;
+    }
+}
+
+GPU_TEST(SceneBuilder_CacheInvalidatedBySidecarFile)
+{
+    // An OBJ scene with its material in a separate .mtl file. The .mtl file is read by Assimp, not by the scene builder.
+    const std::filesystem::path directory = getTempFilePath();
+    std::filesystem::create_directories(directory);
+    const std::filesystem::path scenePath = directory / "scene.obj";
+    const std::filesystem::path mtlPath = directory / "scene.mtl";
+
+    auto writeFile = [](const std::filesystem::path& path, const std::string& content)
+    {
+        std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+        ofs << content;
+    };
+    writeFile(scenePath, "mtllib scene.mtl\nv 0 0 0\nv 1 0 0\nv 0 1 0\nusemtl Sidecar\nf 1 2 3\n");
+    writeFile(mtlPath, "newmtl Sidecar\nKd 1 0 0\n");
+
+    auto getBaseColor = [&](SceneBuilder::Flags flags)
+    {
+        SceneBuilder builder(ctx.getDevice(), scenePath, Settings(), flags);
+        ref<Scene> pScene = builder.getScene();
+        auto pMaterial = pScene ? dynamic_ref_cast<StandardMaterial>(pScene->getMaterialByName("Sidecar")) : nullptr;
+        return pMaterial ? pMaterial->getBaseColor() : float4(-1.f);
+    };
+
+    // Write the cache, then check that it is used while the files are unchanged.
+    EXPECT_EQ(getBaseColor(SceneBuilder::Flags::RebuildCache).x, 1.f);
+    EXPECT_EQ(getBaseColor(SceneBuilder::Flags::UseCache).x, 1.f);
+
+    // Edit only the .mtl file. Also move its modification time forward in case the file clock is coarse.
+    const auto modifiedTime = std::filesystem::last_write_time(mtlPath);
+    writeFile(mtlPath, "newmtl Sidecar\nKd 0 0.5 0\n");
+    std::filesystem::last_write_time(mtlPath, modifiedTime + std::chrono::seconds(2));
+
+    // The cache must be invalidated, so the scene is imported again with the new material.
+    float4 baseColor = getBaseColor(SceneBuilder::Flags::UseCache);
+    EXPECT_EQ(baseColor.x, 0.f);
+    EXPECT_EQ(baseColor.y, 0.5f);
+
+    std::filesystem::remove_all(directory);
+}
+} // namespace Falcor
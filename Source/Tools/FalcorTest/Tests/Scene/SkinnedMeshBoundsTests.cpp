@@ -0,0 +1,147 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Animation/SkinnedMeshBounds.h"
+#include "Utils/Math/MatrixMath.h"
+
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+float4x4 randomTransform(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> u(-1.f, 1.f);
+    float4x4 m = math::matrixFromTranslation(float3(u(rng), u(rng), u(rng)) * 10.f);
+    m = mul(m, math::matrixFromRotation(3.f * u(rng), normalize(float3(u(rng), u(rng), u(rng)) + float3(0.f, 0.f, 2.f))));
+    return mul(m, math::matrixFromScaling(float3(1.5f) + float3(u(rng), u(rng), u(rng))));
+}
+} // namespace
+
+CPU_TEST(SkinnedMeshBounds_ContainsSkinnedVertices)
+{
+    const uint32_t kVertexCount = 1000;
+    const uint32_t kBoneCount = 12;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+
+    // Random mesh with up to 4 bones per vertex and normalized weights. Unused slots have zero weight.
+    std::vector<PackedStaticVertexData> staticData(kVertexCount + 5);
+    std::vector<SkinningVertexData> skinningData(kVertexCount);
+    for (uint32_t i = 0; i < kVertexCount; i++)
+    {
+        StaticVertexData v = {};
+        v.position = float3(u(rng), u(rng), u(rng)) * 4.f - 2.f;
+        staticData[i + 5] = PackedStaticVertexData(v);
+
+        SkinningVertexData& s = skinningData[i];
+        s.staticIndex = i + 5;
+        s.bindMatrixID = 0;
+        s.skeletonMatrixID = 0;
+        const uint32_t usedBones = 1 + i % 4;
+        float weightSum = 0.f;
+        for (uint32_t j = 0; j < 4; j++)
+        {
+            s.boneID[j] = (uint32_t)(u(rng) * kBoneCount) % kBoneCount;
+            s.boneWeight[j] = j < usedBones ? 0.1f + u(rng) : 0.f;
+            weightSum += s.boneWeight[j];
+        }
+        s.boneWeight /= weightSum;
+    }
+
+    SkinnedMeshBounds skinnedBounds;
+    EXPECT_EQ(skinnedBounds.addMesh(skinningData.data(), kVertexCount, staticData), 0u);
+    EXPECT_EQ(skinnedBounds.getMeshCount(), 1u);
+    EXPECT_EQ(skinnedBounds.getBoneCount(0), kBoneCount);
+
+    for (uint32_t pose = 0; pose < 10; pose++)
+    {
+        std::vector<float4x4> boneMatrices(kBoneCount);
+        for (auto& m : boneMatrices)
+            m = randomTransform(rng);
+        const float4x4 transform = randomTransform(rng);
+        const float4x4 bindMatrix = randomTransform(rng);
+
+        const AABB bounds = skinnedBounds.getBounds(0, transform, boneMatrices, bindMatrix);
+        ASSERT(bounds.valid());
+
+        // Skin the vertices the same way as the skinning pass and check that they are inside the bounds.
+        const float eps = 1e-3f * length(bounds.extent());
+        AABB skinned;
+        for (const auto& s : skinningData)
+        {
+            float4x4 blended = float4x4::zeros();
+            for (uint32_t j = 0; j < 4; j++)
+            {
+                for (uint32_t r = 0; r < 4; r++)
+                    blended[r] += boneMatrices[s.boneID[j]][r] * s.boneWeight[j];
+            }
+            const float3 p = transformPoint(mul(transform, mul(blended, bindMatrix)), staticData[s.staticIndex].position);
+            skinned.include(p);
+            EXPECT(all(p >= bounds.minPoint - eps) && all(p <= bounds.maxPoint + eps)) << "Skinned vertex outside of the bounds in pose " << pose;
+        }
+
+        // The bounds should not be excessively loose.
+        EXPECT_LT(bounds.volume(), 100.f * skinned.volume());
+    }
+}
+
+CPU_TEST(SkinnedMeshBounds_IgnoresZeroWeights)
+{
+    std::vector<PackedStaticVertexData> staticData(2);
+    StaticVertexData v = {};
+    v.position = float3(1.f, 2.f, 3.f);
+    staticData[0] = PackedStaticVertexData(v);
+    v.position = float3(-1.f, 0.f, 1.f);
+    staticData[1] = PackedStaticVertexData(v);
+
+    std::vector<SkinningVertexData> skinningData(2);
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        skinningData[i].staticIndex = i;
+        skinningData[i].boneID = uint4(i, 5, 6, 7);
+        skinningData[i].boneWeight = float4(1.f, 0.f, 0.f, 0.f);
+        skinningData[i].bindMatrixID = 3;
+        skinningData[i].skeletonMatrixID = 4;
+    }
+
+    SkinnedMeshBounds skinnedBounds;
+    uint32_t meshIndex = skinnedBounds.addMesh(skinningData.data(), 2, staticData);
+    EXPECT_EQ(skinnedBounds.getBoneCount(meshIndex), 2u);
+    EXPECT_EQ(skinnedBounds.getBindMatrixID(meshIndex), 3u);
+    EXPECT_EQ(skinnedBounds.getSkeletonMatrixID(meshIndex), 4u);
+
+    // Only bones 0 and 1 are accessed, so two bone matrices suffice. Moving bone 1 moves the second vertex only.
+    std::vector<float4x4> boneMatrices = { float4x4::identity(), math::matrixFromTranslation(float3(0.f, 10.f, 0.f)) };
+    AABB bounds = skinnedBounds.getBounds(meshIndex, float4x4::identity(), boneMatrices, float4x4::identity());
+    EXPECT(all(bounds.minPoint == float3(-1.f, 2.f, 1.f)));
+    EXPECT(all(bounds.maxPoint == float3(1.f, 10.f, 3.f)));
+}
+} // namespace Falcor
@@ -0,0 +1,147 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/TlasInstanceDescs.h"
+#include "Utils/Math/MatrixMath.h"
+
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+std::vector<RtInstanceDesc> createDescs(uint32_t count)
+{
+    std::vector<RtInstanceDesc> descs(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        descs[i] = {};
+        descs[i].setTransform(math::matrixFromTranslation(float3((float)i, 0.f, 0.f)));
+        descs[i].instanceID = i;
+        descs[i].instanceMask = 0xFF;
+        descs[i].accelerationStructure = 0x1000 + 0x100 * i;
+    }
+    return descs;
+}
+} // namespace
+
+CPU_TEST(TlasInstanceDescs_Update)
+{
+    TlasInstanceDescs descs;
+    auto src = createDescs(100);
+
+    // All descs are dirty initially.
+    descs.update(src);
+    EXPECT_EQ(descs.getCount(), 100u);
+    auto ranges = descs.collectDirtyRanges();
+    EXPECT_EQ(ranges.size(), 1u);
+    EXPECT_EQ(ranges[0].begin, 0u);
+    EXPECT_EQ(ranges[0].end, 100u);
+    EXPECT_EQ(descs.getUpdatedCount(), 100u);
+
+    // Updating with identical descs changes nothing.
+    descs.update(src);
+    EXPECT(!descs.isDirty());
+    EXPECT(descs.collectDirtyRanges().empty());
+    EXPECT_EQ(descs.getUpdatedCount(), 0u);
+
+    // Only the changed descs are dirty.
+    src[10].instanceMask = 1;
+    src[90].accelerationStructure = 0;
+    descs.update(src);
+    ranges = descs.collectDirtyRanges(0);
+    EXPECT_EQ(ranges.size(), 2u);
+    EXPECT_EQ(ranges[0].begin, 10u);
+    EXPECT_EQ(ranges[0].end, 11u);
+    EXPECT_EQ(ranges[1].begin, 90u);
+    EXPECT_EQ(ranges[1].end, 91u);
+    EXPECT_EQ(descs.getUpdatedCount(), 2u);
+    EXPECT(descs.getDescs()[10].instanceMask == 1);
+
+    // A different desc count marks everything dirty.
+    src.pop_back();
+    descs.update(src);
+    ranges = descs.collectDirtyRanges();
+    EXPECT_EQ(ranges.size(), 1u);
+    EXPECT_EQ(ranges[0].end, 99u);
+}
+
+CPU_TEST(TlasInstanceDescs_SetTransform)
+{
+    TlasInstanceDescs descs;
+    descs.update(createDescs(8));
+    descs.collectDirtyRanges();
+
+    // Setting the current transform doesn't mark the desc dirty.
+    EXPECT(!descs.setTransform(3, math::matrixFromTranslation(float3(3.f, 0.f, 0.f))));
+    EXPECT(!descs.isDirty());
+
+    // Setting a transform twice marks the desc dirty once.
+    const float4x4 transform = math::matrixFromTranslation(float3(1.f, 2.f, 3.f));
+    EXPECT(descs.setTransform(5, transform));
+    EXPECT(!descs.setTransform(5, transform));
+    auto ranges = descs.collectDirtyRanges();
+    EXPECT_EQ(ranges.size(), 1u);
+    EXPECT_EQ(ranges[0].begin, 5u);
+    EXPECT_EQ(ranges[0].end, 6u);
+    EXPECT_EQ(descs.getUpdatedCount(), 1u);
+    EXPECT(descs.getDescs()[5].transform[1][3] == 2.f);
+    EXPECT(descs.getDescs()[5].instanceID == 5);
+}
+
+CPU_TEST(TlasInstanceDescs_MergeRanges)
+{
+    TlasInstanceDescs descs;
+    descs.update(createDescs(1000));
+    descs.collectDirtyRanges();
+
+    // Descs are set out of order, ranges are returned in ascending order.
+    for (uint32_t i : { 500u, 20u, 23u, 21u, 100u, 999u })
+        descs.setTransform(i, float4x4::identity());
+
+    auto ranges = descs.collectDirtyRanges(4);
+    EXPECT_EQ(ranges.size(), 4u);
+    EXPECT_EQ(ranges[0].begin, 20u);
+    EXPECT_EQ(ranges[0].end, 24u);
+    EXPECT_EQ(ranges[1].begin, 100u);
+    EXPECT_EQ(ranges[2].begin, 500u);
+    EXPECT_EQ(ranges[3].begin, 999u);
+    EXPECT_EQ(ranges[3].end, 1000u);
+    EXPECT_EQ(descs.getUpdatedCount(), 6u);
+    EXPECT_EQ(descs.getUploadedCount(), 7u);
+
+    // With a larger gap, nearby ranges are merged.
+    for (uint32_t i : { 20u, 100u, 110u })
+        descs.setTransform(i, math::matrixFromTranslation(float3(1.f)));
+    ranges = descs.collectDirtyRanges(16);
+    EXPECT_EQ(ranges.size(), 2u);
+    EXPECT_EQ(ranges[1].begin, 100u);
+    EXPECT_EQ(ranges[1].end, 111u);
+    EXPECT_EQ(descs.getUploadedCount(), 12u);
+}
+} // namespace Falcor
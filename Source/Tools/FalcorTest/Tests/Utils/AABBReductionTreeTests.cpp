@@ -0,0 +1,138 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Algorithm/AABBReductionTree.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+AABB randomBox(std::mt19937& rng, float range)
+{
+    std::uniform_real_distribution<float> u(-range, range);
+    float3 center(u(rng), u(rng), u(rng));
+    return AABB(center - float3(1.f), center + float3(1.f));
+}
+
+AABB getUnion(const std::vector<AABB>& boxes)
+{
+    AABB bounds;
+    for (const auto& box : boxes)
+        bounds |= box;
+    return bounds;
+}
+} // namespace
+
+CPU_TEST(AABBReductionTree_Empty)
+{
+    AABBReductionTree tree;
+    EXPECT_EQ(tree.getLeafCount(), 0u);
+    EXPECT(!tree.getBounds().valid());
+
+    AABBReductionTree emptyLeaves(std::vector<AABB>(3));
+    EXPECT(!emptyLeaves.getBounds().valid());
+    emptyLeaves.setLeaf(1, AABB(float3(0.f), float3(1.f)));
+    EXPECT(emptyLeaves.getBounds() == AABB(float3(0.f), float3(1.f)));
+}
+
+CPU_TEST(AABBReductionTree_Updates)
+{
+    std::mt19937 rng(1);
+    for (size_t leafCount : { 1, 2, 7, 64, 1000 })
+    {
+        std::vector<AABB> boxes(leafCount);
+        for (auto& box : boxes)
+            box = randomBox(rng, 100.f);
+
+        AABBReductionTree tree(boxes);
+        EXPECT_EQ(tree.getLeafCount(), leafCount);
+        EXPECT(tree.getBounds() == getUnion(boxes));
+
+        // Move boxes around, including the ones on the boundary, and invalidate some.
+        for (uint32_t i = 0; i < 500; i++)
+        {
+            size_t index = rng() % leafCount;
+            boxes[index] = i % 10 == 0 ? AABB() : randomBox(rng, i % 2 ? 50.f : 150.f);
+            tree.setLeaf(index, boxes[index]);
+            EXPECT(tree.getLeaf(index) == boxes[index]);
+            EXPECT(tree.getBounds() == getUnion(boxes)) << "leafCount=" << leafCount << " i=" << i;
+        }
+    }
+}
+
+CPU_TEST(AABBReductionTree_Benchmark)
+{
+    // Large static scene with a few moving instances.
+    const size_t leafCount = 1 << 20;
+    const size_t movingCount = 64;
+    const uint32_t frameCount = 100;
+
+    std::mt19937 rng(2);
+    std::vector<AABB> boxes(leafCount);
+    for (auto& box : boxes)
+        box = randomBox(rng, 1000.f);
+    AABBReductionTree tree(boxes);
+
+    double fullTime = 0.0, incrementalTime = 0.0;
+    bool equal = true;
+    for (uint32_t frame = 0; frame < frameCount; frame++)
+    {
+        std::vector<size_t> moved(movingCount);
+        for (size_t i = 0; i < movingCount; i++)
+        {
+            moved[i] = (i * leafCount) / movingCount;
+            boxes[moved[i]] = randomBox(rng, 1200.f);
+        }
+
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        AABB full = getUnion(boxes);
+        fullTime += CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+        startTime = CpuTimer::getCurrentTimePoint();
+        for (size_t index : moved)
+            tree.setLeaf(index, boxes[index]);
+        AABB incremental = tree.getBounds();
+        incrementalTime += CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+        equal = equal && full == incremental;
+    }
+    EXPECT(equal);
+
+    logInfo(
+        "Scene bounds of {} instances with {} moving: full union {:.3f} ms/frame, reduction tree {:.3f} ms/frame",
+        leafCount,
+        movingCount,
+        fullTime / frameCount,
+        incrementalTime / frameCount
+    );
+}
+} // namespace Falcor
@@ -0,0 +1,253 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Algorithm/BinnedSAH.h"
+#include "Utils/Settings.h"
+#include "Utils/Timing/CpuTimer.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/StandardMaterial.h"
+
+#include <pybind11/pybind11.h>
+
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+AABB makeBox(float3 center, float3 halfExtent)
+{
+    return AABB(center - halfExtent, center + halfExtent);
+}
+
+// Builds an elongated city: a long strip of buildings with a few long road/rail meshes running along it.
+// Each building and road is a separate static mesh, so all of them end up in one mesh group that SceneBuilder
+// splits into BLASes using the given split policy.
+ref<Scene> buildCity(ref<Device> pDevice, const std::string& splitPolicy, uint64_t maxTrianglesPerBLAS, uint64_t& triangleCount)
+{
+    pybind11::dict options;
+    options["sceneBuilder"] = pybind11::dict();
+    options["sceneBuilder"]["blasSplitPolicy"] = splitPolicy;
+    options["sceneBuilder"]["maxTrianglesPerBLAS"] = maxTrianglesPerBLAS;
+    Settings settings;
+    settings.addOptions(options);
+
+    SceneBuilder builder(pDevice, settings);
+    ref<Material> pMaterial = StandardMaterial::create(pDevice, "City");
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    triangleCount = 0;
+
+    // The meshes are unit spheres scaled to the box, with the tessellation setting the triangle count.
+    auto addBox = [&](float3 center, float3 halfExtent, uint32_t segments)
+    {
+        ref<TriangleMesh> pMesh = TriangleMesh::createSphere(0.5f, 2 * segments, segments);
+        triangleCount += pMesh->getIndices().size() / 3;
+        MeshID meshID = builder.addTriangleMesh(pMesh, pMaterial);
+        float4x4 transform = mul(math::matrixFromTranslation(center), math::matrixFromScaling(2.f * halfExtent));
+        NodeID nodeID = builder.addNode(SceneBuilder::Node{ "Box", transform, float4x4::identity() });
+        builder.addMeshInstance(nodeID, meshID);
+    };
+
+    for (uint32_t x = 0; x < 200; x++)
+    {
+        for (uint32_t z = 0; z < 4; z++)
+        {
+            const float height = 5.f + 40.f * u(rng) * u(rng);
+            const float3 center(x * 10.f + 2.f * u(rng), height * 0.5f, z * 10.f + 2.f * u(rng));
+            addBox(center, float3(3.f + u(rng), height * 0.5f, 3.f + u(rng)), 4 + uint32_t(20 * u(rng)));
+        }
+    }
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        const float start = 2000.f * u(rng);
+        const float length = 100.f + 300.f * u(rng);
+        const float3 center(start + 0.5f * length, 0.5f, 40.f * u(rng));
+        addBox(center, float3(0.5f * length, 0.5f, 4.f), 16);
+    }
+
+    return builder.getScene();
+}
+
+AABB getGroupBounds(const Scene& scene, const Scene::MeshGroup& group)
+{
+    AABB bb;
+    for (MeshID meshID : group.meshList)
+        bb.include(scene.getMeshBounds(meshID.get()));
+    return bb;
+}
+
+uint64_t getGroupTriangleCount(const Scene& scene, const Scene::MeshGroup& group)
+{
+    uint64_t count = 0;
+    for (MeshID meshID : group.meshList)
+        count += scene.getMesh(meshID).getTriangleCount();
+    return count;
+}
+
+// Returns the sum of the pairwise overlap volumes of the static mesh group bounding boxes.
+// The static meshes are pre-transformed, so their bounds are in world space.
+double getOverlapVolume(const Scene& scene)
+{
+    std::vector<AABB> bounds;
+    for (const auto& group : scene.getMeshGroups())
+    {
+        if (group.isStatic)
+            bounds.push_back(getGroupBounds(scene, group));
+    }
+
+    double volume = 0.0;
+    for (size_t i = 0; i < bounds.size(); i++)
+    {
+        for (size_t j = i + 1; j < bounds.size(); j++)
+        {
+            AABB overlap = bounds[i] & bounds[j];
+            if (overlap.valid())
+                volume += overlap.volume();
+        }
+    }
+    return volume;
+}
+} // namespace
+
+CPU_TEST(BinnedSAH_SeparatedClusters)
+{
+    // Two clusters along x, the best split is between them.
+    BinnedSAH binning(AABB(float3(0.f), float3(100.f, 10.f, 10.f)), 16);
+    for (int i = 0; i < 10; i++)
+    {
+        binning.add(makeBox(float3(5.f + i, 5.f, 5.f), float3(0.5f)));
+        binning.add(makeBox(float3(85.f + i, 5.f, 5.f), float3(0.5f)));
+    }
+
+    auto split = binning.findBestSplit();
+    ASSERT(split.isValid());
+    EXPECT_EQ(split.axis, 0);
+    EXPECT_GE(split.position, 15.f);
+    EXPECT_LE(split.position, 85.f);
+    EXPECT_EQ(split.leftWeight, 10u);
+    EXPECT_EQ(split.rightWeight, 10u);
+    EXPECT_LT(split.cost, binning.getLeafCost());
+    EXPECT_EQ(binning.getWeight(), 20u);
+}
+
+CPU_TEST(BinnedSAH_Weights)
+{
+    // A heavy primitive on the left should pull the split towards it.
+    BinnedSAH binning(AABB(float3(0.f), float3(8.f, 1.f, 1.f)), 8);
+    for (int i = 0; i < 8; i++)
+        binning.add(makeBox(float3(i + 0.5f, 0.5f, 0.5f), float3(0.5f)), i == 0 ? 100 : 1);
+
+    auto split = binning.findBestSplit();
+    ASSERT(split.isValid());
+    EXPECT_EQ(split.axis, 0);
+    EXPECT_EQ(split.position, 1.f);
+    EXPECT_EQ(split.leftWeight, 100u);
+    EXPECT_EQ(split.rightWeight, 7u);
+}
+
+CPU_TEST(BinnedSAH_NoSplit)
+{
+    // All centroids in the same bin on all axes gives no valid split.
+    BinnedSAH binning(AABB(float3(0.f), float3(1.f)), 4);
+    binning.add(makeBox(float3(0.1f), float3(0.05f)));
+    binning.add(makeBox(float3(0.15f), float3(0.1f)));
+    EXPECT(!binning.findBestSplit().isValid());
+
+    // Empty binning.
+    BinnedSAH empty(AABB(float3(0.f), float3(1.f)), 4);
+    EXPECT(!empty.findBestSplit().isValid());
+    EXPECT_EQ(empty.getLeafCost(), 0.f);
+}
+
+CPU_TEST(BinnedSAH_Merge)
+{
+    const AABB range(float3(0.f), float3(10.f));
+    BinnedSAH all(range), a(range), b(range);
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> u(0.f, 10.f);
+    for (int i = 0; i < 100; i++)
+    {
+        AABB box = makeBox(float3(u(rng), u(rng), u(rng)), float3(0.25f));
+        all.add(box, i);
+        (i % 2 ? a : b).add(box, i);
+    }
+    a.merge(b);
+
+    auto expected = all.findBestSplit();
+    auto result = a.findBestSplit();
+    EXPECT_EQ(result.axis, expected.axis);
+    EXPECT_EQ(result.position, expected.position);
+    EXPECT_EQ(result.cost, expected.cost);
+    EXPECT_EQ(result.leftWeight, expected.leftWeight);
+}
+
+GPU_TEST(BinnedSAH_BLASPartitionBenchmark)
+{
+    // Compare the SceneBuilder mesh group split policies on an elongated city by the overlap between the resulting BLASes.
+    uint64_t triangleCount = 0;
+    buildCity(ctx.getDevice(), "simple", std::numeric_limits<uint32_t>::max(), triangleCount);
+    const uint64_t maxTriangles = triangleCount / 16;
+
+    const char* policies[] = { "median", "midpoint", "sah" };
+
+    double overlap[3] = {};
+    for (size_t p = 0; p < std::size(policies); p++)
+    {
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        ref<Scene> pScene = buildCity(ctx.getDevice(), policies[p], maxTriangles, triangleCount);
+        double time = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+        ASSERT(pScene);
+
+        overlap[p] = getOverlapVolume(*pScene);
+
+        size_t staticGroupCount = 0;
+        uint64_t groupTriangleCount = 0;
+        for (const auto& group : pScene->getMeshGroups())
+        {
+            if (!group.isStatic)
+                continue;
+            staticGroupCount++;
+            const uint64_t count = getGroupTriangleCount(*pScene, group);
+            EXPECT(group.meshList.size() == 1 || count <= maxTriangles);
+            groupTriangleCount += count;
+        }
+        // Splitting meshes at the split planes may add triangles, but never removes any.
+        EXPECT_GE(groupTriangleCount, triangleCount);
+        EXPECT_GT(staticGroupCount, 1u);
+
+        logInfo("BLAS partitioning '{}': {} groups, overlap volume {:.1f}, scene build {:.3f} ms", policies[p], staticGroupCount, overlap[p], time);
+    }
+
+    EXPECT_LE(overlap[2], overlap[1]);
+}
+} // namespace Falcor
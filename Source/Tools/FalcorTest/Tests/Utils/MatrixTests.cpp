@@ -275,6 +275,21 @@ CPU_TEST(Matrix_inverse)
     }
 }
 
+CPU_TEST(Matrix_inverseTransposeAffine)
+{
+    EXPECT(!isAffine(float4x4({1, 2, 3, 4, 8, 7, 6, 5, 9, 10, 12, 11, 15, 16, 13, 14})));
+
+    float4x4 m = math::matrixFromTranslation(float3(1.f, -2.f, 3.f));
+    m = mul(m, math::matrixFromRotation(0.7f, float3(1.f, 2.f, -1.f)));
+    m = math::scale(m, float3(2.f, 0.5f, -3.f));
+    EXPECT(isAffine(m));
+
+    float4x4 expected = transpose(inverse(m));
+    float4x4 result = inverseTransposeAffine(m);
+    for (int r = 0; r < 4; ++r)
+        EXPECT_ALMOST_EQ(result[r], expected[r]);
+}
+
 CPU_TEST(Matrix_extractEulerAngleXYZ)
 {
     {
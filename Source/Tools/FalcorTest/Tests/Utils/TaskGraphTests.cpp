@@ -0,0 +1,212 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Algorithm/TaskGraph.h"
+#include "Utils/Threading.h"
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+enum Resource : TaskGraph::ResourceMask
+{
+    A = 1 << 0,
+    B = 1 << 1,
+    C = 1 << 2,
+};
+
+// Build a graph with a mix of dependent and independent tasks. Each task checks that all its
+// dependencies have finished before it runs and records that it finished itself.
+void buildCheckedGraph(TaskGraph& graph, std::unique_ptr<std::atomic<bool>[]>& finished, std::atomic<uint32_t>& violations, uint32_t taskCount)
+{
+    finished = std::make_unique<std::atomic<bool>[]>(taskCount);
+    for (uint32_t i = 0; i < taskCount; ++i)
+        finished[i] = false;
+
+    for (uint32_t i = 0; i < taskCount; ++i)
+    {
+        // Cycle through read/write patterns on three resources.
+        TaskGraph::ResourceMask reads = (i % 3 == 0) ? A : (i % 3 == 1) ? B : (A | C);
+        TaskGraph::ResourceMask writes = (i % 4 == 0) ? B : (i % 4 == 1) ? 0 : (i % 4 == 2) ? C : 0;
+        graph.addTask(
+            "task" + std::to_string(i), reads, writes,
+            [&graph, &finished, &violations, i]()
+            {
+                for (TaskGraph::TaskID dep : graph.getDependencies(i))
+                {
+                    if (!finished[dep])
+                        violations++;
+                }
+                std::this_thread::yield();
+                finished[i] = true;
+            }
+        );
+    }
+}
+} // namespace
+
+CPU_TEST(TaskGraph_Dependencies)
+{
+    TaskGraph graph;
+    auto noop = []() {};
+    TaskGraph::TaskID t0 = graph.addTask("writeA", 0, A, noop);
+    TaskGraph::TaskID t1 = graph.addTask("readA", A, 0, noop);
+    TaskGraph::TaskID t2 = graph.addTask("readA2", A, 0, noop);
+    TaskGraph::TaskID t3 = graph.addTask("writeB", 0, B, noop);
+    TaskGraph::TaskID t4 = graph.addTask("readBwriteA", B, A, noop);
+    TaskGraph::TaskID t5 = graph.addTask("writeB2", 0, B, noop);
+    TaskGraph::TaskID t6 = graph.addTask("readC", C, 0, noop);
+
+    EXPECT_EQ(graph.getTaskCount(), 7u);
+    EXPECT_EQ(graph.getTaskName(t4), "readBwriteA");
+
+    // Read-after-write.
+    EXPECT(graph.getDependencies(t0).empty());
+    EXPECT(graph.getDependencies(t1) == std::vector<TaskGraph::TaskID>({t0}));
+    // Two readers don't depend on each other.
+    EXPECT(graph.getDependencies(t2) == std::vector<TaskGraph::TaskID>({t0}));
+    EXPECT(graph.getDependencies(t3).empty());
+    // Write-after-write (t0), write-after-read (t1, t2) and read-after-write (t3).
+    EXPECT(graph.getDependencies(t4) == std::vector<TaskGraph::TaskID>({t0, t1, t2, t3}));
+    // Write-after-write (t3) and write-after-read (t4).
+    EXPECT(graph.getDependencies(t5) == std::vector<TaskGraph::TaskID>({t3, t4}));
+    // Untouched resource.
+    EXPECT(graph.getDependencies(t6).empty());
+}
+
+CPU_TEST(TaskGraph_ExecutionOrder)
+{
+    const uint32_t taskCount = 200;
+
+    for (bool parallel : {false, true})
+    {
+        for (uint32_t iter = 0; iter < 10; ++iter)
+        {
+            TaskGraph graph;
+            std::unique_ptr<std::atomic<bool>[]> finished;
+            std::atomic<uint32_t> violations{0};
+            buildCheckedGraph(graph, finished, violations, taskCount);
+
+            graph.execute(parallel);
+
+            EXPECT_EQ(violations.load(), 0u) << "parallel=" << parallel;
+            for (uint32_t i = 0; i < taskCount; ++i)
+                EXPECT(finished[i]) << "task " << i << " did not run, parallel=" << parallel;
+        }
+    }
+}
+
+CPU_TEST(TaskGraph_Exception)
+{
+    for (bool parallel : {false, true})
+    {
+        TaskGraph graph;
+        std::atomic<bool> dependentRan{false};
+        std::atomic<bool> independentRan{false};
+        graph.addTask("throw", 0, A, []() { throw std::runtime_error("Task error"); });
+        graph.addTask("dependent", A, 0, [&]() { dependentRan = true; });
+        graph.addTask("independent", 0, B, [&]() { independentRan = true; });
+
+        bool caught = false;
+        try
+        {
+            graph.execute(parallel);
+        }
+        catch (const std::runtime_error& e)
+        {
+            caught = std::string(e.what()) == "Task error";
+        }
+        EXPECT(caught) << "parallel=" << parallel;
+
+        // Tasks depending on the failed task must not run.
+        EXPECT(!dependentRan) << "parallel=" << parallel;
+        // Independent tasks may or may not have run when executing in parallel. Serially they come later and are skipped.
+        if (!parallel)
+            EXPECT(!independentRan);
+    }
+}
+
+CPU_TEST(TaskGraph_SerialFallback)
+{
+    // Serial execution runs all tasks in the order they were added on the calling thread.
+    {
+        TaskGraph graph;
+        std::vector<uint32_t> order;
+        std::vector<std::thread::id> threads;
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            graph.addTask(
+                "task" + std::to_string(i), 0, 0,
+                [&, i]()
+                {
+                    order.push_back(i);
+                    threads.push_back(std::this_thread::get_id());
+                }
+            );
+        }
+        graph.execute(false);
+
+        ASSERT_EQ(order.size(), 16u);
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            EXPECT_EQ(order[i], i);
+            EXPECT(threads[i] == std::this_thread::get_id());
+        }
+    }
+
+    // A graph executed from a worker thread also runs serially instead of blocking the worker.
+    if (Threading::isStarted())
+    {
+        std::vector<uint32_t> order;
+        bool onWorker = false;
+        auto task = Threading::dispatchTask(
+            [&]()
+            {
+                TaskGraph graph;
+                for (uint32_t i = 0; i < 16; ++i)
+                    graph.addTask("task" + std::to_string(i), 0, 0, [&, i]() { order.push_back(i); });
+                onWorker = Threading::isWorkerThread();
+                graph.execute(true);
+            }
+        );
+        task.finish();
+
+        EXPECT(onWorker);
+        ASSERT_EQ(order.size(), 16u);
+        for (uint32_t i = 0; i < 16; ++i)
+            EXPECT_EQ(order[i], i);
+    }
+}
+} // namespace Falcor
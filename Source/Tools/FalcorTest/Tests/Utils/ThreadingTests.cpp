@@ -0,0 +1,121 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Threading.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+CPU_TEST(Threading_DispatchTask)
+{
+    std::atomic<uint32_t> counter{0};
+    std::vector<Threading::Task> tasks;
+    for (uint32_t i = 0; i < 100; ++i)
+        tasks.push_back(Threading::dispatchTask([&]() { counter++; }));
+    for (auto& task : tasks)
+    {
+        task.finish();
+        EXPECT(!task.isRunning());
+    }
+    EXPECT_EQ(counter.load(), 100u);
+
+    Threading::Task empty;
+    EXPECT(!empty.isValid());
+    EXPECT(!empty.isRunning());
+}
+
+CPU_TEST(Threading_Continuation)
+{
+    std::vector<uint32_t> order;
+    auto task = Threading::dispatchTask([&]() { order.push_back(0); });
+    auto continuation = task.then([&]() { order.push_back(1); }).then([&]() { order.push_back(2); });
+    continuation.finish();
+    EXPECT(!task.isRunning());
+    ASSERT_EQ(order.size(), 3u);
+    for (uint32_t i = 0; i < 3; ++i)
+        EXPECT_EQ(order[i], i);
+
+    // Adding a continuation to a finished task dispatches it immediately.
+    bool ran = false;
+    task.then([&]() { ran = true; }).finish();
+    EXPECT(ran);
+}
+
+CPU_TEST(Threading_Exception)
+{
+    auto task = Threading::dispatchTask([]() { throw std::runtime_error("Task error"); });
+    bool caught = false;
+    try
+    {
+        task.finish();
+    }
+    catch (const std::runtime_error&)
+    {
+        caught = true;
+    }
+    EXPECT(caught);
+}
+
+CPU_TEST(Threading_ParallelFor)
+{
+    const uint32_t kCount = 10000;
+    std::vector<uint32_t> values(kCount, 0);
+    Threading::parallel_for(0u, kCount, [&](uint32_t i) { values[i] += i; });
+    for (uint32_t i = 0; i < kCount; ++i)
+        EXPECT_EQ(values[i], i) << "i = " << i;
+
+    // Nested loops are executed by the per-thread queues.
+    std::atomic<uint32_t> counter{0};
+    Threading::parallel_for(0, 100, [&](int) { Threading::parallel_for(0, 100, [&](int) { counter++; }, 1); }, 1);
+    EXPECT_EQ(counter.load(), 10000u);
+
+    // Empty range.
+    Threading::parallel_for(10, 10, [&](int) { counter++; });
+    EXPECT_EQ(counter.load(), 10000u);
+}
+
+CPU_TEST(Threading_ParallelReduce)
+{
+    const uint64_t kCount = 1000000;
+    uint64_t sum = Threading::parallel_reduce(
+        uint64_t(0), kCount, uint64_t(0), [](uint64_t i) { return i; }, [](uint64_t a, uint64_t b) { return a + b; }
+    );
+    EXPECT_EQ(sum, kCount * (kCount - 1) / 2);
+
+    // Non-commutative reduction must preserve index order.
+    std::string str = Threading::parallel_reduce(
+        0, 26, std::string(), [](int i) { return std::string(1, char('a' + i)); },
+        [](const std::string& a, const std::string& b) { return a + b; }, 3
+    );
+    EXPECT_EQ(str, "abcdefghijklmnopqrstuvwxyz");
+}
+} // namespace Falcor
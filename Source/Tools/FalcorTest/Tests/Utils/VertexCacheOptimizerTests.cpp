@@ -0,0 +1,174 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Geometry/VertexCacheOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+/// Create a regular grid of size x size quads with the triangles in random order.
+std::vector<uint32_t> createShuffledGrid(uint32_t size, uint32_t seed)
+{
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (uint32_t y = 0; y < size; y++)
+    {
+        for (uint32_t x = 0; x < size; x++)
+        {
+            uint32_t i0 = y * (size + 1) + x;
+            uint32_t i1 = i0 + 1;
+            uint32_t i2 = i0 + size + 1;
+            uint32_t i3 = i2 + 1;
+            triangles.push_back({i0, i1, i2});
+            triangles.push_back({i2, i1, i3});
+        }
+    }
+
+    std::mt19937 rng(seed);
+    std::shuffle(triangles.begin(), triangles.end(), rng);
+
+    std::vector<uint32_t> indices;
+    for (const auto& tri : triangles)
+        indices.insert(indices.end(), tri.begin(), tri.end());
+    return indices;
+}
+
+/// Return the triangles with each rotated so the smallest index comes first, sorted. Winding is preserved.
+std::vector<std::array<uint32_t, 3>> getCanonicalTriangles(const std::vector<uint32_t>& indices)
+{
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        std::array<uint32_t, 3> tri = {indices[i], indices[i + 1], indices[i + 2]};
+        std::rotate(tri.begin(), std::min_element(tri.begin(), tri.end()), tri.end());
+        triangles.push_back(tri);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+} // namespace
+
+CPU_TEST(VertexCacheOptimizer_Analyze)
+{
+    // Two triangles sharing an edge.
+    std::vector<uint32_t> indices = {0, 1, 2, 2, 1, 3};
+    VertexCacheStats stats = analyzeVertexCache(indices, 5);
+    EXPECT_EQ(stats.triangleCount, 2u);
+    EXPECT_EQ(stats.vertexCount, 4u);
+    EXPECT_EQ(stats.transformCount, 4u);
+    EXPECT_EQ(stats.getACMR(), 2.f);
+    EXPECT_EQ(stats.getATVR(), 1.f);
+
+    // With a cache of size 1 only consecutive references hit.
+    stats = analyzeVertexCache(indices, 5, 1);
+    EXPECT_EQ(stats.transformCount, 5u);
+
+    // Empty input.
+    stats = analyzeVertexCache({}, 0);
+    EXPECT_EQ(stats.triangleCount, 0u);
+    EXPECT_EQ(stats.getACMR(), 0.f);
+    EXPECT_EQ(stats.getATVR(), 0.f);
+}
+
+CPU_TEST(VertexCacheOptimizer_Grid)
+{
+    const uint32_t size = 64;
+    const uint32_t vertexCount = (size + 1) * (size + 1);
+    std::vector<uint32_t> indices = createShuffledGrid(size, 1);
+
+    VertexCacheStats before = analyzeVertexCache(indices, vertexCount);
+    std::vector<uint32_t> optimized = optimizeVertexCache(indices, vertexCount);
+    VertexCacheStats after = analyzeVertexCache(optimized, vertexCount);
+
+    // The same triangles with the same winding must be emitted.
+    ASSERT_EQ(optimized.size(), indices.size());
+    EXPECT(getCanonicalTriangles(optimized) == getCanonicalTriangles(indices));
+
+    // A shuffled grid transforms each vertex several times. After optimization the
+    // ACMR should be close to the optimum of 0.5 for a regular grid.
+    EXPECT_GT(before.getACMR(), 2.f);
+    EXPECT_LT(after.getACMR(), 0.8f);
+    EXPECT_LT(after.getATVR(), 1.6f);
+    EXPECT_EQ(after.vertexCount, vertexCount);
+
+    // The result must be deterministic.
+    EXPECT(optimizeVertexCache(indices, vertexCount) == optimized);
+
+    // Optimizing an already optimized index buffer should not make it worse.
+    std::vector<uint32_t> reoptimized = optimizeVertexCache(optimized, vertexCount);
+    EXPECT_LE(analyzeVertexCache(reoptimized, vertexCount).transformCount, after.transformCount);
+}
+
+CPU_TEST(VertexCacheOptimizer_DegenerateTriangles)
+{
+    std::vector<uint32_t> indices = {0, 0, 1, 1, 2, 2, 0, 1, 2, 3, 3, 3};
+    std::vector<uint32_t> optimized = optimizeVertexCache(indices, 4);
+    ASSERT_EQ(optimized.size(), indices.size());
+    EXPECT(getCanonicalTriangles(optimized) == getCanonicalTriangles(indices));
+}
+
+CPU_TEST(VertexCacheOptimizer_VertexFetch)
+{
+    const uint32_t size = 16;
+    // Add a few extra vertices that are not referenced.
+    const uint32_t vertexCount = (size + 1) * (size + 1) + 3;
+    const std::vector<uint32_t> indices = createShuffledGrid(size, 2);
+
+    std::vector<uint32_t> remapped = indices;
+    std::vector<uint32_t> remap = optimizeVertexFetch(remapped, vertexCount);
+    ASSERT_EQ(remap.size(), vertexCount);
+    ASSERT_EQ(remapped.size(), indices.size());
+
+    // The remap table must be a permutation.
+    std::vector<uint32_t> sortedRemap = remap;
+    std::sort(sortedRemap.begin(), sortedRemap.end());
+    for (uint32_t i = 0; i < vertexCount; i++)
+        EXPECT_EQ(sortedRemap[i], i);
+
+    // Indices must be rewritten with the remap table, and vertices numbered in order of first use.
+    uint32_t nextIndex = 0;
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        EXPECT_EQ(remapped[i], remap[indices[i]]);
+        EXPECT_LE(remapped[i], nextIndex);
+        if (remapped[i] == nextIndex)
+            nextIndex++;
+    }
+
+    // Unreferenced vertices are placed last in their original order.
+    EXPECT_EQ(nextIndex, vertexCount - 3);
+    EXPECT_EQ(remap[vertexCount - 3], vertexCount - 3);
+    EXPECT_EQ(remap[vertexCount - 2], vertexCount - 2);
+    EXPECT_EQ(remap[vertexCount - 1], vertexCount - 1);
+}
+} // namespace Falcor
@@ -30,7 +30,7 @@
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
 #include "Utils/StringUtils.h"
-#include "Utils/NumericRange.h"
+#include "Utils/Threading.h"
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Math/FalcorMath.h"
@@ -39,6 +39,7 @@
 #include "Scene/Material/Material.h"
 #include "Scene/Material/StandardMaterial.h"
 
+#include <assimp/DefaultIOSystem.h>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
@@ -46,7 +47,6 @@
 
 #include <pybind11/pybind11.h>
 
-#include <execution>
 #include <fstream>
 
 namespace Falcor
@@ -187,6 +187,27 @@ private:
     std::map<const std::string, std::vector<const aiNode*>> mAiNodes;
 };
 
+/**
+ * Assimp IO system that records every file Assimp opens as a scene dependency.
+ * This includes the files referenced by the scene file, e.g. .mtl files of OBJ scenes or .bin buffers of glTF scenes.
+ */
+class DependencyIOSystem : public Assimp::DefaultIOSystem
+{
+public:
+    DependencyIOSystem(SceneBuilder& builder) : mBuilder(builder) {}
+
+    Assimp::IOStream* Open(const char* pFile, const char* pMode) override
+    {
+        Assimp::IOStream* pStream = Assimp::DefaultIOSystem::Open(pFile, pMode);
+        if (pStream)
+            mBuilder.addDependency(pFile);
+        return pStream;
+    }
+
+private:
+    SceneBuilder& mBuilder;
+};
+
 using KeyframeList = std::list<Animation::Keyframe>;
 
 struct AnimationChannelData
@@ -584,26 +605,31 @@ void createMeshes(ImporterData& data)
         meshes.push_back(pMesh);
     }
 
-    // Pre-process meshes.
-    std::vector<SceneBuilder::ProcessedMesh> processedMeshes(meshes.size());
-    auto range = NumericRange<size_t>(0, meshes.size());
-    std::for_each(
-        std::execution::par, range.begin(), range.end(),
+    // Temporary memory for the vertex and index data. This needs to stay alive until the meshes are added.
+    struct MeshBuffers
+    {
+        std::vector<uint32_t> indexList;
+        std::vector<float2> texCrds;
+        std::vector<float4> tangents;
+        std::vector<uint4> boneIds;
+        std::vector<float4> boneWeights;
+    };
+
+    // Convert meshes to the scene builder format.
+    std::vector<SceneBuilder::Mesh> sceneMeshes(meshes.size());
+    std::vector<MeshBuffers> meshBuffers(meshes.size());
+    Threading::parallel_for(
+        size_t(0), meshes.size(),
         [&](size_t i)
         {
             const aiMesh* pAiMesh = meshes[i];
             const uint32_t perFaceIndexCount = pAiMesh->mFaces[0].mNumIndices;
 
-            SceneBuilder::Mesh mesh;
+            SceneBuilder::Mesh& mesh = sceneMeshes[i];
             mesh.name = pAiMesh->mName.C_Str();
             mesh.faceCount = pAiMesh->mNumFaces;
 
-            // Temporary memory for the vertex and index data.
-            std::vector<uint32_t> indexList;
-            std::vector<float2> texCrds;
-            std::vector<float4> tangents;
-            std::vector<uint4> boneIds;
-            std::vector<float4> boneWeights;
+            auto& [indexList, texCrds, tangents, boneIds, boneWeights] = meshBuffers[i];
 
             // Indices
             createIndexList(pAiMesh, indexList);
@@ -648,19 +674,16 @@ void createMeshes(ImporterData& data)
             }
 
             mesh.pMaterial = data.materialMap.at(pAiMesh->mMaterialIndex);
-
-            processedMeshes[i] = data.builder.processMesh(mesh);
-        }
+        },
+        1
     );
 
-    // Add meshes to the scene.
-    // We retain a deterministic order of the meshes in the global scene buffer by adding
-    // them sequentially after being processed in parallel.
-    uint32_t i = 0;
-    for (const auto& mesh : processedMeshes)
+    // Pre-process and add meshes to the scene.
+    // The meshes are processed in parallel and added in order, retaining a deterministic order of the meshes in the global scene buffer.
+    auto meshIDs = data.builder.addMeshes(sceneMeshes);
+    for (uint32_t i = 0; i < (uint32_t)meshIDs.size(); ++i)
     {
-        MeshID meshID = data.builder.addProcessedMesh(mesh);
-        data.meshMap[i++] = meshID;
+        data.meshMap[i] = meshIDs[i];
     }
 }
 
@@ -1140,6 +1163,8 @@ void importInternal(const void* buffer, size_t byteSize, const std::filesystem::
         FALCOR_ASSERT(buffer == nullptr && byteSize == 0);
         if (!path.is_absolute())
             throw ImporterError(path, "Expected absolute path.");
+        // The importer takes ownership of the IO system.
+        importer.SetIOHandler(new DependencyIOSystem(builder));
         pScene = importer.ReadFile(path.string().c_str(), assimpFlags);
     }
     else
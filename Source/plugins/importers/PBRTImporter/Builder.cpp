@@ -126,6 +126,11 @@ void BasicScene::addInstances(std::vector<InstanceSceneEntity>& instances)
     std::move(instances.begin(), instances.end(), std::back_inserter(mInstances));
 }
 
+void BasicScene::addIncludedFile(const std::filesystem::path& path)
+{
+    mIncludedFiles.push_back(path);
+}
+
 const MaterialSceneEntity& BasicScene::getMaterial(const MaterialRef& materialRef) const
 {
     if (const uint32_t* pIndex = std::get_if<uint32_t>(&materialRef))
@@ -455,6 +460,11 @@ void BasicSceneBuilder::onObjectInstance(const std::string& name, FileLoc loc)
     mInstances.push_back(std::move(instance));
 }
 
+void BasicSceneBuilder::onInclude(const std::filesystem::path& path, FileLoc loc)
+{
+    mScene.addIncludedFile(path);
+}
+
 void BasicSceneBuilder::onEndOfFiles()
 {
     if (mCurrentBlock != BlockState::WorldBlock)
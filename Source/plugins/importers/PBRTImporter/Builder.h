@@ -245,6 +245,7 @@ public:
     void addShapes(std::vector<ShapeSceneEntity>& shapes);
     void addInstanceDefinition(InstanceDefinitionSceneEntity instanceDefinition);
     void addInstances(std::vector<InstanceSceneEntity>& instances);
+    void addIncludedFile(const std::filesystem::path& path);
 
     const CameraSceneEntity& getCamera() const { return mCamera; }
 
@@ -257,6 +258,7 @@ public:
     const std::vector<ShapeSceneEntity>& getShapes() const { return mShapes; }
     const std::map<std::string, InstanceDefinitionSceneEntity>& getInstanceDefinitions() const { return mInstanceDefinitions; }
     const std::vector<InstanceSceneEntity>& getInstances() const { return mInstances; }
+    const std::vector<std::filesystem::path>& getIncludedFiles() const { return mIncludedFiles; }
 
     /**
      * Get a named or unnamed material.
@@ -290,6 +292,7 @@ private:
 
     std::map<std::string, InstanceDefinitionSceneEntity> mInstanceDefinitions;
     std::vector<InstanceSceneEntity> mInstances;
+    std::vector<std::filesystem::path> mIncludedFiles;
 };
 
 constexpr uint32_t kMaxTransforms = 2;
@@ -378,6 +381,7 @@ public:
     void onObjectBegin(const std::string& name, FileLoc loc) override;
     void onObjectEnd(FileLoc loc) override;
     void onObjectInstance(const std::string& name, FileLoc loc) override;
+    void onInclude(const std::filesystem::path& path, FileLoc loc) override;
 
     void onEndOfFiles() override;
 
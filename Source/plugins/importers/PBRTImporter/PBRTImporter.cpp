@@ -257,7 +257,12 @@ struct BuilderContext
         return pMaterial;
     }
 
-    Resolver resolver = [this](const std::filesystem::path& path) { return scene.resolvePath(path); };
+    Resolver resolver = [this](const std::filesystem::path& path)
+    {
+        auto resolvedPath = scene.resolvePath(path);
+        builder.addDependency(resolvedPath);
+        return resolvedPath;
+    };
 };
 
 inline void warnUnsupportedType(const FileLoc& loc, const std::string_view category, const std::string_view name)
@@ -1587,7 +1592,7 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
         auto filename = params.getString("filename", "");
         auto path = ctx.resolver(filename);
 
-        shape.pTriangleMesh = Falcor::TriangleMesh::createFromFile(path.string());
+        shape.pTriangleMesh = ctx.builder.loadTriangleMesh(path);
         if (shape.pTriangleMesh)
             shape.pTriangleMesh->setName(filename);
         shape.transform = entity.transform;
@@ -1735,14 +1740,20 @@ InstanceDefinition createInstanceDefinition(BuilderContext& ctx, const InstanceD
 {
     InstanceDefinition instanceDefinition;
 
+    // Triangle meshes are collected and added as a batch to pre-process them in parallel.
+    std::vector<ref<TriangleMesh>> triangleMeshes;
+    std::vector<ref<Material>> materials;
+    std::vector<float4x4> transforms;
+
     for (const auto& shapeEntity : entity.shapes)
     {
         // Process shapes and create meshes.
         auto shape = createShape(ctx, shapeEntity);
         if (shape.pTriangleMesh)
         {
-            auto meshID = ctx.builder.addTriangleMesh(shape.pTriangleMesh, shape.pMaterial);
-            instanceDefinition.meshes.emplace_back(meshID, shape.transform);
+            triangleMeshes.push_back(shape.pTriangleMesh);
+            materials.push_back(shape.pMaterial);
+            transforms.push_back(shape.transform);
         }
 
         // Create curves from curve aggregates assembled during the processing step above.
@@ -1765,6 +1776,12 @@ InstanceDefinition createInstanceDefinition(BuilderContext& ctx, const InstanceD
         ctx.curveAggregates.clear();
     }
 
+    auto meshIDs = ctx.builder.addTriangleMeshes(triangleMeshes, materials);
+    for (size_t i = 0; i < meshIDs.size(); ++i)
+    {
+        instanceDefinition.meshes.emplace_back(meshIDs[i], transforms[i]);
+    }
+
     return instanceDefinition;
 }
 
@@ -1820,15 +1837,37 @@ void buildScene(BuilderContext& ctx)
     }
 
     // Process shapes and create meshes.
-    for (const auto& entity : ctx.scene.getShapes())
+    // Shapes are loaded sequentially and the resulting triangle meshes are added in batches,
+    // which pre-processes them in parallel while bounding the amount of memory held at once.
     {
-        auto shape = createShape(ctx, entity);
-        if (shape.pTriangleMesh)
+        const size_t kMeshBatchSize = 1024;
+        std::vector<ref<TriangleMesh>> triangleMeshes;
+        std::vector<ref<Material>> materials;
+        std::vector<NodeID> nodeIDs;
+
+        auto addMeshBatch = [&]()
         {
-            auto nodeID = ctx.builder.addNode({entity.name, shape.transform});
-            auto meshID = ctx.builder.addTriangleMesh(shape.pTriangleMesh, shape.pMaterial);
-            ctx.builder.addMeshInstance(nodeID, meshID);
+            auto meshIDs = ctx.builder.addTriangleMeshes(triangleMeshes, materials);
+            for (size_t i = 0; i < meshIDs.size(); ++i)
+                ctx.builder.addMeshInstance(nodeIDs[i], meshIDs[i]);
+            triangleMeshes.clear();
+            materials.clear();
+            nodeIDs.clear();
+        };
+
+        for (const auto& entity : ctx.scene.getShapes())
+        {
+            auto shape = createShape(ctx, entity);
+            if (shape.pTriangleMesh)
+            {
+                nodeIDs.push_back(ctx.builder.addNode({entity.name, shape.transform}));
+                triangleMeshes.push_back(shape.pTriangleMesh);
+                materials.push_back(shape.pMaterial);
+                if (triangleMeshes.size() >= kMeshBatchSize)
+                    addMeshBatch();
+            }
         }
+        addMeshBatch();
     }
 
     // Create curves from curve aggregates assembled during the processing step above.
@@ -1899,6 +1938,8 @@ void PBRTImporter::importScene(const std::filesystem::path& path, SceneBuilder&
         pbrt::BasicScene pbrtScene(path.parent_path());
         pbrt::BasicSceneBuilder pbrtBuilder(pbrtScene);
         pbrt::parseFile(pbrtBuilder, path);
+        for (const auto& includedFile : pbrtScene.getIncludedFiles())
+            builder.addDependency(includedFile);
         timeReport.measure("Parsing pbrt scene");
 
         pbrt::BuilderContext ctx{pbrtScene, builder};
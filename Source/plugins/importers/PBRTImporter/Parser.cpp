@@ -635,6 +635,7 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
                 auto path = searchPath / filename;
                 std::unique_ptr<Tokenizer> includeTokenizer = Tokenizer::createFromFile(path);
                 logInfo("PBRTImporter: Started parsing '{}'.", includeTokenizer->getPath().string());
+                target.onInclude(includeTokenizer->getPath(), tok->loc);
                 fileStack.push_back(std::move(includeTokenizer));
             }
             else if (tok->token == "Import")
@@ -533,8 +533,9 @@ StandardMaterialSpec::ConvertedInput PreviewSurfaceConverter::convertColor(
     return ret;
 }
 
-PreviewSurfaceConverter::PreviewSurfaceConverter(ref<Device> pDevice)
-    : mpDevice(pDevice)
+PreviewSurfaceConverter::PreviewSurfaceConverter(SceneBuilder& builder)
+    : mBuilder(builder)
+    , mpDevice(builder.getDevice())
 {
     mpSpecTransPass = ComputePass::create(mpDevice, kSpecTransShaderFile, kSpecTransShaderEntry);
 
@@ -714,6 +715,7 @@ ref<Texture> PreviewSurfaceConverter::loadTexture(const StandardMaterialSpec::Co
     {
         return nullptr;
     }
+    mBuilder.addDependency(ci.texturePath);
     if (hasExtension(ci.texturePath, ".dds"))
     {
         // It would be better if we could separate texture file reading, which is relatlvely
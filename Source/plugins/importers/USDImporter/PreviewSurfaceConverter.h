@@ -33,6 +33,7 @@
 #include "Core/Pass/ComputePass.h"
 #include "Scene/Material/Material.h"
 #include "Scene/Material/StandardMaterial.h"
+#include "Scene/SceneBuilder.h"
 #include "StandardMaterialSpec.h"
 
 BEGIN_DISABLE_USD_WARNINGS
@@ -55,8 +56,9 @@ class PreviewSurfaceConverter
 public:
     /**
      * Create a new converter, compiling required compute shaders
+     * \param builder Scene builder. Loaded textures are recorded as scene dependencies.
      */
-    PreviewSurfaceConverter(ref<Device> pDevice);
+    PreviewSurfaceConverter(SceneBuilder& builder);
 
     /**
      * Create a Falcor material from a USD material containing a UsdPreviewSurface shader.
@@ -114,6 +116,7 @@ private:
     void cacheMaterial(const UsdShadeShader& shader, ref<StandardMaterial> pMaterial);
     void cacheMaterial(const StandardMaterialSpec& spec, ref<StandardMaterial> pMaterial);
 
+    SceneBuilder& mBuilder;
     ref<Device> mpDevice;
 
     ref<ComputePass> mpSpecTransPass; ///< Pass to convert opacity to transparency